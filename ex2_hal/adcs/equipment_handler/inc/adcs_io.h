@@ -34,8 +34,15 @@
 #include <stdbool.h>
 #include <string.h>
 
-#define ADCS_QUEUE_LENGTH 1000
-#define ADCS_QUEUE_ITEM_SIZE 1
+// Receive ring for destuffed reply frames. The largest telemetry frame is 504 bytes
+#define ADCS_RX_RING_SIZE 2048
+#define ADCS_RX_FRAME_SLOTS 32
+#define ADCS_RX_MAX_FRAME_LEN 512
+
+// Largest telecommand sent, before stuffing
+#define ADCS_TC_MAX_LEN 180
+#define ADCS_TC_NO_REPLY_MAX_LEN 8
+#define ADCS_TX_FRAME_BUF_LEN (2 * ADCS_TC_MAX_LEN + ADCS_TC_HEADER_SZ)
 
 #define ADCS_I2C_ADDR 0x57
 #define UART_TIMEOUT_MS pdMS_TO_TICKS(1000)
@@ -65,6 +72,7 @@ ADCS_returnState request_i2c_telemetry(uint8_t TM_ID, uint8_t *telemetry, uint32
 
 // receive downloaded packets over uart
 ADCS_returnState receive_file_download_uart_packet(uint8_t *packet, uint16_t *packet_counter);
+uint32_t adcs_io_get_dropped_frames();
 void write_packet_to_file(int32_t file_des, uint8_t *packet_data, uint8_t length);
 ADCS_returnState adcs_io_exit_file_download_state();
 ADCS_returnState adcs_io_enter_file_download_state();
@@ -28,6 +28,12 @@
 #define ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN 20
 #define ADCS_UART_FILE_DOWNLOAD_PKT_RETRIES 10
 #define ADCS_HOLE_MAP_SIZE 128
+#define ADCS_HOLE_MAP_PART_LEN 16
+#define ADCS_FILE_DOWNLOAD_BLOCK_LEN 20480
+#define ADCS_DOWNLOAD_FILL_BYTE 0x33
+#define ADCS_BLOCK_READY_POLL_MIN_MS 10
+#define ADCS_BLOCK_READY_POLL_MAX_MS 200
+#define ADCS_BLOCK_READY_TIMEOUT_MS 10000
 
 typedef enum ADCS_returnState {
     ADCS_OK = 0,
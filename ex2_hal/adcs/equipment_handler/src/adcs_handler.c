@@ -29,13 +29,19 @@
 
 #include "adcs_io.h"
 #include "adcs_types.h"
+#include "mem_region.h"
 
 #define USE_UART
 //#define USE_I2C
 
 static SemaphoreHandle_t adcs_file_download_mutex;
 
-static ADCS_returnState ADCS_receive_download_burst(uint8_t *hole_map, int32_t file_des, uint16_t length_bytes);
+static uint16_t ADCS_download_block_length(uint32_t size, uint32_t offset);
+static ADCS_returnState ADCS_wait_download_block_ready(void);
+static ADCS_returnState ADCS_send_hole_map(uint8_t *hole_map);
+static ADCS_returnState ADCS_download_block(uint8_t *block, uint16_t block_length, uint16_t *missing);
+static void ADCS_receive_download_burst(uint8_t *hole_map, uint8_t *block, uint16_t block_length,
+                                        uint16_t *remaining);
 
 /*************************** General functions ***************************/
 /**
@@ -379,50 +385,231 @@ ADCS_returnState ADCS_download_file(uint8_t type, uint8_t counter, uint32_t size
         return ADCS_FILE_FAIL;
     }
 
-    // Loop over all blocks
-    uint16_t block_length = 20480;
-    for (uint32_t offset = 0; offset < size; offset += block_length) {
+    uint8_t *block = (uint8_t *)pvPortMalloc(ADCS_FILE_DOWNLOAD_BLOCK_LEN);
+    if (block == NULL) {
+        red_close(file1);
+        xSemaphoreGive(adcs_file_download_mutex);
+        return ADCS_MALLOC_FAILED;
+    }
 
-        // Load one block
-        ret = ADCS_load_file_download_block(type, counter, offset, block_length);
+    // Load the first block. Every following block is loaded while the previous one is written out
+    uint32_t offset = 0;
+    uint16_t block_length = ADCS_download_block_length(size, offset);
+    ret = ADCS_load_file_download_block(type, counter, offset, block_length);
+
+    uint32_t missing_total = 0;
+    while (ret == ADCS_OK && offset < size) {
+        ret = ADCS_wait_download_block_ready();
+        if (ret != ADCS_OK) {
+            break;
+        }
+
+        uint16_t missing = 0;
+        ret = ADCS_download_block(block, block_length, &missing);
+        if (ret != ADCS_OK) {
+            break;
+        }
+        if (missing != 0) {
+            sys_log(ERROR, "ADCS download block at offset %lu is missing %d packets", (unsigned long)offset,
+                    missing);
+            missing_total += missing;
+        }
+
+        // Ask the CubeComputer for the next block before the slow SD card write
+        uint32_t next_offset = offset + block_length;
+        uint16_t next_length = ADCS_download_block_length(size, next_offset);
+        if (next_offset < size) {
+            ret = ADCS_load_file_download_block(type, counter, next_offset, next_length);
+        }
+
+        if (red_write(file1, block, block_length) != block_length) {
+            sys_log(ERROR, "Unexpected error %d from red_write() in ADCS_download_file()", red_errno);
+            ret = ADCS_FILESYSTEM_FAIL;
+        }
+
+        offset = next_offset;
+        block_length = next_length;
+    }
+
+    // Close file and release download mutex
+    vPortFree(block);
+    red_close(file1);
+    xSemaphoreGive(adcs_file_download_mutex);
+
+    if (ret == ADCS_OK && missing_total != 0) {
+        return ADCS_INCORRECT_LENGTH;
+    }
+    return ret;
+}
+
+/**
+ * @brief
+ *      Length of the download block starting at offset
+ */
+static uint16_t ADCS_download_block_length(uint32_t size, uint32_t offset) {
+    if (offset >= size) {
+        return 0;
+    }
+    uint32_t remaining = size - offset;
+    return remaining < ADCS_FILE_DOWNLOAD_BLOCK_LEN ? remaining : ADCS_FILE_DOWNLOAD_BLOCK_LEN;
+}
+
+/**
+ * @brief
+ *      Poll the download block status until the CubeComputer has the block
+ *      ready, backing off between polls
+ * @return
+ * 		Success of function defined in adcs_types.h
+ */
+static ADCS_returnState ADCS_wait_download_block_ready(void) {
+    TickType_t delay = pdMS_TO_TICKS(ADCS_BLOCK_READY_POLL_MIN_MS);
+    TickType_t start = xTaskGetTickCount();
+    bool ready = false;
+    bool param_err;
+    uint16_t crc16_checksum;
+    uint16_t length;
+
+    for (;;) {
+        ADCS_returnState ret = ADCS_get_file_download_block_stat(&ready, &param_err, &crc16_checksum, &length);
         if (ret != ADCS_OK) {
-            xSemaphoreGive(adcs_file_download_mutex);
             return ret;
         }
+        if (param_err) {
+            return ADCS_INVALID_PARAMETERS;
+        }
+        if (ready) {
+            return ADCS_OK;
+        }
+        if ((xTaskGetTickCount() - start) > pdMS_TO_TICKS(ADCS_BLOCK_READY_TIMEOUT_MS)) {
+            return ADCS_UART_FAILED;
+        }
+
+        vTaskDelay(delay);
+        delay *= 2;
+        if (delay > pdMS_TO_TICKS(ADCS_BLOCK_READY_POLL_MAX_MS)) {
+            delay = pdMS_TO_TICKS(ADCS_BLOCK_READY_POLL_MAX_MS);
+        }
+    }
+}
+
+/**
+ * @brief
+ *      Send the hole map to the CubeComputer so the next burst only contains
+ *      the packets still missing
+ * @param hole_map
+ *      ADCS_HOLE_MAP_SIZE bytes, one bit per packet, set once received
+ */
+static ADCS_returnState ADCS_send_hole_map(uint8_t *hole_map) {
+    for (uint8_t num = 1; num <= ADCS_HOLE_MAP_SIZE / ADCS_HOLE_MAP_PART_LEN; num++) {
+        ADCS_returnState ret = ADCS_set_hole_map(&hole_map[(num - 1) * ADCS_HOLE_MAP_PART_LEN], num);
+        if (ret != ADCS_OK) {
+            return ret;
+        }
+    }
+    return ADCS_OK;
+}
+
+/**
+ * @brief
+ *      Download one loaded block into RAM. The first burst sends every
+ *      packet, later bursts only re-send the holes left by the previous one.
+ * @param block
+ *      Output, block_length bytes
+ * @param block_length
+ *      Length of the block loaded on the CubeComputer
+ * @param missing
+ *      Number of packets still missing after all retries. Their data is
+ *      filled with ADCS_DOWNLOAD_FILL_BYTE
+ * @return
+ * 		Success of function defined in adcs_types.h
+ */
+static ADCS_returnState ADCS_download_block(uint8_t *block, uint16_t block_length, uint16_t *missing) {
+    uint8_t hole_map[ADCS_HOLE_MAP_SIZE] = {0};
+    uint16_t num_packets = (block_length + ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN - 1) /
+                           ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN;
+    uint16_t remaining = num_packets;
+    ADCS_returnState ret = ADCS_OK;
+
+    // Packets past the end of the block must never be requested
+    for (uint16_t i = num_packets; i < ADCS_HOLE_MAP_SIZE * 8; i++) {
+        hole_map[i >> 3] |= 1 << (i & 0x07);
+    }
 
-        // Wait until block is finished loading
-        bool ready = 0;
-        bool param_err;
-        uint16_t crc16_checksum;
-        while (ready == false) {
-            ret = ADCS_get_file_download_block_stat(&ready, &param_err, &crc16_checksum, &block_length);
+    for (int attempt = 0; attempt < ADCS_UART_FILE_DOWNLOAD_PKT_RETRIES && remaining > 0; attempt++) {
+        bool ignore_hole_map = (attempt == 0);
+        if (!ignore_hole_map) {
+            ret = ADCS_send_hole_map(hole_map);
             if (ret != ADCS_OK) {
-                xSemaphoreGive(adcs_file_download_mutex);
-                return ret;
+                break;
             }
         }
 
-        // Initiate the download burst
-        uint8_t hole_map[ADCS_HOLE_MAP_SIZE] = {0};
-        bool ignore_hole_map = true; // Set Ignore Hole Map to true
-        adcs_io_enter_file_download_state();
+        ret = adcs_io_enter_file_download_state();
+        if (ret != ADCS_OK) {
+            break;
+        }
         ret = ADCS_initiate_download_burst(ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN, ignore_hole_map);
+        if (ret == ADCS_OK) {
+            ADCS_receive_download_burst(hole_map, block, block_length, &remaining);
+        }
+        adcs_io_exit_file_download_state();
         if (ret != ADCS_OK) {
-            red_close(file1);
-            xSemaphoreGive(adcs_file_download_mutex);
-            adcs_io_exit_file_download_state();
-            return ret;
+            break;
         }
+    }
 
-        // Receive the download burst and write to file
-        ADCS_receive_download_burst(hole_map, file1, block_length);
-        adcs_io_exit_file_download_state();
+    // Fill whatever never arrived so the file keeps its layout
+    for (uint16_t i = 0; i < num_packets; i++) {
+        if ((hole_map[i >> 3] & (1 << (i & 0x07))) == 0) {
+            uint32_t start = (uint32_t)i * ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN;
+            uint32_t len = block_length - start;
+            if (len > ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN) {
+                len = ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN;
+            }
+            memset(&block[start], ADCS_DOWNLOAD_FILL_BYTE, len);
+        }
     }
+    *missing = remaining;
+    return ret;
+}
 
-    // Close file and release download mutex
-    red_close(file1);
-    xSemaphoreGive(adcs_file_download_mutex);
-    return ADCS_OK;
+/**
+ * @brief
+ *      Receives a download burst from ADCS into the block buffer.
+ * @param hole_map
+ *      Tracks received packets, one bit per packet
+ * @param block
+ *      Block buffer being filled
+ * @param block_length
+ *      Length of the block
+ * @param remaining
+ *      Number of packets not yet received. Updated as packets arrive
+ */
+static void ADCS_receive_download_burst(uint8_t *hole_map, uint8_t *block, uint16_t block_length,
+                                        uint16_t *remaining) {
+    uint8_t pckt[ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN];
+    uint16_t pckt_counter = 0;
+
+    while (*remaining > 0) {
+        // A timeout means the burst is over
+        if (receive_file_download_uart_packet(pckt, &pckt_counter) != ADCS_OK) {
+            break;
+        }
+
+        uint32_t start = (uint32_t)pckt_counter * ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN;
+        if (start >= block_length || (hole_map[pckt_counter >> 3] & (1 << (pckt_counter & 0x07)))) {
+            // Out of range or duplicate
+            continue;
+        }
+
+        uint32_t len = block_length - start;
+        if (len > ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN) {
+            len = ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN;
+        }
+        memcpy(&block[start], pckt, len);
+        hole_map[pckt_counter >> 3] |= 1 << (pckt_counter & 0x07);
+        (*remaining)--;
+    }
 }
 
 /*************************** Common TCs ***************************/
@@ -653,79 +840,6 @@ ADCS_returnState ADCS_initiate_download_burst(uint8_t msg_length, bool ignore_ho
     return send_uart_telecommand_no_reply(command, 3);
 }
 
-/**
- * @brief
- *      Receives download burst from ADCS and writes packet data to file.
- * @param hole map
- *      Tracks missed packets
- * @param file_des
- *      File being written to
- * @param length_bytes
- *      Length of file being downloaded
- */
-static ADCS_returnState ADCS_receive_download_burst(uint8_t *hole_map, int32_t file_des, uint16_t length_bytes) {
-
-    ADCS_returnState err;
-
-    uint16_t num_packets = length_bytes / ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN;
-    if ((length_bytes % 20) != 0)
-        num_packets++;
-    uint8_t pckt[ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN];
-    uint16_t pckt_counter = 0;
-
-    uint8_t dummy_data[20] = {0x33};
-
-    for (int i = 0; i < num_packets; i++) {
-
-        err = receive_file_download_uart_packet(pckt, &pckt_counter);
-
-        if (err == ADCS_UART_FAILED) {
-            // End of file earlier than expected or other error
-            break;
-
-        } else if (pckt_counter != i) {
-
-            // Missed a packet (or more) somewhere. Stuff.
-            int j = 0;
-            for (; j < (pckt_counter - i); j++) {
-
-                if (!(length_bytes < 20)) {
-
-                    // More than 20 bytes remaining. Stuff file with full length of dummy data.
-                    write_packet_to_file(file_des, dummy_data, ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN);
-                    length_bytes -= ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN;
-
-                } else {
-
-                    // Less than 20 bytes remaining. Stuff file with only remaining length of dummy data.
-                    write_packet_to_file(file_des, dummy_data, length_bytes);
-                    length_bytes = 0;
-                    break;
-                }
-            }
-
-            i += j;
-
-        } else {
-
-            // Packet received. Write to file
-            if (!(length_bytes < 20)) {
-
-                // More than 20 bytes remaining. Write full packet payload to file.
-                write_packet_to_file(file_des, pckt, ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN);
-                length_bytes -= ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN;
-
-            } else {
-
-                // Less than 20 bytes remaining. Write only remaining data from packet to file.
-                write_packet_to_file(file_des, pckt, length_bytes);
-                length_bytes = 0;
-            }
-        }
-    }
-    return err;
-}
-
 /*************************** Common TMs ***************************/
 /**
  * @brief
@@ -2774,7 +2888,7 @@ ADCS_returnState ADCS_set_star_track_config(cubestar_config config) {
  */
 ADCS_returnState ADCS_get_cubesense_config(cubesense_config *config) {
 
-    uint8_t *telemetry = (uint8_t *)pvPortMalloc(112);
+    uint8_t *telemetry = (uint8_t *)mem_region_alloc(112);
     if (telemetry == NULL) {
         return ADCS_MALLOC_FAILED;
     }
@@ -2867,7 +2981,7 @@ ADCS_returnState ADCS_get_cubesense_config(cubesense_config *config) {
     config->cam2_area.area5.y.min = (telemetry[109] << 8) | telemetry[108];
     config->cam2_area.area5.y.max = (telemetry[111] << 8) | telemetry[110];
 
-    vPortFree(telemetry);
+    mem_region_free(telemetry);
 
     return state;
 }
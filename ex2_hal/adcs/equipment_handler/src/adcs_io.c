@@ -21,16 +21,41 @@
 #include "adcs_types.h"
 #include "logger.h"
 
-static QueueHandle_t adcsQueue;
 static uint8_t adcsBuffer;
 static SemaphoreHandle_t tx_semphr;
+static SemaphoreHandle_t rx_frame_semphr;
 static SemaphoreHandle_t adcs_uart_mutex;
 
 bool downloading_file = false;
 
-static void adcs_byte_stuff(uint8_t *thin_cmd, uint8_t *stuffed_cmd, uint8_t thin_length, uint8_t *stuffed_length);
-static void adcs_byte_destuff(uint8_t *stuffed_reply, uint8_t *thin_reply, uint16_t stuffed_length,
-                              uint16_t *thin_length);
+/* Receive side frame parser state. Bytes are destuffed in place as they arrive
+ * from the ISR and land in rx_ring. Completed frames are described in rx_frames
+ * and the waiting task is woken once per frame through rx_frame_semphr.
+ */
+typedef enum { ADCS_RX_IDLE, ADCS_RX_IDLE_ESC, ADCS_RX_FRAME, ADCS_RX_FRAME_ESC } adcs_rx_state_t;
+
+typedef struct {
+    uint32_t start;
+    uint16_t length;
+} adcs_rx_frame_t;
+
+static uint8_t rx_ring[ADCS_RX_RING_SIZE];
+static adcs_rx_frame_t rx_frames[ADCS_RX_FRAME_SLOTS];
+static adcs_rx_state_t rx_state = ADCS_RX_IDLE;
+static uint32_t rx_write;               // ISR: next free byte in rx_ring
+static uint32_t rx_frame_start;         // ISR: start of the frame being assembled
+static volatile uint32_t rx_read;       // Task: first byte of the oldest unconsumed frame
+static volatile uint32_t rx_frame_head; // ISR: next free slot in rx_frames
+static volatile uint32_t rx_frame_tail; // Task: oldest unconsumed slot in rx_frames
+static volatile uint32_t rx_dropped_frames;
+
+static uint8_t tx_frame[ADCS_TX_FRAME_BUF_LEN];
+
+static uint16_t adcs_build_frame(const uint8_t *command, uint16_t length, uint8_t *frame);
+static void adcs_rx_byte_from_isr(uint8_t byte, BaseType_t *xHigherPriorityTaskWoken);
+static void adcs_rx_flush(void);
+static ADCS_returnState adcs_rx_get_frame(uint8_t *id, uint8_t *data, uint32_t max_length, uint16_t *length,
+                                          TickType_t timeout);
 
 /**
  * @Brief
@@ -44,9 +69,9 @@ ADCS_returnState init_adcs_io() {
     if (tx_semphr == NULL)
         return ADCS_UART_FAILED;
 
-    // Create receive queue
-    adcsQueue = xQueueCreate(ADCS_QUEUE_LENGTH, ADCS_QUEUE_ITEM_SIZE);
-    if (adcsQueue == NULL) {
+    // Create receive frame semaphore, given once per complete frame
+    rx_frame_semphr = xSemaphoreCreateCounting(ADCS_RX_FRAME_SLOTS, 0);
+    if (rx_frame_semphr == NULL) {
         return ADCS_UART_FAILED;
     }
 
@@ -69,14 +94,14 @@ ADCS_returnState init_adcs_io() {
 
 /**
  * @Brief
- *      sciNotification for ADCS_SCI. Handles adding to receive queue
+ *      sciNotification for ADCS_SCI. Feeds the receive frame parser
  */
 void adcs_sciNotification(sciBASE_t *sci, int flags) {
     portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
     switch (flags) {
     case SCI_RX_INT:
-        xQueueSendToBackFromISR(adcsQueue, &adcsBuffer, &xHigherPriorityTaskWoken);
+        adcs_rx_byte_from_isr(adcsBuffer, &xHigherPriorityTaskWoken);
         sciReceive(sci, 1, &adcsBuffer);
         portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
         break;
@@ -89,6 +114,13 @@ void adcs_sciNotification(sciBASE_t *sci, int flags) {
     }
 }
 
+/**
+ * @brief
+ *      Number of received frames discarded because the frame ring was full or
+ *      the frame was malformed
+ */
+uint32_t adcs_io_get_dropped_frames() { return rx_dropped_frames; }
+
 /**
  * @brief
  *      Send telecommand via UART protocol
@@ -99,97 +131,71 @@ void adcs_sciNotification(sciBASE_t *sci, int flags) {
  *
  */
 ADCS_returnState send_uart_telecommand(uint8_t *command, uint32_t length) {
+    if (length > ADCS_TC_MAX_LEN) {
+        return ADCS_INCORRECT_LENGTH;
+    }
+
     if (xSemaphoreTake(adcs_uart_mutex, UART_TIMEOUT_MS) != pdTRUE) {
         return ADCS_UART_BUSY;
     } //  TODO: create response if it times out.
 
-    // Stuff the command
-    uint8_t stuffed_length = length;
-    uint8_t *stuffed_command = (uint8_t *)pvPortMalloc((length + 10) * sizeof(uint8_t));
-    if (stuffed_command == NULL) {
-        xSemaphoreGive(adcs_uart_mutex);
-        return ADCS_MALLOC_FAILED;
-    }
-    adcs_byte_stuff(command, stuffed_command, length, &stuffed_length);
-
-    // Form the command frame
-    uint8_t *frame = (uint8_t *)pvPortMalloc((stuffed_length + ADCS_TC_HEADER_SZ) * sizeof(uint8_t));
-    if (frame == NULL) {
-        vPortFree(stuffed_command);
-        xSemaphoreGive(adcs_uart_mutex);
-        return ADCS_MALLOC_FAILED;
-    }
-    *frame = ADCS_ESC_CHAR;
-    *(frame + 1) = ADCS_SOM;
-    memcpy((frame + 2), stuffed_command, stuffed_length);
-    *(frame + stuffed_length + 2) = ADCS_ESC_CHAR;
-    *(frame + stuffed_length + 3) = ADCS_EOM;
-    vPortFree(stuffed_command);
+    // Stuff the command directly into the frame buffer
+    uint16_t frame_length = adcs_build_frame(command, length, tx_frame);
 
     // Send the command frame
-    sciSend(ADCS_SCI, stuffed_length + ADCS_TC_HEADER_SZ, frame);
+    adcs_rx_flush();
+    sciSend(ADCS_SCI, frame_length, tx_frame);
 
     if (xSemaphoreTake(tx_semphr, UART_TIMEOUT_MS) != pdTRUE) {
         xSemaphoreGive(adcs_uart_mutex);
-        vPortFree(frame);
         return ADCS_UART_FAILED;
     } // TODO: create response if it times out.
 
-    // Receive the reply
-    int received = 0;
-    uint8_t reply[ADCS_TC_ANS_LEN];
+    // Receive the reply: TC ID followed by the TC error flag
+    uint8_t reply_id;
+    uint8_t TC_err_flag;
+    uint16_t reply_length;
+    ADCS_returnState ret = adcs_rx_get_frame(&reply_id, &TC_err_flag, 1, &reply_length, UART_TIMEOUT_MS);
+    xSemaphoreGive(adcs_uart_mutex);
 
-    while (received < ADCS_TC_ANS_LEN) {
-        if (xQueueReceive(adcsQueue, reply + received, UART_TIMEOUT_MS) == pdFAIL) {
-            xSemaphoreGive(adcs_uart_mutex);
-            vPortFree(frame);
-            return ADCS_UART_FAILED;
-        } else {
-            received++;
-        }
+    if (ret != ADCS_OK) {
+        return ret;
     }
-
-    ADCS_returnState TC_err_flag = (ADCS_returnState)reply[3];
-    xSemaphoreGive(adcs_uart_mutex);
-    xQueueReset(adcsQueue);
-    vPortFree(frame);
-    return TC_err_flag;
+    if (reply_length < 1) {
+        return ADCS_INCORRECT_LENGTH;
+    }
+    return (ADCS_returnState)TC_err_flag;
 }
 
 /**
  * @brief
  *      Send telecommand via UART protocol. Expect no reply.
- * @param TM_ID
- *      Telemetry ID byte
- * @param telemetry
- *    Received telemetry data
- * @param expected_len
- *      Expected length of the data (in bytes)
+ * @details
+ *      The frame is byte stuffed like every other telecommand. This path used to
+ *      send the data as it was, which the ADCS misreads when a data byte is 0x1F,
+ *      e.g. an ADCS_initiate_download_burst message length of 31
+ * @param command
+ *      Telecommand frame
+ * @param length
+ *      Length of the data (in bytes)
  *
  */
 ADCS_returnState send_uart_telecommand_no_reply(uint8_t *command, uint32_t length) {
-
-    // Form the command frame
-    uint8_t *frame = (uint8_t *)pvPortMalloc((length + ADCS_TC_HEADER_SZ) * sizeof(uint8_t));
-    if (frame == NULL) {
-        return ADCS_MALLOC_FAILED;
+    if (length > ADCS_TC_NO_REPLY_MAX_LEN) {
+        return ADCS_INCORRECT_LENGTH;
     }
 
-    *frame = ADCS_ESC_CHAR;
-    *(frame + 1) = ADCS_SOM;
-    memcpy((frame + 2), command, length);
-    *(frame + length + 2) = ADCS_ESC_CHAR;
-    *(frame + length + 3) = ADCS_EOM;
+    // Form the command frame. These commands are a few bytes long so the frame lives on the stack
+    uint8_t frame[2 * ADCS_TC_NO_REPLY_MAX_LEN + ADCS_TC_HEADER_SZ];
+    uint16_t frame_length = adcs_build_frame(command, length, frame);
 
     // Send the command frame
-    sciSend(ADCS_SCI, length + ADCS_TC_HEADER_SZ, frame);
+    sciSend(ADCS_SCI, frame_length, frame);
 
     if (xSemaphoreTake(tx_semphr, UART_TIMEOUT_MS) != pdTRUE) {
-        vPortFree(frame);
         return ADCS_UART_FAILED;
     } // TODO: create response if it times out.
 
-    vPortFree(frame);
     return ADCS_OK;
 }
 
@@ -239,126 +245,61 @@ ADCS_returnState request_uart_telemetry(uint8_t TM_ID, uint8_t *telemetry, uint3
 
     // Form the command frame
     uint8_t frame[ADCS_TM_HEADER_SZ];
-    frame[0] = ADCS_ESC_CHAR;
-    frame[1] = ADCS_SOM;
+    frame[0] = ADCS_PARSING_BYTE;
+    frame[1] = ADCS_STARTING_BYTE;
     frame[2] = TM_ID;
-    frame[3] = ADCS_ESC_CHAR;
-    frame[4] = ADCS_EOM;
+    frame[3] = ADCS_PARSING_BYTE;
+    frame[4] = ADCS_ENDING_BYTE;
 
     // Send the command frame
+    adcs_rx_flush();
     sciSend(ADCS_SCI, ADCS_TM_HEADER_SZ, frame);
     if (xSemaphoreTake(tx_semphr, UART_TIMEOUT_MS) != pdTRUE) {
         xSemaphoreGive(adcs_uart_mutex);
         return ADCS_UART_FAILED;
     }
 
-    int received = 0;
-
-    uint8_t *reply = (uint8_t *)pvPortMalloc(length + ADCS_TM_HEADER_SZ);
-    if (reply == NULL) {
-        xSemaphoreGive(adcs_uart_mutex);
-        return ADCS_MALLOC_FAILED;
-    }
-
-    bool end_of_message = false;
-    const uint8_t ending_bytes[ADCS_NUM_ENDING_BYTES] = {ADCS_PARSING_BYTE, ADCS_ENDING_BYTE};
-    uint8_t ending_bytes_index = 0;
-
-    while (!end_of_message) {
-        if (xQueueReceive(adcsQueue, reply + received, UART_TIMEOUT_MS) == pdFAIL) {
-            xSemaphoreGive(adcs_uart_mutex);
-            vPortFree(reply);
-            return ADCS_UART_FAILED;
-        } else {
-            // Check for EOM
-            if (*(reply + received) == ending_bytes[ending_bytes_index]) {
-                ending_bytes_index++;
-
-                if (ending_bytes_index == ADCS_NUM_ENDING_BYTES)
-                    end_of_message = true;
-            } else {
-                ending_bytes_index = 0;
-            }
-            received++;
-        }
-    }
-
-    // Destuff the reply
-    uint8_t *thin_reply = (uint8_t *)pvPortMalloc((received - ADCS_TM_HEADER_SZ) * sizeof(uint8_t));
-    if (thin_reply == NULL) {
-        vPortFree(reply);
-        xSemaphoreGive(adcs_uart_mutex);
-        return ADCS_MALLOC_FAILED;
-    }
+    // The reply frame is the TM ID followed by the telemetry, destuffed by the ISR
+    uint8_t reply_id;
     uint16_t thin_length;
-    adcs_byte_destuff((reply + ADCS_TM_DATA_INDEX), thin_reply, received - ADCS_TM_HEADER_SZ, &thin_length);
-
-    for (int i = 0; i < thin_length; i++) {
-        *(telemetry + i) = *(thin_reply + i);
+    ADCS_returnState ret = adcs_rx_get_frame(&reply_id, telemetry, length, &thin_length, UART_TIMEOUT_MS);
+    if (ret == ADCS_OK && reply_id != TM_ID) {
+        ret = ADCS_INVALID_ID;
+    } else if (ret == ADCS_OK && thin_length != length) {
+        ret = ADCS_INCORRECT_LENGTH;
     }
-    vPortFree(reply);
-    vPortFree(thin_reply);
+
     xSemaphoreGive(adcs_uart_mutex);
-    xQueueReset(adcsQueue);
-    return ADCS_OK;
+    return ret;
 }
 
 /**
  * @brief
  *      Receive packet sent by ADCS from file download request
- * @param hole_map
- *      Map that captures which packets have been sent, and which have not
- * @param image_bytes
- *    the actual image data
+ * @param packet
+ *      Buffer for the packet data (ADCS_UART_FILE_DOWNLOAD_PKT_DATA_LEN bytes)
+ * @param packet_counter
+ *      Packet number within the current block
  *
  */
 ADCS_returnState receive_file_download_uart_packet(uint8_t *packet, uint16_t *packet_counter) {
+    // Destuffed packet: 2 byte packet counter followed by the packet data
+    uint8_t thin_reply[ADCS_UART_FILE_DOWNLOAD_PKT_LEN - ADCS_TM_HEADER_SZ];
+    uint8_t reply_id;
+    uint16_t thin_length;
 
-    uint8_t received = 0; // Number of bytes received from the queue
-    uint8_t reply[ADCS_UART_FILE_DOWNLOAD_PKT_LEN + ADCS_EXTRA_SZ_FOR_STUFFING];
-
-    bool end_of_message = false;
-    bool start_of_message = false;
-    const uint8_t ending_bytes[2] = {ADCS_PARSING_BYTE, ADCS_ENDING_BYTE};
-    const uint8_t starting_bytes[3] = {ADCS_PARSING_BYTE, ADCS_STARTING_BYTE, INITIATE_DOWNLOAD_BURST_ID};
-
-    while (!end_of_message) {
-
-        if (xQueueReceive(adcsQueue, &reply[received], ADCS_FILE_DOWNLOAD_QUEUE_TIMEOUT) == pdFAIL) {
-            return ADCS_UART_FAILED;
-
-        } else if (!start_of_message) {
-            received++;
-            // Parse for SOM
-            if (memcmp(&reply[0], starting_bytes, 3) == 0) {
-                start_of_message = true;
-            } else if (received == 3) {
-                reply[0] = reply[1];
-                reply[1] = reply[2];
-                received--;
-            }
-
-        } else if (received < 25) {
-            // Packets are at least 27 bytes long
-            received++;
-
-        } else {
-            received++;
-            // Parse for EOM
-            if (memcmp(&reply[received - 2], ending_bytes, 2) == 0) {
-                end_of_message = true;
-            }
-            if (received >= (ADCS_UART_FILE_DOWNLOAD_PKT_LEN + ADCS_EXTRA_SZ_FOR_STUFFING)) {
-                // Something has gone terribly wrong in the queue
-                return ADCS_INCORRECT_LENGTH;
-            }
+    do {
+        ADCS_returnState ret = adcs_rx_get_frame(&reply_id, thin_reply, sizeof(thin_reply), &thin_length,
+                                                 ADCS_FILE_DOWNLOAD_QUEUE_TIMEOUT);
+        if (ret != ADCS_OK) {
+            return ret;
         }
-    }
+        // Skip anything that isn't a burst packet
+    } while (reply_id != INITIATE_DOWNLOAD_BURST_ID);
 
-    // Destuff the reply
-    uint8_t thin_reply[ADCS_UART_FILE_DOWNLOAD_PKT_LEN - ADCS_TM_HEADER_SZ];
-    uint16_t thin_length;
-    adcs_byte_destuff(&reply[3], thin_reply, received - ADCS_TM_HEADER_SZ, &thin_length);
+    if (thin_length < sizeof(thin_reply)) {
+        return ADCS_INCORRECT_LENGTH;
+    }
 
     *packet_counter = (thin_reply[1] << 8) | thin_reply[0];
 
@@ -381,60 +322,172 @@ ADCS_returnState adcs_io_exit_file_download_state() {
 
 /**
  * @brief
- *      Stuffs 0x1F data bytes
- * @param thin_cmd
+ *      Builds a telecommand frame, stuffing 0x1F data bytes on the way
+ * @param command
  *      Command before byte stuffing (input)
- * @param stuffed_cmd
- *      Command after byte stuffing (output)
- * @param thin_length
+ * @param length
  *      Length of original command
- * @param stuffed_length
- *      Length of output command
+ * @param frame
+ *      Output buffer, at least 2 * length + ADCS_TC_HEADER_SZ bytes
+ * @return
+ *      Length of the frame
  *
  */
-static void adcs_byte_stuff(uint8_t *thin_cmd, uint8_t *stuffed_cmd, uint8_t thin_length,
-                            uint8_t *stuffed_length) {
-    uint8_t stuffed_index = 0;
-    for (uint8_t thin_index = 0; thin_index < thin_length; thin_index++) {
+static uint16_t adcs_build_frame(const uint8_t *command, uint16_t length, uint8_t *frame) {
+    uint16_t index = 0;
+    frame[index++] = ADCS_PARSING_BYTE;
+    frame[index++] = ADCS_STARTING_BYTE;
+    for (uint16_t i = 0; i < length; i++) {
+        frame[index++] = command[i];
+        if (command[i] == ADCS_PARSING_BYTE) {
+            /* Byte needs to be stuffed */
+            frame[index++] = ADCS_PARSING_BYTE;
+        }
+    }
+    frame[index++] = ADCS_PARSING_BYTE;
+    frame[index++] = ADCS_ENDING_BYTE;
+    return index;
+}
+
+/**
+ * @brief
+ *      Drop the frame being assembled and give its ring space back
+ */
+static inline void adcs_rx_drop_frame(void) {
+    rx_write = rx_frame_start;
+    rx_dropped_frames++;
+    rx_state = ADCS_RX_IDLE;
+}
 
-        *(stuffed_cmd + stuffed_index) = *(thin_cmd + thin_index);
-        stuffed_index++;
+/**
+ * @brief
+ *      Store one destuffed byte of the current frame
+ */
+static inline void adcs_rx_store(uint8_t byte) {
+    if ((rx_write - rx_frame_start) >= ADCS_RX_MAX_FRAME_LEN || (rx_write - rx_read) >= ADCS_RX_RING_SIZE) {
+        adcs_rx_drop_frame();
+        return;
+    }
+    rx_ring[rx_write % ADCS_RX_RING_SIZE] = byte;
+    rx_write++;
+}
 
-        if (*(thin_cmd + thin_index) == ADCS_PARSING_BYTE) {
-            /* Byte needs to be stuffed */
-            *(stuffed_cmd + stuffed_index) = ADCS_PARSING_BYTE;
-            stuffed_index++;
+/**
+ * @brief
+ *      Frame parser, called from the SCI ISR for every received byte.
+ *      Detects ESC/SOM and ESC/EOM, destuffs ESC/ESC in place and wakes
+ *      the waiting task once a complete frame is in the ring.
+ * @param byte
+ *      Received byte
+ * @param xHigherPriorityTaskWoken
+ *      Set if a task was woken by the completed frame
+ *
+ */
+static void adcs_rx_byte_from_isr(uint8_t byte, BaseType_t *xHigherPriorityTaskWoken) {
+    switch (rx_state) {
+    case ADCS_RX_IDLE:
+        if (byte == ADCS_PARSING_BYTE) {
+            rx_state = ADCS_RX_IDLE_ESC;
+        }
+        break;
+
+    case ADCS_RX_IDLE_ESC:
+        if (byte == ADCS_STARTING_BYTE) {
+            rx_frame_start = rx_write;
+            rx_state = ADCS_RX_FRAME;
+        } else if (byte != ADCS_PARSING_BYTE) {
+            rx_state = ADCS_RX_IDLE;
+        }
+        break;
+
+    case ADCS_RX_FRAME:
+        if (byte == ADCS_PARSING_BYTE) {
+            rx_state = ADCS_RX_FRAME_ESC;
+        } else {
+            adcs_rx_store(byte);
         }
+        break;
+
+    case ADCS_RX_FRAME_ESC:
+        if (byte == ADCS_PARSING_BYTE) {
+            /* Stuffed byte: keep a single 0x1F */
+            rx_state = ADCS_RX_FRAME;
+            adcs_rx_store(byte);
+        } else if (byte == ADCS_ENDING_BYTE) {
+            if ((rx_frame_head - rx_frame_tail) >= ADCS_RX_FRAME_SLOTS) {
+                adcs_rx_drop_frame();
+                break;
+            }
+            adcs_rx_frame_t *desc = &rx_frames[rx_frame_head % ADCS_RX_FRAME_SLOTS];
+            desc->start = rx_frame_start;
+            desc->length = rx_write - rx_frame_start;
+            rx_frame_head++;
+            rx_state = ADCS_RX_IDLE;
+            xSemaphoreGiveFromISR(rx_frame_semphr, xHigherPriorityTaskWoken);
+        } else if (byte == ADCS_STARTING_BYTE) {
+            /* Unterminated frame followed by a new one. Resynchronise */
+            rx_write = rx_frame_start;
+            rx_dropped_frames++;
+            rx_state = ADCS_RX_FRAME;
+        } else {
+            adcs_rx_drop_frame();
+        }
+        break;
     }
-    *stuffed_length = stuffed_index;
 }
 
 /**
  * @brief
- *      Destuffs 0x1F data bytes
- * @param stuffed reply
- *      Reply directly from the ADCS (input)
- * @param thin_reply
- *      Reply after byte destuffing (output)
- * @param stuffed_length
- *      Length of original reply
- * @param thin_length
- *      Length of destuffed reply
+ *      Discard any frames received but not yet consumed, e.g. late replies
+ *      to a previous command that timed out
+ */
+static void adcs_rx_flush(void) {
+    taskENTER_CRITICAL();
+    rx_state = ADCS_RX_IDLE;
+    rx_frame_tail = rx_frame_head;
+    rx_read = rx_write;
+    xQueueReset(rx_frame_semphr);
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief
+ *      Wait for the next complete frame and copy it out of the receive ring
+ * @param id
+ *      TM/TC ID of the frame
+ * @param data
+ *      Output buffer for the destuffed frame data following the ID
+ * @param max_length
+ *      Size of the output buffer. Longer frames are truncated
+ * @param length
+ *      Number of data bytes in the frame, which is more than were copied if it was truncated
+ * @param timeout
+ *      Ticks to wait for a frame
  *
  */
-static void adcs_byte_destuff(uint8_t *stuffed_reply, uint8_t *thin_reply, uint16_t stuffed_length,
-                              uint16_t *thin_length) {
-    uint16_t thin_index = 0;
-    for (uint16_t stuffed_index = 0; stuffed_index < stuffed_length; stuffed_index++) {
-        *(thin_reply + thin_index) = *(stuffed_reply + stuffed_index);
-        thin_index++;
-
-        if (*(stuffed_reply + stuffed_index) == ADCS_PARSING_BYTE) {
-            /* Stuffed byte present. Skip the next byte */
-            stuffed_index++;
+static ADCS_returnState adcs_rx_get_frame(uint8_t *id, uint8_t *data, uint32_t max_length, uint16_t *length,
+                                          TickType_t timeout) {
+    if (xSemaphoreTake(rx_frame_semphr, timeout) != pdTRUE) {
+        return ADCS_UART_FAILED;
+    }
+
+    adcs_rx_frame_t *desc = &rx_frames[rx_frame_tail % ADCS_RX_FRAME_SLOTS];
+    uint16_t frame_length = 0;
+    if (desc->length > 0) {
+        *id = rx_ring[desc->start % ADCS_RX_RING_SIZE];
+        frame_length = desc->length - 1;
+        uint16_t copy_length = frame_length > max_length ? max_length : frame_length;
+        for (uint16_t i = 0; i < copy_length; i++) {
+            data[i] = rx_ring[(desc->start + 1 + i) % ADCS_RX_RING_SIZE];
         }
     }
-    *thin_length = thin_index;
+    *length = frame_length;
+
+    // Hand the ring space back to the ISR
+    rx_read = desc->start + desc->length;
+    rx_frame_tail++;
+
+    return desc->length > 0 ? ADCS_OK : ADCS_INCORRECT_LENGTH;
 }
 
 void write_packet_to_file(int32_t file_des, uint8_t *packet_data, uint8_t length) {
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file adcs_tlm_cache.h
+ * @date 2026-10-19
+ */
+
+#ifndef ADCS_TLM_CACHE_H
+#define ADCS_TLM_CACHE_H
+
+#include "adcs.h"
+#include "system.h"
+
+#define ADCS_TLM_CACHE_DEFAULT_PERIOD_S 10
+#define ADCS_TLM_CACHE_MIN_PERIOD_S 1
+// pdMS_TO_TICKS(2 * period * 1000) must fit in 32 bits at a 1 kHz tick
+#define ADCS_TLM_CACHE_MAX_PERIOD_S 1800
+
+// Oldest frame the ADCS service will hand back for an on-demand request
+#define ADCS_TLM_SVC_MAX_AGE pdMS_TO_TICKS(1000)
+
+typedef enum {
+    ADCS_TLM_CURRENT_STATE = 0, // adcs_state
+    ADCS_TLM_MEASUREMENTS,      // adcs_measures
+    ADCS_TLM_POWER_TEMP,        // adcs_pwr_temp
+    ADCS_TLM_SAT_POS_LLH,       // LLH
+    ADCS_TLM_COMMS_STAT,        // uint16_t[ADCS_TLM_COMMS_STAT_LEN]
+    ADCS_TLM_NUM_FRAMES
+} adcs_tlm_frame;
+
+#define ADCS_TLM_COMMS_STAT_LEN 5
+
+ADCS_returnState adcs_tlm_cache_get(adcs_tlm_frame frame, void *data, TickType_t max_age);
+void adcs_tlm_cache_invalidate(void);
+void adcs_tlm_cache_set_period(uint32_t period_s);
+uint32_t adcs_tlm_cache_get_period(void);
+TickType_t adcs_tlm_cache_hk_max_age(void);
+
+SAT_returnState start_adcs_tlm_cache_daemon(void);
+
+#endif /* ADCS_TLM_CACHE_H */
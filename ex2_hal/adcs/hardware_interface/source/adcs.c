@@ -18,6 +18,21 @@
  */
 
 #include "adcs.h"
+#include "adcs_tlm_cache.h"
+
+#if ADCS_IS_STUBBED == 0
+/**
+ * @brief
+ *      Drop cached telemetry after a command that changes what the ADCS reports.
+ *      Done whatever the command returned, since a timed out command may still have run
+ * @return
+ *      status, unchanged
+ */
+static ADCS_returnState prv_tlm_changed(ADCS_returnState status) {
+    adcs_tlm_cache_invalidate();
+    return status;
+}
+#endif
 
 ADCS_returnState HAL_ADCS_download_file_list_to_OBC(void) {
 #if ADCS_IS_STUBBED == 1
@@ -47,7 +62,7 @@ ADCS_returnState HAL_ADCS_reset() {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_reset();
+    return prv_tlm_changed(ADCS_reset());
 #endif
 }
 
@@ -394,7 +409,7 @@ ADCS_returnState HAL_ADCS_run_selected_program() {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_run_selected_program();
+    return prv_tlm_changed(ADCS_run_selected_program());
 #endif
 }
 
@@ -451,7 +466,7 @@ ADCS_returnState HAL_ADCS_set_enabled_state(uint8_t state) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_enabled_state(state);
+    return prv_tlm_changed(ADCS_set_enabled_state(state));
 #endif
 }
 
@@ -467,7 +482,7 @@ ADCS_returnState HAL_ADCS_set_attitude_ctrl_mode(uint8_t ctrl_mode, uint16_t tim
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_attitude_ctrl_mode(ctrl_mode, timeout);
+    return prv_tlm_changed(ADCS_set_attitude_ctrl_mode(ctrl_mode, timeout));
 #endif
 }
 
@@ -475,7 +490,7 @@ ADCS_returnState HAL_ADCS_set_attitude_estimate_mode(uint8_t mode) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_attitude_estimate_mode(mode);
+    return prv_tlm_changed(ADCS_set_attitude_estimate_mode(mode));
 #endif
 }
 
@@ -781,7 +796,7 @@ ADCS_returnState HAL_ADCS_set_sgp4_orbit_params(adcs_sgp4 params) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_sgp4_orbit_params(params);
+    return prv_tlm_changed(ADCS_set_sgp4_orbit_params(params));
 #endif
 }
 
@@ -797,7 +812,7 @@ ADCS_returnState HAL_ADCS_set_system_config(adcs_sysConfig config) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_system_config(config);
+    return prv_tlm_changed(ADCS_set_system_config(config));
 #endif
 }
 
@@ -813,7 +828,7 @@ ADCS_returnState HAL_ADCS_set_MTQ_config(xyzu8 params) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_MTQ_config(params);
+    return prv_tlm_changed(ADCS_set_MTQ_config(params));
 #endif
 }
 
@@ -821,7 +836,7 @@ ADCS_returnState HAL_ADCS_set_RW_config(uint8_t *RW) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_RW_config(RW);
+    return prv_tlm_changed(ADCS_set_RW_config(RW));
 #endif
 }
 
@@ -829,7 +844,7 @@ ADCS_returnState HAL_ADCS_set_rate_gyro(rate_gyro_config params) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_rate_gyro(params);
+    return prv_tlm_changed(ADCS_set_rate_gyro(params));
 #endif
 }
 
@@ -837,7 +852,7 @@ ADCS_returnState HAL_ADCS_set_css_config(css_config config) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_css_config(config);
+    return prv_tlm_changed(ADCS_set_css_config(config));
 #endif
 }
 
@@ -845,7 +860,7 @@ ADCS_returnState HAL_ADCS_set_star_track_config(cubestar_config config) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_star_track_config(config);
+    return prv_tlm_changed(ADCS_set_star_track_config(config));
 #endif
 }
 
@@ -853,7 +868,7 @@ ADCS_returnState HAL_ADCS_set_cubesense_config(cubesense_config params) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_cubesense_config(params);
+    return prv_tlm_changed(ADCS_set_cubesense_config(params));
 #endif
 }
 
@@ -861,7 +876,7 @@ ADCS_returnState HAL_ADCS_set_mtm_config(mtm_config params, uint8_t mtm) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_mtm_config(params, mtm);
+    return prv_tlm_changed(ADCS_set_mtm_config(params, mtm));
 #endif
 }
 
@@ -869,7 +884,7 @@ ADCS_returnState HAL_ADCS_set_detumble_config(detumble_config *config) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_detumble_config(config);
+    return prv_tlm_changed(ADCS_set_detumble_config(config));
 #endif
 }
 
@@ -877,7 +892,7 @@ ADCS_returnState HAL_ADCS_set_ywheel_config(ywheel_ctrl_config params) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_ywheel_config(params);
+    return prv_tlm_changed(ADCS_set_ywheel_config(params));
 #endif
 }
 
@@ -885,7 +900,7 @@ ADCS_returnState HAL_ADCS_set_rwheel_config(rwheel_ctrl_config params) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_rwheel_config(params);
+    return prv_tlm_changed(ADCS_set_rwheel_config(params));
 #endif
 }
 
@@ -893,7 +908,7 @@ ADCS_returnState HAL_ADCS_set_tracking_config(track_ctrl_config params) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_tracking_config(params);
+    return prv_tlm_changed(ADCS_set_tracking_config(params));
 #endif
 }
 
@@ -901,7 +916,7 @@ ADCS_returnState HAL_ADCS_set_MoI_mat(moment_inertia_config cell) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_MoI_mat(cell);
+    return prv_tlm_changed(ADCS_set_MoI_mat(cell));
 #endif
 }
 
@@ -909,7 +924,7 @@ ADCS_returnState HAL_ADCS_set_estimation_config(estimation_config config) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_estimation_config(config);
+    return prv_tlm_changed(ADCS_set_estimation_config(config));
 #endif
 }
 
@@ -917,7 +932,7 @@ ADCS_returnState HAL_ADCS_set_usercoded_setting(usercoded_setting setting) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_usercoded_setting(setting);
+    return prv_tlm_changed(ADCS_set_usercoded_setting(setting));
 #endif
 }
 
@@ -925,7 +940,7 @@ ADCS_returnState HAL_ADCS_set_asgp4_setting(aspg4_setting setting) {
 #if ADCS_IS_STUBBED == 1
     return IS_STUBBED_A;
 #else
-    return ADCS_set_asgp4_setting(setting);
+    return prv_tlm_changed(ADCS_set_asgp4_setting(setting));
 #endif
 }
 
@@ -947,8 +962,9 @@ ADCS_returnState HAL_ADCS_getHK(ADCS_HouseKeeping *adcs_hk) {
     adcs_measures mes;
     adcs_pwr_temp pwr;
     LLH pos;
+    TickType_t max_age = adcs_tlm_cache_hk_max_age();
 
-    if ((temp = HAL_ADCS_get_current_state(&data)) != ADCS_OK) {
+    if ((temp = adcs_tlm_cache_get(ADCS_TLM_CURRENT_STATE, &data, max_age)) != ADCS_OK) {
         return_state = temp;
     } else {
         adcs_hk->att_estimate_mode = data.att_estimate_mode;
@@ -980,7 +996,7 @@ ADCS_returnState HAL_ADCS_getHK(ADCS_HouseKeeping *adcs_hk) {
         adcs_hk->ECEF_Position_Z = data.ecef_pos.z;
     }
 
-    if ((temp = HAL_ADCS_get_measurements(&mes)) != ADCS_OK) {
+    if ((temp = adcs_tlm_cache_get(ADCS_TLM_MEASUREMENTS, &mes, max_age)) != ADCS_OK) {
         return_state = temp;
     } else {
         // adcs_hk->Coarse_Sun_Vector = mes.coarse_sun;
@@ -1005,7 +1021,7 @@ ADCS_returnState HAL_ADCS_getHK(ADCS_HouseKeeping *adcs_hk) {
         adcs_hk->Mag_Field_Vector_Z = mes.magnetic_field.z;
     }
 
-    if ((temp = HAL_ADCS_get_power_temp(&pwr)) != ADCS_OK) {
+    if ((temp = adcs_tlm_cache_get(ADCS_TLM_POWER_TEMP, &pwr, max_age)) != ADCS_OK) {
         return_state = temp;
     } else {
         adcs_hk->Wheel1_Current = pwr.wheel1_I;
@@ -1025,7 +1041,7 @@ ADCS_returnState HAL_ADCS_getHK(ADCS_HouseKeeping *adcs_hk) {
         adcs_hk->Rate_Sensor_Temp_Z = pwr.rate_sensor_temp.z;
     }
 
-    if ((temp = HAL_ADCS_get_sat_pos_LLH(&pos)) != ADCS_OK) {
+    if ((temp = adcs_tlm_cache_get(ADCS_TLM_SAT_POS_LLH, &pos, max_age)) != ADCS_OK) {
         return_state = temp;
     } else {
         adcs_hk->Sat_Position_LLH_X = pos.latitude;
@@ -1033,9 +1049,9 @@ ADCS_returnState HAL_ADCS_getHK(ADCS_HouseKeeping *adcs_hk) {
         adcs_hk->Sat_Position_LLH_Z = pos.altitude;
     }
 
-    uint16_t comms_stat[5];
+    uint16_t comms_stat[ADCS_TLM_COMMS_STAT_LEN];
 
-    if ((temp = HAL_ADCS_get_comms_stat(comms_stat)) != ADCS_OK) {
+    if ((temp = adcs_tlm_cache_get(ADCS_TLM_COMMS_STAT, comms_stat, max_age)) != ADCS_OK) {
         return_state = temp;
     } else {
         adcs_hk->TC_num = comms_stat[0];
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file adcs_tlm_cache.c
+ * @date 2026-10-19
+ */
+
+#include "adcs_tlm_cache.h"
+#include <string.h>
+#include "os_semphr.h"
+#include "os_task.h"
+#include "logger/logger.h"
+
+typedef ADCS_returnState (*adcs_tlm_fetch)(void *data);
+
+typedef struct {
+    void *data;
+    size_t size;
+    adcs_tlm_fetch fetch;
+    TickType_t updated;
+    bool valid;
+} adcs_tlm_entry;
+
+// Large enough to hold any frame while it is fetched outside the cache lock
+typedef union {
+    adcs_state state;
+    adcs_measures measurements;
+    adcs_pwr_temp pwr_temp;
+    LLH llh;
+    uint16_t comms_stat[ADCS_TLM_COMMS_STAT_LEN];
+} adcs_tlm_scratch;
+
+static ADCS_returnState fetch_current_state(void *data) { return HAL_ADCS_get_current_state(data); }
+static ADCS_returnState fetch_measurements(void *data) { return HAL_ADCS_get_measurements(data); }
+static ADCS_returnState fetch_power_temp(void *data) { return HAL_ADCS_get_power_temp(data); }
+static ADCS_returnState fetch_sat_pos_LLH(void *data) { return HAL_ADCS_get_sat_pos_LLH(data); }
+static ADCS_returnState fetch_comms_stat(void *data) { return HAL_ADCS_get_comms_stat(data); }
+
+static adcs_state cached_state;
+static adcs_measures cached_measurements;
+static adcs_pwr_temp cached_pwr_temp;
+static LLH cached_llh;
+static uint16_t cached_comms_stat[ADCS_TLM_COMMS_STAT_LEN];
+
+static adcs_tlm_entry cache[ADCS_TLM_NUM_FRAMES] = {
+    [ADCS_TLM_CURRENT_STATE] = {&cached_state, sizeof(cached_state), fetch_current_state},
+    [ADCS_TLM_MEASUREMENTS] = {&cached_measurements, sizeof(cached_measurements), fetch_measurements},
+    [ADCS_TLM_POWER_TEMP] = {&cached_pwr_temp, sizeof(cached_pwr_temp), fetch_power_temp},
+    [ADCS_TLM_SAT_POS_LLH] = {&cached_llh, sizeof(cached_llh), fetch_sat_pos_LLH},
+    [ADCS_TLM_COMMS_STAT] = {cached_comms_stat, sizeof(cached_comms_stat), fetch_comms_stat},
+};
+
+static SemaphoreHandle_t cache_lock = NULL;
+// Moved on by every invalidation, so a fetch that straddles one is not stored
+static volatile uint32_t cache_generation = 0;
+static uint32_t poll_period_s = ADCS_TLM_CACHE_DEFAULT_PERIOD_S;
+
+/**
+ * @brief
+ *      Copy a cached frame out if it is younger than max_age
+ * @return
+ *      true if data was filled from the cache
+ */
+static bool prv_copy_if_fresh(adcs_tlm_entry *entry, void *data, TickType_t max_age) {
+    bool fresh = false;
+    if (cache_lock == NULL || xSemaphoreTake(cache_lock, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    if (entry->valid && (xTaskGetTickCount() - entry->updated) <= max_age) {
+        memcpy(data, entry->data, entry->size);
+        fresh = true;
+    }
+    xSemaphoreGive(cache_lock);
+    return fresh;
+}
+
+/**
+ * @brief
+ *      Request a frame from the ADCS and store it in the cache
+ * @details
+ *      The frame is not stored if the cache was invalidated during the request,
+ *      since the ADCS may have answered from before the change
+ * @param data
+ *      Optional output for the fresh frame. May be NULL
+ */
+static ADCS_returnState prv_refresh(adcs_tlm_entry *entry, void *data) {
+    adcs_tlm_scratch scratch;
+    uint32_t generation = cache_generation;
+    ADCS_returnState status = entry->fetch(&scratch);
+    if (status != ADCS_OK) {
+        return status;
+    }
+
+    if (cache_lock != NULL && xSemaphoreTake(cache_lock, portMAX_DELAY) == pdTRUE) {
+        if (generation == cache_generation) {
+            memcpy(entry->data, &scratch, entry->size);
+            entry->updated = xTaskGetTickCount();
+            entry->valid = true;
+        }
+        xSemaphoreGive(cache_lock);
+    }
+
+    if (data != NULL) {
+        memcpy(data, &scratch, entry->size);
+    }
+    return ADCS_OK;
+}
+
+/**
+ * @brief
+ *      Read a telemetry frame, going to the ADCS only if the cached copy is
+ *      older than max_age
+ * @param frame
+ *      Frame to read
+ * @param data
+ *      Output, of the type listed for the frame in adcs_tlm_frame
+ * @param max_age
+ *      Oldest acceptable frame, in ticks
+ * @return
+ *      ADCS_returnState of the cache hit or of the fresh request
+ */
+ADCS_returnState adcs_tlm_cache_get(adcs_tlm_frame frame, void *data, TickType_t max_age) {
+    if (frame >= ADCS_TLM_NUM_FRAMES || data == NULL) {
+        return ADCS_INVALID_PARAMETERS;
+    }
+    adcs_tlm_entry *entry = &cache[frame];
+
+    if (prv_copy_if_fresh(entry, data, max_age)) {
+        return ADCS_OK;
+    }
+    return prv_refresh(entry, data);
+}
+
+/**
+ * @brief
+ *      Mark every cached frame stale. Called by the HAL after the ADCS is reset,
+ *      changes mode or takes a new configuration
+ */
+void adcs_tlm_cache_invalidate(void) {
+    if (cache_lock == NULL || xSemaphoreTake(cache_lock, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    cache_generation++;
+    for (int i = 0; i < ADCS_TLM_NUM_FRAMES; i++) {
+        cache[i].valid = false;
+    }
+    xSemaphoreGive(cache_lock);
+}
+
+/**
+ * @brief
+ *      Set how often the poller refreshes the frame set
+ * @param period_s
+ *      Poll period in seconds, clamped to ADCS_TLM_CACHE_MIN_PERIOD_S..ADCS_TLM_CACHE_MAX_PERIOD_S
+ */
+void adcs_tlm_cache_set_period(uint32_t period_s) {
+    if (period_s < ADCS_TLM_CACHE_MIN_PERIOD_S) {
+        period_s = ADCS_TLM_CACHE_MIN_PERIOD_S;
+    } else if (period_s > ADCS_TLM_CACHE_MAX_PERIOD_S) {
+        period_s = ADCS_TLM_CACHE_MAX_PERIOD_S;
+    }
+    poll_period_s = period_s;
+}
+
+uint32_t adcs_tlm_cache_get_period(void) { return poll_period_s; }
+
+/**
+ * @brief
+ *      Age limit for housekeeping reads. One missed poll is tolerated before
+ *      housekeeping falls back to asking the ADCS directly
+ */
+TickType_t adcs_tlm_cache_hk_max_age(void) { return pdMS_TO_TICKS(2 * poll_period_s * 1000); }
+
+/**
+ * @brief
+ *      Refreshes every cached frame once per poll period
+ */
+static void adcs_tlm_cache_daemon(void *pvParameters) {
+    for (;;) {
+        for (int i = 0; i < ADCS_TLM_NUM_FRAMES; i++) {
+            prv_refresh(&cache[i], NULL);
+        }
+        vTaskDelay(pdMS_TO_TICKS(poll_period_s * 1000));
+    }
+}
+
+/**
+ * @brief
+ *      Start the ADCS telemetry poller
+ * @return SAT_returnState
+ *      success report
+ */
+SAT_returnState start_adcs_tlm_cache_daemon(void) {
+    cache_lock = xSemaphoreCreateMutex();
+    if (cache_lock == NULL) {
+        return SATR_ERROR;
+    }
+#if ADCS_IS_STUBBED == 0
+    if (xTaskCreate(adcs_tlm_cache_daemon, "adcs_tlm_cache", ADCS_TLM_DM_SIZE, NULL, ADCS_TLM_CACHE_TASK_PRIO,
+                    NULL) != pdPASS) {
+        sys_log(ERROR, "FAILED TO CREATE TASK adcs_tlm_cache");
+        return SATR_ERROR;
+    }
+#endif
+    return SATR_OK;
+}
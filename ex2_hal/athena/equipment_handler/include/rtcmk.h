@@ -23,9 +23,22 @@ extern time_t unix_timestamp;
 
 /* unix_timestamp is set when RTCMK_SetUnix is called, and then updated every
  * second by an RTC interrupt. RTCMK_Unix_Now() is the preferred way of getting
- * the current unix time.
+ * the current unix time. It only touches the bus if the interrupt has stopped,
+ * and then at most once per RTC_RESYNC_INTERVAL_MS.
  */
-static inline time_t RTCMK_Unix_Now() { return unix_timestamp; }
+time_t RTCMK_Unix_Now(void);
+
+/* Seconds and milliseconds taken from the same second, for callers that need
+ * both. Calling RTCMK_Unix_Now() and RTCMK_GetMs() separately can straddle a
+ * second boundary.
+ */
+time_t RTCMK_Unix_Now_Ms(int32_t *msec);
+
+/* Like RTCMK_Unix_Now() but never touches the bus, for callers holding a lock the
+ * I2C driver may need, such as the Reliance Edge clock. Resyncing is left to
+ * the other callers.
+ */
+time_t RTCMK_Unix_Cached(void);
 
 // Note that the RTC does not actually keep milliseconds itself.
 int RTCMK_GetMs();
@@ -37,6 +50,10 @@ int RTCMK_SetUnix(time_t new_time);
  */
 int RTCMK_GetUnix(time_t *unix_time);
 
+int RTCMK_ReadTime(uint8_t addr, tmElements_t *t);
+
+int RTCMK_WriteTime(uint8_t addr, const tmElements_t *t);
+
 int RTCMK_EnableInt(uint8_t addr);
 
 int RTCMK_ResetTime(uint8_t addr);
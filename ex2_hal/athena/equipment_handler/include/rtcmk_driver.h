@@ -4,6 +4,7 @@
  ******************************************************************************/
 
 #define RTCMK_PORT RTC_I2C
+#define RTCMK_TIME_REG_COUNT 7 // RTCMK_RegSec through RTCMK_RegYear
 
 #define RTCMK_SEC_SEC (0x7FUL << 0)
 #define _RTCMK_SEC_SEC_SHIFT 0
@@ -71,24 +71,11 @@ static inline unsigned int toBIN(unsigned int val) {
  *unable to update time.
  ******************************************************************************/
 int RTCMK_SetUnix(time_t new_time) {
-    // TODO: Make these use a single array
     unix_timestamp = new_time;
 
     tmElements_t t = {0};
     breakTime(new_time, &t);
-    if (RTCMK_SetSecond(RTCMK_ADDR, t.Second) == -1)
-        return -1;
-    if (RTCMK_SetMinute(RTCMK_ADDR, t.Minute) == -1)
-        return -1;
-    if (RTCMK_SetHour(RTCMK_ADDR, t.Hour) == -1)
-        return -1;
-    if (RTCMK_SetDay(RTCMK_ADDR, t.Day) == -1)
-        return -1;
-    if (RTCMK_SetMonth(RTCMK_ADDR, t.Month) == -1)
-        return -1;
-    if (RTCMK_SetYear(RTCMK_ADDR, (tmYearToCalendar(t.Year) % 100)) == -1)
-        return -1;
-    return 0;
+    return RTCMK_WriteTime(RTCMK_ADDR, &t);
 }
 
 /**
@@ -104,42 +91,86 @@ int RTCMK_SetUnix(time_t new_time) {
  *unable to update time.
  ******************************************************************************/
 int RTCMK_GetUnix(time_t *unix_time) {
-    // TODO: make these use a single array
     tmElements_t t = {0};
-
-    uint8_t sec;
-    if (RTCMK_ReadSeconds(RTCMK_ADDR, &sec) == -1)
+    if (RTCMK_ReadTime(RTCMK_ADDR, &t) == -1)
         return -1;
-    t.Second = (uint32_t)sec;
+    *unix_time = makeTime(t);
+    return 0;
+}
 
-    uint8_t min;
-    if (RTCMK_ReadMinutes(RTCMK_ADDR, &min) == -1)
-        return -1;
-    t.Minute = (uint32_t)min;
+/**
+ * @brief
+ *   Read all time and calendar
+ *registers (0x00 to 0x06) in one
+ *auto-incrementing transaction.
+ *
+ * @details
+ *   The RTC latches the time
+ *registers for the duration of the
+ *transaction, so the result cannot
+ *straddle a seconds rollover.
+ *
+ * @param[in] addr
+ *   I2C address, in 8 bit format,
+ *where LSB is reserved for R/W bit.
+ *
+ * @param[out] t
+ *   Time read, Year offset from
+ *1970.
+ *
+ * @return
+ *   Returns 0 if registers read, <0
+ *if unable to read registers.
+ ******************************************************************************/
+int RTCMK_ReadTime(uint8_t addr, tmElements_t *t) {
+    uint8_t reg = RTCMK_RegSec;
+    uint8_t regs[RTCMK_TIME_REG_COUNT];
 
-    uint8_t hour;
-    if (RTCMK_ReadHours(RTCMK_ADDR, &hour) == -1)
+    if (i2c_WriteRead(RTCMK_PORT, addr, 1, &reg, RTCMK_TIME_REG_COUNT, regs) == -1) {
         return -1;
-    t.Hour = (uint32_t)hour;
+    }
 
-    uint8_t day;
-    if (RTCMK_ReadDay(RTCMK_ADDR, &day) == -1)
-        return -1;
-    t.Day = (uint32_t)day;
+    t->Second = toBIN(regs[RTCMK_RegSec] & _RTCMK_SEC_SEC_MASK);
+    t->Minute = toBIN(regs[RTCMK_RegMin] & _RTCMK_MIN_MIN_MASK);
+    t->Hour = toBIN(regs[RTCMK_RegHour] & _RTCMK_HOUR_HOUR_MASK);
+    t->Day = toBIN(regs[RTCMK_RegDay] & _RTCMK_DAY_DAY_MASK);
+    t->Month = toBIN(regs[RTCMK_RegMonth] & _RTCMK_MONTH_MONTH_MASK);
+    t->Year = CalendarYrToTm(toBIN(regs[RTCMK_RegYear] & _RTCMK_YEAR_YEAR_MASK) + 2000);
+    return 0;
+}
 
-    uint8_t mon;
-    if (RTCMK_ReadMonth(RTCMK_ADDR, &mon) == -1)
-        return -1;
-    t.Month = (uint32_t)mon;
+/**
+ * @brief
+ *   Write all time and calendar
+ *registers (0x00 to 0x06) in one
+ *auto-incrementing transaction.
+ *
+ * @param[in] addr
+ *   I2C address, in 8 bit format,
+ *where LSB is reserved for R/W bit.
+ *
+ * @param[in] t
+ *   Time to write, Year offset from
+ *1970. Wday is 1 for Sunday.
+ *
+ * @return
+ *   Returns 0 if registers written,
+ *<0 if unable to write to registers.
+ ******************************************************************************/
+int RTCMK_WriteTime(uint8_t addr, const tmElements_t *t) {
+    uint8_t data[RTCMK_TIME_REG_COUNT + 1];
+    uint8_t *regs = &data[1];
 
-    uint8_t year;
-    if (RTCMK_ReadYear(RTCMK_ADDR, &year) == -1)
-        return -1;
-    t.Year = (uint32_t)year;
-    t.Year += 2000;
-    t.Year = CalendarYrToTm(t.Year);
-    *unix_time = makeTime(t);
-    return 0;
+    data[0] = RTCMK_RegSec;
+    regs[RTCMK_RegSec] = toBCD(t->Second) & _RTCMK_SEC_SEC_MASK;
+    regs[RTCMK_RegMin] = toBCD(t->Minute) & _RTCMK_MIN_MIN_MASK;
+    regs[RTCMK_RegHour] = toBCD(t->Hour) & _RTCMK_HOUR_HOUR_MASK;
+    regs[RTCMK_RegWeek] = toBCD(t->Wday - 1) & _RTCMK_WEEK_WEEK_MASK; // register counts Sunday as 0
+    regs[RTCMK_RegDay] = toBCD(t->Day) & _RTCMK_DAY_DAY_MASK;
+    regs[RTCMK_RegMonth] = toBCD(t->Month) & _RTCMK_MONTH_MONTH_MASK;
+    regs[RTCMK_RegYear] = toBCD(tmYearToCalendar(t->Year) % 100) & _RTCMK_YEAR_YEAR_MASK;
+
+    return i2c_Send(RTCMK_PORT, addr, sizeof(data), data);
 }
 
 /**
@@ -14,26 +14,31 @@
 
 #define NMEA_TASK_SIZE 384
 
+#define NMEA_READ_CHUNK 32
+
 /**
  * @brief Starts NMEA decoding service
+ *
+ * Woken by the UART ISR for each line received. Drains the receive ring through
+ * the parser, which keeps counters rather than logging each sentence
  */
 void NMEA_daemon() {
     ex2_log("NMEA task started");
 
     init_NMEA();
-    static char NMEA_buf[NMEASENTENCE_MAXLENGTH];
+    uint8_t chunk[NMEA_READ_CHUNK];
 
     for (;;) {
-        memset(NMEA_buf, 0, NMEASENTENCE_MAXLENGTH);
+        ulTaskNotifyTake(pdTRUE, DELAY_WAIT_INTERVAL);
 
-        while (xQueueReceive(NMEA_queue, NMEA_buf, DELAY_WAIT_INTERVAL) != pdPASS) {
-            continue;
-        }
-        int i;
-        for (i = 0; i < strlen(NMEA_buf); i++) {
-            NMEAParser_encode(NMEA_buf[i]);
+        size_t len;
+        while ((len = NMEA_ring_read(chunk, sizeof(chunk))) > 0) {
+            size_t i;
+            for (i = 0; i < len; i++) {
+                NMEAParser_encode((char)chunk[i]);
+            }
         }
-        ex2_log("NMEA message received: %s", NMEA_buf);
+        NMEAParser_update_rate(xTaskGetTickCount());
     }
 }
 
@@ -9,6 +9,7 @@
 #define NMEAParser_h
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "FreeRTOS.h"
@@ -27,6 +28,13 @@
 
 #define NMEASENTENCE_MAXLENGTH 120
 #define NMEASENTENCE_MAXTERMS 25
+#define NMEATERM_MAXLENGTH 15 // longest single term, e.g. a high precision latitude
+
+// Bytes buffered between the UART ISR and the NMEA daemon. Must be a power of 2
+#define NMEA_RING_SIZE 512
+
+// Period over which NMEA_stats_s.sentences_per_window is counted
+#define NMEA_RATE_WINDOW_MS 60000
 
 // Set sentences invalid after 10 seconds
 #define GPS_AGE_INVALID_THRESHOLD 10000 * portTICK_RATE_MS
@@ -45,19 +53,24 @@ enum {
     GPS_INVALID_COURSE = 0xFFFF
 };
 
-#define NMEA_QUEUE_ITEM_SIZE NMEASENTENCE_MAXLENGTH
-#define NMEA_QUEUE_MAX_LEN 2
-
-extern QueueHandle_t NMEA_queue;
+typedef struct {
+    uint32_t sentences;            // sentences that passed their checksum, any type
+    uint32_t gga, gsa, gsv, rmc;   // sentences published, by type
+    uint32_t no_fix;               // decoded sentences not published because they report no fix
+    uint32_t checksum_failures;    // sentences dropped for a bad checksum
+    uint32_t malformed;            // sentences too long, cut short, or missing a checksum
+    uint32_t overruns;             // bytes dropped because the receive ring was full
+    uint32_t sentences_per_window; // sentences in the last NMEA_RATE_WINDOW_MS
+} NMEA_stats_s;
 
 extern SemaphoreHandle_t NMEA_mutex;
 
 bool init_NMEA();
 
-static GPGGA_s GPGGA;
-static GPGSA_s GPGSA;
-static GPGSV_s GPGSV;
-static RMC_s RMC;
+void NMEA_ring_put_from_isr(uint8_t c, BaseType_t *woken);
+size_t NMEA_ring_read(uint8_t *out, size_t len);
+void NMEAParser_get_stats(NMEA_stats_s *output);
+void NMEAParser_update_rate(TickType_t now);
 
 bool NMEAParser_get_GPGGA(GPGGA_s *output);
 bool NMEAParser_get_GPGSA(GPGSA_s *output);
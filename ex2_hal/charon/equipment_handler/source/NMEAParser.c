@@ -15,12 +15,51 @@ static int NMEAParser_termcmp(const char *str1, const char *str2);
 static int NMEAParser_hexToInt(char hex);
 static int32_t NMEAParser_parse_decimal(char *p);
 static void NMEAParser_parse_degrees(char *p, int32_t *upper, int32_t *lower);
-static bool NMEAParser_decode_sentence();
+static void NMEAParser_decode_term(void);
+static bool NMEAParser_commit_sentence(void);
 
-static char _sentence[NMEASENTENCE_MAXLENGTH];
-static int _char_offset;
+static GPGGA_s GPGGA;
+static GPGSA_s GPGSA;
+static GPGSV_s GPGSV;
+static RMC_s RMC;
 
-QueueHandle_t NMEA_queue;
+typedef enum { NMEA_WAIT_START, NMEA_IN_BODY, NMEA_IN_CHECKSUM } NMEA_parse_state;
+
+/* Sentence being received. Terms are decoded into scratch as they complete, and
+ * only copied to the published structs once the checksum has been checked */
+static struct {
+    NMEA_parse_state state;
+    int sentence_type;
+    bool data_valid;
+    bool malformed;
+    uint8_t checksum;
+    uint8_t checksum_received;
+    uint8_t checksum_digits;
+    uint8_t term_number; // 0 is the sentence id, data terms start at 1
+    uint8_t term_len;
+    uint16_t length;
+    char term[NMEATERM_MAXLENGTH + 1];
+    union {
+        GPGGA_s gga;
+        GPGSA_s gsa;
+        GPGSV_s gsv;
+        RMC_s rmc;
+    } scratch;
+} _parser;
+
+/* SNR sums across the sentences of a multi-sentence GSV report */
+static uint32_t _gsv_snr_total;
+static uint8_t _gsv_snr_count;
+
+static NMEA_stats_s _stats;
+static uint32_t _rate_window_sentences;
+static TickType_t _rate_window_start;
+
+/* Bytes from the GPS UART. Written only by the ISR, read only by the NMEA daemon */
+static volatile uint8_t _ring[NMEA_RING_SIZE];
+static volatile uint16_t _ring_head;
+static volatile uint16_t _ring_tail;
+static TaskHandle_t _ring_reader = NULL;
 
 SemaphoreHandle_t NMEA_mutex;
 
@@ -63,22 +102,93 @@ const static RMC_s RMC_invalid = {._time = GPS_INVALID_TIME,
 /**
  * @brief sets initial memory values for NMEA
  *
+ * Must be called from the task that drains the receive ring, it is woken for each line
+ *
  * @return true success
  * @return false failure
  */
 bool init_NMEA() {
-    NMEA_queue = xQueueCreate(NMEA_QUEUE_MAX_LEN, NMEA_QUEUE_ITEM_SIZE);
     NMEA_mutex = xSemaphoreCreateRecursiveMutex();
     if (NMEA_mutex == NULL) {
         return false;
     }
-    if (NMEA_queue == NULL) {
-        return false;
-    }
     NMEAParser_reset_all_values();
+    _parser.state = NMEA_WAIT_START;
+    _rate_window_start = xTaskGetTickCount();
+    _ring_reader = xTaskGetCurrentTaskHandle();
     return true;
 }
 
+/**
+ * @brief queue a received byte for the NMEA daemon. Called from the UART ISR
+ *
+ * @param c byte received
+ * @param woken set to pdTRUE if the daemon should run on exit from the ISR
+ */
+void NMEA_ring_put_from_isr(uint8_t c, BaseType_t *woken) {
+    uint16_t next = (_ring_head + 1) & (NMEA_RING_SIZE - 1);
+    if (next == _ring_tail) {
+        _stats.overruns++;
+        return;
+    }
+    _ring[_ring_head] = c;
+    _ring_head = next;
+    if (c == '\n' && _ring_reader != NULL) {
+        vTaskNotifyGiveFromISR(_ring_reader, woken);
+    }
+}
+
+/**
+ * @brief take received bytes out of the ring
+ *
+ * @param out where to put the bytes
+ * @param len size of out
+ * @return number of bytes copied
+ */
+size_t NMEA_ring_read(uint8_t *out, size_t len) {
+    size_t count = 0;
+    uint16_t tail = _ring_tail;
+    uint16_t head = _ring_head;
+    while (count < len && tail != head) {
+        out[count++] = _ring[tail];
+        tail = (tail + 1) & (NMEA_RING_SIZE - 1);
+    }
+    _ring_tail = tail;
+    return count;
+}
+
+/**
+ * @brief copy out the parser counters
+ *
+ * @param output struct * to store counters
+ */
+void NMEAParser_get_stats(NMEA_stats_s *output) {
+    if (NMEA_mutex == NULL) {
+        // NMEA daemon not started yet
+        memcpy(output, &_stats, sizeof(NMEA_stats_s));
+        return;
+    }
+    xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
+    memcpy(output, &_stats, sizeof(NMEA_stats_s));
+    xSemaphoreGiveRecursive(NMEA_mutex);
+}
+
+/**
+ * @brief roll the sentence rate window. Called periodically by the NMEA daemon
+ *
+ * @param now current tick count
+ */
+void NMEAParser_update_rate(TickType_t now) {
+    if (now - _rate_window_start < pdMS_TO_TICKS(NMEA_RATE_WINDOW_MS)) {
+        return;
+    }
+    xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
+    _stats.sentences_per_window = _stats.sentences - _rate_window_sentences;
+    xSemaphoreGiveRecursive(NMEA_mutex);
+    _rate_window_sentences = _stats.sentences;
+    _rate_window_start = now;
+}
+
 /**
  * @brief gets latest incoming GPGGA packet
  *
@@ -213,275 +323,314 @@ void NMEAParser_clear_RMC(void) {
  * @brief string names for each packet type
  *
  */
-const char _GPGGA_TERM[7] = "$GPGGA";
-const char _GPGLL_TERM[7] = "$GPGLL";
-const char _GPGSA_TERM[7] = "$GPGSA";
-const char _GPGSV_TERM[7] = "$GPGSV";
+const char _GPGGA_TERM[6] = "GPGGA";
+const char _GPGLL_TERM[6] = "GPGLL";
+const char _GPGSA_TERM[6] = "GPGSA";
+const char _GPGSV_TERM[6] = "GPGSV";
 #if FLIGHT_CONFIGURATION == 1
-const char _RMC_TERM[7] = "$GNRMC";
+const char _RMC_TERM[6] = "GNRMC";
 #else
-const char _RMC_TERM[7] = "$GPRMC";
+const char _RMC_TERM[6] = "GPRMC";
 #endif
-const char _GPVTG_TERM[7] = "$GPVTG";
-const char _GPZDA_TERM[7] = "$GPZDA";
+const char _GPVTG_TERM[6] = "GPVTG";
+const char _GPZDA_TERM[6] = "GPZDA";
 
 /**
- * @brief takes NMEA string one char at a time until \n
+ * @brief takes NMEA data one char at a time
+ *
+ * Terms are decoded as soon as they end, so the sentence itself is never stored.
+ * A '$' always starts a new sentence, so the parser resyncs after line noise
  *
  * @param c character to register with decoder
- * @return true data decoded
- * @return false data failure
+ * @return true a sentence passed its checksum and was published
+ * @return false otherwise
  */
 bool NMEAParser_encode(char c) {
-    bool new_data = false;
-    if (c == '\n') {
-        if (_sentence[_char_offset - 4] == '*') // checksum exists
-        {
-            int checksum = NMEAParser_hexToInt(_sentence[_char_offset - 2]) +
-                           NMEAParser_hexToInt(_sentence[_char_offset - 3]) * 16;
-            _char_offset -= 5;
-            while (_sentence[_char_offset] && _sentence[_char_offset] != '$')
-                checksum ^= _sentence[_char_offset--];
-            if (checksum == 0) // checksum is valid
-            {
-                xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
-                new_data = NMEAParser_decode_sentence();
-                xSemaphoreGiveRecursive(NMEA_mutex);
+    if (c == '$') {
+        if (_parser.state != NMEA_WAIT_START) {
+            _stats.malformed++; // previous sentence never finished
+        }
+        _parser.state = NMEA_IN_BODY;
+        _parser.sentence_type = NMEA_UNKNOWN;
+        _parser.data_valid = false;
+        _parser.malformed = false;
+        _parser.checksum = 0;
+        _parser.checksum_received = 0;
+        _parser.checksum_digits = 0;
+        _parser.term_number = 0;
+        _parser.term_len = 0;
+        _parser.length = 1;
+        return false;
+    }
+
+    switch (_parser.state) {
+    case NMEA_WAIT_START:
+        return false;
+
+    case NMEA_IN_BODY:
+        if (++_parser.length > NMEASENTENCE_MAXLENGTH) {
+            _stats.malformed++;
+            _parser.state = NMEA_WAIT_START;
+            return false;
+        }
+        if (c == ',' || c == '*') {
+            _parser.term[_parser.term_len] = '\0';
+            NMEAParser_decode_term();
+            _parser.term_number++;
+            _parser.term_len = 0;
+            if (c == '*') {
+                _parser.state = NMEA_IN_CHECKSUM;
+                return false;
             }
-            _char_offset = 0;
-            _sentence[0] = 0;
+        } else if (c == '\r' || c == '\n') {
+            _stats.malformed++; // no checksum
+            _parser.state = NMEA_WAIT_START;
+            return false;
+        } else if (_parser.term_len < NMEATERM_MAXLENGTH) {
+            _parser.term[_parser.term_len++] = c;
+        } else {
+            _parser.malformed = true;
+        }
+        _parser.checksum ^= (uint8_t)c;
+        return false;
+
+    case NMEA_IN_CHECKSUM:
+        _parser.checksum_received = (_parser.checksum_received << 4) | NMEAParser_hexToInt(c);
+        if (++_parser.checksum_digits < 2) {
+            return false;
+        }
+        _parser.state = NMEA_WAIT_START;
+        if (_parser.malformed) {
+            _stats.malformed++;
+            return false;
         }
-    } else
-        _sentence[_char_offset++] = c;
-    return new_data;
+        if (_parser.checksum_received != _parser.checksum) {
+            _stats.checksum_failures++;
+            return false;
+        }
+        return NMEAParser_commit_sentence();
+    }
+    return false;
 }
 
 /**
- * @brief decodes sentence contained in glocal _sentence
- *
- * @return true sentence was valid
- * @return false sentence was invalid
+ * @brief start decoding a sentence from its id term
  */
-static bool NMEAParser_decode_sentence() {
-    TickType_t logtime = xTaskGetTickCount();
-
-    // determine sentence type
-    int sentence_type;
-    char title[7];
-    int i;
-    for (i = 0; i < 6; i++)
-        title[i] = _sentence[i];
-    title[6] = 0;
-    if (!NMEAParser_termcmp(title, _GPGGA_TERM))
-        sentence_type = NMEA_GGA;
-    else if (!NMEAParser_termcmp(title, _GPGSA_TERM))
-        sentence_type = NMEA_GSA;
-    else if (!NMEAParser_termcmp(title, _GPGSV_TERM))
-        sentence_type = NMEA_GSV;
-    else if (!NMEAParser_termcmp(title, _RMC_TERM))
-        sentence_type = NMEA_RMC;
+static void NMEAParser_begin_sentence(void) {
+    if (!NMEAParser_termcmp(_parser.term, _GPGGA_TERM)) {
+        _parser.sentence_type = NMEA_GGA;
+        memcpy(&_parser.scratch.gga, &GPGGA_invalid, sizeof(GPGGA_s));
+    } else if (!NMEAParser_termcmp(_parser.term, _GPGSA_TERM)) {
+        _parser.sentence_type = NMEA_GSA;
+        memcpy(&_parser.scratch.gsa, &GPGSA_invalid, sizeof(GPGSA_s));
+    } else if (!NMEAParser_termcmp(_parser.term, _GPGSV_TERM)) {
+        _parser.sentence_type = NMEA_GSV;
+        memcpy(&_parser.scratch.gsv, &GPGSV_invalid, sizeof(GPGSV_s));
+        _parser.data_valid = true;
+    } else if (!NMEAParser_termcmp(_parser.term, _RMC_TERM)) {
+        _parser.sentence_type = NMEA_RMC;
+        memcpy(&_parser.scratch.rmc, &RMC_invalid, sizeof(RMC_s));
+    }
 
     // Add additional NMEA sentence type here
+}
 
-    else
-        sentence_type = NMEA_UNKNOWN;
-
-    if (sentence_type == NMEA_UNKNOWN)
-        return false;
-
-    char *p;
-    p = _sentence;
-
-    while (*p++ != ',')
-        ; // skip to next term
-
-    // verify validity of sentences (if possible)
-    bool data_valid = false;
-    switch (sentence_type) {
-        int i;
-    case NMEA_GGA:
-        for (i = 0; i < 5; i++) // skip over sentence until start of 5th term
-            while (*p++ != ',')
-                ;
-        data_valid = *p > '0';
-        break;
-    case NMEA_GSA:
-        for (i = 0; i < 1; i++)
-            while (*p++ != ',')
-                ;
-        data_valid = *p > '1';
-        break;
-    case NMEA_GSV:
-        data_valid = true;
-        break;
-    case NMEA_RMC:
-        for (i = 0; i < 1; i++)
-            while (*p++ != ',')
-                ;
-        data_valid = *p == 'A';
-        break;
+/**
+ * @brief decode the term that just ended into the scratch struct for its sentence
+ */
+static void NMEAParser_decode_term(void) {
+    char *p = _parser.term;
 
-        // Add validity checking for additional NMEA sentences here
+    if (_parser.term_number == 0) {
+        NMEAParser_begin_sentence();
+        return;
+    }
+    if (_parser.term_len == 0) {
+        return; // empty term, keep the invalid value
     }
-    p = _sentence;
-
-    if (!data_valid)
-        return false;
 
-    // reset whichever sentence struct we're decoding
-    switch (sentence_type) {
+    // term numbers below count from the first term after the sentence id
+    switch (_parser.sentence_type) {
     case NMEA_GGA:
-        NMEAParser_clear_GPGGA();
-        GPGGA._logtime = logtime;
+        switch (_parser.term_number - 1) {
+        case 0: // UTC Time
+            _parser.scratch.gga._time = NMEAParser_parse_decimal(p);
+            break;
+        case 1: // Latitude
+            NMEAParser_parse_degrees(p, &(_parser.scratch.gga._latitude_upper),
+                                     &(_parser.scratch.gga._latitude_lower));
+            break;
+        case 2: // Latitude Indicator
+            if (*p == 'S') {
+                _parser.scratch.gga._latitude_upper = -_parser.scratch.gga._latitude_upper;
+            }
+            break;
+        case 3: // Longitude
+            NMEAParser_parse_degrees(p, &(_parser.scratch.gga._longitude_upper),
+                                     &(_parser.scratch.gga._longitude_lower));
+            break;
+        case 4: // Longitude Indicator
+            if (*p == 'W') {
+                _parser.scratch.gga._longitude_upper = -_parser.scratch.gga._longitude_upper;
+            }
+            break;
+        case 5: // Fix Quality
+            _parser.scratch.gga._fixquality = *p - '0';
+            _parser.data_valid = *p > '0';
+            break;
+        case 6: // Number of Satellites (tracked/used for fix)
+            _parser.scratch.gga._numsats = (uint8_t)(NMEAParser_parse_decimal(p) / 100);
+            break;
+        case 7: // HDOP
+            _parser.scratch.gga._hdop = (short)NMEAParser_parse_decimal(p);
+            break;
+        case 8: // Altitude
+            _parser.scratch.gga._altitude = NMEAParser_parse_decimal(p);
+            break;
+        }
         break;
     case NMEA_GSA:
-        NMEAParser_clear_GPGSA();
-        GPGSA._logtime = logtime;
+        switch (_parser.term_number - 1) {
+        case 1: // Fix Type
+            _parser.scratch.gsa._fixtype = *p - '0';
+            _parser.data_valid = *p > '1';
+            break;
+        case 14: // PDOP
+            _parser.scratch.gsa._pdop = (short)NMEAParser_parse_decimal(p);
+            break;
+        case 15: // HDOP
+            _parser.scratch.gsa._hdop = (short)NMEAParser_parse_decimal(p);
+            break;
+        case 16: // VDOP
+            _parser.scratch.gsa._vdop = (short)NMEAParser_parse_decimal(p);
+            break;
+        }
         break;
     case NMEA_GSV:
-        NMEAParser_clear_GPGSV();
-        GPGSV._logtime = logtime;
+        switch (_parser.term_number - 1) {
+        case 0: // GSV Sentence Count
+            _parser.scratch.gsv._gsv_sentences = *p - '0';
+            break;
+        case 1: // GSV Current Sentence Number
+            _parser.scratch.gsv._gsv_sentence = *p - '0';
+            break;
+        case 2: // Number of Satellites (in view)
+            _parser.scratch.gsv._numsats_visible = (uint8_t)(NMEAParser_parse_decimal(p) / 100);
+            break;
+        case 6:  // SNR 1
+        case 10: // SNR 2
+        case 14: // SNR 3
+        case 18: // SNR 4
+            // summed per sentence, added to the report totals once the checksum passes
+            if (*p >= '0' && *p <= '9') {
+                _parser.scratch.gsv._snr_count++;
+                _parser.scratch.gsv._new_snr_total += NMEAParser_parse_decimal(p);
+            }
+            break;
+        }
         break;
     case NMEA_RMC:
-        NMEAParser_clear_RMC();
-        RMC._logtime = logtime;
+        switch (_parser.term_number - 1) {
+        case 0: // UTC Time
+            _parser.scratch.rmc._time = NMEAParser_parse_decimal(p);
+            break;
+        case 1: // Status
+            _parser.data_valid = *p == 'A';
+            break;
+        case 2: // Latitude
+            NMEAParser_parse_degrees(p, &(_parser.scratch.rmc._latitude_upper),
+                                     &(_parser.scratch.rmc._latitude_lower));
+            break;
+        case 3: // Latitude Indicator
+            if (*p == 'S') {
+                _parser.scratch.rmc._latitude_upper = -_parser.scratch.rmc._latitude_upper;
+            }
+            break;
+        case 4: // Longitude
+            NMEAParser_parse_degrees(p, &(_parser.scratch.rmc._longitude_upper),
+                                     &(_parser.scratch.rmc._longitude_lower));
+            break;
+        case 5: // Longitude Indicator
+            if (*p == 'W') {
+                _parser.scratch.rmc._longitude_upper = -_parser.scratch.rmc._longitude_upper;
+            }
+            break;
+        case 6: // Speed
+            _parser.scratch.rmc._speed = NMEAParser_parse_decimal(p);
+            break;
+        case 7: // Course
+            _parser.scratch.rmc._course = NMEAParser_parse_decimal(p);
+            break;
+        case 8: // UTC Date
+            _parser.scratch.rmc._date = NMEAParser_parse_decimal(p) / 100;
+            break;
+        }
         break;
+
+        // Add functionality for additional NMEA sentences here
     }
+}
 
-    while (*p++ != ',')
-        ; // advance to first term after sentence id/title
+/**
+ * @brief publish a sentence that passed its checksum
+ *
+ * @return true sentence was published
+ * @return false sentence type is not decoded or it reports no fix
+ */
+static bool NMEAParser_commit_sentence(void) {
+    TickType_t logtime = xTaskGetTickCount();
+    bool published = true;
 
-    // decode data
-    int term_number = 0;
-    bool decoded = false;
-    while (!decoded) {
-        switch (sentence_type) {
+    xSemaphoreTakeRecursive(NMEA_mutex, portMAX_DELAY);
+    _stats.sentences++;
+    if (_parser.sentence_type == NMEA_UNKNOWN) {
+        published = false;
+    } else if (!_parser.data_valid) {
+        _stats.no_fix++;
+        published = false;
+    } else {
+        switch (_parser.sentence_type) {
         case NMEA_GGA:
-            switch (term_number) {
-            case 0: // UTC Time
-                //_last_time_fix = logtime;
-                GPGGA._time = NMEAParser_parse_decimal(p);
-                break;
-            case 1: // Latitude
-                //_last_position_fix = logtime;
-                NMEAParser_parse_degrees(p, &(GPGGA._latitude_upper), &(GPGGA._latitude_lower));
-                break;
-            case 2: // Latitude Indicator
-                GPGGA._latitude_upper = *p == 'S' ? -GPGGA._latitude_upper : GPGGA._latitude_upper;
-                break;
-            case 3: // Longitude
-                NMEAParser_parse_degrees(p, &(GPGGA._longitude_upper), &(GPGGA._longitude_lower));
-                break;
-            case 4: // Longitude Indicator
-                GPGGA._longitude_upper = *p == 'W' ? -GPGGA._longitude_upper : GPGGA._longitude_upper;
-                break;
-            case 5: // Fix Quality
-                GPGGA._fixquality = *p - '0';
-                break;
-            case 6: // Number of Satellites (tracked/used for fix)
-                GPGGA._numsats = (*p - '0') * 10 + *(p + 1) - '0';
-                break;
-            case 7: // HDOP
-                GPGGA._hdop = (short)NMEAParser_parse_decimal(p);
-                break;
-            case 8: // Altitude
-                GPGGA._altitude = NMEAParser_parse_decimal(p);
-                break;
-            }
+            memcpy(&GPGGA, &_parser.scratch.gga, sizeof(GPGGA_s));
+            GPGGA._logtime = logtime;
+            _stats.gga++;
             break;
         case NMEA_GSA:
-            switch (term_number) {
-            case 1: // Fix Type
-                GPGSA._fixtype = *p - '0';
-                break;
-            case 14: // PDOP
-                GPGSA._pdop = (short)NMEAParser_parse_decimal(p);
-                break;
-            case 15: // HDOP
-                GPGSA._hdop = (short)NMEAParser_parse_decimal(p);
-                break;
-            case 16: // VDOP
-                GPGSA._vdop = (short)NMEAParser_parse_decimal(p);
-                break;
-            }
+            memcpy(&GPGSA, &_parser.scratch.gsa, sizeof(GPGSA_s));
+            GPGSA._logtime = logtime;
+            _stats.gsa++;
             break;
-        case NMEA_GSV:
-            switch (term_number) {
-            case 0: // GSV Sentence Count
-                GPGSV._gsv_sentences = *p - '0';
-                break;
-            case 1: // GSV Current Sentence Number
-                GPGSV._gsv_sentence = *p - '0';
-                break;
-            case 2: // Number of Satellites (in view)
-                GPGSV._numsats_visible = (*p - '0') * 10 + *(p + 1) - '0';
-                break;
-            case 6:  // SNR 1
-            case 10: // SNR 2
-            case 14: // SNR 3
-            case 18: // SNR 4
-                if (*p >= '0' && *p <= '9' && *(p + 1) >= '0' && *(p + 1) <= '9')
-                    GPGSV._snr_count++;
-                GPGSV._new_snr_total += NMEAParser_parse_decimal(p);
-                char *ptemp;
-                ptemp = p;
-                while (*ptemp != ',' && *ptemp != '*')
-                    ptemp++;
-                if ((GPGSV._gsv_sentence == GPGSV._gsv_sentences) &&
-                    (*ptemp == '*')) // check to see if multiline gsv message is complete
-                {
-                    GPGSV._snr_total = GPGSV._new_snr_total;
-                    GPGSV._snr_avg = GPGSV._snr_total / GPGSV._snr_count;
-                    GPGSV._new_snr_total = 0;
-                    GPGSV._snr_count = 0;
-                }
-                break;
+        case NMEA_GSV: {
+            GPGSV_s *gsv = &_parser.scratch.gsv;
+            if (gsv->_gsv_sentence == 1) {
+                _gsv_snr_total = 0;
+                _gsv_snr_count = 0;
             }
-            break;
-        case NMEA_RMC:
-            switch (term_number) {
-            case 0: // UTC Time
-                //_last_time_fix = logtime;
-                RMC._time = NMEAParser_parse_decimal(p);
-                break;
-            case 2: // Latitude
-                //_last_position_fix = logtime;
-                NMEAParser_parse_degrees(p, &(RMC._latitude_upper), &(RMC._latitude_lower));
-                break;
-            case 3: // Latitude Indicator
-                RMC._latitude_upper = *p == 'S' ? -RMC._latitude_upper : RMC._latitude_upper;
-                break;
-            case 4: // Longitude
-                NMEAParser_parse_degrees(p, &(RMC._longitude_upper), &(RMC._longitude_lower));
-                break;
-            case 5: // Longitude Indicator
-                RMC._longitude_upper = *p == 'W' ? -RMC._longitude_upper : RMC._longitude_upper;
-                break;
-            case 6: // Speed
-                RMC._speed = NMEAParser_parse_decimal(p);
-                break;
-            case 7: // Course
-                RMC._course = NMEAParser_parse_decimal(p);
-                break;
-            case 8: // UTC Date
-                RMC._date = NMEAParser_parse_decimal(p) / 100;
-                break;
+            _gsv_snr_total += gsv->_new_snr_total;
+            _gsv_snr_count += gsv->_snr_count;
+
+            GPGSV._numsats_visible = gsv->_numsats_visible;
+            GPGSV._gsv_sentence = gsv->_gsv_sentence;
+            GPGSV._gsv_sentences = gsv->_gsv_sentences;
+            // check to see if multiline gsv message is complete
+            if (gsv->_gsv_sentence == gsv->_gsv_sentences && _gsv_snr_count > 0) {
+                GPGSV._snr_count = _gsv_snr_count;
+                GPGSV._snr_total = _gsv_snr_total;
+                GPGSV._snr_avg = _gsv_snr_total / _gsv_snr_count;
             }
+            GPGSV._logtime = logtime;
+            _stats.gsv++;
             break;
-
-            // Add functionality for additional NMEA sentences here
         }
-        while (*p != ',' && *p != '*')
-            p++;
-        p++;
-        term_number++;
-        if (*(p - 1) == '*') {
-            decoded = true;
+        case NMEA_RMC:
+            memcpy(&RMC, &_parser.scratch.rmc, sizeof(RMC_s));
+            RMC._logtime = logtime;
+            _stats.rmc++;
+            break;
         }
-        if (term_number > NMEASENTENCE_MAXTERMS)
-            return false;
     }
-    return true;
+    xSemaphoreGiveRecursive(NMEA_mutex);
+    return published;
 }
 
 static int NMEAParser_termcmp(const char *str1, const char *str2) {
@@ -5,6 +5,7 @@
 #include "os_queue.h"
 #include "skytraq_binary_types.h"
 #include "system.h"
+#include "mem_region.h"
 #include <string.h>
 
 // TODO: implement software download
@@ -96,7 +97,12 @@ GPS_RETURNSTATE skytraq_send_message(uint8_t *payload, uint16_t size) {
     }
     sci_busy = true;
     int total_size = size + header_size + footer_size;
-    uint8_t *message = pvPortMalloc(total_size);
+    uint8_t *message = mem_region_alloc(total_size);
+    if (message == NULL) {
+        sci_busy = false;
+        xSemaphoreGive(uart_mutex);
+        return UNKNOWN_ERROR;
+    }
     memset(message, 0, total_size);
     message[0] = 0xA0;
     message[1] = 0xA1;
@@ -112,7 +118,7 @@ GPS_RETURNSTATE skytraq_send_message(uint8_t *payload, uint16_t size) {
         return TX_TIMEDOUT;
     }
 
-    vPortFree(message);
+    mem_region_free(message);
 
     uint8_t sentence[BUFSIZE];
 
@@ -199,10 +205,12 @@ static inline void increment_buffer(int *buf) { *buf += 1; }
 /**
  * @brief interrupt handler for receiving byte from skytraq
  *
- * Will send data to appropriate queue, be it binary queue for communication messages or NMEA task queue
+ * NMEA bytes go straight to the NMEA receive ring. Binary replies are collected
+ * into a line and sent to the binary queue
  *
+ * @param woken set to pdTRUE if a task should run on exit from the ISR
  */
-void get_byte() {
+void get_byte(BaseType_t *woken) {
     uint8_t in = byte;
 
     if (current_line_type == none) {
@@ -216,15 +224,22 @@ void get_byte() {
         };
     }
 
-    binary_message_buffer[bin_buff_loc] = in;
-    increment_buffer(&bin_buff_loc);
+    if (current_line_type == nmea) {
+        NMEA_ring_put_from_isr(in, woken);
+        if (in == '\n') {
+            current_line_type = none;
+        }
+        return;
+    }
+
+    if (bin_buff_loc < BUFSIZE) {
+        binary_message_buffer[bin_buff_loc] = in;
+        increment_buffer(&bin_buff_loc);
+    }
     if (in == '\n') {
         if (current_line_type == binary) {
             if (binary_queue != NULL)
-                xQueueSendToBackFromISR(binary_queue, binary_message_buffer, pdFALSE);
-        } else if (current_line_type == nmea) {
-            if (NMEA_queue != NULL)
-                xQueueSendToBackFromISR(NMEA_queue, binary_message_buffer, pdFALSE);
+                xQueueSendToBackFromISR(binary_queue, binary_message_buffer, woken);
         }
         bin_buff_loc = 0;
         memset(binary_message_buffer, 0, BUFSIZE);
@@ -243,7 +258,7 @@ void gps_sciNotification(sciBASE_t *sci, unsigned flags) {
 
     switch (flags) {
     case SCI_RX_INT:
-        get_byte();
+        get_byte(&xHigherPriorityTaskWoken);
         sciReceive(sci, 1, &byte);
         portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
         break;
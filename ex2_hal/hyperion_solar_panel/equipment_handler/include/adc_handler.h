@@ -85,6 +85,9 @@
 
 #define AD7291_INIT_DELAY_TICKS pdMS_TO_TICKS(0)
 
+// Most channels adc_read_channels converts in one bus job
+#define AD7291_MAX_BATCH 8
+
 #define AD7291_BAD_TEMP -128
 #define AD7291_BAD_PD 255
 
@@ -100,6 +103,9 @@ int adc_set_register_pointer(uint8_t slave_addr, uint8_t reg_sel);
 // return the raw value from the adc
 int adc_get_raw(uint8_t slave_addr, unsigned short *data, unsigned char *ch);
 
+// convert and read several channels in one bus job
+int adc_read_channels(uint8_t slave_addr, const uint8_t *channels, uint8_t count, unsigned short *data);
+
 // calculate the vin voltage value
 float adc_calculate_vin(unsigned short value, float vref);
 
@@ -24,6 +24,10 @@
 #include <stdint.h>
 #include "system.h"
 
+static uint8_t adc_build_command_reg(uint8_t *buffer, uint8_t channel, uint8_t ext_ref, uint8_t tsense,
+                                     uint8_t noise_delay, uint8_t reset, uint8_t autocycle);
+static void adc_decode_raw(const unsigned char *buffer, unsigned short *data, unsigned char *ch);
+
 /**
  * @brief
  * 		Initialize ADC_Handler
@@ -33,10 +37,15 @@
  * 		1 == success
  */
 unsigned char adc_init(uint8_t slave_addr, uint8_t channel) {
-    adc_set_command_reg(slave_addr, channel, AD7291_EXT_REF_SET, AD7291_TSENSE_SET, AD7291_NOISE_DELAY_SET,
-                        AD7291_RESET_SET, AD7291_REPEAT_SET);
+    uint8_t command[3];
     uint8_t reg_sel = 1; // select read register
-    adc_set_register_pointer(slave_addr, reg_sel);
+    control_reg_val = adc_build_command_reg(command, channel, AD7291_EXT_REF_SET, AD7291_TSENSE_SET,
+                                            AD7291_NOISE_DELAY_SET, AD7291_RESET_SET, AD7291_REPEAT_SET);
+
+    // Command register write and register pointer select go out as one bus job
+    i2c_xfer_t xfers[2] = {{slave_addr, I2C_XFER_WRITE, sizeof(command), command},
+                           {slave_addr, I2C_XFER_WRITE, sizeof(reg_sel), &reg_sel}};
+    i2c_Transfer(ADC_i2c_PORT, xfers, 2);
     vTaskDelay(AD7291_INIT_DELAY_TICKS);
     return 1;
 }
@@ -88,15 +97,10 @@ int adc_read(uint8_t *buf, uint32_t size, uint8_t slave_addr) {
 int adc_set_command_reg(uint8_t slave_addr, uint8_t channel, uint8_t ext_ref, uint8_t tsense, uint8_t noise_delay,
                         uint8_t reset, uint8_t autocycle) {
     int return_val;
-    uint8_t buffer[3] = {0, 0, 0};
+    uint8_t buffer[3];
 
-    uint8_t control_reg_value = AD7291_COMMAND;
-    buffer[1] = channel;
-
-    control_reg_value = (ext_ref * AD7291_EXT_REF) | (tsense * AD7291_TSENSE) | (reset * AD7291_RESET) |
-                        (noise_delay * AD7291_NOISE_DELAY) | (autocycle * AD7291_REPEAT);
-
-    buffer[2] = control_reg_value;
+    uint8_t control_reg_value =
+        adc_build_command_reg(buffer, channel, ext_ref, tsense, noise_delay, reset, autocycle);
 
     // i2c data send
     return_val = adc_write(buffer, 3, slave_addr);
@@ -105,6 +109,25 @@ int adc_set_command_reg(uint8_t slave_addr, uint8_t channel, uint8_t ext_ref, ui
     return return_val;
 }
 
+/**
+ * @brief
+ * 		Fill the 3 byte command register write for adc_set_command_reg
+ * @return
+ * 		The control register value
+ */
+static uint8_t adc_build_command_reg(uint8_t *buffer, uint8_t channel, uint8_t ext_ref, uint8_t tsense,
+                                     uint8_t noise_delay, uint8_t reset, uint8_t autocycle) {
+    uint8_t control_reg_value = AD7291_COMMAND;
+
+    control_reg_value = (ext_ref * AD7291_EXT_REF) | (tsense * AD7291_TSENSE) | (reset * AD7291_RESET) |
+                        (noise_delay * AD7291_NOISE_DELAY) | (autocycle * AD7291_REPEAT);
+
+    buffer[0] = 0;
+    buffer[1] = channel;
+    buffer[2] = control_reg_value;
+    return control_reg_value;
+}
+
 int adc_set_register_pointer(uint8_t slave_addr, uint8_t reg_sel) { return adc_write(&reg_sel, 1, slave_addr); }
 
 /**
@@ -131,6 +154,15 @@ int adc_get_raw(uint8_t slave_addr, unsigned short *data, unsigned char *ch) {
     // i2c slave read
     ret = adc_read(buffer, 2, slave_addr);
 
+    adc_decode_raw(buffer, data, ch);
+    return ret;
+}
+
+/**
+ * @brief
+ * 		Split a conversion result into the channel address and the raw value
+ */
+static void adc_decode_raw(const unsigned char *buffer, unsigned short *data, unsigned char *ch) {
     unsigned short value = (buffer[0] << 8) | buffer[1];
 
     // get current channel (first 4 bits)
@@ -138,10 +170,73 @@ int adc_get_raw(uint8_t slave_addr, unsigned short *data, unsigned char *ch) {
 
     // remove channel information from the 16 bit read.
     value = value - (*ch << 12);
-    // get current data channel as well.
 
     *data = value;
-    return ret;
+}
+
+/**
+ * @brief
+ * 		Convert and read several channels of one ADC as a single bus job
+ * @details
+ * 		Each channel is a command register write, a register pointer select and a result
+ *      read, the same sequence as adc_init followed by adc_get_raw. With no settling delay
+ *      (AD7291_INIT_DELAY_TICKS) the transfers are queued back to back, and the task waits
+ *      for one completion instead of two per channel
+ * @param channels
+ * 		ADC_CHANNEL_x of each conversion, up to AD7291_MAX_BATCH
+ * @param count
+ * 		Number of channels
+ * @param data
+ * 		Raw results, in the order of channels
+ * @return
+ * 		0: success
+ *      -1: fail
+ */
+int adc_read_channels(uint8_t slave_addr, const uint8_t *channels, uint8_t count, unsigned short *data) {
+    uint8_t command[AD7291_MAX_BATCH][3];
+    unsigned char result[AD7291_MAX_BATCH][2];
+    i2c_xfer_t xfers[AD7291_MAX_BATCH * 3];
+    uint8_t reg_sel = 1; // select read register
+    unsigned char ch;
+    uint8_t i;
+    int ret = 0;
+
+    if (count > AD7291_MAX_BATCH) {
+        return -1;
+    }
+    if (AD7291_INIT_DELAY_TICKS != 0) {
+        for (i = 0; i < count; i++) {
+            adc_init(slave_addr, channels[i]);
+            if (adc_get_raw(slave_addr, &data[i], &ch) != 0) {
+                ret = -1;
+            }
+        }
+        return ret;
+    }
+
+    for (i = 0; i < count; i++) {
+        control_reg_val = adc_build_command_reg(command[i], channels[i], AD7291_EXT_REF_SET, AD7291_TSENSE_SET,
+                                                AD7291_NOISE_DELAY_SET, AD7291_RESET_SET, AD7291_REPEAT_SET);
+        xfers[3 * i].addr = slave_addr;
+        xfers[3 * i].flags = I2C_XFER_WRITE;
+        xfers[3 * i].size = sizeof(command[i]);
+        xfers[3 * i].buf = command[i];
+        xfers[3 * i + 1].addr = slave_addr;
+        xfers[3 * i + 1].flags = I2C_XFER_WRITE;
+        xfers[3 * i + 1].size = sizeof(reg_sel);
+        xfers[3 * i + 1].buf = &reg_sel;
+        xfers[3 * i + 2].addr = slave_addr;
+        xfers[3 * i + 2].flags = I2C_XFER_READ;
+        xfers[3 * i + 2].size = sizeof(result[i]);
+        xfers[3 * i + 2].buf = result[i];
+    }
+    if (i2c_Transfer(ADC_i2c_PORT, xfers, 3 * count) != 0) {
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        adc_decode_raw(result[i], &data[i], &ch);
+    }
+    return 0;
 }
 
 /**
@@ -309,9 +404,18 @@ float adc_get_tsense_temp(uint8_t slave_addr, float vref) {
         reg_sel = AD7291_T_SENSE;
     }
 
-    adc_set_register_pointer(slave_addr, reg_sel);
-    vTaskDelay(AD7291_INIT_DELAY_TICKS);
-    adc_get_raw(slave_addr, &data, &ch);
+    if (AD7291_INIT_DELAY_TICKS == 0) {
+        // Register pointer select and result read as one bus job
+        unsigned char buffer[2] = {0, 0};
+        i2c_xfer_t xfers[2] = {{slave_addr, I2C_XFER_WRITE, sizeof(reg_sel), &reg_sel},
+                               {slave_addr, I2C_XFER_READ, sizeof(buffer), buffer}};
+        i2c_Transfer(ADC_i2c_PORT, xfers, 2);
+        adc_decode_raw(buffer, &data, &ch);
+    } else {
+        adc_set_register_pointer(slave_addr, reg_sel);
+        vTaskDelay(AD7291_INIT_DELAY_TICKS);
+        adc_get_raw(slave_addr, &data, &ch);
+    }
     float temp_celsius = AD7291_BAD_TEMP;
     unsigned short value = data;
     temp_celsius =
@@ -310,110 +310,115 @@ void hyperion_config_3_value(config_3_panel_t panel, config_3_channel_type_t cha
     }
 }
 
+/* One config 1 panel, read by hyperion_config_1_panel */
+typedef struct {
+    int8_t temp[3];
+    uint8_t pd[3];
+    uint16_t voltage;
+    uint16_t current;
+    int8_t temp_adc;
+} config_1_panel_values_t;
+
+/**
+ * @brief
+ * 		Read every channel of a config 1 panel
+ * @details
+ * 		The eight channels are converted and read in one bus job with adc_read_channels, rather
+ *      than one adc_init and one adc_get_raw per value as hyperion_config_1_value does. The
+ *      conversions are the same as hyperion_config_1_value
+ * @param slave_addr
+ * 		PANEL_SLAVE_ADDR_x of the panel
+ * @param values
+ * 		The converted values
+ */
+static void hyperion_config_1_panel(uint8_t slave_addr, config_1_panel_values_t *values) {
+    const uint8_t channels[8] = {ADC_CHANNEL_0, ADC_CHANNEL_1, ADC_CHANNEL_2, ADC_CHANNEL_3,
+                                 ADC_CHANNEL_4, ADC_CHANNEL_5, ADC_CHANNEL_6, ADC_CHANNEL_7};
+    unsigned short data[8] = {0};
+    uint8_t i;
+
+    // A failed read leaves the raw values at 0, as hyperion_config_1_value does
+    adc_read_channels(slave_addr, channels, 8, data);
+    for (i = 0; i < 3; i++) {
+        values->temp[i] = (int8_t)adc_calculate_sensor_temp(data[i], ADC_VREF);
+        values->pd[i] = (uint8_t)adc_calculate_sensor_pd(data[3 + i], ADC_VREF);
+    }
+    values->voltage = (uint16_t)adc_calculate_sensor_voltage(data[6], ADC_VREF);
+    values->current = (uint16_t)adc_calculate_sensor_current(data[7], ADC_VREF);
+    values->temp_adc = adc_get_tsense_temp(slave_addr, ADC_VREF);
+}
+
 void Hyperion_config1_getHK(Hyperion_HouseKeeping *hyperion_hk) {
+    config_1_panel_values_t panel = {0};
+
     // NADIR TEMP 1
     hyperion_config_2_value(CONFIG_2_PANEL_NADIR, CONFIG_2_CHANNEL_PD_1, &hyperion_hk->Nadir_Temp1);
 
     // NADIR Temp Adc
     hyperion_hk->Nadir_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_NADIR, ADC_VREF);
 
-    // Port TEMP 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_TEMP_1, &hyperion_hk->Port_Temp1);
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_TEMP_2, &hyperion_hk->Port_Temp2);
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_TEMP_3, &hyperion_hk->Port_Temp3);
-
-    // Port Temp Adc
-    hyperion_hk->Port_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_PORT, ADC_VREF);
-
-    // Port Dep Temp 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_TEMP_1, &hyperion_hk->Port_Dep_Temp1);
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_TEMP_2, &hyperion_hk->Port_Dep_Temp2);
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_TEMP_3, &hyperion_hk->Port_Dep_Temp3);
-
-    // Port Dep Temp Adc
-    hyperion_hk->Port_Dep_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_PORT_DEPLOYABLE, ADC_VREF);
-
-    // Star Temp 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_TEMP_1, &hyperion_hk->Star_Temp1);
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_TEMP_2, &hyperion_hk->Star_Temp2);
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_TEMP_3, &hyperion_hk->Star_Temp3);
-
-    // Star Temp Adc
-    hyperion_hk->Star_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_STARBOARD, ADC_VREF);
-
-    // Star Dep Temp 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_TEMP_1, &hyperion_hk->Star_Dep_Temp1);
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_TEMP_2, &hyperion_hk->Star_Dep_Temp2);
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_TEMP_3, &hyperion_hk->Star_Dep_Temp3);
-
-    // Star Dep Adc
-    hyperion_hk->Star_Dep_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_STARBOARD_DEPLOYABLE, ADC_VREF);
-
-    // Zenith Temp 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_TEMP_1, &hyperion_hk->Zenith_Temp1);
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_TEMP_2, &hyperion_hk->Zenith_Temp2);
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_TEMP_3, &hyperion_hk->Zenith_Temp3);
-
-    // Zenith Temp Adc
-    hyperion_hk->Zenith_Temp_Adc = adc_get_tsense_temp(PANEL_SLAVE_ADDR_ZENITH, ADC_VREF);
-
     // Nadir Pd 1
     hyperion_config_2_value(CONFIG_2_PANEL_NADIR, CONFIG_2_CHANNEL_PD_1, &hyperion_hk->Nadir_Pd1);
 
-    // Port Pd 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_PD_1, &hyperion_hk->Port_Pd1);
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_PD_2, &hyperion_hk->Port_Pd2);
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_PD_3, &hyperion_hk->Port_Pd3);
-
-    // Port Dep Pd 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_PD_1, &hyperion_hk->Port_Dep_Pd1);
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_PD_2, &hyperion_hk->Port_Dep_Pd2);
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_PD_3, &hyperion_hk->Port_Dep_Pd3);
-
-    // Star Pd 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_PD_1, &hyperion_hk->Star_Pd1);
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_PD_2, &hyperion_hk->Star_Pd2);
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_PD_3, &hyperion_hk->Star_Pd3);
-
-    // Star Dep Pd 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_PD_1, &hyperion_hk->Star_Dep_Pd1);
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_PD_2, &hyperion_hk->Star_Dep_Pd2);
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_PD_3, &hyperion_hk->Star_Dep_Pd3);
-
-    // Zenith Pd 1 2 3
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_PD_1, &hyperion_hk->Zenith_Pd1);
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_PD_2, &hyperion_hk->Zenith_Pd2);
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_PD_3, &hyperion_hk->Zenith_Pd3);
-
-    // Port Voltage
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_VOLT, &hyperion_hk->Port_Voltage);
-
-    // Port Dep Voltage
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_VOLT, &hyperion_hk->Port_Dep_Voltage);
-
-    // Star Voltage
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_VOLT, &hyperion_hk->Star_Voltage);
-
-    // Star Dep Voltage
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_VOLT, &hyperion_hk->Star_Dep_Voltage);
-
-    // Zenith Voltage
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_VOLT, &hyperion_hk->Zenith_Voltage);
-
-    // Port Current
-    hyperion_config_1_value(CONFIG_1_PANEL_P, CONFIG_1_CHANNEL_CURR, &hyperion_hk->Port_Current);
-
-    // Port Dep Current
-    hyperion_config_1_value(CONFIG_1_PANEL_PD, CONFIG_1_CHANNEL_CURR, &hyperion_hk->Port_Dep_Current);
-
-    // Star Current
-    hyperion_config_1_value(CONFIG_1_PANEL_S, CONFIG_1_CHANNEL_CURR, &hyperion_hk->Star_Current);
-
-    // Star Dep Current
-    hyperion_config_1_value(CONFIG_1_PANEL_SD, CONFIG_1_CHANNEL_CURR, &hyperion_hk->Star_Dep_Current);
-
-    // Zenith Current
-    hyperion_config_1_value(CONFIG_1_PANEL_Z, CONFIG_1_CHANNEL_CURR, &hyperion_hk->Zenith_Current);
+    // Port
+    hyperion_config_1_panel(PANEL_SLAVE_ADDR_PORT, &panel);
+    hyperion_hk->Port_Temp1 = panel.temp[0];
+    hyperion_hk->Port_Temp2 = panel.temp[1];
+    hyperion_hk->Port_Temp3 = panel.temp[2];
+    hyperion_hk->Port_Temp_Adc = panel.temp_adc;
+    hyperion_hk->Port_Pd1 = panel.pd[0];
+    hyperion_hk->Port_Pd2 = panel.pd[1];
+    hyperion_hk->Port_Pd3 = panel.pd[2];
+    hyperion_hk->Port_Voltage = panel.voltage;
+    hyperion_hk->Port_Current = panel.current;
+
+    // Port Dep
+    hyperion_config_1_panel(PANEL_SLAVE_ADDR_PORT_DEPLOYABLE, &panel);
+    hyperion_hk->Port_Dep_Temp1 = panel.temp[0];
+    hyperion_hk->Port_Dep_Temp2 = panel.temp[1];
+    hyperion_hk->Port_Dep_Temp3 = panel.temp[2];
+    hyperion_hk->Port_Dep_Temp_Adc = panel.temp_adc;
+    hyperion_hk->Port_Dep_Pd1 = panel.pd[0];
+    hyperion_hk->Port_Dep_Pd2 = panel.pd[1];
+    hyperion_hk->Port_Dep_Pd3 = panel.pd[2];
+    hyperion_hk->Port_Dep_Voltage = panel.voltage;
+    hyperion_hk->Port_Dep_Current = panel.current;
+
+    // Star
+    hyperion_config_1_panel(PANEL_SLAVE_ADDR_STARBOARD, &panel);
+    hyperion_hk->Star_Temp1 = panel.temp[0];
+    hyperion_hk->Star_Temp2 = panel.temp[1];
+    hyperion_hk->Star_Temp3 = panel.temp[2];
+    hyperion_hk->Star_Temp_Adc = panel.temp_adc;
+    hyperion_hk->Star_Pd1 = panel.pd[0];
+    hyperion_hk->Star_Pd2 = panel.pd[1];
+    hyperion_hk->Star_Pd3 = panel.pd[2];
+    hyperion_hk->Star_Voltage = panel.voltage;
+    hyperion_hk->Star_Current = panel.current;
+
+    // Star Dep
+    hyperion_config_1_panel(PANEL_SLAVE_ADDR_STARBOARD_DEPLOYABLE, &panel);
+    hyperion_hk->Star_Dep_Temp1 = panel.temp[0];
+    hyperion_hk->Star_Dep_Temp2 = panel.temp[1];
+    hyperion_hk->Star_Dep_Temp3 = panel.temp[2];
+    hyperion_hk->Star_Dep_Temp_Adc = panel.temp_adc;
+    hyperion_hk->Star_Dep_Pd1 = panel.pd[0];
+    hyperion_hk->Star_Dep_Pd2 = panel.pd[1];
+    hyperion_hk->Star_Dep_Pd3 = panel.pd[2];
+    hyperion_hk->Star_Dep_Voltage = panel.voltage;
+    hyperion_hk->Star_Dep_Current = panel.current;
+
+    // Zenith
+    hyperion_config_1_panel(PANEL_SLAVE_ADDR_ZENITH, &panel);
+    hyperion_hk->Zenith_Temp1 = panel.temp[0];
+    hyperion_hk->Zenith_Temp2 = panel.temp[1];
+    hyperion_hk->Zenith_Temp3 = panel.temp[2];
+    hyperion_hk->Zenith_Temp_Adc = panel.temp_adc;
+    hyperion_hk->Zenith_Pd1 = panel.pd[0];
+    hyperion_hk->Zenith_Pd2 = panel.pd[1];
+    hyperion_hk->Zenith_Pd3 = panel.pd[2];
+    hyperion_hk->Zenith_Voltage = panel.voltage;
+    hyperion_hk->Zenith_Current = panel.current;
 }
 
 void Hyperion_config3_getHK(Hyperion_HouseKeeping *hyperion_hk) {
@@ -88,7 +88,14 @@ NS_return NS_upload_artwork(char *filename) {
     }
 
     // Start xmodem transfer
+#if XMODEM_STREAM_1K == 1
+    xmodem_stats xstats;
+    int status = xmodemTransmitStream(file1, stat.st_size, &xstats);
+    sys_log(INFO, "xmodem sent %u bytes in %u blocks, %u retries, %u NAKs, %u timeouts, %u B/s", xstats.bytes,
+            xstats.blocks, xstats.retries, xstats.naks, xstats.timeouts, xstats.bytes_per_s);
+#else
     int status = xmodemTransmit(file1, stat.st_size);
+#endif
     if (status == -1) {
         sys_log(ERROR, "Error %d during xmodem transfer of %s in NS_upload_artwork\r\n", red_errno, filename);
         return_val = NS_FAIL;
@@ -128,6 +128,35 @@ NS_return NS_sendOnly(uint8_t *command, uint32_t command_length) {
     return NS_OK;
 }
 
+/**
+ * @brief
+ *      Start sending over the UART and return while the bytes go out
+ * @details
+ *      The UART stays locked until NS_sendEnd, and the buffer must not change
+ *      before then. Lets the caller do other work, such as reading the next block
+ *      of a file, during the send
+ */
+NS_return NS_sendBegin(uint8_t *command, uint32_t command_length) {
+    if (xSemaphoreTake(uart_mutex, NS_SEMAPHORE_TIMEOUT_MS) != pdTRUE) {
+        return NS_UART_BUSY;
+    }
+    sciSend(PAYLOAD_SCI, command_length, command);
+    return NS_OK;
+}
+
+/**
+ * @brief
+ *      Wait for a send started by NS_sendBegin to finish and unlock the UART
+ */
+NS_return NS_sendEnd(TickType_t timeout) {
+    NS_return ret = NS_OK;
+    if (xSemaphoreTake(ns_tx_semphr, timeout) != pdTRUE) {
+        ret = NS_UART_FAIL;
+    }
+    xSemaphoreGive(uart_mutex);
+    return ret;
+}
+
 NS_return NS_expectResponse(uint8_t *response, uint8_t length, TickType_t timeout) {
     if (xSemaphoreTake(uart_mutex, NS_SEMAPHORE_TIMEOUT_MS) != pdTRUE) {
         return NS_UART_BUSY;
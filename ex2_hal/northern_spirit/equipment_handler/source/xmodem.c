@@ -35,9 +35,11 @@
  */
 
 #include <base_64.h>
+#include "crc16.h"
 #include "xmodem.h"
 #include "northern_spirit_io.h"
 #include <string.h>
+#include <os_task.h>
 #include <redposix.h>
 #include "logger/logger.h"
 
@@ -52,14 +54,7 @@ int _inbyte(void *dat, size_t len, unsigned short timeout) {
 
 void _outbyte(void *c, size_t len) { NS_sendOnly((uint8_t *) c, len); }
 
-unsigned short crc16_ccitt(const void *buf, int len) {
-    register int counter;
-    register unsigned short crc = 0;
-    const char *p = (const char *)buf;
-    for (counter = 0; counter < len; counter++)
-        crc = (crc << 8) ^ crc16tab[((crc >> 8) ^ *p++) & 0x00FF];
-    return crc;
-}
+unsigned short crc16_ccitt(const void *buf, int len) { return crc16_slice8(CRC16_INIT, buf, len); }
 
 static int check(int crc, const char *buf, int sz) {
     if (crc) {
@@ -184,7 +179,8 @@ int xmodemTransmit(int32_t filedes, uint64_t filesz) {
 
     int bufsz, crc = -1;
     unsigned char packetno = 1;
-    int i, len = 0;
+    int i;
+    uint64_t len = 0;
     int retry;
     char c = 0;
     char ack = ACK;
@@ -231,30 +227,19 @@ int xmodemTransmit(int32_t filedes, uint64_t filesz) {
 #endif
             xbuff[1] = packetno;
             xbuff[2] = ~packetno;
-            c = filesz - len;
-
-            if (c > bufsz)
-                c = bufsz;
-            if (c > 0) {
+            if (filesz > len) {
                 // Transmit next xmodem packet
+                unsigned char raw[XMODEM_BASE64_RAW_LEN];
                 memset(&xbuff[3], '=', bufsz);
-                int32_t bytes_read = red_read(filedes, &xbuff[3], 96);
-                len += 96;
+                int32_t bytes_read = red_read(filedes, raw, sizeof(raw));
                 if (bytes_read == -1) {
                     goto trans_error;
                 } else if (bytes_read == 0) {
                     goto done_trans;
-                } else {
-                    size_t encoded_len;
-                    char *temp = base64_encode(&xbuff[3], bytes_read, &encoded_len);
-                    if (!temp) {
-                        goto trans_error;
-                    }
-                    if (encoded_len < c) {
-                        c = encoded_len;
-                    }
-                    memcpy(&xbuff[3], temp, encoded_len);
-                    vPortFree(temp);
+                }
+                len += bytes_read;
+                if (base64_encode_into(raw, bytes_read, (char *)&xbuff[3], bufsz) == 0) {
+                    goto trans_error;
                 }
                 if (crc) {
                     unsigned short ccrc = crc16_ccitt(&xbuff[3], bufsz);
@@ -308,3 +293,217 @@ int xmodemTransmit(int32_t filedes, uint64_t filesz) {
         }
     }
 }
+
+/* Packets of the streaming transmitter, one is on the UART while the next block is read into the other */
+static unsigned char stream_buf[2][XMODEM_PACKET_LEN(XMODEM_1K_BLOCK_LEN)];
+
+static void cancel_transfer(void) {
+    char can = CAN;
+    _outbyte(&can, 1);
+    _outbyte(&can, 1);
+    _outbyte(&can, 1);
+    flushinput();
+}
+
+/**
+ * @brief
+ *      Read the next block of the file into the data field of a packet
+ * @return
+ *      Bytes read, short only at the end of the file, or -1 on error
+ */
+static int32_t stream_read(int32_t filedes, unsigned char *packet, uint64_t remaining) {
+    uint32_t want = remaining < XMODEM_1K_BLOCK_LEN ? (uint32_t)remaining : XMODEM_1K_BLOCK_LEN;
+    uint32_t got = 0;
+
+    while (got < want) {
+        int32_t n = red_read(filedes, &packet[XMODEM_HEADER_LEN + got], want - got);
+        if (n < 0) {
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        got += n;
+    }
+    return got;
+}
+
+/**
+ * @brief
+ *      Fill in the header, padding and check of a packet holding len bytes of data
+ * @details
+ *      A last block of 128 bytes or less goes in a 128 byte packet, so a short
+ *      tail does not cost a whole 1K packet
+ * @return
+ *      Length of the packet
+ */
+static int stream_frame(unsigned char *packet, unsigned char packetno, int32_t len, int crc) {
+    int bufsz = len > XMODEM_BLOCK_LEN ? XMODEM_1K_BLOCK_LEN : XMODEM_BLOCK_LEN;
+    unsigned char *data = &packet[XMODEM_HEADER_LEN];
+
+    packet[0] = bufsz == XMODEM_1K_BLOCK_LEN ? STX : SOH;
+    packet[1] = packetno;
+    packet[2] = ~packetno;
+    memset(&data[len], CTRLZ, bufsz - len);
+    if (crc) {
+        uint16_t ccrc = crc16_slice8(CRC16_INIT, data, bufsz);
+        data[bufsz] = (ccrc >> 8) & 0xFF;
+        data[bufsz + 1] = ccrc & 0xFF;
+        return XMODEM_PACKET_LEN(bufsz);
+    } else {
+        unsigned char ccks = 0;
+        int i;
+        for (i = 0; i < bufsz; ++i) {
+            ccks += data[i];
+        }
+        data[bufsz] = ccks;
+        return XMODEM_PACKET_LEN(bufsz) - 1;
+    }
+}
+
+/**
+ * @brief
+ *      Wait for the receiver to ask for the transfer
+ * @return
+ *      1 for CRC mode, 0 for checksum mode, -1 if cancelled by the receiver, -2 on no sync
+ */
+static int stream_sync(void) {
+    char c;
+    char ack = ACK;
+    int retry;
+
+    for (retry = 0; retry < 16; ++retry) {
+        if (_inbyte(&c, 1, DLY_1S) != 0) {
+            continue;
+        }
+        if (c == 'C') {
+            return 1;
+        } else if (c == NAK) {
+            return 0;
+        } else if (c == CAN) {
+            _inbyte(&c, 1, DLY_1S);
+            if (c == CAN) {
+                _outbyte(&ack, 1);
+                flushinput();
+                return -1;
+            }
+        }
+    }
+    cancel_transfer();
+    return -2;
+}
+
+/**
+ * @brief
+ *      Send a file with XMODEM-1K, as is and without allocating
+ * @details
+ *      Blocks are read from the file straight into one of two static packets. While
+ *      one packet goes out on the UART the next block is read into the other, so the
+ *      file system read is hidden behind the send. The CRC is the slicing by 8 one.
+ *      The packets are not locked, so only one transfer can run at a time, which
+ *      the Northern Spirit command mutex ensures
+ * @param filedes
+ *      File to send, from the current position
+ * @param filesz
+ *      Bytes to send
+ * @param stats
+ *      Filled in with the statistics of the transfer, may be NULL
+ * @return
+ *      Bytes sent, or -1 if cancelled by the receiver, -2 on no sync, -4 on a read
+ *      error or too many retries, -5 if the end of transmission was not acknowledged
+ */
+int xmodemTransmitStream(int32_t filedes, uint64_t filesz, xmodem_stats *stats) {
+    xmodem_stats local;
+    unsigned char packetno = 1;
+    uint64_t read;
+    int32_t len, next_len;
+    int crc, cur = 0, packet_len, retry;
+    TickType_t start;
+    char c = 0;
+    char eot = EOT;
+    char ack = ACK;
+
+    if (stats == NULL) {
+        stats = &local;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    crc = stream_sync();
+    if (crc < 0) {
+        return crc;
+    }
+
+    start = xTaskGetTickCount();
+    len = stream_read(filedes, stream_buf[cur], filesz);
+    if (len < 0) {
+        cancel_transfer();
+        return -4;
+    }
+    read = len;
+
+    while (len > 0) {
+        packet_len = stream_frame(stream_buf[cur], packetno, len, crc);
+        next_len = -2; // not read yet
+
+        for (retry = 0;; ++retry) {
+            if (retry >= MAXRETRANS) {
+                cancel_transfer();
+                return -4;
+            }
+            if (retry > 0) {
+                stats->retries++;
+            }
+            if (NS_sendBegin(stream_buf[cur], packet_len) != NS_OK) {
+                stats->timeouts++;
+                continue;
+            }
+            if (next_len == -2) {
+                next_len = stream_read(filedes, stream_buf[cur ^ 1], filesz - read);
+            }
+            NS_sendEnd(NS_UART_LONG_TIMEOUT_MS);
+
+            if (_inbyte(&c, 1, DLY_1S) != 0) {
+                stats->timeouts++;
+                continue;
+            }
+            if (c == ACK) {
+                break;
+            } else if (c == NAK) {
+                stats->naks++;
+            } else if (c == CAN) {
+                _inbyte(&c, 1, DLY_1S);
+                if (c == CAN) {
+                    _outbyte(&ack, 1);
+                    flushinput();
+                    return -1;
+                }
+            }
+        }
+
+        stats->blocks++;
+        stats->bytes += len;
+        ++packetno;
+        if (next_len < 0) {
+            cancel_transfer();
+            return -4;
+        }
+        read += next_len;
+        len = next_len;
+        cur ^= 1;
+    }
+
+    // The receiver may NAK the first EOT to make sure it was not noise
+    for (retry = 0; retry < MAXRETRANS; ++retry) {
+        _outbyte(&eot, 1);
+        if (_inbyte(&c, 1, DLY_1S) == 0 && c == ACK) {
+            break;
+        }
+    }
+    flushinput();
+
+    stats->elapsed_ms = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+    if (stats->elapsed_ms > 0) {
+        stats->bytes_per_s = (uint32_t)((uint64_t)stats->bytes * 1000 / stats->elapsed_ms);
+    }
+    return (c == ACK) ? (int)stats->bytes : -5;
+}
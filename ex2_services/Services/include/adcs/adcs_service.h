@@ -139,7 +139,9 @@ typedef enum {
     ADCS_SET_ASGP4_SETTING,
     ADCS_GET_FULL_CONFIG,
     ADCS_DOWNLOAD_FILE_LIST_TO_OBC,
-    ADCS_DOWNLOAD_FILE_TO_OBC
+    ADCS_DOWNLOAD_FILE_TO_OBC,
+    ADCS_SET_TLM_CACHE_PERIOD,
+    ADCS_GET_TLM_CACHE_PERIOD
 } ADCS_Subtype;
 
 SAT_returnState adcs_service_app(csp_packet_t *packet);
@@ -22,6 +22,22 @@
 #ifndef EX2_SERVICES_SERVICES_INCLUDE_CLI_H_
 #define EX2_SERVICES_SERVICES_INCLUDE_CLI_H_
 
+#include <stddef.h>
+#include "services.h"
+
+/* Request format, in the subservice byte of a cli request */
+#define CLI_TEXT_OUTPUT 0    // one MAX_OUTPUT_SIZE packet per call of the command
+#define CLI_BATCHED_OUTPUT 1 // outputs packed into full packets
+
+/* Batched reply layout. The status byte is 1 while more packets follow.
+ * The sequence number counts up from 0 for each command. Both fields are
+ * big-endian. */
+#define CLI_BATCH_SEQ_BYTE (OUT_DATA_BYTE)      // uint16_t sequence number
+#define CLI_BATCH_LEN_BYTE (OUT_DATA_BYTE + 2)  // uint16_t bytes of output in this packet
+#define CLI_BATCH_DATA_BYTE (OUT_DATA_BYTE + 4) // output
+
 SAT_returnState start_cli_service(void);
 
+void cli_set_output_len(size_t len);
+
 #endif /* EX2_SERVICES_SERVICES_INCLUDE_CLI_H_ */
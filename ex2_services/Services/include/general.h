@@ -44,7 +44,9 @@ typedef enum {
     DISABLE_BEACON_TASK = 15,
     BEACON_TASK_GET_STATE = 16,
     GET_SOLAR_SWITCH_STATUS = 17,
-    SET_SOLAR_SWITCH = 18
+    SET_SOLAR_SWITCH = 18,
+    GET_TASK_STATS = 19,
+    GET_CSP_POOL_STATS = 20
 } General_Subtype;
 
 typedef enum { bootloader = 'B', golden = 'G', application = 'A' } reboot_mode;
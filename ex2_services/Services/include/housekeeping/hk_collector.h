@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file hk_collector.h
+ * @date 2026-10-19
+ */
+
+#ifndef HK_COLLECTOR_H
+#define HK_COLLECTOR_H
+
+#include "housekeeping/housekeeping_service.h"
+
+/*Deadlines are measured from the start of the snapshot. Devices sharing a bus
+ *are read in table order, so later devices on a bus get the larger deadlines*/
+#define HK_DEADLINE_ADCS_MS 1500
+#define HK_DEADLINE_EPS_MS 2500 // two CSP transactions
+#define HK_DEADLINE_ATHENA_MS 500
+#define HK_DEADLINE_UHF_MS 1500
+#define HK_DEADLINE_HYPERION_MS 2000
+#define HK_DEADLINE_CHARON_MS 2500
+#define HK_DEADLINE_SBAND_MS 1500
+#define HK_DEADLINE_DFGM_MS 1500
+#define HK_DEADLINE_IRIS_MS 2500
+#define HK_DEADLINE_NS_MS 3000
+
+/*Upper bound on a snapshot. Must be at least the largest device deadline*/
+#define HK_SNAPSHOT_DEADLINE_MS 3000
+
+SAT_returnState hk_collector_start(void);
+
+Result hk_collector_collect(All_systems_housekeeping *all_hk_data);
+
+#endif /* HK_COLLECTOR_H */
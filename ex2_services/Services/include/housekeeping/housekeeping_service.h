@@ -35,6 +35,8 @@
 #include "dfgm.h"
 #include "ns_payload.h"
 #include "iris.h"
+#include "diagnostic/task_stats.h"
+#include "diagnostic/heap_stats.h"
 
 /* Housekeeping service address & port*/
 
@@ -57,7 +59,8 @@ typedef enum {
     SET_MAX_FILES = 1,
     GET_MAX_FILES = 2,
     GET_INSTANTANEOUS_HK = 3,
-    GET_LATEST_HK = 4
+    GET_LATEST_HK = 4,
+    GET_LATEST_HK_SECTION = 5
 } subservice;
 
 /*hk data sample*/
@@ -65,6 +68,35 @@ typedef enum { EPS, ADCS, OBC, COMMS } hardware;
 
 /*--------------hk data----------------*/
 
+/*devices polled by the housekeeping collector, in record order*/
+typedef enum {
+    HK_DEV_ADCS = 0,
+    HK_DEV_ATHENA,
+    HK_DEV_EPS,
+    HK_DEV_UHF,
+    HK_DEV_SBAND,
+    HK_DEV_HYPERION,
+    HK_DEV_CHARON,
+    HK_DEV_DFGM,
+    HK_DEV_IRIS,
+    HK_DEV_NS,
+    HK_DEVICE_COUNT
+} hk_device;
+
+typedef enum {
+    HK_DEV_OK = 0,      // read completed within its deadline
+    HK_DEV_ERROR = 1,   // driver returned an error, data may be partial
+    HK_DEV_TIMEOUT = 2, // missed its deadline, data zeroed
+    HK_DEV_BUSY = 3,    // bus still held by a late read from a previous snapshot, data zeroed
+    HK_DEV_LATE = 4,    // read completed after its deadline but before the snapshot closed
+    HK_DEV_STUBBED = 5  // mock data
+} hk_device_status;
+
+typedef struct __attribute__((packed)) {
+    uint8_t status[HK_DEVICE_COUNT];      // hk_device_status of each device
+    uint16_t latency_ms[HK_DEVICE_COUNT]; // time from snapshot start to read completion
+} hk_collection_status;
+
 typedef struct __attribute__((packed)) {
     /*placeholder timestamp structure. Not sure if we use UNIX time*/
     uint8_t final;          // indicator to tell if more datasets will be sent
@@ -87,8 +119,32 @@ typedef struct __attribute__((packed)) {
     DFGM_Housekeeping DFGM_hk;              // DFGM housekeeping struct
     ns_telemetry NS_hk;                     // Northern SPIRIT housekeeping
     IRIS_Housekeeping IRIS_hk;              // Iris housekeeping struct
+    hk_collection_status collection;        // per-device status of this snapshot
+    task_stats_hk task_stats;               // OBC task CPU, stack and latency summary
+    heap_stats_hk heap;                     // OBC heap fragmentation and size class use
 } All_systems_housekeeping;
 
+/*sections of All_systems_housekeeping that can be read on their own, in record order*/
+typedef enum {
+    HK_SECTION_TIME = 0,
+    HK_SECTION_ADCS,
+    HK_SECTION_ATHENA,
+    HK_SECTION_EPS,
+    HK_SECTION_EPS_STARTUP,
+    HK_SECTION_UHF,
+    HK_SECTION_SBAND,
+    HK_SECTION_HYPERION,
+    HK_SECTION_CHARON,
+    HK_SECTION_DFGM,
+    HK_SECTION_NS,
+    HK_SECTION_IRIS,
+    HK_SECTION_COLLECTION,
+    HK_SECTION_TASK_STATS,
+    HK_SECTION_HEAP,
+    HK_SECTION_COUNT
+} hk_section;
+
+SAT_returnState housekeeping_init(void);
 SAT_returnState start_housekeeping_service(void);
 
 /*This function called every interval to collect data periodically*/
@@ -96,6 +152,10 @@ Result populate_and_store_hk_data(void);
 
 uint16_t get_size_of_housekeeping();
 void get_latest_hk(All_systems_housekeeping *hk);
+const All_systems_housekeeping *hk_latest_acquire(uint32_t *seq);
+bool hk_latest_valid(uint32_t seq);
+bool hk_latest_read_section(hk_section section, void *out, size_t out_len);
+size_t hk_section_size(hk_section section);
 
 uint16_t get_file_id_from_timestamp(uint32_t timestamp);
 Result load_historic_hk_data(uint16_t file_num, All_systems_housekeeping *all_hk_data);
@@ -46,7 +46,6 @@ typedef enum {
     NV_STOP_TRANSMIT
 } ns_payload_service_subtype;
 
-void ns_payload_service(void *param);
 SAT_returnState ns_payload_service_app(csp_packet_t *pkt);
 
 SAT_returnState start_ns_payload_service(void);
@@ -39,6 +39,7 @@ typedef enum {
     SCHED_ERR_SUBSERVICE, // from SAT_returnState
     SCHED_ERR_RTC,
     SCHED_ERR_LOCK,
+    SCHED_ERR_BAD_CMD, // command longer than MAX_CMD_LENGTH or cut short by the packet
 } SchedulerError_t;
 
 // The file that holds the schedule
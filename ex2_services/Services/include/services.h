@@ -20,6 +20,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <csp/csp.h>
+
 #include "main/system.h"
 #include "subsystems_ids.h"
 
@@ -36,6 +38,15 @@
 #define MAX_SUBTYPES 256 // an 8-bit integer
 #define SERVICE_BACKLOG_LEN 3
 
+/* SERVICE DISPATCHER */
+#define SERVICE_MAX_REGISTERED 16     // services sharing the dispatcher socket
+#define SERVICE_DISPATCH_BACKLOG 8    // connections waiting to be accepted
+#define SERVICE_DISPATCH_QUEUE_LEN 8  // accepted connections waiting for a worker
+#define SERVICE_DISPATCH_TIMEOUT 1000 // ms to wait for room in a worker queue before dropping
+#define SERVICE_LOCK_TIMEOUT 1000     // ms a worker waits for a service another worker is serving
+#define SERVICE_READ_TIMEOUT 50
+#define SERVICE_REPLY_TIMEOUT 50
+
 #define GS_CSP_ADDR 16
 
 #define NORMAL_TICKS_TO_WAIT 1
@@ -85,8 +96,30 @@ union _cnv {
     uint8_t cnv8[8];
 };
 
+/*
+ * Called by a service worker for every packet read on a connection to the
+ * service's port. The handler owns the packet: it must send or free it.
+ */
+typedef void (*service_handler)(csp_conn_t *conn, csp_packet_t *packet);
+
+typedef enum {
+    SERVICE_SHARED_WORKER,   // served by the shared worker pool
+    SERVICE_DEDICATED_WORKER // long running service, gets a worker task of its own
+} service_worker_type;
+
+typedef struct {
+    const char *name;
+    uint8_t port;
+    uint32_t connections;
+    uint32_t max_wait_ms; // longest time a connection waited for a worker
+} service_stats_t;
+
 SAT_returnState start_service_server(void);
 SAT_returnState start_csp_server(void);
+SAT_returnState register_service(uint8_t port, const char *name, service_handler handler,
+                                 service_worker_type worker, uint16_t stack_size);
+void service_reply(csp_conn_t *conn, csp_packet_t *packet, SAT_returnState state);
+bool get_service_stats(uint8_t index, service_stats_t *stats);
 void increment_commands_recv();
 int get_commands_recv();
 void hex_dump(char *stuff, int size);
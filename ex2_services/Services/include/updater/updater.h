@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file updater.h
+ * @date 2026-10-19
+ */
+
+#ifndef UPDATER_H
+#define UPDATER_H
+
+#include "services.h"
+
+typedef enum {
+    UPDATE_BEGIN = 0,
+    UPDATE_WRITE = 1,
+    UPDATE_FINISH = 2,
+    UPDATE_ABORT = 3,
+    UPDATE_GET_PROGRESS = 4,
+    UPDATE_PATCH_BEGIN = 5,
+    UPDATE_PATCH_WRITE = 6,
+    UPDATE_PATCH_FINISH = 7
+} Updater_Subtype;
+
+SAT_returnState start_updater_service(void);
+
+#endif /* UPDATER_H */
@@ -19,6 +19,7 @@
 
 #include <string.h>
 #include "adcs/adcs_service.h"
+#include "adcs_tlm_cache.h"
 #include "logger/logger.h"
 
 SAT_returnState adcs_service_app(csp_packet_t *packet) {
@@ -426,7 +427,7 @@ SAT_returnState adcs_service_app(csp_packet_t *packet) {
 
     case ADCS_GET_COMMS_STAT: {
         uint16_t comm_status[5];
-        status = HAL_ADCS_get_comms_stat(comm_status);
+        status = adcs_tlm_cache_get(ADCS_TLM_COMMS_STAT, comm_status, ADCS_TLM_SVC_MAX_AGE);
         memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
 
         if (sizeof(comm_status) + 1 > csp_buffer_data_size()) {
@@ -808,7 +809,7 @@ SAT_returnState adcs_service_app(csp_packet_t *packet) {
 
     case ADCS_GET_CURRENT_STATE: {
         adcs_state data;
-        status = HAL_ADCS_get_current_state(&data);
+        status = adcs_tlm_cache_get(ADCS_TLM_CURRENT_STATE, &data, ADCS_TLM_SVC_MAX_AGE);
         memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
         memcpy(&packet->data[OUT_DATA_BYTE], &data, sizeof(adcs_state));
         set_packet_length(packet, sizeof(data) + sizeof(int8_t) + 1);
@@ -849,7 +850,7 @@ SAT_returnState adcs_service_app(csp_packet_t *packet) {
 
     case ADCS_GET_SAT_POS_LLH: {
         LLH target;
-        status = HAL_ADCS_get_sat_pos_LLH(&target);
+        status = adcs_tlm_cache_get(ADCS_TLM_SAT_POS_LLH, &target, ADCS_TLM_SVC_MAX_AGE);
         memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
         memcpy(&packet->data[OUT_DATA_BYTE], &target, sizeof(LLH));
         set_packet_length(packet, sizeof(LLH) + sizeof(int8_t) + 1);
@@ -911,7 +912,7 @@ SAT_returnState adcs_service_app(csp_packet_t *packet) {
     case ADCS_GET_MEASUREMENTS: {
 
         adcs_measures mes;
-        status = HAL_ADCS_get_measurements(&mes);
+        status = adcs_tlm_cache_get(ADCS_TLM_MEASUREMENTS, &mes, ADCS_TLM_SVC_MAX_AGE);
         if (sizeof(mes) + 1 > csp_buffer_data_size()) {
             return_state = SATR_ERROR;
         }
@@ -1011,7 +1012,7 @@ SAT_returnState adcs_service_app(csp_packet_t *packet) {
 
     case ADCS_GET_POWER_TEMP: {
         adcs_pwr_temp mes;
-        status = HAL_ADCS_get_power_temp(&mes);
+        status = adcs_tlm_cache_get(ADCS_TLM_POWER_TEMP, &mes, ADCS_TLM_SVC_MAX_AGE);
         if (sizeof(mes) + 1 > csp_buffer_data_size()) {
             return_state = SATR_ERROR;
         }
@@ -1512,6 +1513,26 @@ SAT_returnState adcs_service_app(csp_packet_t *packet) {
         break;
     }
 
+    case ADCS_SET_TLM_CACHE_PERIOD: {
+        // in: poll period in seconds, clamped to the limits in adcs_tlm_cache.h
+        uint32_t period_s;
+        cnv8_32(&packet->data[IN_DATA_BYTE], &period_s);
+        adcs_tlm_cache_set_period(csp_ntoh32(period_s));
+        status = ADCS_OK;
+        memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
+        set_packet_length(packet, sizeof(int8_t) + 1);
+        break;
+    }
+
+    case ADCS_GET_TLM_CACHE_PERIOD: {
+        uint32_t period_s = csp_hton32(adcs_tlm_cache_get_period());
+        status = ADCS_OK;
+        memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
+        memcpy(&packet->data[OUT_DATA_BYTE], &period_s, sizeof(period_s));
+        set_packet_length(packet, sizeof(period_s) + sizeof(int8_t) + 1);
+        break;
+    }
+
     default:
         break;
     }
@@ -1521,76 +1542,43 @@ SAT_returnState adcs_service_app(csp_packet_t *packet) {
 
 /**
  * @brief
- *      FreeRTOS adcs server task
- * @details
- *      Accepts incoming adcs service packets and executes the
- * application
- * @param void* param
- * @return None
+ *      Handle a packet received by the adcs service
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet, sent back as the reply or freed
  */
-void adcs_service(void *param) {
-    int32_t iErr = red_mkdir("adcs");
-    if (iErr == -1 && red_errno != 17) {
-        sys_log(ERROR, "Unexpected error %d from creating adcs directory", red_errno);
-    } else {
-        sys_log(INFO, "Successfully created adcs directory");
-    }
-
-    // create socket
-    csp_socket_t *sock = csp_socket(CSP_SO_HMACREQ);
-
-    // bind the adcs service to socket
-    csp_bind(sock, TC_ADCS_SERVICE);
-
-    // create connections backlog queue
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    // pointer to current connection and packet
-    csp_conn_t *conn;
-    csp_packet_t *packet;
-    // process incoming connection
-    while (1) {
-
-        // wait for connection, timeout
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-
-            /* timeout */
-            continue;
-        }
-
-        // read packets. timeout is 50ms
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (adcs_service_app(packet) != SATR_OK) {
-                // something went wrong in the service
-                ex2_log("Error");
-                csp_buffer_free(packet);
-            } else {
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
-            }
-        }
-
-        // close current connection
-        csp_close(conn);
+static void adcs_service(csp_conn_t *conn, csp_packet_t *packet) {
+    SAT_returnState state = adcs_service_app(packet);
+    if (state != SATR_OK) {
+        // something went wrong in the service
+        ex2_log("Error");
     }
+    service_reply(conn, packet, state);
 }
 
 /**
  * @brief
- *      Start the adcs server task
+ *      Start the adcs service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming
  *      adcs service requests
  * @param None
  * @return SAT_returnState
  *      success report
  */
 SAT_returnState start_adcs_service(void) {
-    // create adcs service
-    if (xTaskCreate((TaskFunction_t)adcs_service, "adcs_service", ADCS_SVC_SIZE, NULL, NORMAL_SERVICE_PRIO,
-                    NULL) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK start_adcs_service\n");
+    int32_t iErr = red_mkdir("adcs");
+    if (iErr == -1 && red_errno != 17) {
+        sys_log(ERROR, "Unexpected error %d from creating adcs directory", red_errno);
+    } else {
+        sys_log(INFO, "Successfully created adcs directory");
+    }
+
+    // File and image downloads can take minutes, keep them off the shared workers
+    if (register_service(TC_ADCS_SERVICE, "adcs_service", adcs_service, SERVICE_DEDICATED_WORKER,
+                         ADCS_SVC_SIZE) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER adcs_service\n");
         return SATR_ERROR;
     }
 
@@ -38,6 +38,8 @@
 #include "cli/fs_utils.h"
 #include "bl_eeprom.h"
 #include "main/version.h"
+#include "mem_region.h"
+#include "NMEAParser.h"
 /*
  * Command Implementations
  *
@@ -101,13 +103,72 @@ static BaseType_t prvUptimeCommand(char *pcWriteBuffer, size_t xWriteBufferLen,
     return pdFALSE;
 }
 
+// Heap totals, free block histogram, then one line per size class, called again while pdTRUE is returned
 static BaseType_t prvHeapCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
-    BaseType_t heap_used = xPortGetFreeHeapSize();
-    BaseType_t heap_total = xPortGetMinimumEverFreeHeapSize();
-    int heap_percent = configTOTAL_HEAP_SIZE / heap_used;
-    snprintf(pcWriteBuffer, xWriteBufferLen, "Free: %d\nMinimum: %d\nPercent: %d\n", heap_used, heap_total,
-             heap_percent);
-    return pdFALSE;
+    static HeapStats_t heap;
+    static uint8_t line = 0;
+    mem_region_stats region;
+    int i;
+
+    switch (line) {
+    case 0:
+        vPortGetHeapStats(&heap);
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Free: %u\nMinimum: %u\nLargest block: %u\nFree blocks: %u\n",
+                 heap.xAvailableHeapSpaceInBytes, heap.xMinimumEverFreeBytesRemaining,
+                 heap.xSizeOfLargestFreeBlockInBytes, heap.xNumberOfFreeBlocks);
+        break;
+    case 1:
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Allocs: %u\nFrees: %u\nFailed: %u\nLargest failed: %u\n",
+                 heap.xNumberOfSuccessfulAllocations, heap.xNumberOfSuccessfulFrees,
+                 heap.xNumberOfFailedAllocations, heap.xLargestFailedRequest);
+        break;
+    case 2:
+    case 3: {
+        // half of the histogram per call, bucket n holds blocks of 2^(n+5) up to 2^(n+6) bytes
+        int first = (line - 2) * portHEAP_HISTOGRAM_BUCKETS / 2;
+        int written = snprintf(pcWriteBuffer, xWriteBufferLen, "%s", line == 2 ? "Free blocks by size:\n" : "");
+        for (i = first; i < first + portHEAP_HISTOGRAM_BUCKETS / 2 && written < (int)xWriteBufferLen; i++) {
+            written += snprintf(pcWriteBuffer + written, xWriteBufferLen - written, " %s%u: %u\n",
+                                i == 0 ? "<" : (i == portHEAP_HISTOGRAM_BUCKETS - 1 ? ">=" : ""),
+                                i == 0 ? 64u : 1u << (i + 5), heap.usFreeBlockHistogram[i]);
+        }
+        break;
+    }
+    default:
+        if (!mem_region_get_stats(line - 4, &region)) {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "Size class spills: %u\n", mem_region_spills());
+            line = 0;
+            return pdFALSE;
+        }
+        snprintf(pcWriteBuffer, xWriteBufferLen, "Class %4u: %2u/%2u used, peak %2u, allocs %u, exhausted %u\n",
+                 region.block_size, region.in_use, region.blocks, region.peak_in_use, region.allocations,
+                 region.exhausted);
+        break;
+    }
+    line++;
+    return pdTRUE;
+}
+
+// One line per task that has allocated from the heap, called again while pdTRUE is returned
+static BaseType_t prvHeapCallersCommand(char *pcWriteBuffer, size_t xWriteBufferLen,
+                                        const char *pcCommandString) {
+    static HeapCallerStats_t callers[portHEAP_CALLER_SLOTS];
+    static UBaseType_t count = 0;
+    static UBaseType_t index = 0;
+
+    if (index == 0) {
+        count = uxPortGetHeapCallerStats(callers, portHEAP_CALLER_SLOTS);
+    }
+    if (index >= count) {
+        index = 0;
+        snprintf(pcWriteBuffer, xWriteBufferLen, "\n");
+        return pdFALSE;
+    }
+    snprintf(pcWriteBuffer, xWriteBufferLen, "%-16s allocs %8u  failed %4u  bytes %10u\n",
+             callers[index].pcTaskName, callers[index].ulAllocations, callers[index].ulFailures,
+             callers[index].ulBytesRequested);
+    index++;
+    return pdTRUE;
 }
 
 static BaseType_t prvBootInfoCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
@@ -286,6 +347,40 @@ static BaseType_t prvHostNameCommand(char *pcWriteBuffer, size_t xWriteBufferLen
     return pdFALSE;
 }
 
+// One line per registered service, called again by the CLI while pdTRUE is returned
+static BaseType_t prvServicesCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    static uint8_t index = 0;
+    service_stats_t stats;
+
+    if (!get_service_stats(index, &stats)) {
+        index = 0;
+        snprintf(pcWriteBuffer, xWriteBufferLen, "\n");
+        return pdFALSE;
+    }
+    snprintf(pcWriteBuffer, xWriteBufferLen, "%-24s port %2d  conns %6u  max wait %u ms\n", stats.name, stats.port,
+             stats.connections, stats.max_wait_ms);
+    index++;
+    return pdTRUE;
+}
+
+// GPS sentence counters in two lines, called again by the CLI while pdTRUE is returned
+static BaseType_t prvGpsStatsCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    static NMEA_stats_s stats;
+    static uint8_t line = 0;
+
+    if (line == 0) {
+        NMEAParser_get_stats(&stats);
+        snprintf(pcWriteBuffer, xWriteBufferLen, "sentences %u (%u per min)  gga %u  gsa %u  gsv %u  rmc %u\n",
+                 stats.sentences, stats.sentences_per_window, stats.gga, stats.gsa, stats.gsv, stats.rmc);
+        line++;
+        return pdTRUE;
+    }
+    snprintf(pcWriteBuffer, xWriteBufferLen, "no fix %u  bad checksum %u  malformed %u  overruns %u\n",
+             stats.no_fix, stats.checksum_failures, stats.malformed, stats.overruns);
+    line = 0;
+    return pdFALSE;
+}
+
 /*
  * Command Struct Definitions
  *
@@ -308,13 +403,108 @@ static const CLI_Command_Definition_t xUptimeCommand = {"uptime", "uptime:\n\tGe
                                                         prvUptimeCommand, 0};
 static const CLI_Command_Definition_t xHostNameCommand = {"hostname", "hostname\n\tReturns hostname\n",
                                                           prvHostNameCommand, 0};
-static const CLI_Command_Definition_t xHeapCommand = {"heap", "heap\n\tReturns heap stats\n", prvHeapCommand, 0};
+static const CLI_Command_Definition_t xHeapCommand = {
+    "heap", "heap\n\tReturns heap stats, fragmentation and size class use\n", prvHeapCommand, 0};
+static const CLI_Command_Definition_t xHeapCallersCommand = {
+    "heapcallers", "heapcallers\n\tHeap allocations and failures per task\n", prvHeapCallersCommand, 0};
+static const CLI_Command_Definition_t xServicesCommand = {
+    "services", "services\n\tConnections served and longest wait for a worker per service\n",
+    prvServicesCommand, 0};
+static const CLI_Command_Definition_t xGpsStatsCommand = {
+    "gpsstats", "gpsstats:\n\tGPS NMEA sentence and error counters\n", prvGpsStatsCommand, 0};
+static int32_t output_len = -1;
+
+/**
+ * @brief
+ *      Report how many bytes the running command wrote, for output that may
+ *      contain NUL bytes. Text output does not need to call this
+ * @param len
+ *      Bytes written to pcWriteBuffer by this call
+ */
+void cli_set_output_len(size_t len) { output_len = (int32_t)len; }
+
+static size_t prv_output_len(const char *out, size_t max) {
+    size_t len = 0;
+    if (output_len >= 0) {
+        len = (size_t)output_len > max ? max : (size_t)output_len;
+    } else {
+        while (len < max && out[len] != '\0') {
+            len++;
+        }
+    }
+    output_len = -1;
+    return len;
+}
+
+static SAT_returnState prv_send_batch(csp_conn_t *conn, csp_packet_t *packet, uint16_t seq, uint16_t used,
+                                      int8_t more) {
+    uint16_t field;
+    packet->data[SUBSERVICE_BYTE] = CLI_BATCHED_OUTPUT;
+    memcpy(&packet->data[STATUS_BYTE], &more, sizeof(int8_t));
+    field = csp_hton16(seq);
+    memcpy(&packet->data[CLI_BATCH_SEQ_BYTE], &field, sizeof(field));
+    field = csp_hton16(used);
+    memcpy(&packet->data[CLI_BATCH_LEN_BYTE], &field, sizeof(field));
+    set_packet_length(packet, CLI_BATCH_DATA_BYTE + used);
+
+    if (!csp_send(conn, packet, SERVICE_REPLY_TIMEOUT)) {
+        csp_buffer_free(packet);
+        return SATR_ERROR;
+    }
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Run a command and pack its output into as few packets as possible
+ * @details
+ *      Each call of the command is given the rest of the packet, never less
+ *      than MAX_OUTPUT_SIZE. Outputs are packed back to back, and a packet is
+ *      sent once less than MAX_OUTPUT_SIZE bytes remain. Packets carry a
+ *      sequence number so the ground can detect a lost packet in the middle
+ *      of a long listing.
+ */
+static SAT_returnState prv_cli_batched(const char *input, csp_conn_t *conn) {
+    size_t capacity = csp_buffer_data_size() - CLI_BATCH_DATA_BYTE;
+    csp_packet_t *packet = NULL;
+    BaseType_t xMoreDataToFollow;
+    uint16_t seq = 0;
+    size_t used = 0;
+
+    do {
+        if (packet != NULL && capacity - used < MAX_OUTPUT_SIZE) {
+            if (prv_send_batch(conn, packet, seq++, used, pdTRUE) != SATR_OK) {
+                return SATR_ERROR;
+            }
+            packet = NULL;
+        }
+        if (packet == NULL) {
+            packet = csp_buffer_get(csp_buffer_data_size());
+            if (packet == NULL) {
+                return SATR_ERROR;
+            }
+            used = 0;
+        }
+        char *out = (char *)&packet->data[CLI_BATCH_DATA_BYTE + used];
+        out[0] = '\0';
+        output_len = -1;
+        xMoreDataToFollow = FreeRTOS_CLIProcessCommand(input, out, capacity - used);
+        used += prv_output_len(out, capacity - used);
+    } while (xMoreDataToFollow != pdFALSE);
+
+    return prv_send_batch(conn, packet, seq, used, pdFALSE);
+}
+
 /**
  * @brief
  *      Handle incoming csp_packet_t
  * @details
  *      Takes a csp packet destined for the cli service,
  *              and returns its string return value.
+ *      With CLI_TEXT_OUTPUT in the subservice byte every call of the
+ *              command is sent in its own MAX_OUTPUT_SIZE packet. With
+ *              CLI_BATCHED_OUTPUT outputs are packed, see prv_cli_batched.
+ *      Takes ownership of packet.
  * @param csp_packet_t *packet
  *              Incoming CSP packet - we can be sure that this packet is
  *              valid and destined for this service.
@@ -327,13 +517,22 @@ SAT_returnState cli_app(csp_packet_t *packet, csp_conn_t *conn) {
     bool xMoreDataToFollow;
     char pcOutputString[MAX_OUTPUT_SIZE];
     char pcInputString[MAX_INPUT_SIZE] = {0};
+    if (size >= MAX_INPUT_SIZE) {
+        size = MAX_INPUT_SIZE - 1;
+    }
     memcpy(&pcInputString, (char *)&packet->data[IN_DATA_BYTE + 1], size);
 
+    if (packet->data[SUBSERVICE_BYTE] == CLI_BATCHED_OUTPUT) {
+        csp_buffer_free(packet);
+        return prv_cli_batched(pcInputString, conn);
+    }
+
     // store the original packet so we can reuse it later
     csp_packet_t *original = csp_buffer_clone(packet);
 
     do {
         memset(pcOutputString, 0x00, MAX_OUTPUT_SIZE);
+        output_len = -1;
         /* Send the command string to the command interpreter.  Any
         output generated by the command interpreter will be placed in the        pcOutputString buffer. */
         xMoreDataToFollow = FreeRTOS_CLIProcessCommand((char *)&pcInputString,  /* The command string.*/
@@ -360,36 +559,18 @@ SAT_returnState cli_app(csp_packet_t *packet, csp_conn_t *conn) {
 
 /**
  * @brief
- *      FreeRTOS cli server task
+ *      Handle a packet received by the cli service
  * @details
- *      Accepts incoming cli service packets and executes the application
- * @param void* param
- * @return None
+ *      cli_app sends its own replies and frees the packet
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet
  */
-void cli_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ); // require RDP connection
-    csp_bind(sock, TC_CLI_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    for (;;) {
-
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-
-            /* timeout */
-            continue;
-        }
-
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            SAT_returnState status = cli_app(packet, conn);
-            if (status != SATR_OK) {
-                csp_buffer_free(packet);
-                ex2_log("CLI error %d", status);
-            }
-        }
-        csp_close(conn);
+static void cli_service(csp_conn_t *conn, csp_packet_t *packet) {
+    SAT_returnState status = cli_app(packet, conn);
+    if (status != SATR_OK) {
+        ex2_log("CLI error %d", status);
     }
 }
 
@@ -403,14 +584,17 @@ void register_commands() {
     FreeRTOS_CLIRegisterCommand(&xUptimeCommand);
     FreeRTOS_CLIRegisterCommand(&xHostNameCommand);
     FreeRTOS_CLIRegisterCommand(&xHeapCommand);
+    FreeRTOS_CLIRegisterCommand(&xHeapCallersCommand);
+    FreeRTOS_CLIRegisterCommand(&xServicesCommand);
+    FreeRTOS_CLIRegisterCommand(&xGpsStatsCommand);
     register_fs_utils();
 }
 
 /**
  * @brief
- *      Start the cli server task
+ *      Start the cli service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming
  *      cli packets and registers cli commands
  * @param None
  * @return SAT_returnState
@@ -418,9 +602,10 @@ void register_commands() {
  */
 SAT_returnState start_cli_service(void) {
 
-    if (xTaskCreate((TaskFunction_t)cli_service, "cli_svc", CLI_SVC_SIZE, NULL, NORMAL_SERVICE_PRIO, NULL) !=
-        pdPASS) {
-        ex2_log("FAILED TO CREATE TASK cli_svc\n");
+    // Reliance Edge keeps the working directory per task, so cd must always run on the same task
+    if (register_service(TC_CLI_SERVICE, "cli_svc", cli_service, SERVICE_DEDICATED_WORKER, CLI_SVC_SIZE) !=
+        SATR_OK) {
+        ex2_log("FAILED TO REGISTER cli_svc\n");
         return SATR_ERROR;
     }
     register_commands();
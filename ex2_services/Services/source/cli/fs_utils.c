@@ -24,6 +24,10 @@
 #include <redposix.h>
 #include "printf.h"
 #include <string.h>
+#include <csp/csp_endian.h>
+#include "cli/cli.h"
+#include "fs_copy.h"
+#include <stdlib.h>
 
 #define str(s) #s
 
@@ -133,10 +137,58 @@ static BaseType_t prvCDCommand(char *pcWriteBuffer, size_t xWriteBufferLen, cons
     return pdFALSE;
 }
 
+/* ls -l record: name_len, name (not terminated), then size, mtime and mode
+ * big-endian. A name_len of 0 ends the listing. */
+#define LS_RECORD_FIXED_LEN (1 + 4 + 4 + 2)
+
+/**
+ * @brief
+ *      Write one directory entry to buf
+ * @param force
+ *      Truncate the entry if it does not fit rather than failing
+ * @return
+ *      Bytes written, or -1 if the entry does not fit
+ */
+static int prvFormatEntry(const REDDIRENT *entry, bool binary, char *buf, size_t len, bool force) {
+    if (!binary) {
+        int n = snprintf(buf, len, "%s\n", entry->d_name);
+        if (n >= (int)len) {
+            return force ? (int)len - 1 : -1;
+        }
+        return n;
+    }
+
+    size_t name_len = strlen(entry->d_name);
+    if (LS_RECORD_FIXED_LEN + name_len > len) {
+        if (!force || len <= LS_RECORD_FIXED_LEN) {
+            return -1;
+        }
+        name_len = len - LS_RECORD_FIXED_LEN;
+    }
+    uint32_t size = csp_hton32((uint32_t)entry->d_stat.st_size);
+    uint32_t mtime = csp_hton32(entry->d_stat.st_mtime);
+    uint16_t mode = csp_hton16(entry->d_stat.st_mode);
+    buf[0] = (char)name_len;
+    memcpy(&buf[1], entry->d_name, name_len);
+    memcpy(&buf[1 + name_len], &size, sizeof(size));
+    memcpy(&buf[1 + name_len + 4], &mtime, sizeof(mtime));
+    memcpy(&buf[1 + name_len + 8], &mode, sizeof(mode));
+    return (int)(LS_RECORD_FIXED_LEN + name_len);
+}
+
+// Fills the output buffer with as many entries as fit, called again by the CLI while pdTRUE is returned
 static BaseType_t prvLSCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
     static bool firstRun = true;
+    static bool binary = false;
     static REDDIR *dir;
+    static REDDIRENT *pending = NULL; // read from the directory but did not fit last time
+    size_t written = 0;
+
     if (firstRun) {
+        BaseType_t parameterLen;
+        const char *parameter = FreeRTOS_CLIGetParameter(pcCommandString, 1, &parameterLen);
+        binary = parameter != NULL && parameterLen == 2 && strncmp(parameter, "-l", 2) == 0;
+
         red_errno = 0;
         char pszBuffer[REDCONF_NAME_MAX];
         char *cwd = red_getcwd(pszBuffer, REDCONF_NAME_MAX);
@@ -149,23 +201,48 @@ static BaseType_t prvLSCommand(char *pcWriteBuffer, size_t xWriteBufferLen, cons
             createErrorOutput(pcWriteBuffer, xWriteBufferLen);
             return pdFALSE;
         }
+        pending = NULL;
         firstRun = false;
     }
-    red_errno = 0;
-    REDDIRENT *current = red_readdir(dir);
-    if (current == NULL) {
-        if (red_errno == 0) {
-            snprintf(pcWriteBuffer, xWriteBufferLen, "\n");
-        } else {
-            createErrorOutput(pcWriteBuffer, xWriteBufferLen);
+
+    for (;;) {
+        if (pending == NULL) {
+            red_errno = 0;
+            pending = red_readdir(dir);
         }
-        red_closedir(dir);
-        firstRun = true;
-        return pdFALSE;
-    } else {
-        snprintf(pcWriteBuffer, xWriteBufferLen, "%s\n", current->d_name);
-        return pdTRUE;
+        if (pending == NULL) {
+            break;
+        }
+        int n = prvFormatEntry(pending, binary, pcWriteBuffer + written, xWriteBufferLen - written, written == 0);
+        if (n < 0) {
+            if (binary) {
+                cli_set_output_len(written);
+            }
+            return pdTRUE;
+        }
+        written += n;
+        pending = NULL;
+    }
+
+    if (red_errno != 0) {
+        createErrorOutput(pcWriteBuffer + written, xWriteBufferLen - written);
+        written += strlen(pcWriteBuffer + written);
+    } else if (binary) {
+        if (written == xWriteBufferLen) {
+            // no room for the end marker, it goes out on the next call
+            cli_set_output_len(written);
+            return pdTRUE;
+        }
+        pcWriteBuffer[written++] = 0;
+    } else if (written == 0) {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "\n");
     }
+    if (binary) {
+        cli_set_output_len(written);
+    }
+    red_closedir(dir);
+    firstRun = true;
+    return pdFALSE;
 }
 
 static BaseType_t prvMKDIRCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
@@ -338,6 +415,9 @@ static BaseType_t prvREADCommand(char *pcWriteBuffer, size_t xWriteBufferLen, co
         firstRun = false;
     }
     int32_t status = red_read(fd, pcWriteBuffer, xWriteBufferLen);
+    if (status > 0) {
+        cli_set_output_len(status);
+    }
     if (status == 0) {
         red_close(fd);
         firstRun = true;
@@ -370,65 +450,75 @@ static BaseType_t prvTRANSACTCommand(char *pcWriteBuffer, size_t xWriteBufferLen
     return pdFALSE;
 }
 
+/**
+ * @brief
+ *      Copy the nth parameter of the command into a terminated buffer
+ * @return
+ *      false if the parameter is missing or does not fit
+ */
+static bool prvGetParameter(const char *pcCommandString, UBaseType_t index, char *out, size_t len) {
+    BaseType_t parameterLen;
+    const char *parameter = FreeRTOS_CLIGetParameter(pcCommandString, index, &parameterLen);
+    if (parameter == NULL || parameterLen >= len) {
+        return false;
+    }
+    memcpy(out, parameter, parameterLen);
+    out[parameterLen] = '\0';
+    return true;
+}
+
+// Queues the copy on the fs_copy task so large files don't hold up the CLI
 static BaseType_t prvCPCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
-    BaseType_t fromParameterLen;
-    char *copyFrom = (char *)FreeRTOS_CLIGetParameter( // I know casting away from const is bad, a null terminator
-                                                       // needs to be placed in the array :(
-        /* The command string itself. */
-        pcCommandString,
-        /* Return the first parameter. */
-        1,
-        /* Store the parameter string length. */
-        &fromParameterLen);
-    BaseType_t toParameterLen;
-    const char *copyTo = FreeRTOS_CLIGetParameter(
-        /* The command string itself. */
-        pcCommandString,
-        /* Return the second parameter. */
-        2,
-        /* Store the parameter string length. */
-        &toParameterLen);
-    copyFrom[fromParameterLen] = 0;
-    int from_fd = red_open(copyFrom, RED_O_RDONLY);
-    if (from_fd < 0) {
-        createErrorOutput(pcWriteBuffer, xWriteBufferLen);
+    char copyFrom[FS_COPY_PATH_MAX];
+    char copyTo[FS_COPY_PATH_MAX];
+    char number[12];
+    uint32_t offset = 0;
+    uint32_t length = FS_COPY_TO_END;
+
+    if (!prvGetParameter(pcCommandString, 1, copyFrom, sizeof(copyFrom)) ||
+        !prvGetParameter(pcCommandString, 2, copyTo, sizeof(copyTo))) {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "usage: cp <from> <to> [offset] [length]\n");
         return pdFALSE;
     }
-    int to_fd = red_open(copyTo, RED_O_WRONLY | RED_O_CREAT);
-    if (to_fd < 0) {
-        createErrorOutput(pcWriteBuffer, xWriteBufferLen);
-        red_close(from_fd);
-        return pdFALSE;
+    if (prvGetParameter(pcCommandString, 3, number, sizeof(number))) {
+        offset = strtoul(number, NULL, 0);
     }
-    int8_t *buf = pvPortMalloc(512);
-    if (buf == NULL) {
-        snprintf(pcWriteBuffer, xWriteBufferLen, "%s\n", "failed to allocate buffer");
-        red_close(to_fd);
-        red_close(from_fd);
-        return pdFALSE;
+    if (prvGetParameter(pcCommandString, 4, number, sizeof(number))) {
+        length = strtoul(number, NULL, 0);
     }
-    bool done = false;
-    while (!done) {
-        int32_t bytes_read = red_read(from_fd, buf, 512);
-        if (bytes_read == 0) {
-            done = true;
-            continue;
-        }
-        if (bytes_read < 0) {
-            done = true;
-            createErrorOutput(pcWriteBuffer, xWriteBufferLen);
+
+    int id = fs_copy_start(copyFrom, copyTo, offset, length);
+    if (id < 0) {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "%s\n", "bad path, copy onto itself or copy queue full");
+    } else {
+        snprintf(pcWriteBuffer, xWriteBufferLen, "copy %d queued, see cpstat\n", id);
+    }
+    return pdFALSE;
+}
+
+// One line per copy job slot, called again by the CLI while pdTRUE is returned
+static BaseType_t prvCPSTATCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    static const char *const state_names[] = {"free", "queued", "running", "done", "failed"};
+    static uint8_t index = 0;
+    fs_copy_job_t job;
+
+    while (fs_copy_get_job(index, &job)) {
+        index++;
+        if (job.state == FS_COPY_FREE) {
             continue;
         }
-        int32_t bytes_written = red_write(to_fd, buf, 512);
-        if (bytes_written < 0) {
-            done = true;
-            createErrorOutput(pcWriteBuffer, xWriteBufferLen);
-            continue;
+        if (job.state == FS_COPY_QUEUED) {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "%3d %-7s %s -> %s\n", job.id, state_names[job.state],
+                     job.src, job.dst);
+        } else {
+            snprintf(pcWriteBuffer, xWriteBufferLen, "%3d %-7s %lu/%lu err %ld %s -> %s\n", job.id,
+                     state_names[job.state], (unsigned long)job.copied, (unsigned long)job.total, (long)job.error,
+                     job.src, job.dst);
         }
+        return pdTRUE;
     }
-    red_close(to_fd);
-    red_close(from_fd);
-    vPortFree(buf);
+    index = 0;
+    snprintf(pcWriteBuffer, xWriteBufferLen, "\n");
     return pdFALSE;
 }
 
@@ -454,7 +544,9 @@ static BaseType_t prvFORMATCommand(char *pcWriteBuffer, size_t xWriteBufferLen,
 
 static const CLI_Command_Definition_t xPWDCommand = {"pwd", "pwd:\n\tGet current working directory\n",
                                                      prvPWDCommand, 0};
-static const CLI_Command_Definition_t xLSCommand = {"ls", "ls:\n\tGet list of tiles in cwd\n", prvLSCommand, 0};
+static const CLI_Command_Definition_t xLSCommand = {
+    "ls", "ls:\n\tGet list of files in cwd\n\tUse -l for binary name, size, mtime and mode records\n",
+    prvLSCommand, -1};
 static const CLI_Command_Definition_t xCDCommand = {"cd", "cd:\n\tChange current working directory\n",
                                                     prvCDCommand, 1};
 static const CLI_Command_Definition_t xMKDIRCommand = {"mkdir", "mkdir:\n\tMake a new directory\n",
@@ -471,8 +563,11 @@ static const CLI_Command_Definition_t xTRANSACTCommand = {
     "transact",
     "transact:\n\tTell Reliance-edge to transact the filesystem.\n\tMust include volume prefix to transact\n",
     prvTRANSACTCommand, 1};
-static const CLI_Command_Definition_t xCPCommand = {"cp", "cp:\n\tCopy first parameter to second parameter\n",
-                                                    prvCPCommand, 2};
+static const CLI_Command_Definition_t xCPCommand = {
+    "cp", "cp:\n\tCopy first parameter to second parameter in the background\n\tOptional byte offset and length\n",
+    prvCPCommand, -1};
+static const CLI_Command_Definition_t xCPSTATCommand = {"cpstat", "cpstat:\n\tProgress of background copies\n",
+                                                        prvCPSTATCommand, 0};
 static const CLI_Command_Definition_t xFORMATCommand = {
     "format",
     "format:\n\tFormat the specified volume. It may take a long time to format and the response may time out, "
@@ -491,5 +586,6 @@ void register_fs_utils() {
     FreeRTOS_CLIRegisterCommand(&xREADCommand);
     FreeRTOS_CLIRegisterCommand(&xTRANSACTCommand);
     FreeRTOS_CLIRegisterCommand(&xCPCommand);
+    FreeRTOS_CLIRegisterCommand(&xCPSTATCommand);
     FreeRTOS_CLIRegisterCommand(&xFORMATCommand);
 }
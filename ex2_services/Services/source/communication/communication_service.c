@@ -48,47 +48,21 @@ SAT_returnState communication_service_app(csp_packet_t *packet);
 
 /**
  * @brief
- *      FreeRTOS communication server task
- * @details
- *      Accepts incoming communication service packets and executes the
- * application
- * @param void* param
- * @return None
+ *      Handle a packet received by the communication service
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet, sent back as the reply or freed
  */
-void communication_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_COMMUNICATION_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    for (;;) {
-        csp_packet_t *packet;
-        csp_conn_t *conn;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-
-            /* timeout */
-            continue;
-        }
-
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (communication_service_app(packet) != SATR_OK) {
-                // something went wrong in the service
-                csp_buffer_free(packet);
-            } else {
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
-            }
-        }
-        csp_close(conn);
-    }
+static void communication_service(csp_conn_t *conn, csp_packet_t *packet) {
+    service_reply(conn, packet, communication_service_app(packet));
 }
 
 /**
  * @brief
- *      Start the communication server task
+ *      Start the communication service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming
  *      communication service requests
  * @param None
  * @return SAT_returnState
@@ -96,9 +70,9 @@ void communication_service(void *param) {
  */
 SAT_returnState start_communication_service(void) {
 
-    if (xTaskCreate((TaskFunction_t)communication_service, "communication_service", COMM_SVC_SIZE, NULL,
-                    NORMAL_SERVICE_PRIO, NULL) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK start_communication_service\n");
+    if (register_service(TC_COMMUNICATION_SERVICE, "communication_service", communication_service,
+                         SERVICE_SHARED_WORKER, 0) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER communication_service\n");
         return SATR_ERROR;
     }
     ex2_log("Communication service started\n");
@@ -33,51 +33,21 @@
 SAT_returnState dfgm_service_app(csp_packet_t *packet);
 /**
  * @brief
- *      FreeRTOS DFGM server task
- * @details
- *      Accepts incoming DFGM service packets and executes
- *      the application
- * @param void* param
- * @return None
+ *      Handle a packet received by the DFGM service
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet, sent back as the reply or freed
  */
-void dfgm_service(void *param) {
-    // socket initialization
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_DFGM_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    for (;;) {
-        // establish a connection
-        csp_packet_t *packet;
-        csp_conn_t *conn;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-
-            /* timeout */
-            continue;
-        }
-
-        // read and process packets
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (dfgm_service_app(packet) != SATR_OK) {
-                // something went wrong in the subservice
-                csp_buffer_free(packet);
-            } else {
-                // subservice was successful
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
-            }
-        }
-        csp_close(conn);
-    }
+static void dfgm_service(csp_conn_t *conn, csp_packet_t *packet) {
+    service_reply(conn, packet, dfgm_service_app(packet));
 }
 
 /**
  * @brief
- *      Starts the DFGM server task
+ *      Starts the DFGM service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming
  *      DFGM service requests
  * @param None
  * @return SAT_returnState
@@ -85,9 +55,8 @@ void dfgm_service(void *param) {
  */
 SAT_returnState start_dfgm_service(void) {
 
-    if (xTaskCreate((TaskFunction_t)dfgm_service, "dfgm_service", DFGM_SVC_SIZE, NULL, NORMAL_SERVICE_PRIO,
-                    NULL) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK start_dfgm_service\n");
+    if (register_service(TC_DFGM_SERVICE, "dfgm_service", dfgm_service, SERVICE_SHARED_WORKER, 0) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER dfgm_service\n");
         return SATR_ERROR;
     }
     ex2_log("DFGM service started\n");
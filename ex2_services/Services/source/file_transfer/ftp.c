@@ -23,6 +23,7 @@
 #include <os_queue.h>
 #include <redposix.h>
 
+#include "csp_buffer_pool.h"
 #include "ftp.h"
 #include "services.h"
 
@@ -30,6 +31,7 @@
 #include <string.h>
 #include "logger.h"
 #include "sband_sender/sband_sender.h"
+#include "mem_region.h"
 
 typedef enum { GET_REQUEST = 0, POST_REQUEST = 1 } FTP_REQUESTTYPE;
 typedef struct {
@@ -55,7 +57,7 @@ typedef struct __attribute__((packed)) {
 static FTP_t current_upload = {0};
 
 SAT_returnState ftp_send_over_csp(csp_conn_t *conn, void *data, int len) {
-    csp_packet_t *packet = csp_buffer_get(len);
+    csp_packet_t *packet = csp_buffer_get_small(len); // goes to the ground, nothing replies in it
     if (packet == NULL) {
         sys_log(WARN, "Could not allocate CSP buffer");
         return SATR_ERROR;
@@ -109,7 +111,7 @@ SAT_returnState send_download_burst(csp_conn_t *conn, FTP_t *ftp) {
     int outbuffer_get_retries = 20;
     while (current->count--) {
         for (int i = 0; i < outbuffer_get_retries; i++) {
-            outdata = pvPortMalloc(sizeof(ftp_data_packet_t) + current->blocksize);
+            outdata = mem_region_alloc(sizeof(ftp_data_packet_t) + current->blocksize);
             if (outdata) {
                 break;
             }
@@ -141,11 +143,13 @@ SAT_returnState send_download_burst(csp_conn_t *conn, FTP_t *ftp) {
         int total_len = bytes_read + sizeof(ftp_data_packet_t);
 
         if (current->use_sband) {
-            ftp_send_over_sband(outdata, total_len);
+            if (ftp_send_over_sband(outdata, total_len) != SATR_OK) {
+                mem_region_free(outdata); // never reached the sender thread
+            }
             outdata = NULL; // The sender thread will free this pointer
         } else {
             ftp_send_over_csp(conn, outdata, total_len);
-            vPortFree(outdata);
+            mem_region_free(outdata);
             outdata = NULL;
         }
 
@@ -162,62 +166,31 @@ SAT_returnState FTP_app(csp_packet_t *packet, csp_conn_t *conn);
 
 /**
  * @brief
- *      FreeRTOS File Transferring (FT) server task
- * @details
- *      Accepts incoming FTP service packets and executes
- *      the application
- * @param void* param
- * @return None
+ *      Handle a packet received by the File Transferring (FT) service
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet, sent back as the reply or freed
  */
-void FTP_service(void *param) {
-    // socket initialization
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_FTP_COMMAND_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    csp_packet_t *packet;
-    csp_conn_t *conn;
-
-    for (;;) {
-        // establish a connection
-
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-
-            /* timeout */
-            continue;
-        }
-
-        // read and process packets
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (FTP_app(packet, conn) != SATR_OK) {
-                // something went wrong in the subservice
-                csp_buffer_free(packet);
-            } else {
-                // subservice was successful
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
-            }
-        }
-        csp_close(conn);
-    }
+static void FTP_service(csp_conn_t *conn, csp_packet_t *packet) {
+    service_reply(conn, packet, FTP_app(packet, conn));
 }
 
 /**
  * @brief
- *      Starts the File Transferring (FT) server task
+ *      Starts the File Transferring (FT) service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming FTP service requests
  * @param None
  * @return SAT_returnState
  *      Success report
  */
 SAT_returnState start_FTP_service(void) {
 
-    if (xTaskCreate((TaskFunction_t)FTP_service, "FTP_service", FTP_SVC_SIZE, NULL, NORMAL_SERVICE_PRIO, NULL) !=
-        pdPASS) {
-        sys_log(CRITICAL, "FAILED TO CREATE TASK FTP_service");
+    // Download bursts hold the connection for a long time, keep them off the shared workers
+    if (register_service(TC_FTP_COMMAND_SERVICE, "FTP_service", FTP_service, SERVICE_DEDICATED_WORKER,
+                         FTP_SVC_SIZE) != SATR_OK) {
+        sys_log(CRITICAL, "FAILED TO REGISTER FTP_service");
         return SATR_ERROR;
     }
 
@@ -32,15 +32,17 @@
 #include "deployablescontrol.h"
 #include "bl_eeprom.h"
 #include "beacon_task.h"
+#include "diagnostic/task_stats.h"
+#include "csp_pool.h"
 
 SAT_returnState general_app(csp_conn_t *conn, csp_packet_t *packet);
-void general_service(void *param);
+static void general_service(csp_conn_t *conn, csp_packet_t *packet);
 
 /**
  * @brief
- *      Start the general server task
+ *      Start the general service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming
  *      general packets
  * @param None
  * @return SAT_returnState
@@ -48,9 +50,9 @@ void general_service(void *param);
  */
 SAT_returnState start_general_service(void) {
 
-    if (xTaskCreate((TaskFunction_t)general_service, "general_service", GENERAL_SVC_SIZE, NULL,
-                    NORMAL_SERVICE_PRIO, NULL) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK general_service\n");
+    if (register_service(TC_GENERAL_SERVICE, "general_service", general_service, SERVICE_SHARED_WORKER, 0) !=
+        SATR_OK) {
+        ex2_log("FAILED TO REGISTER general_service\n");
         return SATR_ERROR;
     }
     ex2_log("General service started\n");
@@ -59,42 +61,18 @@ SAT_returnState start_general_service(void) {
 
 /**
  * @brief
- *      FreeRTOS general server task
- * @details
- *      Accepts incoming csp connections to perform tasks not covered by other services
- * @param void* param
- * @return None
+ *      Handle a packet received by the general service
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet, sent back as the reply or freed
  */
-void general_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ); // require RDP connection
-    csp_bind(sock, TC_GENERAL_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    for (;;) {
-
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-
-        // wait for connection, timeout
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-
-            /* timeout */
-            continue;
-        }
-
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (general_app(conn, packet) != SATR_OK) {
-                csp_buffer_free(packet);
-                ex2_log("Error responding to packet");
-            } else {
-                if (!csp_send(conn, packet, CSP_TIMEOUT)) {
-                    csp_buffer_free(packet);
-                }
-            }
-        }
-        csp_close(conn); // frees buffers used
+static void general_service(csp_conn_t *conn, csp_packet_t *packet) {
+    SAT_returnState state = general_app(conn, packet);
+    if (state != SATR_OK) {
+        ex2_log("Error responding to packet");
     }
+    service_reply(conn, packet, state);
 }
 
 /**
@@ -304,6 +282,69 @@ SAT_returnState general_app(csp_conn_t *conn, csp_packet_t *packet) {
         break;
     }
 
+    case GET_TASK_STATS: {
+        // in: index of the first task. out: tasks tracked, entries in this reply, entries
+        uint8_t first = packet->data[IN_DATA_BYTE];
+        size_t room = (csp_buffer_data_size() - OUT_DATA_BYTE - 2) / sizeof(task_stats_entry);
+        task_stats_entry *entries = (task_stats_entry *)&packet->data[OUT_DATA_BYTE + 2];
+        size_t count = task_stats_get(first, entries, room);
+        size_t i;
+        for (i = 0; i < count; i++) {
+            entries[i].stack_free = csp_hton16(entries[i].stack_free);
+            entries[i].cpu_min = csp_hton16(entries[i].cpu_min);
+            entries[i].cpu_avg = csp_hton16(entries[i].cpu_avg);
+            entries[i].cpu_max = csp_hton16(entries[i].cpu_max);
+            entries[i].latency_avg_us = csp_hton16(entries[i].latency_avg_us);
+            entries[i].latency_max_us = csp_hton16(entries[i].latency_max_us);
+        }
+        status = 0;
+        memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
+        packet->data[OUT_DATA_BYTE] = task_stats_count();
+        packet->data[OUT_DATA_BYTE + 1] = (uint8_t)count;
+        set_packet_length(packet, sizeof(int8_t) + 2 + count * sizeof(task_stats_entry) + 1); // +1 for subservice
+        break;
+    }
+
+    case GET_CSP_POOL_STATS: {
+        // in: 1 to clear the counters after reading. out: class count, caller count, classes, callers
+        uint8_t reset = packet->data[IN_DATA_BYTE];
+        csp_pool_class_stats *classes = (csp_pool_class_stats *)&packet->data[OUT_DATA_BYTE + 2];
+        csp_pool_caller_stats *callers;
+        uint8_t class_count, caller_count, i;
+
+        taskENTER_CRITICAL();
+        class_count = csp_pool_get_stats(classes, CSP_POOL_MAX_CLASSES, xTaskGetTickCount() * portTICK_PERIOD_MS);
+        callers = (csp_pool_caller_stats *)&classes[class_count];
+        caller_count = csp_pool_get_callers(callers, CSP_POOL_MAX_CALLERS);
+        if (reset == 1) {
+            csp_pool_reset_stats();
+        }
+        taskEXIT_CRITICAL();
+
+        for (i = 0; i < class_count; i++) {
+            classes[i].data_size = csp_hton16(classes[i].data_size);
+            classes[i].count = csp_hton16(classes[i].count);
+            classes[i].free = csp_hton16(classes[i].free);
+            classes[i].high_water = csp_hton16(classes[i].high_water);
+            classes[i].allocs = csp_hton32(classes[i].allocs);
+            classes[i].fallbacks = csp_hton32(classes[i].fallbacks);
+            classes[i].failures = csp_hton32(classes[i].failures);
+            classes[i].hold_avg_ms = csp_hton32(classes[i].hold_avg_ms);
+            classes[i].hold_max_ms = csp_hton32(classes[i].hold_max_ms);
+            classes[i].oldest_ms = csp_hton32(classes[i].oldest_ms);
+        }
+        for (i = 0; i < caller_count; i++) {
+            callers[i].failures = csp_hton32(callers[i].failures);
+        }
+        status = 0;
+        memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
+        packet->data[OUT_DATA_BYTE] = class_count;
+        packet->data[OUT_DATA_BYTE + 1] = caller_count;
+        set_packet_length(packet, sizeof(int8_t) + 2 + class_count * sizeof(csp_pool_class_stats) +
+                                      caller_count * sizeof(csp_pool_caller_stats) + 1); // +1 for subservice
+        break;
+    }
+
     default: {
         ex2_log("No such subservice\n");
         return SATR_PKT_ILLEGAL_SUBSERVICE;
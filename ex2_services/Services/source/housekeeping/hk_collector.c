@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file hk_collector.c
+ * @date 2026-10-19
+ */
+#include "housekeeping/hk_collector.h"
+
+#include <FreeRTOS.h>
+#include <os_queue.h>
+#include <os_semphr.h>
+#include <os_task.h>
+#include <stddef.h>
+#include <string.h>
+#include "logger/logger.h"
+#include "housekeeping_mocks.h"
+
+/*One worker per bus. Devices on the same bus are read one after another,
+ *devices on different buses are read at the same time*/
+typedef enum { HK_BUS_ADCS = 0, HK_BUS_CAN, HK_BUS_I2C, HK_BUS_SBAND, HK_BUS_PAYLOAD, HK_BUS_COUNT } hk_bus;
+
+typedef hk_device_status (*hk_read_fn)(All_systems_housekeeping *hk);
+
+typedef struct {
+    hk_bus bus;
+    uint16_t deadline_ms;
+    uint16_t offset; // where the device's data sits in All_systems_housekeeping
+    uint16_t size;
+    hk_read_fn read;
+} hk_device_entry;
+
+typedef struct {
+    const char *name;
+    TaskHandle_t task;
+    TickType_t start;
+    volatile bool busy;
+} hk_bus_worker;
+
+typedef struct {
+    uint32_t round;
+    uint8_t device;
+    uint8_t status;
+    uint16_t latency_ms;
+} hk_completion;
+
+static hk_device_status read_adcs(All_systems_housekeeping *hk) {
+#if ADCS_IS_STUBBED == 0
+    return HAL_ADCS_getHK(&hk->adcs_hk) == ADCS_OK ? HK_DEV_OK : HK_DEV_ERROR;
+#else
+    mock_adcs(&hk->adcs_hk);
+    return HK_DEV_STUBBED;
+#endif /* ADCS_IS_STUBBED */
+}
+
+static hk_device_status read_athena(All_systems_housekeeping *hk) {
+#if ATHENA_IS_STUBBED == 0
+    return Athena_getHK(&hk->Athena_hk) == 0 ? HK_DEV_OK : HK_DEV_ERROR;
+#else
+    mock_athena(&hk->Athena_hk);
+    return HK_DEV_STUBBED;
+#endif /* ATHENA_IS_STUBBED */
+}
+
+static hk_device_status read_eps(All_systems_housekeeping *hk) {
+#if EPS_IS_STUBBED == 0
+    hk_device_status status = HK_DEV_OK;
+    if (eps_refresh_instantaneous_telemetry() != SATR_OK)
+        status = HK_DEV_ERROR;
+    if (eps_refresh_startup_telemetry() != SATR_OK)
+        status = HK_DEV_ERROR;
+    EPS_getHK(&hk->EPS_hk, &hk->EPS_startup_hk);
+    return status;
+#else
+    mock_eps_instantaneous(&hk->EPS_hk);
+    mock_eps_startup(&hk->EPS_startup_hk);
+    return HK_DEV_STUBBED;
+#endif /* EPS_IS_STUBBED */
+}
+
+static hk_device_status read_uhf(All_systems_housekeeping *hk) {
+#if UHF_IS_STUBBED == 0
+    return UHF_getHK(&hk->UHF_hk) == U_GOOD_CONFIG ? HK_DEV_OK : HK_DEV_ERROR;
+#else
+    mock_uhf(&hk->UHF_hk);
+    return HK_DEV_STUBBED;
+#endif /* UHF_IS_STUBBED */
+}
+
+static hk_device_status read_sband(All_systems_housekeeping *hk) {
+#if SBAND_IS_STUBBED == 0
+    return HAL_S_getHK(&hk->S_band_hk) == S_SUCCESS ? HK_DEV_OK : HK_DEV_ERROR;
+#else
+    mock_sband(&hk->S_band_hk);
+    return HK_DEV_STUBBED;
+#endif /* SBAND_IS_STUBBED */
+}
+
+static hk_device_status read_hyperion(All_systems_housekeeping *hk) {
+#if HYPERION_IS_STUBBED == 0
+#if HYPERION_PANEL_3U == 1
+    Hyperion_config1_getHK(&hk->hyperion_hk);
+#endif /* HYPERION_PANEL_3U */
+#if HYPERION_PANEL_2U == 1
+    Hyperion_config3_getHK(&hk->hyperion_hk);
+#endif /* HYPERION_PANEL_2U */
+    return HK_DEV_OK;
+#else
+    mock_hyperion(&hk->hyperion_hk);
+    return HK_DEV_STUBBED;
+#endif /* HYPERION_IS_STUBBED */
+}
+
+static hk_device_status read_charon(All_systems_housekeeping *hk) {
+#if CHARON_IS_STUBBED == 0
+    return Charon_getHK(&hk->charon_hk) == GPS_SUCCESS ? HK_DEV_OK : HK_DEV_ERROR;
+#else
+    mock_charon(&hk->charon_hk);
+    return HK_DEV_STUBBED;
+#endif /* CHARON_IS_STUBBED */
+}
+
+static hk_device_status read_dfgm(All_systems_housekeeping *hk) {
+#if DFGM_IS_STUBBED == 0
+    return HAL_DFGM_get_HK(&hk->DFGM_hk) == DFGM_SUCCESS ? HK_DEV_OK : HK_DEV_ERROR;
+#else
+    mock_dfgm(&hk->DFGM_hk);
+    return HK_DEV_STUBBED;
+#endif /* DFGM_IS_STUBBED */
+}
+
+static hk_device_status read_iris(All_systems_housekeeping *hk) {
+#if IRIS_IS_STUBBED == 0
+    return iris_get_housekeeping(&hk->IRIS_hk) == IRIS_HAL_OK ? HK_DEV_OK : HK_DEV_ERROR;
+#else
+    mock_iris(&hk->IRIS_hk);
+    return HK_DEV_STUBBED;
+#endif /* IRIS_IS_STUBBED */
+}
+
+static hk_device_status read_ns(All_systems_housekeeping *hk) {
+#if NS_IS_STUBBED == 0
+    return HAL_NS_get_telemetry(&hk->NS_hk) == NS_OK ? HK_DEV_OK : HK_DEV_ERROR;
+#else
+    mock_ns(&hk->NS_hk);
+    return HK_DEV_STUBBED;
+#endif /* NS_IS_STUBBED */
+}
+
+#define HK_FIELD(member)                                                                                      \
+    offsetof(All_systems_housekeeping, member), sizeof(((All_systems_housekeeping *)0)->member)
+
+static const hk_device_entry hk_devices[HK_DEVICE_COUNT] = {
+    [HK_DEV_ADCS] = {HK_BUS_ADCS, HK_DEADLINE_ADCS_MS, HK_FIELD(adcs_hk), read_adcs},
+    [HK_DEV_ATHENA] = {HK_BUS_I2C, HK_DEADLINE_ATHENA_MS, HK_FIELD(Athena_hk), read_athena},
+    // EPS_hk and EPS_startup_hk are adjacent in the packed struct
+    [HK_DEV_EPS] = {HK_BUS_CAN, HK_DEADLINE_EPS_MS, offsetof(All_systems_housekeeping, EPS_hk),
+                    offsetof(All_systems_housekeeping, UHF_hk) - offsetof(All_systems_housekeeping, EPS_hk),
+                    read_eps},
+    [HK_DEV_UHF] = {HK_BUS_I2C, HK_DEADLINE_UHF_MS, HK_FIELD(UHF_hk), read_uhf},
+    [HK_DEV_SBAND] = {HK_BUS_SBAND, HK_DEADLINE_SBAND_MS, HK_FIELD(S_band_hk), read_sband},
+    [HK_DEV_HYPERION] = {HK_BUS_I2C, HK_DEADLINE_HYPERION_MS, HK_FIELD(hyperion_hk), read_hyperion},
+    [HK_DEV_CHARON] = {HK_BUS_I2C, HK_DEADLINE_CHARON_MS, HK_FIELD(charon_hk), read_charon},
+    [HK_DEV_DFGM] = {HK_BUS_PAYLOAD, HK_DEADLINE_DFGM_MS, HK_FIELD(DFGM_hk), read_dfgm},
+    [HK_DEV_IRIS] = {HK_BUS_PAYLOAD, HK_DEADLINE_IRIS_MS, HK_FIELD(IRIS_hk), read_iris},
+    [HK_DEV_NS] = {HK_BUS_PAYLOAD, HK_DEADLINE_NS_MS, HK_FIELD(NS_hk), read_ns},
+};
+
+static hk_bus_worker hk_workers[HK_BUS_COUNT] = {
+    [HK_BUS_ADCS] = {"hk_adcs"},   [HK_BUS_CAN] = {"hk_can"},         [HK_BUS_I2C] = {"hk_i2c"},
+    [HK_BUS_SBAND] = {"hk_sband"}, [HK_BUS_PAYLOAD] = {"hk_payload"},
+};
+
+/*Workers write here, never into the caller's record, so a read that finishes
+ *after its snapshot closed cannot corrupt the next one*/
+static All_systems_housekeeping hk_stage;
+static QueueHandle_t completion_queue = NULL;
+static SemaphoreHandle_t collector_lock = NULL;
+static uint32_t current_round = 0;
+
+static inline uint16_t prv_ticks_to_ms(TickType_t ticks) {
+    uint32_t ms = ticks * portTICK_PERIOD_MS;
+    return ms > UINT16_MAX ? UINT16_MAX : (uint16_t)ms;
+}
+
+/**
+ * @brief
+ *      Reads every device on one bus when notified. The notification value is
+ *      the snapshot round. Devices whose deadline has already passed are
+ *      skipped so a slow bus catches up instead of falling further behind
+ */
+static void hk_bus_worker_task(void *pvParameters) {
+    hk_bus bus = (hk_bus)(uintptr_t)pvParameters;
+    hk_bus_worker *worker = &hk_workers[bus];
+
+    for (;;) {
+        uint32_t round;
+        xTaskNotifyWait(0, 0xFFFFFFFF, &round, portMAX_DELAY);
+
+        for (int i = 0; i < HK_DEVICE_COUNT; i++) {
+            const hk_device_entry *entry = &hk_devices[i];
+            if (entry->bus != bus) {
+                continue;
+            }
+            hk_completion done = {round, (uint8_t)i, HK_DEV_TIMEOUT, 0};
+            if (xTaskGetTickCount() - worker->start < pdMS_TO_TICKS(entry->deadline_ms)) {
+                done.status = entry->read(&hk_stage);
+            }
+            done.latency_ms = prv_ticks_to_ms(xTaskGetTickCount() - worker->start);
+            xQueueSend(completion_queue, &done, 0);
+        }
+        worker->busy = false;
+    }
+}
+
+/**
+ * @brief
+ *      Create the per-bus collection workers
+ * @return SAT_returnState
+ *      success report
+ */
+SAT_returnState hk_collector_start(void) {
+    completion_queue = xQueueCreate(2 * HK_DEVICE_COUNT, sizeof(hk_completion));
+    collector_lock = xSemaphoreCreateMutex();
+    if (completion_queue == NULL || collector_lock == NULL) {
+        return SATR_ERROR;
+    }
+
+    for (int bus = 0; bus < HK_BUS_COUNT; bus++) {
+        if (xTaskCreate(hk_bus_worker_task, hk_workers[bus].name, HK_BUS_WORKER_SIZE, (void *)(uintptr_t)bus,
+                        HK_BUS_WORKER_PRIO, &hk_workers[bus].task) != pdPASS) {
+            sys_log(ERROR, "FAILED TO CREATE TASK %s", hk_workers[bus].name);
+            return SATR_ERROR;
+        }
+    }
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Take a housekeeping snapshot from every device, reading all buses in
+ *      parallel
+ * @details
+ *      Waits until every device has reported or HK_SNAPSHOT_DEADLINE_MS has
+ *      passed. Devices that did not report have their data zeroed. The
+ *      status and latency of each device is written to all_hk_data->collection.
+ *      hk_timeorder is left for the caller to fill in
+ * @param all_hk_data
+ *      Output record
+ * @return Result
+ *      SUCCESS if every device reported in time without error. A partial
+ *      snapshot is still returned on FAILURE
+ */
+Result hk_collector_collect(All_systems_housekeeping *all_hk_data) {
+    hk_collection_status *report = &all_hk_data->collection;
+    hk_completion done;
+    uint16_t pending = 0;
+    uint16_t copied = 0;
+    Result result = SUCCESS;
+
+    if (collector_lock == NULL || xSemaphoreTake(collector_lock, portMAX_DELAY) != pdTRUE) {
+        return FAILURE;
+    }
+
+    // completions left over from a late bus in an earlier snapshot
+    while (xQueueReceive(completion_queue, &done, 0) == pdPASS)
+        ;
+
+    uint32_t round = ++current_round;
+    TickType_t start = xTaskGetTickCount();
+    memset(report, 0, sizeof(*report));
+
+    for (int bus = 0; bus < HK_BUS_COUNT; bus++) {
+        hk_bus_worker *worker = &hk_workers[bus];
+        bool skip = worker->busy;
+        for (int i = 0; i < HK_DEVICE_COUNT; i++) {
+            if (hk_devices[i].bus != bus) {
+                continue;
+            }
+            if (skip) {
+                report->status[i] = HK_DEV_BUSY;
+            } else {
+                pending |= 1 << i;
+            }
+        }
+        if (!skip) {
+            worker->busy = true;
+            worker->start = start;
+            xTaskNotify(worker->task, round, eSetValueWithOverwrite);
+        }
+    }
+
+    while (pending != 0) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= pdMS_TO_TICKS(HK_SNAPSHOT_DEADLINE_MS)) {
+            break;
+        }
+        if (xQueueReceive(completion_queue, &done, pdMS_TO_TICKS(HK_SNAPSHOT_DEADLINE_MS) - elapsed) != pdPASS) {
+            break;
+        }
+        if (done.round != round || !(pending & (1 << done.device))) {
+            continue;
+        }
+        pending &= ~(1 << done.device);
+
+        const hk_device_entry *entry = &hk_devices[done.device];
+        report->latency_ms[done.device] = done.latency_ms;
+        report->status[done.device] = done.status;
+        if (done.status != HK_DEV_TIMEOUT) {
+            if (done.latency_ms > entry->deadline_ms) {
+                report->status[done.device] = HK_DEV_LATE;
+            }
+            memcpy((uint8_t *)all_hk_data + entry->offset, (uint8_t *)&hk_stage + entry->offset, entry->size);
+            copied |= 1 << done.device;
+        }
+    }
+
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    for (int i = 0; i < HK_DEVICE_COUNT; i++) {
+        if (pending & (1 << i)) {
+            report->status[i] = HK_DEV_TIMEOUT;
+            report->latency_ms[i] = prv_ticks_to_ms(elapsed);
+        }
+        if (!(copied & (1 << i))) {
+            memset((uint8_t *)all_hk_data + hk_devices[i].offset, 0, hk_devices[i].size);
+        }
+        if (report->status[i] == HK_DEV_ERROR || report->status[i] == HK_DEV_TIMEOUT ||
+            report->status[i] == HK_DEV_BUSY) {
+            result = FAILURE;
+        }
+    }
+
+    xSemaphoreGive(collector_lock);
+    return result;
+}
@@ -17,9 +17,12 @@
  * @date 2020-07-07
  */
 #include "housekeeping/housekeeping_service.h"
+#include "housekeeping/hk_collector.h"
 
 #include <FreeRTOS.h>
 #include <os_semphr.h>
+#include <os_task.h>
+#include <stddef.h>
 #include <redposix.h> //include for file system
 #include "rtcmk.h"    //to get time from RTC
 #include "redconf.h"
@@ -27,8 +30,10 @@
 #include "util/service_utilities.h"
 #include "logger/logger.h"
 #include "csp/csp_endian.h"
+#include "csp_buffer_pool.h"
 #include "ns_payload.h"
 #include "housekeeping_mocks.h"
+#include "snapshot.h"
 
 uint16_t MAX_FILES = 20160; // value is 20160 (7 days) based on 30 second period
 char fileName[] = "VOL0:/tempHKdata.TMP";
@@ -42,8 +47,33 @@ uint16_t hk_timestamp_array_size = 0; // NOT BYTES. stored as number of items. 1
 
 SemaphoreHandle_t f_count_lock = NULL;
 
-static All_systems_housekeeping latest_hk = {0};
-SemaphoreHandle_t latest_hk_lock = {0};
+#define HK_SECTION(field)                                                                                    \
+    { offsetof(All_systems_housekeeping, field), sizeof(((All_systems_housekeeping *)0)->field) }
+
+/*Where each hk_section lives in the record, in hk_section order*/
+static const struct {
+    uint16_t offset;
+    uint16_t size;
+} hk_sections[HK_SECTION_COUNT] = {
+    HK_SECTION(hk_timeorder),
+    HK_SECTION(adcs_hk),
+    HK_SECTION(Athena_hk),
+    HK_SECTION(EPS_hk),
+    HK_SECTION(EPS_startup_hk),
+    HK_SECTION(UHF_hk),
+    HK_SECTION(S_band_hk),
+    HK_SECTION(hyperion_hk),
+    HK_SECTION(charon_hk),
+    HK_SECTION(DFGM_hk),
+    HK_SECTION(NS_hk),
+    HK_SECTION(IRIS_hk),
+    HK_SECTION(collection),
+    HK_SECTION(task_stats),
+    HK_SECTION(heap)};
+
+/*The latest record, published by the housekeeping daemon only*/
+static All_systems_housekeeping latest_hk[2] = {0};
+static snapshot_t latest_snapshot = SNAPSHOT_INIT(&latest_hk[0], &latest_hk[1], sizeof(All_systems_housekeeping));
 
 /**
  * @brief
@@ -195,91 +225,16 @@ Result mock_everyone(All_systems_housekeeping *all_hk_data) {
 /**
  * @brief
  *      Private. Collect housekeeping information from each device in system
- * @attention
- *      Error testing and review recommended to check for possible shallow
- *      copies and resultant data loss and concurrency errors
+ * @details
+ *      Devices on different buses are read in parallel by hk_collector. The
+ *      per-device status and latency are recorded in all_hk_data->collection
  * @param all_hk_data
  *      pointer to struct of all the housekeeping data collected from components
  * @return Result
- *      FAILURE or SUCCESS
+ *      FAILURE if any device failed or missed its deadline, SUCCESS otherwise.
+ *      The snapshot is still filled in on FAILURE
  */
-
-Result collect_hk_from_devices(All_systems_housekeeping *all_hk_data) {
-/*populate struct by calling appropriate functions*/
-#if ADCS_IS_STUBBED == 0
-    ADCS_returnState ADCS_return_code = HAL_ADCS_getHK(&all_hk_data->adcs_hk); /* ADCS Housekeeping */
-#else
-    mock_adcs(&all_hk_data->adcs_hk);
-#endif /* ADCS_IS_STUBBED */
-
-#if ATHENA_IS_STUBBED == 0
-    int Athena_return_code = Athena_getHK(&all_hk_data->Athena_hk); /* Athena Housekeeping */
-#else
-    mock_athena(&all_hk_data->Athena_hk);
-#endif /* ATHENA_IS_STUBBED */
-
-#if EPS_IS_STUBBED == 0
-    SAT_returnState EPS_return_code = SATR_OK;
-    if (eps_refresh_instantaneous_telemetry() != SATR_OK)
-        EPS_return_code = SATR_ERROR;
-    if (eps_refresh_startup_telemetry() != SATR_OK)
-        EPS_return_code = SATR_ERROR;
-    EPS_getHK(&all_hk_data->EPS_hk, &all_hk_data->EPS_startup_hk); /* EPS Housekeeping */
-#else
-    mock_eps_instantaneous(&all_hk_data->EPS_hk);
-    mock_eps_startup(&all_hk_data->EPS_startup_hk);
-#endif /* EPS_IS_STUBBED */
-
-#if UHF_IS_STUBBED == 0
-    UHF_return UHF_return_code = UHF_getHK(&all_hk_data->UHF_hk); /* UHF Housekeeping */
-#else
-    mock_uhf(&all_hk_data->UHF_hk);
-#endif /* UHF_IS_STUBBED */
-
-#if SBAND_IS_STUBBED == 0
-    STX_return STX_return_code = HAL_S_getHK(&all_hk_data->S_band_hk); /* SBAND Housekeeping */
-#else
-    mock_sband(&all_hk_data->S_band_hk);
-#endif /* SBAND_IS_STUBBED */
-
-#if HYPERION_IS_STUBBED == 0
-#if HYPERION_PANEL_3U == 1
-    Hyperion_config1_getHK(&all_hk_data->hyperion_hk); /* Hyperion 3U Housekeeping */
-#endif                                                 /* HYPERION_PANEL_3U */
-
-#if HYPERION_PANEL_2U == 1
-    Hyperion_config3_getHK(&all_hk_data->hyperion_hk); /* Hyperion 2U Housekeeping */
-#endif                                                 /* HYPERION_PANEL_2U */
-#else
-    mock_hyperion(&all_hk_data->hyperion_hk);
-#endif /* HYPERION_IS_STUBBED */
-
-#if CHARON_IS_STUBBED == 0
-    GPS_RETURNSTATE Charon_return_code = Charon_getHK(&all_hk_data->charon_hk); /* Charon Houskeeping */
-#else
-    mock_charon(&all_hk_data->charon_hk);
-#endif /* CHARON_IS_STUBBED */
-
-#if DFGM_IS_STUBBED == 0
-    DFGM_return DFGM_return_code = HAL_DFGM_get_HK(&all_hk_data->DFGM_hk); /* DFGM Housekeeping */
-#else
-    mock_dfgm(&all_hk_data->DFGM_hk);
-#endif /* DFGM_IS_STUBBED */
-
-#if IRIS_IS_STUBBED == 0
-    Iris_HAL_return Iris_return_code = iris_get_housekeeping(&all_hk_data->IRIS_hk);
-#else
-    mock_iris(&all_hk_data->IRIS_hk);
-#endif
-
-#if NS_IS_STUBBED == 0
-    NS_return NS_return_code = HAL_NS_get_telemetry(&all_hk_data->NS_hk);
-#else
-    mock_ns(&all_hk_data->NS_hk);
-#endif
-    /*consider if struct should hold error codes returned from these functions*/
-    return SUCCESS;
-}
+Result collect_hk_from_devices(All_systems_housekeeping *all_hk_data) { return hk_collector_collect(all_hk_data); }
 
 /**
  * @brief
@@ -453,27 +408,77 @@ int num_digits(int num) {
     return count;
 }
 
-static inline void prv_get_lock(SemaphoreHandle_t *lock) {
-    if (*lock == NULL) {
-        *lock = xSemaphoreCreateMutex();
-    }
-    xSemaphoreTake(*lock, portMAX_DELAY);
-}
+static inline void prv_get_lock(SemaphoreHandle_t *lock) { xSemaphoreTake(*lock, portMAX_DELAY); }
 
 static inline void prv_give_lock(SemaphoreHandle_t *lock) { xSemaphoreGive(*lock); }
 
+/**
+ * @brief
+ *      Borrow the latest snapshot without copying it
+ * @details
+ *      Read the fields you need, then call hk_latest_valid(). If it returns false
+ *      the snapshot was being overwritten while you read it, so read again
+ * @param seq
+ *      Receives the publication number to pass to hk_latest_valid()
+ * @return
+ *      The latest snapshot. All zeros until the first collection
+ */
+const All_systems_housekeeping *hk_latest_acquire(uint32_t *seq) {
+    return (const All_systems_housekeeping *)snapshot_acquire(&latest_snapshot, seq);
+}
+
+/**
+ * @brief
+ *      Check a snapshot from hk_latest_acquire() was not overwritten while it was read
+ */
+bool hk_latest_valid(uint32_t seq) { return snapshot_valid(&latest_snapshot, seq); }
+
 void get_latest_hk(All_systems_housekeeping *hk) {
-    prv_get_lock(&latest_hk_lock);
-    memcpy(hk, &latest_hk, sizeof(All_systems_housekeeping));
-    prv_give_lock(&latest_hk_lock);
+    snapshot_read(&latest_snapshot, 0, hk, sizeof(All_systems_housekeeping));
+}
+
+/**
+ * @brief
+ *      Copy one subsystem's part of the latest snapshot
+ * @param out_len
+ *      Size of out. Must be at least hk_section_size(section)
+ * @return
+ *      false if section is unknown or out is too small
+ */
+bool hk_latest_read_section(hk_section section, void *out, size_t out_len) {
+    if (section >= HK_SECTION_COUNT || out_len < hk_sections[section].size) {
+        return false;
+    }
+    return snapshot_read(&latest_snapshot, hk_sections[section].offset, out, hk_sections[section].size);
 }
 
-void set_latest_hk(All_systems_housekeeping *hk) {
-    prv_get_lock(&latest_hk_lock);
-    memcpy(&latest_hk, hk, sizeof(All_systems_housekeeping));
-    prv_give_lock(&latest_hk_lock);
+/**
+ * @brief
+ *      Size in bytes of a section of All_systems_housekeeping, 0 if unknown
+ */
+size_t hk_section_size(hk_section section) {
+    return section < HK_SECTION_COUNT ? hk_sections[section].size : 0;
 }
 
+/**
+ * @brief
+ *      Create the housekeeping locks
+ * @details
+ *      Called by both the housekeeping daemon and service before either can use
+ *      the locks. Both start from the init task, so they cannot race
+ * @return SAT_returnState
+ *      success report
+ */
+SAT_returnState housekeeping_init(void) {
+    if (f_count_lock == NULL) {
+        f_count_lock = xSemaphoreCreateMutex();
+    }
+    return f_count_lock == NULL ? SATR_ERROR : SATR_OK;
+}
+
+/*Only called by the housekeeping daemon*/
+static void set_latest_hk(All_systems_housekeeping *hk) { snapshot_publish(&latest_snapshot, hk); }
+
 /**
  * @brief
  *      Public. Performs all calls and operations to retrieve hk data and store it
@@ -489,6 +494,8 @@ Result populate_and_store_hk_data(void) {
     }
 
     temp_hk_data.hk_timeorder.UNIXtimestamp = RTCMK_Unix_Now();
+    task_stats_get_hk(&temp_hk_data.task_stats);
+    heap_stats_get_hk(&temp_hk_data.heap);
 
     prv_get_lock(&f_count_lock); // lock
 
@@ -662,13 +669,18 @@ Result fetch_historic_hk_and_transmit(csp_conn_t *conn, uint16_t limit, uint16_t
 
         uint16_t needed_size = get_size_of_housekeeping() + 2; // +2 for subservice and error
 
-        csp_packet_t *packet = csp_buffer_get((size_t)needed_size);
+        csp_packet_t *packet = csp_buffer_get_small((size_t)needed_size);
+        if (packet == NULL) {
+            ex2_log("No buffer for housekeeping reply");
+            return FAILURE;
+        }
         uint8_t ser_subtype = GET_HK;
 
         memcpy(&packet->data[SUBSERVICE_BYTE], &ser_subtype, sizeof(int8_t));
         memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
 
         memcpy(&packet->data[OUT_DATA_BYTE], &all_hk_data, get_size_of_housekeeping());
+        set_packet_length(packet, needed_size);
 
         if (!csp_send(conn, packet, 50)) { // why are we all using magic number?
             ex2_log("Failed to send packet");
@@ -757,38 +769,76 @@ SAT_returnState hk_service_app(csp_conn_t *conn, csp_packet_t *packet) {
 
         uint16_t needed_size = get_size_of_housekeeping() + 2; // +2 for subservice and error
 
-        csp_packet_t *packet = csp_buffer_get((size_t)needed_size);
-        uint8_t ser_subtype = GET_HK;
+        csp_packet_t *reply = csp_buffer_get_small((size_t)needed_size);
+        csp_buffer_free(packet); // the request is not big enough to carry the reply
+        if (reply == NULL) {
+            return SATR_ERROR;
+        }
+        ser_subtype = GET_HK;
 
-        memcpy(&packet->data[SUBSERVICE_BYTE], &ser_subtype, sizeof(int8_t));
-        memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
+        memcpy(&reply->data[SUBSERVICE_BYTE], &ser_subtype, sizeof(int8_t));
+        memcpy(&reply->data[STATUS_BYTE], &status, sizeof(int8_t));
 
-        memcpy(&packet->data[OUT_DATA_BYTE], &all_hk_data, needed_size);
-        set_packet_length(packet, needed_size);
+        memcpy(&reply->data[OUT_DATA_BYTE], &all_hk_data, get_size_of_housekeeping());
+        set_packet_length(reply, needed_size);
 
-        csp_send(conn, packet, 50);
-        csp_buffer_free(packet);
+        if (!csp_send(conn, reply, 50)) {
+            csp_buffer_free(reply);
+        }
         break;
     }
     case GET_LATEST_HK: {
-        All_systems_housekeeping all_hk_data;
-        get_latest_hk(&all_hk_data);
+        uint16_t hk_size = get_size_of_housekeeping();
+        uint16_t needed_size = hk_size + 2; // +2 for subservice and error
 
-        all_hk_data.hk_timeorder.final = 0;
+        csp_packet_t *reply = csp_buffer_get_small((size_t)needed_size);
+        if (reply == NULL) {
+            csp_buffer_free(packet);
+            return SATR_ERROR;
+        }
+        csp_buffer_free(packet); // the request is not big enough to carry the reply
+        uint8_t ser_subtype = GET_HK;
 
-        uint16_t needed_size = get_size_of_housekeeping() + 2; // +2 for subservice and error
+        memcpy(&reply->data[SUBSERVICE_BYTE], &ser_subtype, sizeof(int8_t));
+        memcpy(&reply->data[STATUS_BYTE], &status, sizeof(int8_t));
 
-        csp_packet_t *packet = csp_buffer_get((size_t)needed_size);
-        uint8_t ser_subtype = GET_HK;
+        // Straight from the published snapshot into the packet, no intermediate copy
+        uint32_t seq;
+        do {
+            memcpy(&reply->data[OUT_DATA_BYTE], hk_latest_acquire(&seq), hk_size);
+        } while (!hk_latest_valid(seq));
+        reply->data[OUT_DATA_BYTE + offsetof(All_systems_housekeeping, hk_timeorder.final)] = 0;
+        set_packet_length(reply, needed_size);
 
-        memcpy(&packet->data[SUBSERVICE_BYTE], &ser_subtype, sizeof(int8_t));
-        memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
+        if (!csp_send(conn, reply, 50)) {
+            csp_buffer_free(reply);
+        }
+        break;
+    }
+    case GET_LATEST_HK_SECTION: {
+        // in: hk_section. out: the section, then its part of the latest record
+        hk_section section = (hk_section)packet->data[IN_DATA_BYTE];
+        size_t section_size = hk_section_size(section);
 
-        memcpy(&packet->data[OUT_DATA_BYTE], &all_hk_data, needed_size);
-        set_packet_length(packet, needed_size);
+        if (section_size == 0) {
+            status = -1;
+        }
+        csp_packet_t *reply = csp_buffer_get_small(section_size + 3); // +3 for subservice, error and section
+        csp_buffer_free(packet); // the request is not big enough to carry the reply
+        if (reply == NULL) {
+            return SATR_ERROR;
+        }
+        reply->data[SUBSERVICE_BYTE] = GET_LATEST_HK_SECTION;
+        memcpy(&reply->data[STATUS_BYTE], &status, sizeof(int8_t));
+        reply->data[OUT_DATA_BYTE] = (uint8_t)section;
+        if (section_size > 0) {
+            hk_latest_read_section(section, &reply->data[OUT_DATA_BYTE + 1], section_size);
+        }
+        set_packet_length(reply, section_size + 3);
 
-        csp_send(conn, packet, 50);
-        csp_buffer_free(packet);
+        if (!csp_send(conn, reply, 50)) {
+            csp_buffer_free(reply);
+        }
         break;
     }
     default:
@@ -803,50 +853,39 @@ SAT_returnState start_housekeeping_service(void);
 
 /**
  * @brief
- *      FreeRTOS housekeeping server task
+ *      Handle a packet received by the housekeeping service
  * @details
- *      Accepts incoming housekeeping service packets and executes the application
- * @param void* param
- * @return None
+ *      hk_service_app sends its own replies
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet
  */
-void housekeeping_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_HOUSEKEEPING_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    for (;;) {
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-        if ((conn = csp_accept(sock, CSP_MAX_TIMEOUT)) == NULL) {
-            /* timeout */
-            continue;
-        }
-
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (hk_service_app(conn, packet) != SATR_OK) {
-                ex2_log("Error responding to packet");
-            }
-        }
-        csp_close(conn); // frees buffers used
+static void housekeeping_service(csp_conn_t *conn, csp_packet_t *packet) {
+    if (hk_service_app(conn, packet) != SATR_OK) {
+        ex2_log("Error responding to packet");
     }
 }
 
 /**
  * @brief
- *      Start the housekeeping server task
+ *      Start the housekeeping service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming
  *      housekeeping service requests
  * @param None
  * @return SAT_returnState
  *      success report
  */
 SAT_returnState start_housekeeping_service(void) {
+    if (housekeeping_init() != SATR_OK) {
+        ex2_log("FAILED TO CREATE housekeeping locks\n");
+        return SATR_ERROR;
+    }
 
-    if (xTaskCreate((TaskFunction_t)housekeeping_service, "start_housekeeping_service", HK_SVC_SIZE, NULL,
-                    NORMAL_SERVICE_PRIO, NULL) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK start_housekeeping_service\n");
+    if (register_service(TC_HOUSEKEEPING_SERVICE, "housekeeping_service", housekeeping_service,
+                         SERVICE_SHARED_WORKER, 0) != SATR_OK) {
+        ex2_log("FAILED TO REGISTER housekeeping_service\n");
         return SATR_ERROR;
     }
     ex2_log("Service handlers started\n");
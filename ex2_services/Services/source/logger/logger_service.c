@@ -159,46 +159,21 @@ SAT_returnState start_logger_service(void);
 
 /**
  * @brief
- *      FreeRTOS logger server task
- * @details
- *      Accepts incoming logger service packets and executes the application
- * @param void* param
- * @return None
+ *      Handle a packet received by the logger service
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet, sent back as the reply or freed
  */
-void logger_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_LOGGER_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    for (;;) {
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-
-            /* timeout */
-            continue;
-        }
-
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (logger_service_app(packet) != SATR_OK) {
-                // something went wrong, this shouldn't happen
-                csp_buffer_free(packet);
-            } else {
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
-            }
-        }
-        csp_close(conn); // frees buffers used
-    }
+static void logger_service(csp_conn_t *conn, csp_packet_t *packet) {
+    service_reply(conn, packet, logger_service_app(packet));
 }
 
 /**
  * @brief
- *      Start the logger server task
+ *      Start the logger service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming
  *      logger service requests
  * @param None
  * @return SAT_returnState
@@ -206,9 +181,9 @@ void logger_service(void *param) {
  */
 SAT_returnState start_logger_service(void) {
 
-    if (xTaskCreate((TaskFunction_t)logger_service, "start_logger_service", LOGGER_SVC_SIZE, NULL,
-                    NORMAL_SERVICE_PRIO, NULL) != pdPASS) {
-        ex2_log("FAILED TO CREATE TASK start_logger_service\n");
+    if (register_service(TC_LOGGER_SERVICE, "logger_service", logger_service, SERVICE_SHARED_WORKER, 0) !=
+        SATR_OK) {
+        ex2_log("FAILED TO REGISTER logger_service\n");
         return SATR_ERROR;
     }
 
@@ -20,51 +20,21 @@
 #include "northern_voices/northern_voices.h"
 /**
  * @brief
- *      FreeRTOS 2U Payload server task
- * @details
- *      Executes the application for Northern Images payload and northern voices
- * @param void* param
- * @return None
+ *      Handle a packet received by the northern spirit payload service
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet, sent back as the reply or freed
  */
-void ns_payload_service(void *param) {
-    increment_commands_recv();
-    // socket initialization
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_NORTHERN_SPIRIT_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    for (;;) {
-        // establish a connection
-        csp_packet_t *packet;
-        csp_conn_t *conn;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-
-            /* timeout */
-            continue;
-        }
-
-        // read and process packets
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (ns_payload_service_app(packet) != SATR_OK) {
-                // something went wrong in the subservice
-                csp_buffer_free(packet);
-            } else {
-                // subservice was successful
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
-            }
-        }
-        csp_close(conn);
-    }
+static void ns_payload_service(csp_conn_t *conn, csp_packet_t *packet) {
+    service_reply(conn, packet, ns_payload_service_app(packet));
 }
 
 /**
  * @brief
- *      Starts the northern spirit payload server task
+ *      Starts the northern spirit payload service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming
  *      northern spirit service requests
  * @param None
  * @return SAT_returnState
@@ -72,9 +42,9 @@ void ns_payload_service(void *param) {
  */
 SAT_returnState start_ns_payload_service(void) {
 
-    if (xTaskCreate((TaskFunction_t)ns_payload_service, "ns_payload_service", NS_SVC_SIZE, NULL,
-                    NORMAL_SERVICE_PRIO, NULL) != pdPASS) {
-        sys_log(ERROR, "FAILED TO CREATE TASK ns_payload_service\n");
+    if (register_service(TC_NORTHERN_SPIRIT_SERVICE, "ns_payload_service", ns_payload_service,
+                         SERVICE_SHARED_WORKER, 0) != SATR_OK) {
+        sys_log(ERROR, "FAILED TO REGISTER ns_payload_service\n");
         return SATR_ERROR;
     }
 
@@ -35,47 +35,21 @@ SAT_returnState iris_service_app(csp_packet_t *packet);
 
 /**
  * @brief
- *      Initialize and bind socket, and listen for packets in an infinite loop
- * @details
- *      Accepts incoming iris service packets and executes the application
- * @param void* param
- * @return None
+ *      Handle a packet received by the iris service
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet, sent back as the reply or freed
  */
-void iris_service(void *param) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ); // require RDP connection
-    csp_bind(sock, TC_IRIS_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    for (;;) {
-
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-
-            /* timeout */
-            continue;
-        }
-
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (iris_service_app(packet) != SATR_OK) {
-                // something went wrong, this shouldn't happen
-                csp_buffer_free(packet);
-            } else {
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
-            }
-        }
-        csp_close(conn);
-    }
+static void iris_service(csp_conn_t *conn, csp_packet_t *packet) {
+    service_reply(conn, packet, iris_service_app(packet));
 }
 
 /**
  * @brief
- *      Start the iris server task
+ *      Start the iris service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming
  *      iris packets
  * @param None
  * @return SAT_returnState
@@ -83,9 +57,8 @@ void iris_service(void *param) {
  */
 SAT_returnState start_iris_service(void) {
 
-    if (xTaskCreate((TaskFunction_t)iris_service, "iris_service", IRIS_SVC_SIZE, NULL, NORMAL_SERVICE_PRIO,
-                    NULL) != pdPASS) {
-        sys_log(ERROR, "FAILED TO CREATE TASK iris_service");
+    if (register_service(TC_IRIS_SERVICE, "iris_service", iris_service, SERVICE_SHARED_WORKER, 0) != SATR_OK) {
+        sys_log(ERROR, "FAILED TO REGISTER iris_service");
         return SATR_ERROR;
     }
     return SATR_OK;
@@ -10,6 +10,7 @@
 #include "scheduler/scheduler.h"
 #include "scheduler/scheduler_task.h"
 #include "logger.h"
+#include "mem_region.h"
 /*
  * scheduler.c
  *
@@ -76,7 +77,7 @@ static int scheduler_service_app(csp_packet_t *packet) {
                         sys_log(WARN, "red_write error: %d", (int)red_errno);
                         rc = SCHED_ERR_IO;
                     }
-                    vPortFree(cmds[i]);
+                    mem_region_free(cmds[i]);
                 }
                 red_close(fd);
             }
@@ -199,13 +200,30 @@ static int scheduler_service_app(csp_packet_t *packet) {
  *      ERROR < 0 or number of cmds parsed
  */
 
+/* Bytes of a command in the request before its op and arguments */
+#define SCHED_CMD_HEADER_LEN (3 * sizeof(uint32_t) + 2 * sizeof(uint8_t) + sizeof(uint16_t))
+
+static void free_cmds(ScheduledCmd_t **cmds, int num_cmds) {
+    for (int i = 0; i < num_cmds; i++) {
+        mem_region_free(cmds[i]);
+        cmds[i] = NULL;
+    }
+}
+
 static int parse_packet(csp_packet_t *pkt, ScheduledCmd_t **cmds) {
     const uint8_t *ptr = &(pkt->data[IN_DATA_BYTE]);
+    const uint8_t *end = &(pkt->data[pkt->length]);
     int cmd_num = 0;
-    while ((ptr - pkt->data) < pkt->length && cmd_num < MAX_NUM_CMDS) {
-        cmds[cmd_num] = (ScheduledCmd_t*) pvPortMalloc(sizeof(ScheduledCmd_t));
+    while (ptr < end && cmd_num < MAX_NUM_CMDS) {
+        if (end - ptr < SCHED_CMD_HEADER_LEN) {
+            sys_log(NOTICE, "Scheduled command %d cut short", cmd_num);
+            free_cmds(cmds, cmd_num);
+            return SCHED_ERR_BAD_CMD;
+        }
+        cmds[cmd_num] = (ScheduledCmd_t*) mem_region_alloc(sizeof(ScheduledCmd_t));
         if (!cmds[cmd_num]) {
             sys_log(NOTICE, "Out of memory?");
+            free_cmds(cmds, cmd_num);
             return SCHED_ERR_NO_MEM;
         }
 
@@ -219,8 +237,15 @@ static int parse_packet(csp_packet_t *pkt, ScheduledCmd_t **cmds) {
         cmds[cmd_num]->dport = *ptr++;
         cmds[cmd_num]->len = *((uint16_t *) ptr);
         ptr += sizeof(uint16_t);
+        cmds[cmd_num]->msecs = 0; // not carried in the request
 
-        for (int op=0; op<cmds[cmd_num]->len && op<MAX_CMD_LENGTH; op++) {
+        // A longer command would leave ptr out of step with the next one and overrun cmd when sent
+        if (cmds[cmd_num]->len > MAX_CMD_LENGTH || end - ptr < cmds[cmd_num]->len) {
+            sys_log(NOTICE, "Scheduled command %d has bad length %u", cmd_num, cmds[cmd_num]->len);
+            free_cmds(cmds, cmd_num + 1);
+            return SCHED_ERR_BAD_CMD;
+        }
+        for (int op=0; op<cmds[cmd_num]->len; op++) {
             cmds[cmd_num]->cmd[op] = *ptr++;
         }
 
@@ -260,40 +285,22 @@ void sort_cmds(ScheduledCmd_t **cmds, int num_cmds) {
 
 /**
  * @brief
- *      FreeRTOS scheduler server task
+ *      Handle a packet received by the scheduler service
  * @details
- *      Accepts incoming scheduler packets and saves them for execution
- * @param void* param
- * @return SAT_returnState
+ *      Saves the schedule and always replies with the result in the status byte
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet, sent back as the reply
  */
-static SAT_returnState scheduler_service(void) {
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_SCHEDULER_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN); // TODO: SERVICE_BACKLOG_LEN constant TBD
-
-    for (;;) {
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-
-        if ((conn = csp_accept(sock, CSP_MAX_TIMEOUT)) == NULL) {
-            /* timeout */
-            // ex2_log("woke up");
-            continue;
-        }
-        // TODO: is a watchdog needed?
-
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            increment_commands_recv();
-            int rc = scheduler_service_app(packet);
-            packet->data[STATUS_BYTE] = rc;
-
-            if (!csp_send(conn, packet, 50)) {
-                // You have to free your own buffer on error :-/
-                csp_buffer_free(packet);
-            }
-        }
-        csp_close(conn); // frees buffers used
+static void scheduler_service(csp_conn_t *conn, csp_packet_t *packet) {
+    increment_commands_recv();
+    int rc = scheduler_service_app(packet);
+    packet->data[STATUS_BYTE] = rc;
+
+    if (!csp_send(conn, packet, SERVICE_REPLY_TIMEOUT)) {
+        // You have to free your own buffer on error :-/
+        csp_buffer_free(packet);
     }
 }
 
@@ -301,7 +308,7 @@ static SAT_returnState scheduler_service(void) {
  * @brief
  *      Start scheduler service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming
  *      schedule packets
  * @param None
  * @return SAT_returnState
@@ -313,10 +320,9 @@ SAT_returnState start_scheduler_service(void) {
     if (!SchedLock)
         SchedLock = xSemaphoreCreateMutex();
 
-    if (xTaskCreate((TaskFunction_t)scheduler_service, "sched_service",
-                    SCHEDULER_SVC_SIZE, NULL, NORMAL_SERVICE_PRIO, NULL)
-        != pdPASS) {
-        sys_log(ERROR, "FAILED TO CREATE TASK scheduler_service\n");
+    if (register_service(TC_SCHEDULER_SERVICE, "sched_service", scheduler_service, SERVICE_SHARED_WORKER, 0) !=
+        SATR_OK) {
+        sys_log(ERROR, "FAILED TO REGISTER scheduler_service\n");
         return SATR_ERROR;
     }
     sys_log(NOTICE, "Scheduler service started\n");
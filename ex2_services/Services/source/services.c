@@ -21,6 +21,8 @@
 
 #include <FreeRTOS.h>
 #include <csp/csp.h>
+#include <os_queue.h>
+#include <os_semphr.h>
 #include <os_task.h>
 
 #include "communication/communication_service.h"
@@ -36,11 +38,36 @@
 #include "adcs/adcs_service.h"
 #include "northern_spirit/ns_service.h"
 #include "payload/iris/iris_service.h"
+#include "updater/updater.h"
 
 #include "printf.h"
 
 void csp_server(void *parameters);
 SAT_returnState start_service_server(void);
+static SAT_returnState start_service_dispatcher(void);
+
+typedef struct {
+    const char *name;
+    uint8_t port;
+    service_handler handler;
+    service_worker_type worker;
+    uint16_t stack_size;
+    QueueHandle_t queue;    // shared_queue, or the queue of the dedicated worker
+    SemaphoreHandle_t lock; // one connection per service at a time, services are not reentrant
+    uint32_t connections;
+    TickType_t max_wait;
+} service_entry_t;
+
+typedef struct {
+    csp_conn_t *conn;
+    service_entry_t *service;
+    TickType_t accepted;
+} service_job_t;
+
+static service_entry_t service_table[SERVICE_MAX_REGISTERED];
+static uint8_t service_count = 0;
+static service_entry_t *service_by_port[MAX_SERVICES];
+static QueueHandle_t shared_queue = NULL;
 
 static int commands_received = 0;
 
@@ -50,9 +77,9 @@ int get_commands_recv() { return commands_received; }
 
 /**
  * @brief
- *      Start the services server, and response task
+ *      Start the services server
  * @details
- *      intitializes the FreeRTOS queue and task
+ *      Registers every service and starts the dispatcher and workers serving them
  * @param void
  * @return SAT_returnState
  *      success or failure
@@ -61,7 +88,8 @@ SAT_returnState start_service_server(void) {
     const static char *service_names[] = {"cli_service",       "communication_service", "time_management_service",
                                           "scheduler_service", "housekeeping_service",  "general_service",
                                           "logger_service",    "dfgm_service",          "adcs_service",
-                                          "FTP_service",       "ns_payload_service",    "iris_service"};
+                                          "FTP_service",       "ns_payload_service",    "iris_service",
+                                          "updater_service"};
 
     services start_service_function[] = {start_cli_service,
                                          start_communication_service,
@@ -75,6 +103,7 @@ SAT_returnState start_service_server(void) {
                                          start_FTP_service,
                                          start_ns_payload_service,
                                          start_iris_service,
+                                         start_updater_service,
                                          NULL};
 
     for (int i = 0; start_service_function[i]; i++) {
@@ -84,6 +113,208 @@ SAT_returnState start_service_server(void) {
         state = start_service_function[i]();
         sys_log(INFO, "Start service %s reports %d", service_name, state);
     }
+    return start_service_dispatcher();
+}
+
+/**
+ * @brief
+ *      Register a service with the dispatcher
+ * @details
+ *      Called from the start_*_service functions before start_service_server
+ *      brings up the dispatcher. Connections to the port are handed to the
+ *      shared worker pool, or to a worker task created for this service.
+ * @param port
+ *      CSP port the service listens on
+ * @param name
+ *      Service name, also used for the dedicated worker task
+ * @param handler
+ *      Called for every packet received on a connection to the port
+ * @param worker
+ *      SERVICE_SHARED_WORKER or SERVICE_DEDICATED_WORKER
+ * @param stack_size
+ *      Stack of the dedicated worker, ignored for shared services
+ * @return SAT_returnState
+ *      SATR_ERROR if the port is taken or the table is full
+ */
+SAT_returnState register_service(uint8_t port, const char *name, service_handler handler,
+                                 service_worker_type worker, uint16_t stack_size) {
+    if (port >= MAX_SERVICES || service_by_port[port] != NULL || service_count >= SERVICE_MAX_REGISTERED) {
+        sys_log(ERROR, "Cannot register service %s on port %d", name, port);
+        return SATR_ERROR;
+    }
+
+    service_entry_t *service = &service_table[service_count];
+    service->lock = xSemaphoreCreateMutex();
+    if (service->lock == NULL) {
+        return SATR_ERROR;
+    }
+    service->name = name;
+    service->port = port;
+    service->handler = handler;
+    service->worker = worker;
+    service->stack_size = stack_size;
+    service_by_port[port] = service;
+    service_count++;
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Send a service's reply, or drop the packet if the service failed
+ * @param conn
+ *      Connection the request came in on
+ * @param packet
+ *      Request packet, rewritten in place by the service
+ * @param state
+ *      Result of the service application
+ */
+void service_reply(csp_conn_t *conn, csp_packet_t *packet, SAT_returnState state) {
+    if (state != SATR_OK) {
+        csp_buffer_free(packet);
+    } else if (!csp_send(conn, packet, SERVICE_REPLY_TIMEOUT)) {
+        csp_buffer_free(packet);
+    }
+}
+
+/**
+ * @brief
+ *      Read out the dispatcher statistics of a registered service
+ * @param index
+ *      0 to the number of registered services - 1
+ * @param stats
+ *      Filled with the service statistics
+ * @return bool
+ *      false once index is past the last service
+ */
+bool get_service_stats(uint8_t index, service_stats_t *stats) {
+    if (index >= service_count) {
+        return false;
+    }
+    service_entry_t *service = &service_table[index];
+    stats->name = service->name;
+    stats->port = service->port;
+    stats->connections = service->connections;
+    stats->max_wait_ms = service->max_wait * portTICK_PERIOD_MS;
+    return true;
+}
+
+/**
+ * @brief
+ *      Serve connections handed over by the dispatcher
+ * @param parameters
+ *      Queue of service_job_t to take connections from
+ */
+static void service_worker(void *parameters) {
+    QueueHandle_t queue = (QueueHandle_t)parameters;
+    service_job_t job;
+
+    for (;;) {
+        if (xQueueReceive(queue, &job, portMAX_DELAY) != pdPASS) {
+            continue;
+        }
+        service_entry_t *service = job.service;
+        csp_packet_t *packet;
+
+        // Another worker may be serving this service. Its connection closes once no packet has come
+        // for SERVICE_READ_TIMEOUT, so the wait is usually short. The bound keeps a stuck service
+        // from holding a pool worker
+        if (xSemaphoreTake(service->lock, pdMS_TO_TICKS(SERVICE_LOCK_TIMEOUT)) != pdTRUE) {
+            sys_log(WARN, "Service %s busy, dropping connection", service->name);
+            csp_close(job.conn);
+            continue;
+        }
+        TickType_t wait = xTaskGetTickCount() - job.accepted;
+        if (wait > service->max_wait) {
+            service->max_wait = wait;
+        }
+        service->connections++;
+
+        while ((packet = csp_read(job.conn, SERVICE_READ_TIMEOUT)) != NULL) {
+            service->handler(job.conn, packet);
+        }
+        xSemaphoreGive(service->lock);
+        csp_close(job.conn); // frees buffers used
+    }
+}
+
+/**
+ * @brief
+ *      Accept connections for every registered service and queue them to a worker
+ * @param parameters
+ *      Socket bound to the ports of all registered services
+ */
+static void service_dispatcher(void *parameters) {
+    csp_socket_t *sock = (csp_socket_t *)parameters;
+
+    for (;;) {
+        csp_conn_t *conn;
+        if ((conn = csp_accept(sock, CSP_MAX_TIMEOUT)) == NULL) {
+            /* timeout */
+            continue;
+        }
+
+        int port = csp_conn_dport(conn);
+        service_entry_t *service = (port >= 0 && port < MAX_SERVICES) ? service_by_port[port] : NULL;
+        if (service == NULL) {
+            csp_close(conn);
+            continue;
+        }
+
+        service_job_t job = {conn, service, xTaskGetTickCount()};
+        if (xQueueSendToBack(service->queue, &job, pdMS_TO_TICKS(SERVICE_DISPATCH_TIMEOUT)) != pdPASS) {
+            sys_log(WARN, "Service %s busy, dropping connection", service->name);
+            csp_close(conn);
+        }
+    }
+}
+
+/**
+ * @brief
+ *      Bind the registered services and start the dispatcher and its workers
+ * @return SAT_returnState
+ *      success or failure
+ */
+static SAT_returnState start_service_dispatcher(void) {
+    csp_socket_t *sock = csp_socket(CSP_SO_HMACREQ);
+    if (sock == NULL) {
+        return SATR_ERROR;
+    }
+
+    shared_queue = xQueueCreate(SERVICE_DISPATCH_QUEUE_LEN, sizeof(service_job_t));
+    if (shared_queue == NULL) {
+        return SATR_ERROR;
+    }
+
+    for (int i = 0; i < service_count; i++) {
+        service_entry_t *service = &service_table[i];
+        if (service->worker == SERVICE_DEDICATED_WORKER) {
+            service->queue = xQueueCreate(SERVICE_BACKLOG_LEN, sizeof(service_job_t));
+            if (service->queue == NULL ||
+                xTaskCreate(service_worker, service->name, service->stack_size, (void *)service->queue,
+                            NORMAL_SERVICE_PRIO, NULL) != pdPASS) {
+                sys_log(ERROR, "FAILED TO CREATE WORKER for %s", service->name);
+                return SATR_ERROR;
+            }
+        } else {
+            service->queue = shared_queue;
+        }
+        csp_bind(sock, service->port);
+    }
+
+    for (int i = 0; i < SERVICE_WORKER_COUNT; i++) {
+        if (xTaskCreate(service_worker, "svc_worker", SERVICE_WORKER_SIZE, (void *)shared_queue,
+                        NORMAL_SERVICE_PRIO, NULL) != pdPASS) {
+            sys_log(ERROR, "FAILED TO CREATE TASK svc_worker");
+            return SATR_ERROR;
+        }
+    }
+
+    csp_listen(sock, SERVICE_DISPATCH_BACKLOG);
+    if (xTaskCreate(service_dispatcher, "svc_dispatch", SERVICE_DISPATCHER_SIZE, (void *)sock, NORMAL_SERVICE_PRIO,
+                    NULL) != pdPASS) {
+        sys_log(ERROR, "FAILED TO CREATE TASK svc_dispatch");
+        return SATR_ERROR;
+    }
     return SATR_OK;
 }
 
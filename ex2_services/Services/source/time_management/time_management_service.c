@@ -37,48 +37,21 @@ static SAT_returnState time_management_app(csp_packet_t *packet);
 
 /**
  * @brief
- *      FreeRTOS time management server task
- * @details
- *      Accepts incoming time management service packets and executes the application
- * @param void* param
- * @return None
+ *      Handle a packet received by the time management service
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet, sent back as the reply or freed
  */
-static void time_management_service(void *param) {
-    increment_commands_recv();
-    csp_socket_t *sock;
-    sock = csp_socket(CSP_SO_HMACREQ);
-    csp_bind(sock, TC_TIME_MANAGEMENT_SERVICE);
-    csp_listen(sock, SERVICE_BACKLOG_LEN);
-
-    for (;;) {
-
-        csp_conn_t *conn;
-        csp_packet_t *packet;
-        if ((conn = csp_accept(sock, DELAY_WAIT_TIMEOUT)) == NULL) {
-
-            /* timeout */
-            continue;
-        }
-
-        while ((packet = csp_read(conn, 50)) != NULL) {
-            if (time_management_app(packet) != SATR_OK) {
-                // something went wrong, this shouldn't happen
-                csp_buffer_free(packet);
-            } else {
-                if (!csp_send(conn, packet, 50)) {
-                    csp_buffer_free(packet);
-                }
-            }
-        }
-        csp_close(conn);
-    }
+static void time_management_service(csp_conn_t *conn, csp_packet_t *packet) {
+    service_reply(conn, packet, time_management_app(packet));
 }
 
 /**
  * @brief
- *      Start the time management server task
+ *      Start the time management service
  * @details
- *      Starts the FreeRTOS task responsible for accepting incoming
+ *      Registers the handler for incoming
  *      time management packets
  * @param None
  * @return SAT_returnState
@@ -86,9 +59,9 @@ static void time_management_service(void *param) {
  */
 SAT_returnState start_time_management_service(void) {
 
-    if (xTaskCreate((TaskFunction_t)time_management_service, "time_management_service", TIMEMANAGEMENT_SVC_SIZE,
-                    NULL, NORMAL_SERVICE_PRIO, NULL) != pdPASS) {
-        sys_log(WARN, "FAILED TO CREATE TASK time_management_service");
+    if (register_service(TC_TIME_MANAGEMENT_SERVICE, "time_management_service", time_management_service,
+                         SERVICE_SHARED_WORKER, 0) != SATR_OK) {
+        sys_log(WARN, "FAILED TO REGISTER time_management_service");
         return SATR_ERROR;
     }
     return SATR_OK;
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file updater.c
+ * @date 2026-10-19
+ */
+
+#include <FreeRTOS.h>
+#include <csp/csp.h>
+
+#include "updater/updater.h"
+#include "services.h"
+
+#include "util/service_utilities.h"
+#include <string.h>
+#include "image_patch.h"
+#include "image_update.h"
+#include "logger.h"
+
+#define UPDATE_WRITE_HDR_LEN 4 // offset ahead of the chunk data
+
+SAT_returnState updater_app(csp_packet_t *packet);
+
+/**
+ * @brief
+ *      Handle a packet received by the updater service
+ * @param conn
+ *      Connection the packet arrived on
+ * @param packet
+ *      Incoming packet, sent back as the reply or freed
+ */
+static void updater_service(csp_conn_t *conn, csp_packet_t *packet) {
+    service_reply(conn, packet, updater_app(packet));
+}
+
+/**
+ * @brief
+ *      Start the updater service
+ * @details
+ *      Resumes an image update a reset interrupted, then registers the handler for
+ *      incoming updater packets. Only the golden image runs it: the working image
+ *      executes from the application slot the update rewrites
+ * @param None
+ * @return SAT_returnState
+ *      success report
+ */
+SAT_returnState start_updater_service(void) {
+#if GOLDEN_IMAGE == 1
+    image_update_status status = image_update_resume();
+    if (status != IMAGE_UPDATE_OK) {
+        sys_log(WARN, "Could not resume image update, status %d", status);
+    }
+
+    // Erasing and verifying flash holds the connection for a long time, keep it off the shared workers
+    if (register_service(TC_UPDATER_SERVICE, "updater_service", updater_service, SERVICE_DEDICATED_WORKER,
+                         UPDATER_SVC_SIZE) != SATR_OK) {
+        sys_log(CRITICAL, "FAILED TO REGISTER updater_service");
+        return SATR_ERROR;
+    }
+    sys_log(INFO, "Updater service started\n");
+#else
+    sys_log(INFO, "Updater service only runs on the golden image\n");
+#endif
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Takes a CSP packet and switches based on the subservice command
+ * @details
+ *      Streams an application image into flash, see image_update.h, or rebuilds
+ *      one from the golden image and a patch, see image_patch.h
+ * @param *packet
+ *      The CSP packet
+ * @return SAT_returnState
+ *      Success or failure
+ */
+SAT_returnState updater_app(csp_packet_t *packet) {
+    increment_commands_recv();
+    uint8_t ser_subtype = (uint8_t)packet->data[SUBSERVICE_BYTE];
+    int8_t status = 0;
+    uint32_t reply_len = 0;
+
+    switch (ser_subtype) {
+    case UPDATE_BEGIN: {
+        /**
+         * Request: uint32_t address, uint32_t size, uint16_t crc
+         */
+        uint32_t address;
+        uint32_t size;
+        uint16_t crc;
+        cnv8_32(&packet->data[IN_DATA_BYTE], &address);
+        cnv8_32(&packet->data[IN_DATA_BYTE + 4], &size);
+        cnv8_16(&packet->data[IN_DATA_BYTE + 8], &crc);
+        status = image_update_begin(address, size, crc);
+        sys_log(INFO, "Image update of %u bytes at 0x%08X, status %d", size, address, status);
+        break;
+    }
+    case UPDATE_WRITE: {
+        /**
+         * Request: uint32_t offset, uint8_t data[] to the end of the packet
+         * Response: uint32_t next offset the update expects
+         */
+        uint32_t offset;
+        image_update_progress progress;
+        if (packet->length < IN_DATA_BYTE + UPDATE_WRITE_HDR_LEN) {
+            status = IMAGE_UPDATE_BAD_ARGS;
+        } else {
+            cnv8_32(&packet->data[IN_DATA_BYTE], &offset);
+            status = image_update_write(offset, &packet->data[IN_DATA_BYTE + UPDATE_WRITE_HDR_LEN],
+                                        packet->length - IN_DATA_BYTE - UPDATE_WRITE_HDR_LEN);
+        }
+        image_update_get_progress(&progress);
+        cnv32_8(progress.next, &packet->data[OUT_DATA_BYTE]);
+        reply_len = sizeof(uint32_t);
+        break;
+    }
+    case UPDATE_FINISH: {
+        status = image_update_finish();
+        sys_log(INFO, "Image update finished, status %d", status);
+        break;
+    }
+    case UPDATE_ABORT: {
+        status = image_update_abort();
+        sys_log(INFO, "Image update aborted, status %d", status);
+        break;
+    }
+    case UPDATE_GET_PROGRESS: {
+        /**
+         * Response: uint8_t active, uint32_t address, uint32_t size, uint32_t next,
+         *           uint16_t crc, uint16_t crc so far
+         */
+        image_update_progress progress;
+        image_update_get_progress(&progress);
+        packet->data[OUT_DATA_BYTE] = progress.active;
+        cnv32_8(progress.address, &packet->data[OUT_DATA_BYTE + 1]);
+        cnv32_8(progress.size, &packet->data[OUT_DATA_BYTE + 5]);
+        cnv32_8(progress.next, &packet->data[OUT_DATA_BYTE + 9]);
+        cnv16_8(progress.crc, &packet->data[OUT_DATA_BYTE + 13]);
+        cnv16_8(progress.crc_sofar, &packet->data[OUT_DATA_BYTE + 15]);
+        reply_len = 17;
+        break;
+    }
+    case UPDATE_PATCH_BEGIN: {
+        status = image_patch_begin();
+        sys_log(INFO, "Image patch started, status %d", status);
+        break;
+    }
+    case UPDATE_PATCH_WRITE: {
+        /**
+         * Request: uint32_t offset, uint8_t patch[] to the end of the packet
+         * Response: uint32_t next patch offset expected
+         */
+        uint32_t offset;
+        if (packet->length < IN_DATA_BYTE + UPDATE_WRITE_HDR_LEN) {
+            status = IMAGE_UPDATE_BAD_ARGS;
+        } else {
+            cnv8_32(&packet->data[IN_DATA_BYTE], &offset);
+            status = image_patch_write(offset, &packet->data[IN_DATA_BYTE + UPDATE_WRITE_HDR_LEN],
+                                       packet->length - IN_DATA_BYTE - UPDATE_WRITE_HDR_LEN);
+        }
+        cnv32_8(image_patch_next(), &packet->data[OUT_DATA_BYTE]);
+        reply_len = sizeof(uint32_t);
+        break;
+    }
+    case UPDATE_PATCH_FINISH: {
+        status = image_patch_finish();
+        sys_log(INFO, "Image patch finished, status %d", status);
+        break;
+    }
+    default:
+        ex2_log("No such subservice\n");
+        return SATR_PKT_ILLEGAL_SUBSERVICE;
+    }
+
+    memcpy(&packet->data[STATUS_BYTE], &status, sizeof(int8_t));
+    set_packet_length(packet, reply_len + sizeof(int8_t) + 1); // +1 for subservice
+    return SATR_OK;
+}
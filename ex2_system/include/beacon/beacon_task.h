@@ -83,7 +83,7 @@ typedef struct __attribute__((packed)) {
  */
 
 /* Updates Beacon Packet with the latest housekeeping data */
-void update_beacon(All_systems_housekeeping *all_hk_data, beacon_packet_1_t *beacon_packet_one,
+void update_beacon(const All_systems_housekeeping *all_hk_data, beacon_packet_1_t *beacon_packet_one,
                    beacon_packet_2_t *beacon_packet_two);
 
 SAT_returnState start_beacon_daemon(void);
@@ -22,6 +22,11 @@
 
 #include "main/system.h"
 
+/* Geofence zones set up when the daemon starts, the rest are free for other users */
+#define GEOFENCE_ZONE_CHINA 0 // China is covered by three regions, 0 to 2
+#define GEOFENCE_ZONE_CHINA_COUNT 3
+#define GEOFENCE_ZONE_EDMONTON 3
+
 SAT_returnState start_coordinate_management_daemon(void);
 
 #endif /* EX2_SYSTEM_INCLUDE_COORDINATE_MANAGEMENT_COORDINATE_MANAGEMENT_H_ */
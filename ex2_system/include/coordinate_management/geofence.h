@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file geofence.h
+ * @date 2026-10-19
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_COORDINATE_MANAGEMENT_GEOFENCE_H_
+#define EX2_SYSTEM_INCLUDE_COORDINATE_MANAGEMENT_GEOFENCE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "main/system.h"
+
+/*
+ * Tracks which regions the satellite is over and which ground stations can see it,
+ * and tells subscribers when that changes.
+ *
+ * Every zone is a cap on the Earth around a centre point. A region's cap is its
+ * radius on the ground. A station's cap holds the sub-satellite points from which
+ * the satellite is above the station's minimum elevation at the current altitude.
+ * The centre is kept as a unit vector and the cap edge as the cosine of its angular
+ * radius, so testing a position is one dot product and a compare per zone, with
+ * no trig. The exit edge is GEOFENCE_HYSTERESIS_KM further out than the entry edge,
+ * so GPS noise at a boundary does not send a stream of events.
+ *
+ * Positions come from the GPS (latitude and longitude) or from a propagator (a
+ * vector in the Earth fixed frame). The engine is not locked: only the coordinate
+ * management daemon updates it, and zones and subscribers are set up before the
+ * daemon starts.
+ */
+#define GEOFENCE_MAX_ZONES 16
+#define GEOFENCE_MAX_SUBSCRIBERS 8
+#define GEOFENCE_EARTH_RADIUS_KM 6371.0f
+#define GEOFENCE_HYSTERESIS_KM 10.0f
+#define GEOFENCE_DEFAULT_ALTITUDE_KM 550.0f
+
+typedef struct {
+    float x, y, z;
+} geofence_vec;
+
+typedef enum { GEOFENCE_UNUSED = 0, GEOFENCE_REGION, GEOFENCE_STATION } geofence_kind;
+
+typedef enum { GEOFENCE_ENTER, GEOFENCE_EXIT } geofence_event_type;
+
+typedef struct {
+    uint8_t zone;
+    geofence_kind kind;
+    geofence_event_type type;
+    uint32_t time; // of the position that caused it
+} geofence_event;
+
+/* Called from the daemon that updates the position, so it must not block for long */
+typedef void (*geofence_handler)(const geofence_event *event, void *arg);
+
+void geofence_init(void);
+
+SAT_returnState geofence_set_region(uint8_t zone, float lat, float lon, float radius_km);
+
+SAT_returnState geofence_set_station(uint8_t zone, float lat, float lon, float min_elevation);
+
+SAT_returnState geofence_clear(uint8_t zone);
+
+void geofence_set_altitude(float altitude_km);
+
+float geofence_get_altitude(void);
+
+SAT_returnState geofence_subscribe(geofence_handler handler, void *arg);
+
+void geofence_unit_vector(float lat, float lon, geofence_vec *v);
+
+uint8_t geofence_update(const geofence_vec *position, uint32_t time);
+
+uint8_t geofence_update_lat_lon(float lat, float lon, uint32_t time);
+
+bool geofence_inside(uint8_t zone);
+
+#endif /* EX2_SYSTEM_INCLUDE_COORDINATE_MANAGEMENT_GEOFENCE_H_ */
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file crc16.h
+ * @date 2026-10-19
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_CRC16_H_
+#define EX2_SYSTEM_INCLUDE_CRC16_H_
+
+#include <stdint.h>
+
+/*
+ * CRC-16/XMODEM: poly 0x1021, init 0x0000, no reflection, no final xor.
+ * This is the checksum stored in image_info.crc by the image upload tooling.
+ */
+#define CRC16_POLY 0x1021
+#define CRC16_INIT 0x0000
+
+typedef enum { CRC16_BITWISE, CRC16_SLICE8 } crc16_method_t;
+
+uint16_t crc16_bitwise(uint16_t crc, const void *data, uint32_t length);
+
+uint16_t crc16_slice8(uint16_t crc, const void *data, uint32_t length);
+
+uint16_t crc16_update(crc16_method_t method, uint16_t crc, const void *data, uint32_t length);
+
+uint16_t crc16_checksum(const void *data, uint32_t length);
+
+#endif /* EX2_SYSTEM_INCLUDE_CRC16_H_ */
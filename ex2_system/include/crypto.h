@@ -21,6 +21,9 @@
 #ifndef EX2_SYSTEM_INCLUDE_CRYPTO_H_
 #define EX2_SYSTEM_INCLUDE_CRYPTO_H_
 
+#include <stdint.h>
+#include "sha1.h"
+
 #define KEY_TEST_MODE 1
 #define KEY_SET_MODE 0
 #define KEY_LEN 64
@@ -30,8 +33,41 @@ typedef enum {
     ENCRYPT_KEY,
 } CRYPTO_KEY_T;
 
+/*
+ * Per-key state the packet path would otherwise rebuild for every packet. An
+ * HMAC starts by hashing one block of key ^ ipad and ends by hashing one of
+ * key ^ opad; the context keeps SHA-1 states with those blocks already hashed.
+ * XTEA adds the running sum to a key word before every half round; the context
+ * keeps the 64 sums. csp_crypto.c builds both when main.c sets the libcsp keys,
+ * and serves libcsp's HMAC and XTEA calls from them; crypto_xtea_csp makes the
+ * key stream libcsp's csp_xtea_encrypt does.
+ */
+#define CRYPTO_HMAC_LEN SHA1_DIGEST_LEN
+#define CRYPTO_XTEA_KEY_LEN 16
+#define CRYPTO_XTEA_BLOCK_LEN 8
+#define CRYPTO_XTEA_CYCLES 32
+
+typedef struct {
+    sha1_state inner; // after key ^ ipad
+    sha1_state outer; // after key ^ opad
+} crypto_hmac_ctx;
+
+typedef struct {
+    uint32_t round_key[2 * CRYPTO_XTEA_CYCLES]; // key word plus sum, for each half round
+} crypto_xtea_ctx;
+
 void set_keys_from_keyfile();
 void get_crypto_key(CRYPTO_KEY_T type, char **key, int *key_len);
 void set_crypto_key(CRYPTO_KEY_T type, char *key, int key_len);
 
+void crypto_hmac_init(crypto_hmac_ctx *ctx, const uint8_t *key, uint32_t key_len);
+void crypto_hmac_begin(const crypto_hmac_ctx *ctx, sha1_state *state);
+void crypto_hmac_end(const crypto_hmac_ctx *ctx, sha1_state *state, uint8_t mac[CRYPTO_HMAC_LEN]);
+void crypto_hmac(const crypto_hmac_ctx *ctx, const void *data, uint32_t len, uint8_t mac[CRYPTO_HMAC_LEN]);
+
+void crypto_xtea_init(crypto_xtea_ctx *ctx, const uint8_t *key, uint32_t key_len);
+void crypto_xtea_encrypt_block(const crypto_xtea_ctx *ctx, uint32_t v[2]);
+void crypto_xtea_decrypt_block(const crypto_xtea_ctx *ctx, uint32_t v[2]);
+void crypto_xtea_csp(const crypto_xtea_ctx *ctx, uint8_t *data, uint32_t len, const uint32_t iv[2]);
+
 #endif /* EX2_SYSTEM_INCLUDE_CRYPTO_H_ */
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file csp_buffer_pool.h
+ * @date 2026-10-19
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_CSP_BUFFER_POOL_H_
+#define EX2_SYSTEM_INCLUDE_CSP_BUFFER_POOL_H_
+
+#include <stddef.h>
+#include <csp/csp_buffer.h>
+
+/*
+ * csp_buffer_pool.c replaces libcsp's csp_buffer.c, so that buffer use is counted
+ * in every build: high water, failures by task and hold times, read out with
+ * GET_CSP_POOL_STATS. By default the pool has one class of csp_conf.buffers
+ * buffers of csp_conf.buffer_data_size, the same buffers libcsp would make.
+ *
+ * CSP_BUFFER_SIZE_CLASSES 1 adds the small class from system.h for
+ * csp_buffer_get_small. It stays off until file transfer no longer loses
+ * throughput to it (test_csp_pool.c).
+ *
+ * Either way csp_buffer_get() returns a full size buffer, because services reply
+ * in the request packet. Only a task that sends a packet to the ground, which no
+ * service on this node answers in place, can ask for less with csp_buffer_get_small().
+ */
+#ifndef CSP_BUFFER_SIZE_CLASSES
+#define CSP_BUFFER_SIZE_CLASSES 0
+#endif
+
+void *csp_buffer_get_small(size_t size);
+
+#endif /* EX2_SYSTEM_INCLUDE_CSP_BUFFER_POOL_H_ */
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file csp_pool.h
+ * @date 2026-10-19
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_CSP_POOL_H_
+#define EX2_SYSTEM_INCLUDE_CSP_POOL_H_
+
+/* No FreeRTOS or CSP includes here, so the pool can be built and tested on a host */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Packet buffers in a few size classes, the memory behind csp_buffer_get().
+ *
+ * A request is served from the smallest class it fits, or from a larger class if
+ * that one is empty, so a 20 byte acknowledgement does not tie up a 1 KiB buffer
+ * that a file transfer is waiting for. Each class keeps its own high water mark,
+ * failures and how long buffers are held, and failed requests are counted by the
+ * task that made them.
+ *
+ * The pool is not locked, csp_buffer_pool.c wraps it in critical sections. Times
+ * are passed in by the caller in milliseconds.
+ */
+#define CSP_POOL_MAX_CLASSES 4
+#define CSP_POOL_MAX_CALLERS 8 // the last one collects every caller that does not fit
+#define CSP_POOL_NAME_LEN 16   // configMAX_TASK_NAME_LEN
+#define CSP_POOL_ALIGN 8
+
+typedef struct {
+    uint16_t data_size;
+    uint16_t count;
+} csp_pool_class_config;
+
+typedef struct __attribute__((packed)) {
+    uint16_t data_size;
+    uint16_t count;
+    uint16_t free;
+    uint16_t high_water;  // most buffers in use at once
+    uint32_t allocs;
+    uint32_t fallbacks;   // requests that fitted this class but were served by a larger one
+    uint32_t failures;    // requests that fitted this class and found it and every larger class empty
+    uint32_t hold_avg_ms; // over the buffers freed so far
+    uint32_t hold_max_ms;
+    uint32_t oldest_ms;   // age of the oldest buffer in use now
+} csp_pool_class_stats;
+
+typedef struct __attribute__((packed)) {
+    char name[CSP_POOL_NAME_LEN];
+    uint32_t failures;
+} csp_pool_caller_stats;
+
+size_t csp_pool_memory_size(const csp_pool_class_config *config, uint8_t count, size_t overhead);
+
+bool csp_pool_init(const csp_pool_class_config *config, uint8_t count, size_t overhead, void *memory);
+
+void *csp_pool_get(size_t size, const char *caller, uint32_t now_ms);
+
+bool csp_pool_free(void *buffer, uint32_t now_ms);
+
+bool csp_pool_ref(void *buffer);
+
+size_t csp_pool_capacity(const void *buffer);
+
+size_t csp_pool_max_size(void);
+
+uint32_t csp_pool_remaining(void);
+
+uint8_t csp_pool_get_stats(csp_pool_class_stats *out, uint8_t max, uint32_t now_ms);
+
+uint8_t csp_pool_get_callers(csp_pool_caller_stats *out, uint8_t max);
+
+void csp_pool_reset_stats(void);
+
+#endif /* EX2_SYSTEM_INCLUDE_CSP_POOL_H_ */
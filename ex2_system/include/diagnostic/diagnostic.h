@@ -27,6 +27,7 @@
 #define BOOT_COUNTER_RESET_DELAY pdMS_TO_TICKS(600000)
 
 SAT_returnState start_diagnostic_daemon(void);
+SAT_returnState start_task_stats_daemon(void);
 TickType_t get_uhf_watchdog_delay(void);
 TickType_t get_sband_watchdog_delay(void);
 TickType_t get_charon_watchdog_delay(void);
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file heap_stats.h
+ * @date 2026-10-19
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_DIAGNOSTIC_HEAP_STATS_H_
+#define EX2_SYSTEM_INCLUDE_DIAGNOSTIC_HEAP_STATS_H_
+
+#include <stdint.h>
+#include "mem_region.h"
+
+/* Summary carried in every housekeeping record */
+typedef struct __attribute__((packed)) {
+    uint32_t free_bytes;
+    uint32_t min_free_bytes;                 // lowest free_bytes since boot
+    uint32_t largest_free_block;             // an allocation also needs 8 bytes of it for a header
+    uint16_t free_blocks;                    // many free blocks and a small largest_free_block mean fragmentation
+    uint16_t failed_allocations;
+    uint32_t largest_failed_request;
+    uint16_t region_spills;                  // size class requests that fell back to the heap
+    uint8_t region_peak[MEM_REGION_CLASSES]; // most blocks ever in use in each size class
+} heap_stats_hk;
+
+void heap_stats_get_hk(heap_stats_hk *hk);
+
+#endif /* EX2_SYSTEM_INCLUDE_DIAGNOSTIC_HEAP_STATS_H_ */
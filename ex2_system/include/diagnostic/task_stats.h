@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file task_stats.h
+ * @date 2026-10-19
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_DIAGNOSTIC_TASK_STATS_H_
+#define EX2_SYSTEM_INCLUDE_DIAGNOSTIC_TASK_STATS_H_
+
+/* No FreeRTOS includes here, so the statistics can be built and tested on a host */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TASK_STATS_MAX_TASKS 64      // tasks are tracked by TCB number, higher numbers are ignored
+#define TASK_STATS_WINDOW 12         // samples covered by the rolling min/avg/max
+#define TASK_STATS_NAME_LEN 16       // configMAX_TASK_NAME_LEN
+#define TASK_STATS_CYCLES_PER_US 300 // the run time counter is the 300 MHz CPU cycle counter
+
+/* The cycle counter wraps every 14 s, so samples must be closer together than that */
+#define TASK_STATS_PERIOD_MS 5000
+
+/* One task as seen by the sampler */
+typedef struct {
+    uint32_t number;     // TCB number, unique for the life of the task
+    const char *name;
+    uint8_t priority;
+    uint32_t run_time;   // cycles spent running since the task was created, wraps
+    uint16_t stack_free; // stack high water mark in words
+} task_stats_input;
+
+typedef struct __attribute__((packed)) {
+    char name[TASK_STATS_NAME_LEN];
+    uint8_t number;
+    uint8_t priority;
+    uint16_t stack_free;     // stack words never used since the task started
+    uint16_t cpu_min;        // CPU use in one sample period, hundredths of a percent
+    uint16_t cpu_avg;
+    uint16_t cpu_max;
+    uint16_t latency_avg_us; // time from ready to running
+    uint16_t latency_max_us;
+} task_stats_entry;
+
+/* Summary carried in every housekeeping record */
+typedef struct __attribute__((packed)) {
+    uint8_t task_count;
+    uint16_t idle_cpu_avg;       // hundredths of a percent
+    uint8_t busiest_task;        // TCB number of the task with the highest average CPU use, idle excluded
+    uint16_t busiest_cpu_avg;
+    uint8_t min_stack_task;      // TCB number of the task closest to overflowing its stack
+    uint16_t min_stack_free;     // words
+    uint8_t worst_latency_task;  // TCB number of the task with the worst ready to running time
+    uint16_t worst_latency_us;
+} task_stats_hk;
+
+/* Called by the kernel through the trace macros in FreeRTOSConfig.h, with interrupts masked */
+void task_stats_ready(uint32_t number, uint32_t cycles);
+void task_stats_switched_in(uint32_t number, uint32_t cycles);
+
+void task_stats_update(const task_stats_input *tasks, size_t count, uint32_t total_run_time);
+void task_stats_reset(void);
+
+uint8_t task_stats_count(void);
+size_t task_stats_get(uint8_t first, task_stats_entry *out, size_t max);
+void task_stats_get_hk(task_stats_hk *hk);
+
+#endif /* EX2_SYSTEM_INCLUDE_DIAGNOSTIC_TASK_STATS_H_ */
@@ -27,6 +27,7 @@
 
 #define KEY_STORE_BLOCKNUMBER 5
 
+Fapi_StatusType eeprom_init();
 Fapi_StatusType eeprom_write(void *dat, uint8_t block, uint32_t size);
 Fapi_StatusType eeprom_read(void *dat, uint8_t block, uint32_t size);
 
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file eeprom_log.h
+ * @date 2026-10-19
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_EEPROM_LOG_H_
+#define EX2_SYSTEM_INCLUDE_EEPROM_LOG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "F021.h"
+
+/*
+ * Log-structured record store over the bank 7 (EEPROM emulation) sectors.
+ *
+ * Each eeprom_write() appends a new version of the record, tagged with a
+ * sequence number and CRC, to the active sector. A sector is only erased once
+ * the log wraps around to it, after any record whose newest copy still lives
+ * there has been moved forward. One sector is always kept erased as a spare.
+ *
+ * Sectors 0 - 7 keep the legacy one-record-per-sector layout and are only read
+ * as a fallback for records that have never been written through the log.
+ * Boot info, both image infos and update info are read by the bootloader, so
+ * eeprom.c keeps writing them to their legacy sectors and never logs them.
+ */
+#define EEPROM_LOG_FIRST_SECTOR 8
+#define EEPROM_LOG_NUM_SECTORS 8
+#define EEPROM_LOG_SECTOR_SIZE 0x1000
+#define EEPROM_LOG_MAX_RECORDS 8
+#define EEPROM_LOG_MAX_DATA_LEN 256
+
+typedef struct {
+    uint32_t writes;          // records programmed, including relocations
+    uint32_t skipped_writes;  // writes dropped because the data was unchanged
+    uint32_t erases;          // sector erases since mount
+    uint32_t corrupt_records; // records that failed their CRC during mount
+} eeprom_log_stats_t;
+
+Fapi_StatusType eeprom_log_mount(void);
+
+Fapi_StatusType eeprom_log_write(uint8_t id, const void *data, uint32_t size);
+
+Fapi_StatusType eeprom_log_read(uint8_t id, void *data, uint32_t size);
+
+void eeprom_log_get_stats(eeprom_log_stats_t *stats);
+
+/*
+ * Flash access used by the record store. Implemented over the F021 API in
+ * eeprom.c; the unit tests provide a RAM-backed simulation instead.
+ * Sector numbers are absolute bank 7 sector numbers.
+ */
+Fapi_StatusType eeprom_flash_erase(uint8_t sector);
+
+Fapi_StatusType eeprom_flash_program(uint8_t sector, uint32_t offset, const void *data, uint32_t size);
+
+Fapi_StatusType eeprom_flash_read(uint8_t sector, uint32_t offset, void *data, uint32_t size);
+
+#endif /* EX2_SYSTEM_INCLUDE_EEPROM_LOG_H_ */
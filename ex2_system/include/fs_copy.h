@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file fs_copy.h
+ * @date 2026-10-19
+ */
+
+#ifndef FS_COPY_H
+#define FS_COPY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <redconf.h>
+#include "system.h"
+
+/* RAM used by background copies is the chunk buffer plus the job table */
+#define FS_COPY_CHUNK_SIZE (8 * REDCONF_BLOCK_SIZE)
+#define FS_COPY_MAX_JOBS 4
+#define FS_COPY_PATH_MAX 96
+
+#define FS_COPY_TO_END 0xFFFFFFFF // length that copies from offset to the end of the file
+
+typedef enum { FS_COPY_FREE = 0, FS_COPY_QUEUED, FS_COPY_RUNNING, FS_COPY_DONE, FS_COPY_FAILED } fs_copy_state;
+
+typedef struct {
+    uint8_t id;
+    fs_copy_state state;
+    uint32_t offset;
+    uint32_t copied; // bytes written so far
+    uint32_t total;  // bytes to copy, known once the job is running
+    int32_t error;   // red_errno if the job failed
+    char src[FS_COPY_PATH_MAX];
+    char dst[FS_COPY_PATH_MAX];
+} fs_copy_job_t;
+
+int32_t fs_copy_range(const char *src, const char *dst, uint32_t offset, uint32_t length, void *buf,
+                      uint32_t buf_len, volatile uint32_t *copied, uint32_t *total);
+
+int fs_copy_start(const char *src, const char *dst, uint32_t offset, uint32_t length);
+
+bool fs_copy_get_job(uint8_t index, fs_copy_job_t *job);
+
+SAT_returnState start_fs_copy_daemon(void);
+
+#endif /* FS_COPY_H */
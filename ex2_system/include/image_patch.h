@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file image_patch.h
+ * @date 2026-10-19
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_IMAGE_PATCH_H_
+#define EX2_SYSTEM_INCLUDE_IMAGE_PATCH_H_
+
+#include <stdint.h>
+#include "image_update.h"
+
+/*
+ * Rebuilds a new application image from the golden image and a patch uplinked in
+ * pieces, and streams it into the application slot through image_update.c.
+ *
+ * The golden image is the base because it is the image running the updater and
+ * the application slot is the one being rewritten: a sector of the old
+ * application is erased before the write pointer reaches it, so its bytes are
+ * gone before a copy from the same place could read them.
+ *
+ * Patch layout, fixed size fields big endian:
+ *   header  uint32_t IMAGE_PATCH_MAGIC
+ *           uint32_t base size, uint16_t base CRC, must match the golden image_info
+ *           uint32_t image size, uint16_t image CRC, of the image the patch builds
+ *   ops, each an opcode byte and its arguments, until IMAGE_PATCH_END:
+ *     IMAGE_PATCH_COPY  zigzag varint base offset, relative to the end of the last
+ *                       copy, and varint length. Copies bytes from the base image
+ *     IMAGE_PATCH_DATA  varint length, then that many bytes of the new image
+ *     IMAGE_PATCH_FILL  varint length, then one byte repeated that many times
+ *     IMAGE_PATCH_END
+ * Varints are LEB128, 7 bits to a byte, least significant first, the top bit set
+ * on every byte but the last. Zigzag maps 0, -1, 1, -2 ... onto 0, 1, 2, 3 ...
+ *
+ * The applier keeps IMAGE_PATCH_BUF_LEN bytes of the new image in RAM and never
+ * holds a whole op, so the patch can be sent in chunks of any size. The patch is
+ * not checkpointed: after a reset the update is restarted with the whole patch.
+ * tools/image_patch builds patches on the ground.
+ */
+#define IMAGE_PATCH_MAGIC 0x45584450 // "EXDP"
+#define IMAGE_PATCH_HEADER_LEN 16
+#define IMAGE_PATCH_BUF_LEN (8 * IMAGE_UPDATE_ALIGN) // new image staged between flash writes
+#define IMAGE_PATCH_VARINT_MAX 5                     // bytes in a varint of a uint32_t
+
+typedef enum {
+    IMAGE_PATCH_END = 0,
+    IMAGE_PATCH_COPY = 1,
+    IMAGE_PATCH_DATA = 2,
+    IMAGE_PATCH_FILL = 3
+} image_patch_op;
+
+image_update_status image_patch_begin(void);
+
+image_update_status image_patch_write(uint32_t offset, const void *data, uint32_t len);
+
+image_update_status image_patch_finish(void);
+
+uint32_t image_patch_next(void);
+
+#endif /* EX2_SYSTEM_INCLUDE_IMAGE_PATCH_H_ */
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file image_update.h
+ * @date 2026-10-19
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_IMAGE_UPDATE_H_
+#define EX2_SYSTEM_INCLUDE_IMAGE_UPDATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "F021.h"
+
+/*
+ * Streams a new application image straight into the application slot.
+ *
+ * Data must arrive in order. Each flash sector is erased just before the write
+ * pointer reaches it and every chunk is programmed as it arrives, with a running
+ * CRC-16 kept over the image so far. The write pointer is checkpointed to
+ * update_info in the EEPROM every IMAGE_UPDATE_CHECKPOINT bytes and at the end
+ * of the image, so an update interrupted by a reset resumes from the last
+ * checkpoint. update_info shares the emulated EEPROM sectors with boot_info and the
+ * image records, so the interval is long enough to keep the writes to a few per image. A reset costs at most
+ * one interval of resent data, and chunks already in flash are not programmed again.
+ * The application image_info is cleared when an update begins and only written again once the
+ * whole image has been read back from flash and its CRC matches.
+ *
+ * Chunks start on IMAGE_UPDATE_ALIGN byte boundaries and, apart from the last
+ * one, are whole multiples of it, so no flash word is programmed twice.
+ */
+#define IMAGE_UPDATE_ALIGN 32          // bank 0 and 1 program width
+#define IMAGE_UPDATE_CHECKPOINT 0x10000 // bytes between update_info writes
+#define IMAGE_UPDATE_SLOT_END 0x00400000
+
+typedef enum {
+    IMAGE_UPDATE_OK = 0,
+    IMAGE_UPDATE_BAD_ARGS = -1,     // image outside the application slot, or a misaligned chunk
+    IMAGE_UPDATE_NOT_STARTED = -2,  // no update in progress
+    IMAGE_UPDATE_OUT_OF_ORDER = -3, // chunk not at the write pointer, resend from progress.next
+    IMAGE_UPDATE_FLASH_ERROR = -4,
+    IMAGE_UPDATE_EEPROM_ERROR = -5,
+    IMAGE_UPDATE_INCOMPLETE = -6, // finish before the whole image was written
+    IMAGE_UPDATE_BAD_CRC = -7,
+    IMAGE_UPDATE_BAD_SOURCE = -8 // a patch does not apply to the golden image
+} image_update_status;
+
+typedef struct {
+    bool active;
+    uint32_t address;   // start of the image in flash
+    uint32_t size;      // bytes in the whole image
+    uint32_t next;      // bytes written so far, where the next chunk must start
+    uint16_t crc;       // CRC-16 of the whole image, from the ground
+    uint16_t crc_sofar; // running CRC-16 of the first next bytes
+} image_update_progress;
+
+image_update_status image_update_resume(void);
+
+image_update_status image_update_begin(uint32_t address, uint32_t size, uint16_t crc);
+
+image_update_status image_update_write(uint32_t offset, const void *data, uint32_t len);
+
+image_update_status image_update_finish(void);
+
+image_update_status image_update_abort(void);
+
+void image_update_get_progress(image_update_progress *progress);
+
+Fapi_StatusType image_flash_crc(uint32_t address, uint32_t len, uint16_t *crc);
+
+/*
+ * Flash access used by the update. Implemented over bl_flash.c in
+ * image_flash.c; the unit tests provide a RAM-backed simulation instead.
+ */
+bool image_flash_sector(uint32_t address, uint32_t *start, uint32_t *length);
+
+Fapi_StatusType image_flash_erase(uint32_t start, uint32_t length);
+
+Fapi_StatusType image_flash_program(uint32_t address, const void *data, uint32_t size);
+
+Fapi_StatusType image_flash_read(uint32_t address, void *data, uint32_t size);
+
+#endif /* EX2_SYSTEM_INCLUDE_IMAGE_UPDATE_H_ */
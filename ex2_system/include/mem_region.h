@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file mem_region.h
+ * @date 2026-10-19
+ */
+
+#ifndef MEM_REGION_H
+#define MEM_REGION_H
+
+/* Kept free of system.h so the allocator builds in the host tests */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Size classes, smallest first. Each is one run of equal blocks carved from the heap at boot */
+#define MEM_REGION_CLASSES 3
+
+typedef struct {
+    uint16_t block_size;
+    uint16_t blocks;
+    uint16_t in_use;
+    uint16_t peak_in_use;
+    uint32_t allocations;
+    uint32_t exhausted; // requests of this class that had to go to a larger class or the heap
+} mem_region_stats;
+
+bool mem_region_init(void);
+
+void *mem_region_alloc(size_t size);
+void mem_region_free(void *ptr);
+
+bool mem_region_get_stats(uint8_t class_index, mem_region_stats *stats);
+uint32_t mem_region_spills(void);
+
+#endif /* MEM_REGION_H */
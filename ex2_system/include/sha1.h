@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file sha1.h
+ * @date 2026-10-19
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_SHA1_H_
+#define EX2_SYSTEM_INCLUDE_SHA1_H_
+
+#include <stdint.h>
+
+/*
+ * SHA-1 (FIPS 180-4), the hash under the CSP HMAC. The state is a plain struct,
+ * so the state after a fixed prefix can be saved and copied to skip hashing the
+ * prefix again, which is how crypto.c caches the HMAC pads.
+ */
+#define SHA1_BLOCK_LEN 64
+#define SHA1_DIGEST_LEN 20
+
+typedef struct {
+    uint32_t h[5];
+    uint64_t length; // bytes hashed so far
+    uint8_t block[SHA1_BLOCK_LEN];
+    uint32_t block_len; // bytes waiting in block
+} sha1_state;
+
+void sha1_init(sha1_state *state);
+
+void sha1_update(sha1_state *state, const void *data, uint32_t len);
+
+void sha1_final(sha1_state *state, uint8_t digest[SHA1_DIGEST_LEN]);
+
+void sha1(const void *data, uint32_t len, uint8_t digest[SHA1_DIGEST_LEN]);
+
+#endif /* EX2_SYSTEM_INCLUDE_SHA1_H_ */
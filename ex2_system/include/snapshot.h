@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file snapshot.h
+ * @date 2026-10-19
+ */
+
+#ifndef EX2_SYSTEM_INCLUDE_SNAPSHOT_H_
+#define EX2_SYSTEM_INCLUDE_SNAPSHOT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A record published by one task and read by any number of others without a lock.
+ *
+ * Publication n lives in buffer[n & 1], so the writer fills the buffer readers of
+ * the current publication are not using, then moves seq on. A reader notes seq,
+ * reads, and reads again if seq moved meanwhile: the writer may have lapped it and
+ * be filling the buffer it was reading.
+ */
+typedef struct {
+    void *buffer[2];
+    size_t size;
+    volatile uint32_t seq;
+} snapshot_t;
+
+#define SNAPSHOT_INIT(buffer0, buffer1, record_size) {{(buffer0), (buffer1)}, (record_size), 0}
+
+void snapshot_publish(snapshot_t *snapshot, const void *record);
+
+const void *snapshot_acquire(const snapshot_t *snapshot, uint32_t *seq);
+
+bool snapshot_valid(const snapshot_t *snapshot, uint32_t seq);
+
+bool snapshot_read(const snapshot_t *snapshot, size_t offset, void *out, size_t len);
+
+#endif /* EX2_SYSTEM_INCLUDE_SNAPSHOT_H_ */
@@ -31,6 +31,28 @@ static bool beacon_task_enabled = true; /* Beacon starts enabled! */
 static void *beacon_daemon();
 SAT_returnState start_beacon_daemon();
 
+/* Large enough for either packet, so encoding never touches the heap */
+static char beacon_encoded[BASE64_ENCODED_LEN(sizeof(beacon_packet_1_t) > sizeof(beacon_packet_2_t)
+                                                  ? sizeof(beacon_packet_1_t)
+                                                  : sizeof(beacon_packet_2_t))];
+
+/**
+ * @brief
+ *      Base64 encode a beacon packet and hand it to the UHF
+ * @return
+ *      UHF status of setting the beacon message
+ */
+static UHF_return prv_set_beacon_msg(const void *beacon_packet, size_t packet_len) {
+    UHF_configStruct beacon_msg;
+    size_t output_len = base64_encode_into(beacon_packet, packet_len, beacon_encoded, sizeof(beacon_encoded));
+
+    // Truncate len if it's too big. At least some data will get transmitted
+    size_t message_len = output_len > MAX_W_CMDLEN ? MAX_W_CMDLEN : output_len;
+    memcpy(&beacon_msg.message, beacon_encoded, message_len);
+    beacon_msg.len = message_len;
+    return HAL_UHF_setBeaconMsg(beacon_msg);
+}
+
 /**
  * Construct and send out the system beacon at the required frequency.
  *
@@ -44,17 +66,15 @@ static void *beacon_daemon() {
         /* Main beacon loop to update beacon contents with latest housekeeping data */
         if (beacon_task_enabled) {
 
-            /* Fetch most recent housekeeping */
-            All_systems_housekeeping all_hk_data;
-            get_latest_hk(&all_hk_data);
-
-            /* Constructing the beacon content */
-            UHF_configStruct beacon_msg;
+            /* Constructing the beacon content from the most recent housekeeping */
             beacon_packet_1_t beacon_packet_one;
             beacon_packet_2_t beacon_packet_two;
-            memset(&beacon_packet_one, 0, sizeof(beacon_packet_one));
-            memset(&beacon_packet_two, 0, sizeof(beacon_packet_two));
-            update_beacon(&all_hk_data, &beacon_packet_one, &beacon_packet_two);
+            uint32_t hk_seq;
+            do {
+                memset(&beacon_packet_one, 0, sizeof(beacon_packet_one));
+                memset(&beacon_packet_two, 0, sizeof(beacon_packet_two));
+                update_beacon(hk_latest_acquire(&hk_seq), &beacon_packet_one, &beacon_packet_two);
+            } while (!hk_latest_valid(hk_seq));
 
             /* Get the beacon period from the UHF so that we know how long to wait */
             uint32_t beacon_t_s;
@@ -69,43 +89,23 @@ static void *beacon_daemon() {
             beacon_packet_one.time = unix_time;
             beacon_packet_two.time = unix_time;
 
-            /* Encode the first beacon content */
-            size_t output_len = 0;
-            char *beacon_content =
-                base64_encode((void *)&beacon_packet_one, sizeof(beacon_packet_1_t), &output_len);
-
-            // Truncate len if it's too big. At least some data will get transmitted
-            size_t message_len = output_len > MAX_W_CMDLEN ? MAX_W_CMDLEN : output_len;
             /* Set first beacon packet */
-            memcpy(&beacon_msg.message, beacon_content, message_len);
-            beacon_msg.len = message_len;
-            uhf_status = HAL_UHF_setBeaconMsg(beacon_msg);
+            uhf_status = prv_set_beacon_msg(&beacon_packet_one, sizeof(beacon_packet_1_t));
             if (uhf_status != U_GOOD_CONFIG) {
-                vPortFree(beacon_content);
                 vTaskDelay(20 * ONE_SECOND);
                 continue;
             }
 
             /* Wait for UHF to send first beacon */
-            vPortFree(beacon_content);
             vTaskDelay(pdMS_TO_TICKS(beacon_t_s * 1000));
 
-            /* Encode the second beacon content */
-            beacon_content = base64_encode((void *)&beacon_packet_two, sizeof(beacon_packet_2_t), &output_len);
-            message_len = output_len > MAX_W_CMDLEN ? MAX_W_CMDLEN : output_len;
-
             /* Set the second beacon packet */
-            memcpy(&(beacon_msg.message), beacon_content, message_len);
-            beacon_msg.len = message_len;
-            uhf_status = HAL_UHF_setBeaconMsg(beacon_msg);
+            uhf_status = prv_set_beacon_msg(&beacon_packet_two, sizeof(beacon_packet_2_t));
             if (uhf_status != U_GOOD_CONFIG) {
-                vPortFree(beacon_content);
                 vTaskDelay(20 * ONE_SECOND);
                 continue;
             }
 
-            vPortFree(beacon_content);
-
             /* Wait for UHF to send second beacon */
             vTaskDelay(pdMS_TO_TICKS(beacon_t_s * 1000));
         } else {
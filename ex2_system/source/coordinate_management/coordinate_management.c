@@ -19,39 +19,77 @@
 #include "coordinate_management/coordinate_management.h"
 
 #include <FreeRTOS.h>
+#include <math.h>
 #include <os_task.h>
+#include "coordinate_management/geofence.h"
 #include "logger/logger.h"
+#include "rtcmk.h"
+#include "skytraq_gps.h"
 
 static void *coordinate_management_daemon(void *pvParameters);
 SAT_returnState start_coordinate_management_daemon(void);
 
-/*
-int is_china(double lat,double lon){
-    const double lata =30.747500833466347;
-    const double longa=111.181640625;
-    const double rada=1500;
-    const double latb=38.54129088479034;
-    const double longb =88.41796875;
-    const double radb=1350;
-    const double latc=46.313549654089094;
-    const double longc=123.92578125;
-    const double radc=1000;
+/* Regions covering China, kept from the ground check this daemon used to have */
+static const float china_regions[][3] = {
+    {30.7475008f, 111.1816406f, 1500.0f}, // lat, lon, radius km
+    {38.5412909f, 88.4179688f, 1350.0f},
+    {46.3135497f, 123.9257813f, 1000.0f},
+};
+
+#define EDMONTON_LAT 53.5232f
+#define EDMONTON_LON -113.5263f
+#define EDMONTON_MIN_ELEVATION 10.0f
+
+#define ALTITUDE_STEP_KM 5.0f // station caps are recomputed when the altitude moves this far
 
-    const double earth_radius=6371;
+/**
+ * @brief
+ *      Set up the default geofence zones
+ * @details
+ *      The geofence is not reset, so handlers subscribed before the daemon starts
+ *      are kept
+ */
+static void coordinate_management_zones(void) {
+    uint8_t i;
 
-    double siga,sigb,sigc;
+    for (i = 0; i < GEOFENCE_ZONE_CHINA_COUNT; i++) {
+        geofence_set_region(GEOFENCE_ZONE_CHINA + i, china_regions[i][0], china_regions[i][1],
+                            china_regions[i][2]);
+    }
+    geofence_set_station(GEOFENCE_ZONE_EDMONTON, EDMONTON_LAT, EDMONTON_LON, EDMONTON_MIN_ELEVATION);
+}
 
-    siga=earth_radius*acos(sin(lat*M_PI/180)*sin(lata*M_PI/180)+cos(lat*M_PI/180)*cos(lata*M_PI/180)*cos(fabs((lon-longa)*M_PI/180)));
-    sigb=earth_radius*acos(sin(lat*M_PI/180)*sin(latb*M_PI/180)+cos(lat*M_PI/180)*cos(latb*M_PI/180)*cos(fabs((lon-longb)*M_PI/180)));
-    sigc=earth_radius*acos(sin(lat*M_PI/180)*sin(latc*M_PI/180)+cos(lat*M_PI/180)*cos(latc*M_PI/180)*cos(fabs((lon-longc)*M_PI/180)));
+#if CHARON_IS_STUBBED == 0
+/**
+ * @brief
+ *      Feed the latest GPS fix to the geofence
+ * @details
+ *      The GPS reports whole degrees with the sign, and the fraction as an unsigned
+ *      count of ten millionths of a degree
+ */
+static void coordinate_management_gps(void) {
+    int32_t lat_upper, lat_lower, lon_upper, lon_lower;
+    uint32_t alt_cm;
+    float lat, lon, alt_km;
 
-    if(siga<=rada||sigb<=radb||sigc<=radc) return 1;
-    else return 0;
-}*/
+    if (gps_get_altitude(&alt_cm)) {
+        alt_km = alt_cm / 100000.0f;
+        if (fabsf(alt_km - geofence_get_altitude()) > ALTITUDE_STEP_KM) {
+            geofence_set_altitude(alt_km);
+        }
+    }
+    if (!gps_get_position(&lat_upper, &lat_lower, &lon_upper, &lon_lower)) {
+        return;
+    }
+    lat = lat_upper + (lat_upper < 0 ? -1.0f : 1.0f) * lat_lower / 10000000.0f;
+    lon = lon_upper + (lon_upper < 0 ? -1.0f : 1.0f) * lon_lower / 10000000.0f;
+    geofence_update_lat_lon(lat, lon, (uint32_t)RTCMK_Unix_Now());
+}
+#endif
 
 /**
  * Coordinate management. Handle updates of current latitude, longitude, and time as
- * reported by the Global Positioning System.
+ * reported by the Global Positioning System, and pass the position to the geofence.
  *
  * @param pvParameters
  *    task parameters (not used)
@@ -59,7 +97,9 @@ int is_china(double lat,double lon){
 static void *coordinate_management_daemon(void *pvParameters) {
     TickType_t delay = pdMS_TO_TICKS(1000);
     for (;;) {
-        // TODO Application level management of the GPS
+#if CHARON_IS_STUBBED == 0
+        coordinate_management_gps();
+#endif
 
         vTaskDelay(delay);
     }
@@ -72,6 +112,7 @@ static void *coordinate_management_daemon(void *pvParameters) {
  *   error report of task creation
  */
 SAT_returnState start_coordinate_management_daemon(void) {
+    coordinate_management_zones();
     if (xTaskCreate((TaskFunction_t)coordinate_management_daemon, "coordinate_management_daemon", COORD_DM_SIZE,
                     NULL, COORDINATE_MANAGEMENT_TASK_PRIO, NULL) != pdPASS) {
         ex2_log("FAILED TO CREATE TASK coordinate_management_daemon\n");
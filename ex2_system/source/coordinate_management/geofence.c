@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file geofence.c
+ * @date 2026-10-19
+ */
+
+#include "coordinate_management/geofence.h"
+#include <math.h>
+#include <stddef.h>
+
+#define DEG_TO_RAD 0.017453292519943295f
+#define PI_F 3.14159265358979f
+
+typedef struct {
+    geofence_kind kind;
+    float range; // radius in km for a region, minimum elevation in degrees for a station
+    geofence_vec centre;
+    float cos_enter;
+    float cos_exit;
+    bool inside;
+} geofence_zone;
+
+typedef struct {
+    geofence_handler handler;
+    void *arg;
+} geofence_subscriber;
+
+static geofence_zone zones[GEOFENCE_MAX_ZONES];
+static geofence_subscriber subscribers[GEOFENCE_MAX_SUBSCRIBERS];
+static uint8_t subscriber_count;
+static float altitude_km = GEOFENCE_DEFAULT_ALTITUDE_KM;
+static uint32_t last_time;
+
+static void publish(uint8_t zone, geofence_event_type type, uint32_t time) {
+    geofence_event event;
+    uint8_t i;
+
+    event.zone = zone;
+    event.kind = zones[zone].kind;
+    event.type = type;
+    event.time = time;
+    for (i = 0; i < subscriber_count; i++) {
+        subscribers[i].handler(&event, subscribers[i].arg);
+    }
+}
+
+/**
+ * @brief
+ *      Set the entry and exit edges of a zone from the angular radius of its cap
+ * @details
+ *      The exit edge is pushed out by the hysteresis distance, and both edges stop
+ *      at the antipode
+ */
+static void set_edges(geofence_zone *z, float angle) {
+    float exit_angle = angle + GEOFENCE_HYSTERESIS_KM / GEOFENCE_EARTH_RADIUS_KM;
+
+    if (angle > PI_F) {
+        angle = PI_F;
+    }
+    if (exit_angle > PI_F) {
+        exit_angle = PI_F;
+    }
+    z->cos_enter = cosf(angle);
+    z->cos_exit = cosf(exit_angle);
+}
+
+/**
+ * @brief
+ *      Angular radius of the cap of sub-satellite points that a station can see
+ * @details
+ *      From the triangle of Earth centre, station and satellite: the satellite is at
+ *      elevation e when the central angle is acos(Re cos(e) / (Re + h)) - e
+ */
+static float station_angle(float min_elevation) {
+    float e = min_elevation * DEG_TO_RAD;
+    float c = GEOFENCE_EARTH_RADIUS_KM * cosf(e) / (GEOFENCE_EARTH_RADIUS_KM + altitude_km);
+    return acosf(c) - e;
+}
+
+/**
+ * @brief
+ *      Remove a zone, reporting an exit if the satellite was inside it
+ */
+static void remove_zone(uint8_t zone) {
+    if (zones[zone].kind != GEOFENCE_UNUSED && zones[zone].inside) {
+        zones[zone].inside = false;
+        publish(zone, GEOFENCE_EXIT, last_time);
+    }
+    zones[zone].kind = GEOFENCE_UNUSED;
+}
+
+static bool valid_position(float lat, float lon) {
+    return lat >= -90.0f && lat <= 90.0f && lon >= -180.0f && lon <= 360.0f;
+}
+
+/**
+ * @brief
+ *      Clear all zones and subscribers
+ */
+void geofence_init(void) {
+    uint8_t i;
+    for (i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        zones[i].kind = GEOFENCE_UNUSED;
+        zones[i].inside = false;
+    }
+    subscriber_count = 0;
+    altitude_km = GEOFENCE_DEFAULT_ALTITUDE_KM;
+    last_time = 0;
+}
+
+/**
+ * @brief
+ *      Unit vector in the Earth fixed frame pointing at a latitude and longitude
+ * @param lat
+ *      Degrees north
+ * @param lon
+ *      Degrees east
+ * @param v
+ *      Output vector, x towards 0 longitude and z towards the north pole
+ */
+void geofence_unit_vector(float lat, float lon, geofence_vec *v) {
+    float phi = lat * DEG_TO_RAD;
+    float lambda = lon * DEG_TO_RAD;
+    float cos_phi = cosf(phi);
+
+    v->x = cos_phi * cosf(lambda);
+    v->y = cos_phi * sinf(lambda);
+    v->z = sinf(phi);
+}
+
+/**
+ * @brief
+ *      Set a zone to a circular region on the ground, such as a country
+ * @param zone
+ *      Index of the zone, anything already there is removed first
+ * @param lat
+ *      Latitude of the centre in degrees
+ * @param lon
+ *      Longitude of the centre in degrees
+ * @param radius_km
+ *      Great circle distance from the centre to the edge
+ * @return SAT_returnState
+ *      SATR_ERROR if the zone or region is not valid
+ */
+SAT_returnState geofence_set_region(uint8_t zone, float lat, float lon, float radius_km) {
+    geofence_zone *z;
+
+    if (zone >= GEOFENCE_MAX_ZONES || !valid_position(lat, lon) || !(radius_km > 0.0f)) {
+        return SATR_ERROR;
+    }
+    remove_zone(zone);
+    z = &zones[zone];
+    geofence_unit_vector(lat, lon, &z->centre);
+    z->range = radius_km;
+    set_edges(z, radius_km / GEOFENCE_EARTH_RADIUS_KM);
+    z->inside = false;
+    z->kind = GEOFENCE_REGION;
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Set a zone to the visibility of a ground station
+ * @details
+ *      The satellite is inside while it is above the minimum elevation seen from the
+ *      station. The cap depends on the altitude, so it is recomputed by
+ *      geofence_set_altitude
+ * @param zone
+ *      Index of the zone, anything already there is removed first
+ * @param lat
+ *      Latitude of the station in degrees
+ * @param lon
+ *      Longitude of the station in degrees
+ * @param min_elevation
+ *      Elevation mask of the station in degrees, 0 to less than 90
+ * @return SAT_returnState
+ *      SATR_ERROR if the zone or station is not valid
+ */
+SAT_returnState geofence_set_station(uint8_t zone, float lat, float lon, float min_elevation) {
+    geofence_zone *z;
+
+    if (zone >= GEOFENCE_MAX_ZONES || !valid_position(lat, lon) || !(min_elevation >= 0.0f) ||
+        !(min_elevation < 90.0f)) {
+        return SATR_ERROR;
+    }
+    remove_zone(zone);
+    z = &zones[zone];
+    geofence_unit_vector(lat, lon, &z->centre);
+    z->range = min_elevation;
+    set_edges(z, station_angle(min_elevation));
+    z->inside = false;
+    z->kind = GEOFENCE_STATION;
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Remove a zone, subscribers get an exit event if the satellite was inside it
+ */
+SAT_returnState geofence_clear(uint8_t zone) {
+    if (zone >= GEOFENCE_MAX_ZONES) {
+        return SATR_ERROR;
+    }
+    remove_zone(zone);
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Set the altitude used for station visibility and recompute the station caps
+ * @details
+ *      Zone states are kept, the new caps take effect on the next update
+ */
+void geofence_set_altitude(float altitude) {
+    uint8_t i;
+
+    if (!(altitude > 0.0f)) {
+        return;
+    }
+    altitude_km = altitude;
+    for (i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        if (zones[i].kind == GEOFENCE_STATION) {
+            set_edges(&zones[i], station_angle(zones[i].range));
+        }
+    }
+}
+
+float geofence_get_altitude(void) { return altitude_km; }
+
+/**
+ * @brief
+ *      Register a handler for enter and exit events
+ * @return SAT_returnState
+ *      SATR_ERROR if the handler is NULL or there is no room for it
+ */
+SAT_returnState geofence_subscribe(geofence_handler handler, void *arg) {
+    if (handler == NULL || subscriber_count >= GEOFENCE_MAX_SUBSCRIBERS) {
+        return SATR_ERROR;
+    }
+    subscribers[subscriber_count].handler = handler;
+    subscribers[subscriber_count].arg = arg;
+    subscriber_count++;
+    return SATR_OK;
+}
+
+/**
+ * @brief
+ *      Test a position against every zone and publish the changes
+ * @details
+ *      The position does not have to be a unit vector, so a propagated position in
+ *      km can be passed directly. Instead of dividing it out, its length scales the
+ *      cosine thresholds, which leaves one square root per update and none per zone
+ * @param position
+ *      Position in the Earth fixed frame, in any unit
+ * @param time
+ *      Time of the position, copied into the events
+ * @return uint8_t
+ *      Number of events published
+ */
+uint8_t geofence_update(const geofence_vec *position, uint32_t time) {
+    float norm = sqrtf(position->x * position->x + position->y * position->y + position->z * position->z);
+    uint8_t events = 0;
+    uint8_t i;
+
+    if (!(norm > 0.0f)) {
+        return 0;
+    }
+    last_time = time;
+    for (i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        geofence_zone *z = &zones[i];
+        float dot;
+
+        if (z->kind == GEOFENCE_UNUSED) {
+            continue;
+        }
+        dot = z->centre.x * position->x + z->centre.y * position->y + z->centre.z * position->z;
+        if (!z->inside && dot >= z->cos_enter * norm) {
+            z->inside = true;
+            publish(i, GEOFENCE_ENTER, time);
+            events++;
+        } else if (z->inside && dot < z->cos_exit * norm) {
+            z->inside = false;
+            publish(i, GEOFENCE_EXIT, time);
+            events++;
+        }
+    }
+    return events;
+}
+
+/**
+ * @brief
+ *      Test a GPS fix against every zone and publish the changes
+ * @param lat
+ *      Degrees north
+ * @param lon
+ *      Degrees east
+ * @param time
+ *      Time of the fix, copied into the events
+ * @return uint8_t
+ *      Number of events published
+ */
+uint8_t geofence_update_lat_lon(float lat, float lon, uint32_t time) {
+    geofence_vec position;
+
+    if (!valid_position(lat, lon)) {
+        return 0;
+    }
+    geofence_unit_vector(lat, lon, &position);
+    return geofence_update(&position, time);
+}
+
+bool geofence_inside(uint8_t zone) {
+    if (zone >= GEOFENCE_MAX_ZONES || zones[zone].kind == GEOFENCE_UNUSED) {
+        return false;
+    }
+    return zones[zone].inside;
+}
@@ -120,3 +120,148 @@ void set_crypto_key(CRYPTO_KEY_T type, char *key, int key_len) {
     }
 #endif
 }
+
+/**
+ * @brief
+ *      Hash the two pad blocks of an HMAC-SHA1 key (RFC 2104)
+ * @param key_len
+ *      Any length, a key longer than a block is hashed first
+ */
+void crypto_hmac_init(crypto_hmac_ctx *ctx, const uint8_t *key, uint32_t key_len) {
+    uint8_t pad[SHA1_BLOCK_LEN] = {0};
+    int i;
+
+    if (key_len > SHA1_BLOCK_LEN) {
+        sha1(key, key_len, pad);
+    } else {
+        memcpy(pad, key, key_len);
+    }
+    for (i = 0; i < SHA1_BLOCK_LEN; i++) {
+        pad[i] ^= 0x36;
+    }
+    sha1_init(&ctx->inner);
+    sha1_update(&ctx->inner, pad, SHA1_BLOCK_LEN);
+    for (i = 0; i < SHA1_BLOCK_LEN; i++) {
+        pad[i] ^= 0x36 ^ 0x5C;
+    }
+    sha1_init(&ctx->outer);
+    sha1_update(&ctx->outer, pad, SHA1_BLOCK_LEN);
+    memset(pad, 0, sizeof(pad));
+}
+
+/**
+ * @brief
+ *      Start an HMAC over a message given in parts, fed to state with sha1_update
+ */
+void crypto_hmac_begin(const crypto_hmac_ctx *ctx, sha1_state *state) { *state = ctx->inner; }
+
+void crypto_hmac_end(const crypto_hmac_ctx *ctx, sha1_state *state, uint8_t mac[CRYPTO_HMAC_LEN]) {
+    uint8_t inner[SHA1_DIGEST_LEN];
+    sha1_final(state, inner);
+    *state = ctx->outer;
+    sha1_update(state, inner, sizeof(inner));
+    sha1_final(state, mac);
+}
+
+void crypto_hmac(const crypto_hmac_ctx *ctx, const void *data, uint32_t len, uint8_t mac[CRYPTO_HMAC_LEN]) {
+    sha1_state state;
+    crypto_hmac_begin(ctx, &state);
+    sha1_update(&state, data, len);
+    crypto_hmac_end(ctx, &state, mac);
+}
+
+#define XTEA_DELTA 0x9E3779B9U
+
+/**
+ * @brief
+ *      Work out the round keys of an XTEA key
+ * @param key
+ *      Key bytes, read as four big endian words. A shorter key is padded with zeros
+ *      and only the first CRYPTO_XTEA_KEY_LEN bytes of a longer one are used
+ */
+void crypto_xtea_init(crypto_xtea_ctx *ctx, const uint8_t *key, uint32_t key_len) {
+    uint8_t bytes[CRYPTO_XTEA_KEY_LEN] = {0};
+    uint32_t k[4], sum = 0;
+    int i;
+
+    memcpy(bytes, key, key_len < sizeof(bytes) ? key_len : sizeof(bytes));
+    for (i = 0; i < 4; i++) {
+        k[i] = ((uint32_t)bytes[4 * i] << 24) | ((uint32_t)bytes[4 * i + 1] << 16) |
+               ((uint32_t)bytes[4 * i + 2] << 8) | bytes[4 * i + 3];
+    }
+    for (i = 0; i < CRYPTO_XTEA_CYCLES; i++) {
+        ctx->round_key[2 * i] = sum + k[sum & 3];
+        sum += XTEA_DELTA;
+        ctx->round_key[2 * i + 1] = sum + k[(sum >> 11) & 3];
+    }
+    memset(bytes, 0, sizeof(bytes));
+    memset(k, 0, sizeof(k));
+}
+
+void crypto_xtea_encrypt_block(const crypto_xtea_ctx *ctx, uint32_t v[2]) {
+    const uint32_t *rk = ctx->round_key;
+    uint32_t v0 = v[0], v1 = v[1];
+    int i;
+
+    for (i = 0; i < CRYPTO_XTEA_CYCLES; i++) {
+        v0 += (((v1 << 4) ^ (v1 >> 5)) + v1) ^ *rk++;
+        v1 += (((v0 << 4) ^ (v0 >> 5)) + v0) ^ *rk++;
+    }
+    v[0] = v0;
+    v[1] = v1;
+}
+
+void crypto_xtea_decrypt_block(const crypto_xtea_ctx *ctx, uint32_t v[2]) {
+    const uint32_t *rk = &ctx->round_key[2 * CRYPTO_XTEA_CYCLES];
+    uint32_t v0 = v[0], v1 = v[1];
+    int i;
+
+    for (i = 0; i < CRYPTO_XTEA_CYCLES; i++) {
+        v1 -= (((v0 << 4) ^ (v0 >> 5)) + v0) ^ *--rk;
+        v0 -= (((v1 << 4) ^ (v1 >> 5)) + v1) ^ *--rk;
+    }
+    v[0] = v0;
+    v[1] = v1;
+}
+
+/**
+ * @brief
+ *      Encrypt or decrypt with the key stream of libcsp's csp_xtea_encrypt
+ * @details
+ *      Block 0 of the key stream is the encryption of {iv[0], iv[1]}, taken as big
+ *      endian bytes, and block i after it the encryption of {iv[0], iv[1] + i - 1}.
+ *      libcsp increments the counter after copying it, so blocks 0 and 1 are the
+ *      same; that is kept, since the other end of the link decrypts with libcsp.
+ *      Running it again with the same iv undoes it. libcsp takes the first 16 bytes
+ *      of the key and refuses a shorter one, where crypto_xtea_init pads it
+ * @param data
+ *      Encrypted in place, any length
+ */
+void crypto_xtea_csp(const crypto_xtea_ctx *ctx, uint8_t *data, uint32_t len, const uint32_t iv[2]) {
+    uint32_t counter = iv[1];
+    uint32_t block = 0;
+    uint8_t bytes[CRYPTO_XTEA_BLOCK_LEN];
+
+    while (len > 0) {
+        uint32_t n = len < CRYPTO_XTEA_BLOCK_LEN ? len : CRYPTO_XTEA_BLOCK_LEN;
+        uint32_t i;
+
+        if (block != 1) { // block 1 reuses the stream of block 0
+            uint32_t stream[2] = {iv[0], counter};
+            crypto_xtea_encrypt_block(ctx, stream);
+            for (i = 0; i < 4; i++) {
+                bytes[i] = (uint8_t)(stream[0] >> (24 - 8 * i));
+                bytes[4 + i] = (uint8_t)(stream[1] >> (24 - 8 * i));
+            }
+        }
+        if (block != 0) {
+            counter++;
+        }
+        for (i = 0; i < n; i++) {
+            data[i] ^= bytes[i];
+        }
+        data += n;
+        len -= n;
+        block++;
+    }
+}
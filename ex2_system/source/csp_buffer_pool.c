@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file csp_buffer_pool.c
+ * @date 2026-10-19
+ *
+ * The libcsp buffer API on top of the size class pool in csp_pool.c. It replaces
+ * libcsp/src/csp_buffer.c, which is excluded from the build (csp_buffer_pool.h).
+ *
+ * The largest class is csp_conf.buffers buffers of csp_conf.buffer_data_size, which
+ * is what csp_buffer_data_size() reports. With CSP_BUFFER_SIZE_CLASSES set there is
+ * also the small class of CSP_POOL_SMALL_SIZE from system.h. csp_buffer_get,
+ * csp_buffer_get_isr and csp_buffer_clone always return the largest class, since a
+ * service replies in the packet it was given; only csp_buffer_get_small can return
+ * a smaller one.
+ */
+
+#include <FreeRTOS.h>
+#include <os_task.h>
+#include <csp/csp.h>
+#include <csp/csp_buffer.h>
+#include <csp/csp_debug.h>
+#include <csp/arch/csp_malloc.h>
+#include <stddef.h>
+#include <string.h>
+#include "csp_buffer_pool.h"
+#include "csp_pool.h"
+#include "system.h"
+
+#define CSP_BUFFER_PACKET_OVERHEAD offsetof(csp_packet_t, data)
+
+/* csp_send appends the XTEA nonce, HMAC and CRC32 after the data, so every buffer
+ * has room for them past what was asked for */
+#define CSP_BUFFER_TRAILER_ROOM 12
+
+static void *pool_memory = NULL;
+static size_t max_data_size = 0;
+
+static const char *prv_task_name(void) {
+    if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        return "main";
+    }
+    return pcTaskGetName(NULL);
+}
+
+/**
+ * @brief
+ *      Room to ask the pool for a packet of size bytes, with the trailers csp_send adds
+ */
+static size_t prv_with_trailer(size_t size) {
+    size += CSP_BUFFER_TRAILER_ROOM;
+    return size > max_data_size ? max_data_size : size;
+}
+
+int csp_buffer_init(void) {
+    const csp_conf_t *conf = csp_get_conf();
+    csp_pool_class_config classes[] = {
+#if CSP_BUFFER_SIZE_CLASSES
+        {CSP_POOL_SMALL_SIZE, CSP_POOL_SMALL_COUNT},
+#endif
+        {conf->buffer_data_size, conf->buffers}};
+    uint8_t count = sizeof(classes) / sizeof(classes[0]);
+    size_t size = csp_pool_memory_size(classes, count, CSP_BUFFER_PACKET_OVERHEAD);
+
+    pool_memory = csp_malloc(size);
+    if (pool_memory == NULL) {
+        return CSP_ERR_NOMEM;
+    }
+    if (!csp_pool_init(classes, count, CSP_BUFFER_PACKET_OVERHEAD, pool_memory)) {
+        csp_free(pool_memory);
+        pool_memory = NULL;
+        return CSP_ERR_INVAL;
+    }
+    max_data_size = conf->buffer_data_size;
+    return CSP_ERR_NONE;
+}
+
+void csp_buffer_free_resources(void) {
+    csp_free(pool_memory);
+    pool_memory = NULL;
+    max_data_size = 0;
+}
+
+static void *prv_get(size_t size) {
+    void *buffer;
+
+    taskENTER_CRITICAL();
+    buffer = csp_pool_get(size, prv_task_name(), xTaskGetTickCount() * portTICK_PERIOD_MS);
+    taskEXIT_CRITICAL();
+    if (buffer == NULL) {
+        csp_log_error("Out of buffers for %u bytes", (unsigned int)size);
+    }
+    return buffer;
+}
+
+/**
+ * @brief
+ *      Full size buffer, whatever is asked for. The packet can reach a service that
+ *      writes its reply into it
+ */
+void *csp_buffer_get(size_t size) {
+    if (size > max_data_size) {
+        csp_log_error("GET: Too large data size %u > %u", (unsigned int)size, (unsigned int)max_data_size);
+        return NULL;
+    }
+    return prv_get(max_data_size);
+}
+
+/**
+ * @brief
+ *      Buffer with room for size bytes and the trailers, from the smallest class that
+ *      has one free. Only for packets no service on this node replies in
+ */
+void *csp_buffer_get_small(size_t size) {
+    if (size > max_data_size) {
+        csp_log_error("GET: Too large data size %u > %u", (unsigned int)size, (unsigned int)max_data_size);
+        return NULL;
+    }
+    return prv_get(prv_with_trailer(size));
+}
+
+/**
+ * @brief
+ *      Buffer for an interface to receive into, always full size
+ */
+void *csp_buffer_get_isr(size_t size) {
+    void *buffer;
+    UBaseType_t mask;
+
+    if (size > max_data_size) {
+        return NULL;
+    }
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    buffer = csp_pool_get(max_data_size, NULL, xTaskGetTickCountFromISR() * portTICK_PERIOD_MS);
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return buffer;
+}
+
+void csp_buffer_free(void *buffer) {
+    bool ok;
+
+    if (buffer == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL();
+    ok = csp_pool_free(buffer, xTaskGetTickCount() * portTICK_PERIOD_MS);
+    taskEXIT_CRITICAL();
+    if (!ok) {
+        csp_log_error("FREE: Invalid or already free buffer %p", buffer);
+    }
+}
+
+void csp_buffer_free_isr(void *buffer) {
+    UBaseType_t mask;
+
+    if (buffer == NULL) {
+        return;
+    }
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    csp_pool_free(buffer, xTaskGetTickCountFromISR() * portTICK_PERIOD_MS);
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+void csp_buffer_refc_inc(void *buffer) {
+    bool ok;
+
+    if (buffer == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL();
+    ok = csp_pool_ref(buffer);
+    taskEXIT_CRITICAL();
+    if (!ok) {
+        csp_log_error("REFC: Invalid buffer %p", buffer);
+    }
+}
+
+/**
+ * @brief
+ *      Copy a packet into a new full size buffer, whatever class it came from
+ */
+void *csp_buffer_clone(void *buffer) {
+    csp_packet_t *packet = (csp_packet_t *)buffer;
+    csp_packet_t *clone;
+
+    if (csp_pool_capacity(buffer) == 0) {
+        return NULL;
+    }
+    clone = prv_get(max_data_size);
+    if (clone != NULL) {
+        memcpy(clone, packet, CSP_BUFFER_PACKET_OVERHEAD + packet->length);
+    }
+    return clone;
+}
+
+int csp_buffer_remaining(void) {
+    int remaining;
+    taskENTER_CRITICAL();
+    remaining = (int)csp_pool_remaining();
+    taskEXIT_CRITICAL();
+    return remaining;
+}
+
+size_t csp_buffer_size(void) { return max_data_size + CSP_BUFFER_PACKET_OVERHEAD; }
+
+size_t csp_buffer_data_size(void) { return max_data_size; }
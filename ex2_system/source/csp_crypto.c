@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file csp_crypto.c
+ * @date 2026-10-19
+ *
+ * The libcsp HMAC and XTEA API on top of the contexts in crypto.c. It replaces
+ * libcsp/src/crypto/csp_hmac.c and csp_xtea.c, which are excluded from the build,
+ * and gives the same results: the HMAC key is the first 16 bytes of the SHA-1 of
+ * the key given, the HMAC is cut to CSP_HMAC_LENGTH bytes, and XTEA uses the first
+ * 16 bytes of a key of at least 16 bytes. The contexts are built when a key is set,
+ * so a packet costs its own hashing and nothing for the key.
+ */
+
+#include <csp/csp.h>
+#include <csp/crypto/csp_hmac.h>
+#include <csp/crypto/csp_xtea.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crypto.h"
+
+#define CSP_HMAC_KEY_LEN 16
+
+// Keys are set from init_csp before the router starts, and not changed after
+static crypto_hmac_ctx hmac_ctx;
+static crypto_xtea_ctx xtea_ctx;
+static bool hmac_ready = false;
+static bool xtea_ready = false;
+
+/**
+ * @brief
+ *      Contexts for the zero keys libcsp starts with, for a packet sent before a key is set
+ */
+static void make_ready(void) {
+    static const uint8_t zero_key[CRYPTO_XTEA_KEY_LEN] = {0};
+    if (!hmac_ready) {
+        crypto_hmac_init(&hmac_ctx, zero_key, CSP_HMAC_KEY_LEN);
+        hmac_ready = true;
+    }
+    if (!xtea_ready) {
+        crypto_xtea_init(&xtea_ctx, zero_key, CRYPTO_XTEA_KEY_LEN);
+        xtea_ready = true;
+    }
+}
+
+int csp_hmac_set_key(const void *key, uint32_t keylen) {
+    uint8_t hash[SHA1_DIGEST_LEN];
+
+    if (key == NULL || keylen == 0) {
+        return CSP_ERR_INVAL;
+    }
+    sha1(key, keylen, hash);
+    crypto_hmac_init(&hmac_ctx, hash, CSP_HMAC_KEY_LEN);
+    hmac_ready = true;
+    memset(hash, 0, sizeof(hash));
+    return CSP_ERR_NONE;
+}
+
+int csp_hmac_memory(const void *key, uint32_t keylen, const void *data, uint32_t datalen, uint8_t *hmac) {
+    crypto_hmac_ctx ctx;
+
+    if (key == NULL || data == NULL || hmac == NULL) {
+        return CSP_ERR_INVAL;
+    }
+    crypto_hmac_init(&ctx, key, keylen);
+    crypto_hmac(&ctx, data, datalen, hmac);
+    return CSP_ERR_NONE;
+}
+
+/**
+ * @brief
+ *      HMAC of the packet data, and of the id in front of it if include_header is set
+ */
+static void packet_hmac(const csp_packet_t *packet, uint32_t length, bool include_header,
+                        uint8_t mac[CRYPTO_HMAC_LEN]) {
+    make_ready();
+    if (include_header) {
+        crypto_hmac(&hmac_ctx, &packet->id, length + sizeof(packet->id), mac);
+    } else {
+        crypto_hmac(&hmac_ctx, packet->data, length, mac);
+    }
+}
+
+int csp_hmac_append(csp_packet_t *packet, bool include_header) {
+    uint8_t mac[CRYPTO_HMAC_LEN];
+
+    if (packet == NULL) {
+        return CSP_ERR_INVAL;
+    }
+    packet_hmac(packet, packet->length, include_header, mac);
+    memcpy(&packet->data[packet->length], mac, CSP_HMAC_LENGTH);
+    packet->length += CSP_HMAC_LENGTH;
+    return CSP_ERR_NONE;
+}
+
+int csp_hmac_verify(csp_packet_t *packet, bool include_header) {
+    uint8_t mac[CRYPTO_HMAC_LEN];
+
+    if (packet == NULL) {
+        return CSP_ERR_INVAL;
+    }
+    if (packet->length < CSP_HMAC_LENGTH) {
+        return CSP_ERR_HMAC;
+    }
+    packet_hmac(packet, packet->length - CSP_HMAC_LENGTH, include_header, mac);
+    if (memcmp(&packet->data[packet->length - CSP_HMAC_LENGTH], mac, CSP_HMAC_LENGTH) != 0) {
+        return CSP_ERR_HMAC;
+    }
+    packet->length -= CSP_HMAC_LENGTH;
+    return CSP_ERR_NONE;
+}
+
+int csp_xtea_set_key(const void *key, uint32_t keylen) {
+    if (key == NULL || keylen < CRYPTO_XTEA_KEY_LEN) {
+        return CSP_ERR_INVAL;
+    }
+    crypto_xtea_init(&xtea_ctx, key, CRYPTO_XTEA_KEY_LEN);
+    xtea_ready = true;
+    return CSP_ERR_NONE;
+}
+
+/**
+ * @brief
+ *      Encrypt in place and move the counter in iv[1] on by a block count, as libcsp does
+ */
+int csp_xtea_encrypt(void *plain, uint32_t len, uint32_t iv[2]) {
+    if (plain == NULL || iv == NULL) {
+        return CSP_ERR_INVAL;
+    }
+    make_ready();
+    crypto_xtea_csp(&xtea_ctx, plain, len, iv);
+    iv[1] += (len + CRYPTO_XTEA_BLOCK_LEN - 1) / CRYPTO_XTEA_BLOCK_LEN;
+    return CSP_ERR_NONE;
+}
+
+int csp_xtea_decrypt(void *cipher, uint32_t len, uint32_t iv[2]) { return csp_xtea_encrypt(cipher, len, iv); }
@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file csp_pool.c
+ * @date 2026-10-19
+ */
+
+#include "csp_pool.h"
+#include <string.h>
+
+#define ALIGN_UP(n) (((n) + CSP_POOL_ALIGN - 1) / CSP_POOL_ALIGN * CSP_POOL_ALIGN)
+
+/* In front of every buffer. The pointer handed out is just past it */
+typedef struct pool_header {
+    struct pool_header *self; // checked on free, catches pointers that did not come from the pool
+    struct pool_header *next; // free list link
+    uint32_t alloc_ms;
+    uint8_t class_index;
+    uint8_t refcount;
+} pool_header;
+
+#define HEADER_SIZE ALIGN_UP(sizeof(pool_header))
+
+typedef struct {
+    uint16_t data_size;
+    uint16_t count;
+    uint16_t free;
+    uint16_t high_water;
+    size_t stride;
+    uint8_t *base;
+    pool_header *free_list;
+    uint32_t allocs;
+    uint32_t fallbacks;
+    uint32_t failures;
+    uint32_t frees;
+    uint64_t hold_total_ms;
+    uint32_t hold_max_ms;
+} pool_class;
+
+static pool_class classes[CSP_POOL_MAX_CLASSES];
+static uint8_t class_count = 0;
+static uint8_t *pool_start, *pool_end;
+static csp_pool_caller_stats callers[CSP_POOL_MAX_CALLERS];
+static uint8_t caller_count = 0;
+
+static size_t prv_stride(uint16_t data_size, size_t overhead) {
+    return HEADER_SIZE + ALIGN_UP(overhead + data_size);
+}
+
+/**
+ * @brief
+ *      Bytes of memory needed for a pool
+ * @param config
+ *      Size classes, smallest first
+ * @param count
+ *      Number of classes
+ * @param overhead
+ *      Bytes in front of the data in every buffer, the packet header
+ */
+size_t csp_pool_memory_size(const csp_pool_class_config *config, uint8_t count, size_t overhead) {
+    size_t size = 0;
+    uint8_t i;
+    for (i = 0; i < count; i++) {
+        size += config[i].count * prv_stride(config[i].data_size, overhead);
+    }
+    return size;
+}
+
+/**
+ * @brief
+ *      Lay the pool out in memory and clear the statistics
+ * @param config
+ *      Size classes, smallest first
+ * @param count
+ *      Number of classes, up to CSP_POOL_MAX_CLASSES
+ * @param overhead
+ *      Bytes in front of the data in every buffer, the packet header
+ * @param memory
+ *      csp_pool_memory_size() bytes aligned to CSP_POOL_ALIGN
+ * @return
+ *      false if the classes are not valid
+ */
+bool csp_pool_init(const csp_pool_class_config *config, uint8_t count, size_t overhead, void *memory) {
+    uint8_t *p = (uint8_t *)memory;
+    uint8_t i;
+    uint16_t j;
+
+    if (count == 0 || count > CSP_POOL_MAX_CLASSES || memory == NULL) {
+        return false;
+    }
+    for (i = 0; i < count; i++) {
+        if (config[i].count == 0 || (i > 0 && config[i].data_size <= config[i - 1].data_size)) {
+            return false;
+        }
+    }
+
+    memset(classes, 0, sizeof(classes));
+    pool_start = p;
+    for (i = 0; i < count; i++) {
+        pool_class *c = &classes[i];
+        c->data_size = config[i].data_size;
+        c->count = config[i].count;
+        c->stride = prv_stride(c->data_size, overhead);
+        c->base = p;
+        // Push in reverse so the first buffer is handed out first
+        for (j = c->count; j > 0; j--) {
+            pool_header *h = (pool_header *)(c->base + (j - 1) * c->stride);
+            h->self = h;
+            h->class_index = i;
+            h->refcount = 0;
+            h->next = c->free_list;
+            c->free_list = h;
+        }
+        c->free = c->count;
+        p += c->count * c->stride;
+    }
+    pool_end = p;
+    class_count = count;
+    memset(callers, 0, sizeof(callers));
+    caller_count = 0;
+    return true;
+}
+
+/**
+ * @brief
+ *      Count a failed request against the task that made it
+ */
+static void prv_caller_failed(const char *caller) {
+    uint8_t i;
+
+    if (caller == NULL) {
+        caller = "ISR";
+    }
+    for (i = 0; i < caller_count; i++) {
+        if (strncmp(callers[i].name, caller, CSP_POOL_NAME_LEN) == 0) {
+            callers[i].failures++;
+            return;
+        }
+    }
+    if (caller_count < CSP_POOL_MAX_CALLERS - 1) {
+        i = caller_count++;
+        strncpy(callers[i].name, caller, CSP_POOL_NAME_LEN - 1);
+    } else {
+        i = CSP_POOL_MAX_CALLERS - 1;
+        if (caller_count < CSP_POOL_MAX_CALLERS) {
+            caller_count++;
+            strncpy(callers[i].name, "other", CSP_POOL_NAME_LEN - 1);
+        }
+    }
+    callers[i].failures++;
+}
+
+/**
+ * @brief
+ *      Take a buffer with room for at least size bytes of data
+ * @param size
+ *      Bytes of data after the packet header
+ * @param caller
+ *      Name of the task asking, NULL from an interrupt
+ * @param now_ms
+ *      Current time, for the hold time statistics
+ * @return
+ *      The buffer, or NULL if size is too big or every class it fits is empty
+ */
+void *csp_pool_get(size_t size, const char *caller, uint32_t now_ms) {
+    uint8_t fit, i;
+
+    for (fit = 0; fit < class_count && classes[fit].data_size < size; fit++) {
+    }
+    if (fit == class_count) {
+        prv_caller_failed(caller);
+        return NULL;
+    }
+    for (i = fit; i < class_count && classes[i].free == 0; i++) {
+    }
+    if (i == class_count) {
+        classes[fit].failures++;
+        prv_caller_failed(caller);
+        return NULL;
+    }
+    if (i != fit) {
+        classes[fit].fallbacks++;
+    }
+
+    pool_class *c = &classes[i];
+    pool_header *h = c->free_list;
+    c->free_list = h->next;
+    c->free--;
+    c->allocs++;
+    if (c->count - c->free > c->high_water) {
+        c->high_water = c->count - c->free;
+    }
+    h->refcount = 1;
+    h->alloc_ms = now_ms;
+    return (uint8_t *)h + HEADER_SIZE;
+}
+
+/**
+ * @brief
+ *      Find the header of a buffer, NULL if the pointer did not come from the pool
+ */
+static pool_header *prv_header(const void *buffer) {
+    const uint8_t *p = (const uint8_t *)buffer;
+    pool_header *h;
+
+    if (p < pool_start + HEADER_SIZE || p >= pool_end) {
+        return NULL;
+    }
+    h = (pool_header *)(p - HEADER_SIZE);
+    if ((((uintptr_t)h - (uintptr_t)pool_start) % CSP_POOL_ALIGN) != 0 || h->self != h ||
+        h->class_index >= class_count) {
+        return NULL;
+    }
+    return h;
+}
+
+/**
+ * @brief
+ *      Drop a reference to a buffer, returning it to its class with the last one
+ * @return
+ *      false if the buffer is not from the pool or is already free
+ */
+bool csp_pool_free(void *buffer, uint32_t now_ms) {
+    pool_header *h = prv_header(buffer);
+    pool_class *c;
+    uint32_t held;
+
+    if (h == NULL || h->refcount == 0) {
+        return false;
+    }
+    if (--h->refcount > 0) {
+        return true;
+    }
+    c = &classes[h->class_index];
+    held = now_ms - h->alloc_ms;
+    c->frees++;
+    c->hold_total_ms += held;
+    if (held > c->hold_max_ms) {
+        c->hold_max_ms = held;
+    }
+    h->next = c->free_list;
+    c->free_list = h;
+    c->free++;
+    return true;
+}
+
+/**
+ * @brief
+ *      Add a reference to a buffer, it then takes one more free to return it
+ */
+bool csp_pool_ref(void *buffer) {
+    pool_header *h = prv_header(buffer);
+    if (h == NULL || h->refcount == 0 || h->refcount == UINT8_MAX) {
+        return false;
+    }
+    h->refcount++;
+    return true;
+}
+
+/**
+ * @brief
+ *      Bytes of data a buffer has room for, which can be more than was asked for
+ */
+size_t csp_pool_capacity(const void *buffer) {
+    pool_header *h = prv_header(buffer);
+    return h == NULL ? 0 : classes[h->class_index].data_size;
+}
+
+size_t csp_pool_max_size(void) { return class_count == 0 ? 0 : classes[class_count - 1].data_size; }
+
+/**
+ * @brief
+ *      Free buffers in all classes
+ */
+uint32_t csp_pool_remaining(void) {
+    uint32_t remaining = 0;
+    uint8_t i;
+    for (i = 0; i < class_count; i++) {
+        remaining += classes[i].free;
+    }
+    return remaining;
+}
+
+/**
+ * @brief
+ *      Copy out the statistics of each class
+ * @details
+ *      Finding the oldest buffer in use walks every buffer of the class, so this is
+ *      for telemetry rather than the packet path
+ * @return
+ *      Number of classes copied
+ */
+uint8_t csp_pool_get_stats(csp_pool_class_stats *out, uint8_t max, uint32_t now_ms) {
+    uint8_t i;
+    uint16_t j;
+
+    for (i = 0; i < class_count && i < max; i++) {
+        pool_class *c = &classes[i];
+        csp_pool_class_stats *s = &out[i];
+        s->data_size = c->data_size;
+        s->count = c->count;
+        s->free = c->free;
+        s->high_water = c->high_water;
+        s->allocs = c->allocs;
+        s->fallbacks = c->fallbacks;
+        s->failures = c->failures;
+        s->hold_avg_ms = c->frees == 0 ? 0 : (uint32_t)(c->hold_total_ms / c->frees);
+        s->hold_max_ms = c->hold_max_ms;
+        s->oldest_ms = 0;
+        for (j = 0; j < c->count; j++) {
+            pool_header *h = (pool_header *)(c->base + j * c->stride);
+            if (h->refcount > 0 && now_ms - h->alloc_ms > s->oldest_ms) {
+                s->oldest_ms = now_ms - h->alloc_ms;
+            }
+        }
+    }
+    return i;
+}
+
+/**
+ * @brief
+ *      Copy out the failed requests of each task
+ * @return
+ *      Number of tasks copied
+ */
+uint8_t csp_pool_get_callers(csp_pool_caller_stats *out, uint8_t max) {
+    uint8_t n = caller_count < max ? caller_count : max;
+    memcpy(out, callers, n * sizeof(csp_pool_caller_stats));
+    return n;
+}
+
+/**
+ * @brief
+ *      Clear the counters, leaving the buffers in use as they are
+ */
+void csp_pool_reset_stats(void) {
+    uint8_t i;
+    for (i = 0; i < class_count; i++) {
+        pool_class *c = &classes[i];
+        c->high_water = c->count - c->free;
+        c->allocs = c->fallbacks = c->failures = c->frees = 0;
+        c->hold_total_ms = 0;
+        c->hold_max_ms = 0;
+    }
+    memset(callers, 0, sizeof(callers));
+    caller_count = 0;
+}
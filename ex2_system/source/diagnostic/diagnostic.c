@@ -562,6 +562,10 @@ SAT_returnState start_diagnostic_daemon(void) {
     }
 #endif
 #endif
+    if (start_task_stats_daemon() == SATR_OK) {
+        sys_log(INFO, "Task statistics sampler started.");
+    }
+
     if (xTaskCreate(boot_counter_reset, "BootRst", 128, NULL, 1, NULL) != pdPASS) {
         sys_log(ERROR, "FAILED TO CREATE TASK BootRst.");
     }
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file heap_stats.c
+ * @date 2026-10-19
+ */
+
+#include "diagnostic/heap_stats.h"
+#include <FreeRTOS.h>
+#include <string.h>
+
+static uint16_t prv_clip16(uint32_t value) { return value > UINT16_MAX ? UINT16_MAX : (uint16_t)value; }
+
+/**
+ * @brief
+ *      Summarise heap and size class use for housekeeping
+ * @details
+ *      Walks the heap free list with the scheduler suspended
+ */
+void heap_stats_get_hk(heap_stats_hk *hk) {
+    HeapStats_t heap;
+    mem_region_stats region;
+    uint8_t i;
+
+    vPortGetHeapStats(&heap);
+    memset(hk, 0, sizeof(*hk));
+    hk->free_bytes = heap.xAvailableHeapSpaceInBytes;
+    hk->min_free_bytes = heap.xMinimumEverFreeBytesRemaining;
+    hk->largest_free_block = heap.xSizeOfLargestFreeBlockInBytes;
+    hk->free_blocks = prv_clip16(heap.xNumberOfFreeBlocks);
+    hk->failed_allocations = prv_clip16(heap.xNumberOfFailedAllocations);
+    hk->largest_failed_request = heap.xLargestFailedRequest;
+    hk->region_spills = prv_clip16(mem_region_spills());
+    for (i = 0; mem_region_get_stats(i, &region); i++) {
+        hk->region_peak[i] = region.peak_in_use > UINT8_MAX ? UINT8_MAX : (uint8_t)region.peak_in_use;
+    }
+}
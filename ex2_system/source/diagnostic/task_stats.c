@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file task_stats.c
+ * @date 2026-10-19
+ */
+
+#include "diagnostic/task_stats.h"
+#include <string.h>
+
+typedef struct {
+    bool active;
+    uint8_t priority;
+    uint8_t samples; // valid entries in the windows, up to TASK_STATS_WINDOW
+    uint16_t stack_free;
+    char name[TASK_STATS_NAME_LEN];
+    uint32_t last_run_time;
+    uint16_t cpu[TASK_STATS_WINDOW];
+    uint16_t latency_avg_us[TASK_STATS_WINDOW];
+    uint16_t latency_max_us[TASK_STATS_WINDOW];
+
+    // written by the kernel hooks, consumed by task_stats_update
+    bool ready_pending;
+    uint32_t ready_at;
+    uint32_t latency_sum;
+    uint32_t latency_max;
+    uint16_t latency_count;
+} task_record;
+
+static task_record records[TASK_STATS_MAX_TASKS];
+static uint8_t window_pos = 0;
+static uint32_t last_total_run_time = 0;
+static bool have_total = false;
+
+/**
+ * @brief
+ *      Note that a task became ready to run
+ * @param number
+ *      TCB number of the task
+ * @param cycles
+ *      Current run time counter
+ */
+void task_stats_ready(uint32_t number, uint32_t cycles) {
+    if (number >= TASK_STATS_MAX_TASKS || records[number].ready_pending) {
+        return;
+    }
+    records[number].ready_pending = true;
+    records[number].ready_at = cycles;
+}
+
+/**
+ * @brief
+ *      Note that a task started running, completing a ready to running latency measurement
+ */
+void task_stats_switched_in(uint32_t number, uint32_t cycles) {
+    if (number >= TASK_STATS_MAX_TASKS || !records[number].ready_pending) {
+        return;
+    }
+    task_record *rec = &records[number];
+    uint32_t latency = cycles - rec->ready_at;
+    rec->ready_pending = false;
+    rec->latency_sum += latency;
+    if (latency > rec->latency_max) {
+        rec->latency_max = latency;
+    }
+    rec->latency_count++;
+}
+
+static uint16_t prv_cycles_to_us(uint32_t cycles) {
+    uint32_t us = cycles / TASK_STATS_CYCLES_PER_US;
+    return us > UINT16_MAX ? UINT16_MAX : (uint16_t)us;
+}
+
+/**
+ * @brief
+ *      Add one sample period to the rolling statistics
+ * @details
+ *      Latency accumulators are read and cleared, so the caller must mask the
+ *      kernel hooks while this runs. Tasks missing from tasks are treated as deleted
+ * @param tasks
+ *      Every task in the system, as reported by uxTaskGetSystemState
+ * @param total_run_time
+ *      Run time counter when tasks was filled in
+ */
+void task_stats_update(const task_stats_input *tasks, size_t count, uint32_t total_run_time) {
+    bool seen[TASK_STATS_MAX_TASKS] = {false};
+    uint32_t elapsed = total_run_time - last_total_run_time;
+    bool first = !have_total;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (tasks[i].number >= TASK_STATS_MAX_TASKS) {
+            continue;
+        }
+        task_record *rec = &records[tasks[i].number];
+        seen[tasks[i].number] = true;
+
+        if (!rec->active) {
+            // new task, its run time so far is not attributable to any one period
+            rec->active = true;
+            rec->samples = 0;
+            rec->last_run_time = tasks[i].run_time;
+            rec->latency_sum = 0;
+            rec->latency_max = 0;
+            rec->latency_count = 0;
+            strncpy(rec->name, tasks[i].name, TASK_STATS_NAME_LEN - 1);
+            rec->name[TASK_STATS_NAME_LEN - 1] = '\0';
+            rec->priority = tasks[i].priority;
+            rec->stack_free = tasks[i].stack_free;
+            continue;
+        }
+
+        rec->priority = tasks[i].priority;
+        rec->stack_free = tasks[i].stack_free;
+        if (first || elapsed == 0) {
+            rec->last_run_time = tasks[i].run_time;
+            continue;
+        }
+
+        uint32_t ran = tasks[i].run_time - rec->last_run_time;
+        rec->last_run_time = tasks[i].run_time;
+        uint32_t cpu = (uint32_t)(((uint64_t)ran * 10000) / elapsed);
+        rec->cpu[window_pos] = cpu > 10000 ? 10000 : (uint16_t)cpu;
+        rec->latency_avg_us[window_pos] =
+            rec->latency_count ? prv_cycles_to_us(rec->latency_sum / rec->latency_count) : 0;
+        rec->latency_max_us[window_pos] = prv_cycles_to_us(rec->latency_max);
+        rec->latency_sum = 0;
+        rec->latency_max = 0;
+        rec->latency_count = 0;
+        if (rec->samples < TASK_STATS_WINDOW) {
+            rec->samples++;
+        }
+    }
+
+    for (i = 0; i < TASK_STATS_MAX_TASKS; i++) {
+        if (!seen[i]) {
+            records[i].active = false;
+            records[i].ready_pending = false;
+        }
+    }
+
+    if (!first && elapsed != 0) {
+        window_pos = (window_pos + 1) % TASK_STATS_WINDOW;
+    }
+    last_total_run_time = total_run_time;
+    have_total = true;
+}
+
+/**
+ * @brief
+ *      Forget all tasks and samples
+ */
+void task_stats_reset(void) {
+    memset(records, 0, sizeof(records));
+    window_pos = 0;
+    last_total_run_time = 0;
+    have_total = false;
+}
+
+/**
+ * @brief
+ *      Number of tasks being tracked
+ */
+uint8_t task_stats_count(void) {
+    uint8_t count = 0;
+    int i;
+    for (i = 0; i < TASK_STATS_MAX_TASKS; i++) {
+        if (records[i].active) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void prv_fill_entry(uint8_t number, task_stats_entry *entry) {
+    const task_record *rec = &records[number];
+    uint32_t cpu_sum = 0;
+    uint32_t latency_sum = 0;
+    int i;
+
+    memset(entry, 0, sizeof(*entry));
+    memcpy(entry->name, rec->name, TASK_STATS_NAME_LEN);
+    entry->number = number;
+    entry->priority = rec->priority;
+    entry->stack_free = rec->stack_free;
+    if (rec->samples == 0) {
+        return;
+    }
+
+    // the window is only partly filled until TASK_STATS_WINDOW samples have been taken,
+    // and the filled part always ends just before window_pos
+    entry->cpu_min = UINT16_MAX;
+    for (i = 0; i < rec->samples; i++) {
+        int slot = (window_pos + TASK_STATS_WINDOW - 1 - i) % TASK_STATS_WINDOW;
+        cpu_sum += rec->cpu[slot];
+        latency_sum += rec->latency_avg_us[slot];
+        if (rec->cpu[slot] < entry->cpu_min) {
+            entry->cpu_min = rec->cpu[slot];
+        }
+        if (rec->cpu[slot] > entry->cpu_max) {
+            entry->cpu_max = rec->cpu[slot];
+        }
+        if (rec->latency_max_us[slot] > entry->latency_max_us) {
+            entry->latency_max_us = rec->latency_max_us[slot];
+        }
+    }
+    entry->cpu_avg = cpu_sum / rec->samples;
+    entry->latency_avg_us = latency_sum / rec->samples;
+}
+
+/**
+ * @brief
+ *      Copy out statistics for tracked tasks, in TCB number order
+ * @param first
+ *      Index of the first tracked task to copy, for paging through the list
+ * @param max
+ *      Number of entries out has room for
+ * @return
+ *      Entries copied
+ */
+size_t task_stats_get(uint8_t first, task_stats_entry *out, size_t max) {
+    size_t copied = 0;
+    uint8_t index = 0;
+    int i;
+    for (i = 0; i < TASK_STATS_MAX_TASKS && copied < max; i++) {
+        if (!records[i].active) {
+            continue;
+        }
+        if (index++ < first) {
+            continue;
+        }
+        prv_fill_entry((uint8_t)i, &out[copied++]);
+    }
+    return copied;
+}
+
+/**
+ * @brief
+ *      Summarise the tracked tasks for housekeeping
+ */
+void task_stats_get_hk(task_stats_hk *hk) {
+    task_stats_entry entry;
+    int i;
+
+    memset(hk, 0, sizeof(*hk));
+    hk->min_stack_free = UINT16_MAX;
+    for (i = 0; i < TASK_STATS_MAX_TASKS; i++) {
+        if (!records[i].active) {
+            continue;
+        }
+        prv_fill_entry((uint8_t)i, &entry);
+        hk->task_count++;
+        if (strcmp(entry.name, "IDLE") == 0) {
+            hk->idle_cpu_avg = entry.cpu_avg;
+        } else if (entry.cpu_avg >= hk->busiest_cpu_avg) {
+            hk->busiest_task = entry.number;
+            hk->busiest_cpu_avg = entry.cpu_avg;
+        }
+        if (entry.stack_free < hk->min_stack_free) {
+            hk->min_stack_task = entry.number;
+            hk->min_stack_free = entry.stack_free;
+        }
+        if (entry.latency_max_us >= hk->worst_latency_us) {
+            hk->worst_latency_task = entry.number;
+            hk->worst_latency_us = entry.latency_max_us;
+        }
+    }
+    if (hk->task_count == 0) {
+        hk->min_stack_free = 0;
+    }
+}
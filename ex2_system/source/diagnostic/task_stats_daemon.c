@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file task_stats_daemon.c
+ * @date 2026-10-19
+ */
+
+#include "diagnostic/diagnostic.h"
+#include "diagnostic/task_stats.h"
+#include <FreeRTOS.h>
+#include <os_task.h>
+#include "logger/logger.h"
+
+static TaskStatus_t task_status[TASK_STATS_MAX_TASKS];
+static task_stats_input task_input[TASK_STATS_MAX_TASKS];
+
+/**
+ * @brief
+ *      Samples run time and stack use of every task each TASK_STATS_PERIOD_MS
+ */
+static void task_stats_daemon(void *pvParameters) {
+    TickType_t last_wake = xTaskGetTickCount();
+    for (;;) {
+        uint32_t total_run_time;
+        UBaseType_t count = uxTaskGetSystemState(task_status, TASK_STATS_MAX_TASKS, &total_run_time);
+        UBaseType_t i;
+
+        for (i = 0; i < count; i++) {
+            task_input[i].number = task_status[i].xTaskNumber;
+            task_input[i].name = task_status[i].pcTaskName;
+            task_input[i].priority = task_status[i].uxCurrentPriority;
+            task_input[i].run_time = task_status[i].ulRunTimeCounter;
+            task_input[i].stack_free = task_status[i].usStackHighWaterMark;
+        }
+
+        // keep the kernel hooks out while their accumulators are collected
+        taskENTER_CRITICAL();
+        task_stats_update(task_input, count, total_run_time);
+        taskEXIT_CRITICAL();
+
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(TASK_STATS_PERIOD_MS));
+    }
+}
+
+/**
+ * @brief
+ *      Start the task statistics sampler
+ * @return SAT_returnState
+ *      success report
+ */
+SAT_returnState start_task_stats_daemon(void) {
+    if (xTaskCreate(task_stats_daemon, "task_stats", TASK_STATS_DM_SIZE, NULL, SYSTEM_STATS_TASK_PRIO, NULL) !=
+        pdPASS) {
+        sys_log(ERROR, "FAILED TO CREATE TASK task_stats");
+        return SATR_ERROR;
+    }
+    return SATR_OK;
+}
@@ -10,6 +10,15 @@
 #include "flash_defines.h"
 #include "F021.h"
 #include "bl_flash.h"
+#include "eeprom.h"
+#include "eeprom_log.h"
+#include "FreeRTOS.h"
+#include "os_semphr.h"
+#include "os_task.h"
+#include <stdbool.h>
+#include <string.h>
+
+static SemaphoreHandle_t eeprom_mutex = NULL;
 
 static const SECTORS *eeprom_get_sector_by_block(uint8_t block) {
     const SECTORS *sector = 0;
@@ -25,41 +34,140 @@ static const SECTORS *eeprom_get_sector_by_block(uint8_t block) {
     return sector;
 }
 
-Fapi_StatusType eeprom_write(void *dat, uint8_t block, uint32_t size) {
-    // find address of block
+static Fapi_StatusType eeprom_legacy_read(void *dat, uint8_t block, uint32_t size) {
     const SECTORS *sector = eeprom_get_sector_by_block(block);
     if (sector == 0) {
         return Fapi_Error_InvalidAddress;
     }
-
     void *addr = sector->start;
     uint32_t sector_size = sector->length;
 
     if (size > sector_size) {
         return Fapi_Error_AsyncIncorrectDataBufferLength;
     }
+    memcpy(dat, addr, size);
+    return Fapi_Status_Success;
+}
+
+static void eeprom_lock() {
+    if (eeprom_mutex != NULL && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        xSemaphoreTake(eeprom_mutex, portMAX_DELAY);
+    }
+}
+
+static void eeprom_unlock() {
+    if (eeprom_mutex != NULL && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        xSemaphoreGive(eeprom_mutex);
+    }
+}
+
+/**
+ * @brief
+ *      Create the EEPROM lock and mount the record log
+ * @details
+ *      Must be called before the scheduler starts. Without it (e.g. in the
+ *      bootloader) accesses are unlocked and the log mounts on first use.
+ */
+Fapi_StatusType eeprom_init() {
+    if (eeprom_mutex == NULL) {
+        eeprom_mutex = xSemaphoreCreateMutex();
+    }
+    return eeprom_log_mount();
+}
+
+/**
+ * @brief
+ *      True for the blocks the bootloader reads. It is built separately and only knows the
+ *      one-sector-per-block layout, so these stay out of the log
+ */
+static bool eeprom_is_bootloader_block(uint8_t block) {
+    return block == BOOT_INFO_BLOCKNUMBER || block == APP_STATUS_BLOCKNUMBER || block == GOLD_STATUS_BLOCKNUMBER ||
+           block == UPDATE_INFO_BLOCKNUMBER;
+}
+
+static Fapi_StatusType eeprom_legacy_write(void *dat, uint8_t block, uint32_t size) {
+    const SECTORS *sector = eeprom_get_sector_by_block(block);
+    if (sector == 0) {
+        return Fapi_Error_InvalidAddress;
+    }
+    if (size > sector->length) {
+        return Fapi_Error_AsyncIncorrectDataBufferLength;
+    }
+    if (memcmp(sector->start, dat, size) == 0) {
+        // Already stored, skip the erase
+        return Fapi_Status_Success;
+    }
+    Fapi_StatusType status = eeprom_flash_erase(block);
+    if (status == Fapi_Status_Success) {
+        status = eeprom_flash_program(block, 0, dat, size);
+    }
+    return status;
+}
+
+Fapi_StatusType eeprom_write(void *dat, uint8_t block, uint32_t size) {
+    Fapi_StatusType status;
+    eeprom_lock();
+    if (eeprom_is_bootloader_block(block)) {
+        status = eeprom_legacy_write(dat, block, size);
+    } else {
+        status = eeprom_log_write(block, dat, size);
+    }
+    eeprom_unlock();
+    return status;
+}
+
+Fapi_StatusType eeprom_read(void *dat, uint8_t block, uint32_t size) {
+    Fapi_StatusType status;
+    eeprom_lock();
+    if (eeprom_is_bootloader_block(block)) {
+        status = eeprom_legacy_read(dat, block, size);
+    } else {
+        status = eeprom_log_read(block, dat, size);
+        if (status == Fapi_Error_Fail) {
+            // Never written through the log, fall back to the pre-log one-sector-per-block layout
+            status = eeprom_legacy_read(dat, block, size);
+        }
+    }
+    eeprom_unlock();
+    return status;
+}
+
+Fapi_StatusType eeprom_flash_erase(uint8_t block) {
+    const SECTORS *sector = eeprom_get_sector_by_block(block);
+    if (sector == 0) {
+        return Fapi_Error_InvalidAddress;
+    }
     raise_privilege();
-    uint32_t status = Fapi_BlockErase((uint32_t)addr, size);
-    status = Fapi_BlockProgram(7, (uint32_t)addr, (uint32_t)dat, size);
+    uint32_t status = Fapi_BlockErase((uint32_t)sector->start, sector->length);
     reset_privilege();
     return (Fapi_StatusType)status;
 }
 
-Fapi_StatusType eeprom_read(void *dat, uint8_t block, uint32_t size) {
+Fapi_StatusType eeprom_flash_program(uint8_t block, uint32_t offset, const void *data, uint32_t size) {
     const SECTORS *sector = eeprom_get_sector_by_block(block);
     if (sector == 0) {
         return Fapi_Error_InvalidAddress;
     }
-    void *addr = sector->start;
-    uint32_t sector_size = sector->length;
+    if (offset + size > sector->length) {
+        return Fapi_Error_AsyncIncorrectDataBufferLength;
+    }
+    raise_privilege();
+    uint32_t status = Fapi_BlockProgram(7, (uint32_t)sector->start + offset, (uint32_t)data, size);
+    reset_privilege();
+    if (status == 0 && memcmp((uint8_t *)sector->start + offset, data, size) != 0) {
+        return Fapi_Error_Fail;
+    }
+    return (Fapi_StatusType)status;
+}
 
+Fapi_StatusType eeprom_flash_read(uint8_t block, uint32_t offset, void *data, uint32_t size) {
+    const SECTORS *sector = eeprom_get_sector_by_block(block);
     if (sector == 0) {
         return Fapi_Error_InvalidAddress;
     }
-
-    if (size > sector_size) {
+    if (offset + size > sector->length) {
         return Fapi_Error_AsyncIncorrectDataBufferLength;
     }
-    memcpy(dat, addr, size);
+    memcpy(data, (uint8_t *)sector->start + offset, size);
     return Fapi_Status_Success;
 }
@@ -0,0 +1,420 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file eeprom_log.c
+ * @date 2026-10-19
+ */
+
+#include "eeprom_log.h"
+#include "crc16.h"
+#include <string.h>
+
+#define EEPROM_LOG_SECTOR_MAGIC 0x454C4F47 // "ELOG"
+#define EEPROM_LOG_RECORD_MAGIC 0xA55A
+#define EEPROM_LOG_WORD_LEN 8 // bank 7 is programmed and ECC protected in 64-bit words
+#define EEPROM_LOG_NONE 0xFFFFFFFF
+#define EEPROM_LOG_BLANK_CHUNK 64
+
+#define EEPROM_LOG_ALIGN(x) (((x) + EEPROM_LOG_WORD_LEN - 1) / EEPROM_LOG_WORD_LEN * EEPROM_LOG_WORD_LEN)
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t generation; // increases every time a sector becomes the active one
+} eeprom_log_sector_hdr;
+
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint8_t id;
+    uint8_t reserved;
+    uint16_t length;
+    uint16_t crc; // CRC-16 over this header (crc field zeroed) and the data
+    uint32_t sequence;
+    uint32_t reserved2;
+} eeprom_log_record_hdr;
+
+// sizeof the headers above, which are already whole flash words
+#define EEPROM_LOG_SECTOR_HDR_LEN 8
+#define EEPROM_LOG_RECORD_HDR_LEN 16
+#define EEPROM_LOG_RECORD_LEN(length) (EEPROM_LOG_RECORD_HDR_LEN + EEPROM_LOG_ALIGN(length))
+
+// Every live record must fit in a freshly formatted sector for relocation to succeed
+#if EEPROM_LOG_MAX_RECORDS * EEPROM_LOG_RECORD_LEN(EEPROM_LOG_MAX_DATA_LEN) >                                    \
+    EEPROM_LOG_SECTOR_SIZE - EEPROM_LOG_SECTOR_HDR_LEN
+#error "EEPROM log sectors are too small for EEPROM_LOG_MAX_RECORDS of EEPROM_LOG_MAX_DATA_LEN"
+#endif
+
+#if EEPROM_LOG_NUM_SECTORS < 3
+#error "EEPROM log needs an active, a spare, and at least one history sector"
+#endif
+
+typedef struct {
+    bool mounted;
+    uint8_t active;        // index of the sector currently appended to
+    uint32_t write_offset; // next free byte in the active sector
+    uint32_t next_sequence;
+    uint32_t generation[EEPROM_LOG_NUM_SECTORS]; // 0 for sectors without a valid header
+    uint32_t latest[EEPROM_LOG_MAX_RECORDS];     // log offset of the newest copy, or EEPROM_LOG_NONE
+    uint32_t latest_sequence[EEPROM_LOG_MAX_RECORDS];
+    uint16_t latest_length[EEPROM_LOG_MAX_RECORDS];
+    eeprom_log_stats_t stats;
+} eeprom_log_t;
+
+static eeprom_log_t elog;
+
+// Staging area for a whole record so it is programmed with a single call
+static uint8_t record_buf[EEPROM_LOG_RECORD_LEN(EEPROM_LOG_MAX_DATA_LEN)];
+
+static inline uint8_t log_sector(uint8_t index) { return EEPROM_LOG_FIRST_SECTOR + index; }
+
+static inline uint32_t log_offset(uint8_t index, uint32_t offset) {
+    return (uint32_t)index * EEPROM_LOG_SECTOR_SIZE + offset;
+}
+
+static uint16_t eeprom_log_record_crc(const eeprom_log_record_hdr *hdr, const uint8_t *data) {
+    eeprom_log_record_hdr h = *hdr;
+    h.crc = 0;
+    uint16_t crc = crc16_update(CRC16_SLICE8, CRC16_INIT, &h, sizeof(h));
+    return crc16_update(CRC16_SLICE8, crc, data, hdr->length);
+}
+
+static bool eeprom_log_is_erased(const void *data, uint32_t size) {
+    const uint8_t *p = (const uint8_t *)data;
+    while (size--) {
+        if (*p++ != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool eeprom_log_sector_blank(uint8_t index) {
+    uint8_t chunk[EEPROM_LOG_BLANK_CHUNK];
+    uint32_t offset;
+    for (offset = 0; offset < EEPROM_LOG_SECTOR_SIZE; offset += sizeof(chunk)) {
+        eeprom_flash_read(log_sector(index), offset, chunk, sizeof(chunk));
+        if (!eeprom_log_is_erased(chunk, sizeof(chunk))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static Fapi_StatusType eeprom_log_erase(uint8_t index) {
+    Fapi_StatusType status = eeprom_flash_erase(log_sector(index));
+    elog.generation[index] = 0;
+    elog.stats.erases++;
+    return status;
+}
+
+static Fapi_StatusType eeprom_log_format(uint8_t index, uint32_t generation) {
+    eeprom_log_sector_hdr hdr = {.magic = EEPROM_LOG_SECTOR_MAGIC, .generation = generation};
+    uint8_t buf[EEPROM_LOG_SECTOR_HDR_LEN];
+
+    memset(buf, 0xFF, sizeof(buf));
+    memcpy(buf, &hdr, sizeof(hdr));
+    Fapi_StatusType status = eeprom_flash_program(log_sector(index), 0, buf, sizeof(buf));
+    if (status != Fapi_Status_Success) {
+        return status;
+    }
+    elog.generation[index] = generation;
+    elog.active = index;
+    elog.write_offset = EEPROM_LOG_SECTOR_HDR_LEN;
+    return Fapi_Status_Success;
+}
+
+/**
+ * @brief
+ * 		Program the record staged in record_buf at the end of the active sector
+ * @details
+ * 		The caller has placed the data after the header in record_buf and made
+ * 		sure the record fits in the active sector.
+ */
+static Fapi_StatusType eeprom_log_append(uint8_t id, uint16_t length, uint32_t sequence) {
+    eeprom_log_record_hdr hdr = {0};
+    uint32_t record_len = EEPROM_LOG_RECORD_LEN(length);
+    uint32_t offset = elog.write_offset;
+    uint8_t *data = record_buf + EEPROM_LOG_RECORD_HDR_LEN;
+
+    hdr.magic = EEPROM_LOG_RECORD_MAGIC;
+    hdr.id = id;
+    hdr.reserved = 0xFF;
+    hdr.length = length;
+    hdr.sequence = sequence;
+    hdr.reserved2 = 0xFFFFFFFF;
+    hdr.crc = eeprom_log_record_crc(&hdr, data);
+
+    memset(record_buf, 0xFF, EEPROM_LOG_RECORD_HDR_LEN);
+    memcpy(record_buf, &hdr, sizeof(hdr));
+    memset(data + length, 0xFF, record_len - EEPROM_LOG_RECORD_HDR_LEN - length);
+
+    // The space is consumed even if programming fails part way through
+    elog.write_offset += record_len;
+    elog.stats.writes++;
+    Fapi_StatusType status = eeprom_flash_program(log_sector(elog.active), offset, record_buf, record_len);
+    if (status != Fapi_Status_Success) {
+        return status;
+    }
+
+    elog.latest[id] = log_offset(elog.active, offset);
+    elog.latest_sequence[id] = sequence;
+    elog.latest_length[id] = length;
+    return Fapi_Status_Success;
+}
+
+/**
+ * @brief
+ * 		Move every record whose newest copy is in a sector to the active sector, then erase it
+ */
+static Fapi_StatusType eeprom_log_reclaim(uint8_t index) {
+    uint8_t id;
+    for (id = 0; id < EEPROM_LOG_MAX_RECORDS; id++) {
+        uint32_t latest = elog.latest[id];
+        if (latest == EEPROM_LOG_NONE || latest / EEPROM_LOG_SECTOR_SIZE != index) {
+            continue;
+        }
+        uint16_t length = elog.latest_length[id];
+        if (elog.write_offset + EEPROM_LOG_RECORD_LEN(length) > EEPROM_LOG_SECTOR_SIZE) {
+            return Fapi_Error_Fail;
+        }
+        eeprom_flash_read(log_sector(index), latest % EEPROM_LOG_SECTOR_SIZE + EEPROM_LOG_RECORD_HDR_LEN,
+                          record_buf + EEPROM_LOG_RECORD_HDR_LEN, length);
+        Fapi_StatusType status = eeprom_log_append(id, length, elog.latest_sequence[id]);
+        if (status != Fapi_Status_Success) {
+            return status;
+        }
+    }
+    return eeprom_log_erase(index);
+}
+
+/**
+ * @brief
+ * 		Start appending to the spare sector and free the oldest sector as the new spare
+ */
+static Fapi_StatusType eeprom_log_rotate(void) {
+    uint8_t next = (elog.active + 1) % EEPROM_LOG_NUM_SECTORS;
+    uint8_t victim = (next + 1) % EEPROM_LOG_NUM_SECTORS;
+    Fapi_StatusType status;
+
+    if (!eeprom_log_sector_blank(next)) {
+        status = eeprom_log_erase(next);
+        if (status != Fapi_Status_Success) {
+            return status;
+        }
+    }
+    status = eeprom_log_format(next, elog.generation[elog.active] + 1);
+    if (status != Fapi_Status_Success) {
+        return status;
+    }
+    if (elog.generation[victim] != 0 || !eeprom_log_sector_blank(victim)) {
+        status = eeprom_log_reclaim(victim);
+    }
+    return status;
+}
+
+/**
+ * @brief
+ * 		Walk the records of one sector, updating the newest copy of each record
+ * @return uint32_t
+ * 		Offset just past the last readable record
+ */
+static uint32_t eeprom_log_scan(uint8_t index) {
+    uint32_t offset = EEPROM_LOG_SECTOR_HDR_LEN;
+    eeprom_log_record_hdr hdr;
+    uint8_t *data = record_buf + EEPROM_LOG_RECORD_HDR_LEN;
+
+    while (offset + EEPROM_LOG_RECORD_HDR_LEN <= EEPROM_LOG_SECTOR_SIZE) {
+        eeprom_flash_read(log_sector(index), offset, &hdr, sizeof(hdr));
+        if (eeprom_log_is_erased(&hdr, sizeof(hdr))) {
+            break;
+        }
+        if (hdr.magic != EEPROM_LOG_RECORD_MAGIC || hdr.id >= EEPROM_LOG_MAX_RECORDS ||
+            hdr.length > EEPROM_LOG_MAX_DATA_LEN ||
+            offset + EEPROM_LOG_RECORD_LEN(hdr.length) > EEPROM_LOG_SECTOR_SIZE) {
+            // Torn header, nothing after it can be trusted and nothing more may be appended here
+            elog.stats.corrupt_records++;
+            return EEPROM_LOG_SECTOR_SIZE;
+        }
+
+        eeprom_flash_read(log_sector(index), offset + EEPROM_LOG_RECORD_HDR_LEN, data, hdr.length);
+        if (eeprom_log_record_crc(&hdr, data) != hdr.crc) {
+            elog.stats.corrupt_records++;
+        } else {
+            // Sectors are scanned oldest first, so an equal sequence is a newer relocated copy
+            if (elog.latest[hdr.id] == EEPROM_LOG_NONE || hdr.sequence >= elog.latest_sequence[hdr.id]) {
+                elog.latest[hdr.id] = log_offset(index, offset);
+                elog.latest_sequence[hdr.id] = hdr.sequence;
+                elog.latest_length[hdr.id] = hdr.length;
+            }
+            if (hdr.sequence >= elog.next_sequence) {
+                elog.next_sequence = hdr.sequence + 1;
+            }
+        }
+        offset += EEPROM_LOG_RECORD_LEN(hdr.length);
+    }
+    return offset;
+}
+
+/**
+ * @brief
+ * 		Rebuild the record index from flash
+ * @details
+ * 		Formats the first log sector if no sector has a valid header, and finishes
+ * 		a rotation that was interrupted by a reset.
+ * @return Fapi_StatusType
+ * 		Fapi_Status_Success, or the F021 status of a failed erase/program
+ */
+Fapi_StatusType eeprom_log_mount(void) {
+    eeprom_log_sector_hdr hdr;
+    uint8_t index;
+    uint8_t i;
+    bool found = false;
+
+    memset(&elog, 0, sizeof(elog));
+    memset(elog.latest, 0xFF, sizeof(elog.latest));
+    elog.next_sequence = 1;
+
+    for (index = 0; index < EEPROM_LOG_NUM_SECTORS; index++) {
+        eeprom_flash_read(log_sector(index), 0, &hdr, sizeof(hdr));
+        if (hdr.magic == EEPROM_LOG_SECTOR_MAGIC && hdr.generation != 0 && hdr.generation != EEPROM_LOG_NONE) {
+            elog.generation[index] = hdr.generation;
+            if (!found || hdr.generation > elog.generation[elog.active]) {
+                elog.active = index;
+                found = true;
+            }
+        }
+    }
+
+    if (!found) {
+        Fapi_StatusType status = Fapi_Status_Success;
+        if (!eeprom_log_sector_blank(0)) {
+            status = eeprom_log_erase(0);
+        }
+        if (status == Fapi_Status_Success) {
+            status = eeprom_log_format(0, 1);
+        }
+        elog.mounted = status == Fapi_Status_Success;
+        return status;
+    }
+
+    // Sectors are used in a ring, so starting after the active one visits them oldest first
+    for (i = 1; i <= EEPROM_LOG_NUM_SECTORS; i++) {
+        index = (elog.active + i) % EEPROM_LOG_NUM_SECTORS;
+        if (elog.generation[index] != 0) {
+            uint32_t end = eeprom_log_scan(index);
+            if (index == elog.active) {
+                elog.write_offset = end;
+            }
+        }
+    }
+    elog.mounted = true;
+
+    // A reset during rotation can leave the sector after the active one holding data
+    index = (elog.active + 1) % EEPROM_LOG_NUM_SECTORS;
+    if (elog.generation[index] != 0 || !eeprom_log_sector_blank(index)) {
+        return eeprom_log_reclaim(index);
+    }
+    return Fapi_Status_Success;
+}
+
+/**
+ * @brief
+ * 		Store a new version of a record
+ * @details
+ * 		Costs a single program of the record unless the active sector is full.
+ * 		Writing data identical to the stored version does not touch flash.
+ * @param id
+ * 		Record number, below EEPROM_LOG_MAX_RECORDS
+ * @param data
+ * 		Record contents
+ * @param size
+ * 		Length of data, at most EEPROM_LOG_MAX_DATA_LEN
+ * @return Fapi_StatusType
+ * 		Fapi_Status_Success, or an F021 error status
+ */
+Fapi_StatusType eeprom_log_write(uint8_t id, const void *data, uint32_t size) {
+    uint8_t *staged = record_buf + EEPROM_LOG_RECORD_HDR_LEN;
+    Fapi_StatusType status;
+
+    if (id >= EEPROM_LOG_MAX_RECORDS) {
+        return Fapi_Error_InvalidAddress;
+    }
+    if (size > EEPROM_LOG_MAX_DATA_LEN) {
+        return Fapi_Error_AsyncIncorrectDataBufferLength;
+    }
+    if (!elog.mounted) {
+        status = eeprom_log_mount();
+        if (status != Fapi_Status_Success) {
+            return status;
+        }
+    }
+
+    if (elog.latest[id] != EEPROM_LOG_NONE && elog.latest_length[id] == size) {
+        eeprom_flash_read(log_sector(elog.latest[id] / EEPROM_LOG_SECTOR_SIZE),
+                          elog.latest[id] % EEPROM_LOG_SECTOR_SIZE + EEPROM_LOG_RECORD_HDR_LEN, staged, size);
+        if (memcmp(staged, data, size) == 0) {
+            elog.stats.skipped_writes++;
+            return Fapi_Status_Success;
+        }
+    }
+
+    if (elog.write_offset + EEPROM_LOG_RECORD_LEN(size) > EEPROM_LOG_SECTOR_SIZE) {
+        status = eeprom_log_rotate();
+        if (status != Fapi_Status_Success) {
+            return status;
+        }
+    }
+
+    memcpy(staged, data, size);
+    return eeprom_log_append(id, size, elog.next_sequence++);
+}
+
+/**
+ * @brief
+ * 		Read the newest valid version of a record
+ * @details
+ * 		If the stored record is shorter than size the remainder is zeroed.
+ * @param id
+ * 		Record number, below EEPROM_LOG_MAX_RECORDS
+ * @param data
+ * 		Buffer to fill
+ * @param size
+ * 		Length of data
+ * @return Fapi_StatusType
+ * 		Fapi_Status_Success, or Fapi_Error_Fail if no valid copy of the record exists
+ */
+Fapi_StatusType eeprom_log_read(uint8_t id, void *data, uint32_t size) {
+    Fapi_StatusType status;
+    uint32_t length;
+
+    if (id >= EEPROM_LOG_MAX_RECORDS) {
+        return Fapi_Error_InvalidAddress;
+    }
+    if (!elog.mounted) {
+        status = eeprom_log_mount();
+        if (status != Fapi_Status_Success) {
+            return status;
+        }
+    }
+    if (elog.latest[id] == EEPROM_LOG_NONE) {
+        return Fapi_Error_Fail;
+    }
+
+    length = elog.latest_length[id] < size ? elog.latest_length[id] : size;
+    eeprom_flash_read(log_sector(elog.latest[id] / EEPROM_LOG_SECTOR_SIZE),
+                      elog.latest[id] % EEPROM_LOG_SECTOR_SIZE + EEPROM_LOG_RECORD_HDR_LEN, data, length);
+    memset((uint8_t *)data + length, 0, size - length);
+    return Fapi_Status_Success;
+}
+
+void eeprom_log_get_stats(eeprom_log_stats_t *stats) { *stats = elog.stats; }
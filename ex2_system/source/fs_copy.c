@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file fs_copy.c
+ * @date 2026-10-19
+ */
+
+#include "fs_copy.h"
+#include <FreeRTOS.h>
+#include <os_queue.h>
+#include <os_semphr.h>
+#include <os_task.h>
+#include <redposix.h>
+#include "printf.h"
+#include <string.h>
+#include "logger/logger.h"
+
+static fs_copy_job_t jobs[FS_COPY_MAX_JOBS];
+static uint8_t chunk[FS_COPY_CHUNK_SIZE];
+static QueueHandle_t job_queue = NULL;
+static SemaphoreHandle_t job_lock = NULL;
+static uint8_t next_id = 0;
+
+/**
+ * @brief
+ *      Copy a byte range of one file to a new file
+ * @details
+ *      dst is created or truncated and receives bytes [offset, offset + length)
+ *      of src. Transfers are buf_len bytes, so with a multiple of the block
+ *      size every write to dst covers whole blocks. dst must not be src, under
+ *      any name: it is checked before dst is truncated.
+ * @param length
+ *      Bytes to copy, or FS_COPY_TO_END. Clipped to the end of src
+ * @param buf
+ *      Transfer buffer
+ * @param copied
+ *      Optional. Updated after every transfer so another task can show progress
+ * @param total
+ *      Optional. Set to the number of bytes that will be copied
+ * @return
+ *      0 on success, -1 with red_errno set on failure
+ */
+int32_t fs_copy_range(const char *src, const char *dst, uint32_t offset, uint32_t length, void *buf,
+                      uint32_t buf_len, volatile uint32_t *copied, uint32_t *total) {
+    REDSTAT st;
+    int32_t ret = -1;
+    uint32_t done = 0;
+
+    int32_t from_fd = red_open(src, RED_O_RDONLY);
+    if (from_fd < 0) {
+        return -1;
+    }
+    if (red_fstat(from_fd, &st) < 0) {
+        red_close(from_fd);
+        return -1;
+    }
+    if (offset > st.st_size) {
+        red_close(from_fd);
+        red_errno = RED_EINVAL;
+        return -1;
+    }
+    if (length > st.st_size - offset) {
+        length = (uint32_t)(st.st_size - offset);
+    }
+    if (total != NULL) {
+        *total = length;
+    }
+    if (red_lseek(from_fd, offset, RED_SEEK_SET) < 0) {
+        red_close(from_fd);
+        return -1;
+    }
+
+    // Truncate only once dst is known not to be src, which would lose the data to copy
+    int32_t to_fd = red_open(dst, RED_O_WRONLY | RED_O_CREAT);
+    if (to_fd < 0) {
+        red_close(from_fd);
+        return -1;
+    }
+    REDSTAT dst_st;
+    if (red_fstat(to_fd, &dst_st) < 0) {
+        red_close(to_fd);
+        red_close(from_fd);
+        return -1;
+    }
+    if (dst_st.st_dev == st.st_dev && dst_st.st_ino == st.st_ino) {
+        red_close(to_fd);
+        red_close(from_fd);
+        red_errno = RED_EINVAL;
+        return -1;
+    }
+    if (red_ftruncate(to_fd, 0) < 0) {
+        red_close(to_fd);
+        red_close(from_fd);
+        return -1;
+    }
+
+    while (done < length) {
+        uint32_t want = length - done < buf_len ? length - done : buf_len;
+        int32_t bytes_read = red_read(from_fd, buf, want);
+        if (bytes_read <= 0) {
+            if (bytes_read == 0) {
+                red_errno = RED_EIO; // file shrank underneath us
+            }
+            break;
+        }
+        int32_t bytes_written = red_write(to_fd, buf, (uint32_t)bytes_read);
+        if (bytes_written != bytes_read) {
+            if (bytes_written >= 0) {
+                red_errno = RED_ENOSPC; // a short write means the volume filled up
+            }
+            break;
+        }
+        done += (uint32_t)bytes_read;
+        if (copied != NULL) {
+            *copied = done;
+        }
+    }
+    if (done == length) {
+        ret = 0;
+    }
+
+    // Keep the first error, not one from closing
+    int32_t err = red_errno;
+    red_close(to_fd);
+    red_close(from_fd);
+    red_errno = err;
+    return ret;
+}
+
+/**
+ * @brief
+ *      Resolve a path against the working directory of the calling task
+ * @details
+ *      Reliance Edge keeps the working directory per task, so a relative path
+ *      must be made absolute before it is handed to the copy task.
+ * @param out
+ *      FS_COPY_PATH_MAX bytes
+ * @return
+ *      false if the working directory cannot be read or the result is too long
+ */
+static bool fs_copy_absolute_path(const char *path, char *out) {
+    char cwd[FS_COPY_PATH_MAX];
+    int len;
+
+    if (strchr(path, ':') != NULL) {
+        // Has a volume prefix, already absolute
+        len = snprintf(out, FS_COPY_PATH_MAX, "%s", path);
+        return len >= 0 && len < FS_COPY_PATH_MAX;
+    }
+    if (red_getcwd(cwd, sizeof(cwd)) == NULL) {
+        return false;
+    }
+    if (path[0] == REDCONF_PATH_SEPARATOR) {
+        // Root of the current volume, keep only its prefix
+        char *prefix_end = strchr(cwd, ':');
+        if (prefix_end != NULL) {
+            prefix_end[1] = '\0';
+        } else {
+            cwd[0] = '\0';
+        }
+        len = snprintf(out, FS_COPY_PATH_MAX, "%s%s", cwd, path);
+    } else {
+        size_t cwd_len = strlen(cwd);
+        bool has_separator = cwd_len > 0 && cwd[cwd_len - 1] == REDCONF_PATH_SEPARATOR;
+        len = snprintf(out, FS_COPY_PATH_MAX, "%s%s%s", cwd, has_separator ? "" : "/", path);
+    }
+    return len >= 0 && len < FS_COPY_PATH_MAX;
+}
+
+/**
+ * @brief
+ *      Queue a background copy
+ * @details
+ *      Relative paths are resolved against the working directory of the
+ *      calling task here, since the copy runs on another task.
+ * @param length
+ *      Bytes to copy, or FS_COPY_TO_END
+ * @return
+ *      Job id, or -1 if a path cannot be resolved or is too long, src and dst are the same file,
+ *      or every job slot is busy
+ */
+int fs_copy_start(const char *src, const char *dst, uint32_t offset, uint32_t length) {
+    char src_path[FS_COPY_PATH_MAX];
+    char dst_path[FS_COPY_PATH_MAX];
+    fs_copy_job_t *job = NULL;
+    int index;
+
+    if (job_lock == NULL || !fs_copy_absolute_path(src, src_path) || !fs_copy_absolute_path(dst, dst_path)) {
+        return -1;
+    }
+    if (strcmp(src_path, dst_path) == 0) {
+        return -1; // would truncate src before reading it, fs_copy_range also checks other names
+    }
+    xSemaphoreTake(job_lock, portMAX_DELAY);
+    for (index = 0; index < FS_COPY_MAX_JOBS; index++) {
+        if (jobs[index].state != FS_COPY_QUEUED && jobs[index].state != FS_COPY_RUNNING) {
+            job = &jobs[index];
+            break;
+        }
+    }
+    if (job == NULL) {
+        xSemaphoreGive(job_lock);
+        return -1;
+    }
+    memset(job, 0, sizeof(*job));
+    job->id = next_id++;
+    job->state = FS_COPY_QUEUED;
+    job->offset = offset;
+    job->total = length;
+    strcpy(job->src, src_path);
+    strcpy(job->dst, dst_path);
+    int id = job->id;
+    xSemaphoreGive(job_lock);
+
+    uint8_t slot = (uint8_t)index;
+    xQueueSend(job_queue, &slot, 0); // cannot fail, one entry per slot
+    return id;
+}
+
+/**
+ * @brief
+ *      Copy out a job slot for reporting
+ * @return
+ *      false once index is past the last slot
+ */
+bool fs_copy_get_job(uint8_t index, fs_copy_job_t *job) {
+    if (index >= FS_COPY_MAX_JOBS || job_lock == NULL) {
+        return false;
+    }
+    xSemaphoreTake(job_lock, portMAX_DELAY);
+    memcpy(job, &jobs[index], sizeof(*job));
+    xSemaphoreGive(job_lock);
+    return true;
+}
+
+/**
+ * @brief
+ *      Runs queued copies one at a time through the shared chunk buffer
+ */
+static void fs_copy_daemon(void *pvParameters) {
+    uint8_t slot;
+    for (;;) {
+        xQueueReceive(job_queue, &slot, portMAX_DELAY);
+        fs_copy_job_t *job = &jobs[slot];
+
+        // src, dst, offset and length are not touched by anyone else until the job finishes
+        xSemaphoreTake(job_lock, portMAX_DELAY);
+        job->state = FS_COPY_RUNNING;
+        xSemaphoreGive(job_lock);
+        int32_t ret = fs_copy_range(job->src, job->dst, job->offset, job->total, chunk, sizeof(chunk),
+                                    &job->copied, &job->total);
+
+        xSemaphoreTake(job_lock, portMAX_DELAY);
+        if (ret == 0) {
+            job->state = FS_COPY_DONE;
+        } else {
+            job->state = FS_COPY_FAILED;
+            job->error = red_errno;
+            sys_log(WARN, "copy %s to %s failed: %d", job->src, job->dst, job->error);
+        }
+        xSemaphoreGive(job_lock);
+    }
+}
+
+/**
+ * @brief
+ *      Start the background file copy task
+ * @return SAT_returnState
+ *      success report
+ */
+SAT_returnState start_fs_copy_daemon(void) {
+    job_queue = xQueueCreate(FS_COPY_MAX_JOBS, sizeof(uint8_t));
+    job_lock = xSemaphoreCreateMutex();
+    if (job_queue == NULL || job_lock == NULL) {
+        return SATR_ERROR;
+    }
+    if (xTaskCreate(fs_copy_daemon, "fs_copy", FS_COPY_DM_SIZE, NULL, FS_COPY_TASK_PRIO, NULL) != pdPASS) {
+        sys_log(ERROR, "FAILED TO CREATE TASK fs_copy");
+        return SATR_ERROR;
+    }
+    return SATR_OK;
+}
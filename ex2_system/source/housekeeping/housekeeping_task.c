@@ -23,6 +23,7 @@
 #include <os_task.h>
 
 #include "housekeeping_service.h"
+#include "housekeeping/hk_collector.h"
 #include "housekeeping_task.h"
 
 static void *housekeeping_daemon(void *pvParameters);
@@ -51,6 +52,14 @@ static void *housekeeping_daemon(void *pvParameters) {
  *   error report of task creation
  */
 SAT_returnState start_housekeeping_daemon(void) {
+    if (housekeeping_init() != SATR_OK) {
+        ex2_log("FAILED TO CREATE housekeeping locks\n");
+        return SATR_ERROR;
+    }
+    if (hk_collector_start() != SATR_OK) {
+        ex2_log("FAILED TO START housekeeping collector\n");
+        return SATR_ERROR;
+    }
     if (xTaskCreate((TaskFunction_t)housekeeping_daemon, "housekeeping_daemon", HK_DM_SIZE, NULL,
                     HOUSEKEEPING_TASK_PRIO, NULL) != pdPASS) {
         ex2_log("FAILED TO CREATE TASK housekeeping_daemon\n");
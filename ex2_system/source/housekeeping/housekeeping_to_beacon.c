@@ -28,7 +28,7 @@ static EPS_reset_TypeDef determine_eps_last_reset_reason(uint32_t reg);
  *      The pointer to where housekeeping data is kept
  */
 
-void update_beacon(All_systems_housekeeping *all_hk_data, beacon_packet_1_t *beacon_packet_one,
+void update_beacon(const All_systems_housekeeping *all_hk_data, beacon_packet_1_t *beacon_packet_one,
                    beacon_packet_2_t *beacon_packet_two) {
 
     /*-------META-------*/
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file image_flash.c
+ * @date 2026-10-19
+ */
+
+/* Main flash access for image_update.c, over the bootloader's F021 routines */
+
+#include "image_update.h"
+#include "F021.h"
+#include "bl_flash.h"
+#include "flash_defines.h"
+#include "privileged_functions.h"
+#include <string.h>
+
+static const SECTORS *image_flash_find(uint32_t address) {
+    for (int i = 0; i < NUMBEROFSECTORS; i++) {
+        uint32_t start = (uint32_t)flash_sector[i].start;
+        if (flash_sector[i].bankNumber != 7 && address >= start && address - start < flash_sector[i].length) {
+            return &flash_sector[i];
+        }
+    }
+    return 0;
+}
+
+bool image_flash_sector(uint32_t address, uint32_t *start, uint32_t *length) {
+    const SECTORS *sector = image_flash_find(address);
+    if (sector == 0) {
+        return false;
+    }
+    *start = (uint32_t)sector->start;
+    *length = sector->length;
+    return true;
+}
+
+Fapi_StatusType image_flash_erase(uint32_t start, uint32_t length) {
+    raise_privilege();
+    uint32_t status = Fapi_BlockErase(start, length);
+    reset_privilege();
+    if (status == 0 && Flash_Erase_Check(start, length) != 0) {
+        return Fapi_Error_Fail;
+    }
+    return (Fapi_StatusType)status;
+}
+
+Fapi_StatusType image_flash_program(uint32_t address, const void *data, uint32_t size) {
+    const SECTORS *sector = image_flash_find(address);
+    if (sector == 0) {
+        return Fapi_Error_InvalidAddress;
+    }
+    raise_privilege();
+    uint32_t status = Fapi_BlockProgram(sector->bankNumber, address, (uint32_t)data, size);
+    reset_privilege();
+    if (status == 0 && memcmp((const void *)address, data, size) != 0) {
+        return Fapi_Error_Fail;
+    }
+    return (Fapi_StatusType)status;
+}
+
+Fapi_StatusType image_flash_read(uint32_t address, void *data, uint32_t size) {
+    memcpy(data, (const void *)address, size);
+    return Fapi_Status_Success;
+}
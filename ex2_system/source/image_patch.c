@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file image_patch.c
+ * @date 2026-10-19
+ */
+
+#include "image_patch.h"
+#include "bl_eeprom.h"
+#include "crc16.h"
+#include "eeprom.h"
+#include <string.h>
+
+typedef enum {
+    PATCH_IDLE,
+    PATCH_HEADER,
+    PATCH_OP,
+    PATCH_COPY_FROM, // varint base offset of a copy
+    PATCH_LENGTH,    // varint length of any op
+    PATCH_FILL_BYTE,
+    PATCH_DATA,
+    PATCH_DONE
+} patch_state;
+
+// Not locked: the updater service, on its own worker, is the only caller
+static struct {
+    patch_state state;
+    uint32_t next; // patch bytes taken so far
+    uint8_t header[IMAGE_PATCH_HEADER_LEN];
+    uint8_t header_len;
+    image_info base; // golden image the copies read from
+    uint32_t size;   // bytes in the new image
+    uint8_t op;
+    uint32_t varint;
+    uint8_t varint_len;
+    uint32_t copy_from; // base offset of the next byte to copy
+    uint32_t remaining; // bytes the current op has still to produce
+    uint32_t written;   // bytes of the new image handed to image_update_write
+    uint8_t buf[IMAGE_PATCH_BUF_LEN];
+    uint32_t buf_len;
+} patch;
+
+static uint32_t get_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t get_be16(const uint8_t *p) { return (uint16_t)((p[0] << 8) | p[1]); }
+
+static image_update_status flush(void) {
+    image_update_status status = image_update_write(patch.written, patch.buf, patch.buf_len);
+    if (status != IMAGE_UPDATE_OK) {
+        // Only a flash error, nothing else writes to the update
+        return status;
+    }
+    patch.written += patch.buf_len;
+    patch.buf_len = 0;
+    return IMAGE_UPDATE_OK;
+}
+
+/**
+ * @brief
+ *      Add the output of an op to the staging buffer, programming it each time it fills
+ * @param data
+ *      Bytes of the new image, or NULL to copy from the base image at copy_from
+ * @param fill
+ *      Byte repeated when data is NULL and the op is a fill
+ */
+static image_update_status emit(const uint8_t *data, uint8_t fill, uint32_t len) {
+    while (len > 0) {
+        uint32_t n = IMAGE_PATCH_BUF_LEN - patch.buf_len;
+        if (n > len) {
+            n = len;
+        }
+        if (data != NULL) {
+            memcpy(&patch.buf[patch.buf_len], data, n);
+            data += n;
+        } else if (patch.op == IMAGE_PATCH_COPY) {
+            if (image_flash_read(patch.base.addr + patch.copy_from, &patch.buf[patch.buf_len], n) !=
+                Fapi_Status_Success) {
+                return IMAGE_UPDATE_FLASH_ERROR;
+            }
+            patch.copy_from += n;
+        } else {
+            memset(&patch.buf[patch.buf_len], fill, n);
+        }
+        patch.buf_len += n;
+        len -= n;
+        if (patch.buf_len == IMAGE_PATCH_BUF_LEN) {
+            image_update_status status = flush();
+            if (status != IMAGE_UPDATE_OK) {
+                return status;
+            }
+        }
+    }
+    return IMAGE_UPDATE_OK;
+}
+
+/**
+ * @brief
+ *      Check the patch applies to the golden image, then begin the update it builds
+ */
+static image_update_status start_image(void) {
+    uint16_t crc = CRC16_INIT;
+
+    if (get_be32(&patch.header[0]) != IMAGE_PATCH_MAGIC) {
+        return IMAGE_UPDATE_BAD_ARGS;
+    }
+    if (eeprom_get_golden_info(&patch.base) != Fapi_Status_Success) {
+        return IMAGE_UPDATE_EEPROM_ERROR;
+    }
+    if (patch.base.exists != EXISTS_FLAG || patch.base.size != get_be32(&patch.header[4]) ||
+        patch.base.crc != get_be16(&patch.header[8])) {
+        return IMAGE_UPDATE_BAD_SOURCE;
+    }
+    // Every copy trusts the base, so check it once rather than each read
+    if (image_flash_crc(patch.base.addr, patch.base.size, &crc) != Fapi_Status_Success) {
+        return IMAGE_UPDATE_FLASH_ERROR;
+    }
+    if (crc != patch.base.crc) {
+        return IMAGE_UPDATE_BAD_SOURCE;
+    }
+
+    patch.size = get_be32(&patch.header[10]);
+    patch.state = PATCH_OP;
+    return image_update_begin(APP_DEFAULT_ADDR, patch.size, get_be16(&patch.header[14]));
+}
+
+static image_update_status start_op(uint8_t op) {
+    patch.op = op;
+    switch (op) {
+    case IMAGE_PATCH_COPY:
+        patch.state = PATCH_COPY_FROM;
+        return IMAGE_UPDATE_OK;
+    case IMAGE_PATCH_DATA:
+    case IMAGE_PATCH_FILL:
+        patch.state = PATCH_LENGTH;
+        return IMAGE_UPDATE_OK;
+    case IMAGE_PATCH_END:
+        if (patch.written + patch.buf_len != patch.size) {
+            return IMAGE_UPDATE_BAD_ARGS;
+        }
+        patch.state = PATCH_DONE;
+        return patch.buf_len > 0 ? flush() : IMAGE_UPDATE_OK;
+    default:
+        return IMAGE_UPDATE_BAD_ARGS;
+    }
+}
+
+/**
+ * @brief
+ *      Act on an argument once the last byte of its varint has arrived
+ */
+static image_update_status end_varint(uint32_t value) {
+    if (patch.state == PATCH_COPY_FROM) {
+        // Zigzag decode; the offset wraps like the two's complement delta it encodes
+        patch.copy_from += (value >> 1) ^ (0U - (value & 1U));
+        patch.state = PATCH_LENGTH;
+        return IMAGE_UPDATE_OK;
+    }
+
+    if (value > patch.size - patch.written - patch.buf_len) {
+        return IMAGE_UPDATE_BAD_ARGS;
+    }
+    switch (patch.op) {
+    case IMAGE_PATCH_COPY:
+        if (patch.copy_from > patch.base.size || value > patch.base.size - patch.copy_from) {
+            return IMAGE_UPDATE_BAD_ARGS;
+        }
+        patch.state = PATCH_OP;
+        return emit(NULL, 0, value);
+    case IMAGE_PATCH_DATA:
+        patch.remaining = value;
+        patch.state = value > 0 ? PATCH_DATA : PATCH_OP;
+        return IMAGE_UPDATE_OK;
+    default:
+        patch.remaining = value;
+        patch.state = PATCH_FILL_BYTE;
+        return IMAGE_UPDATE_OK;
+    }
+}
+
+static image_update_status varint_byte(uint8_t byte) {
+    // The last of the five bytes only has the top four bits of a uint32_t to give
+    if (patch.varint_len == IMAGE_PATCH_VARINT_MAX - 1 && (byte & 0xF0) != 0) {
+        return IMAGE_UPDATE_BAD_ARGS;
+    }
+    patch.varint |= (uint32_t)(byte & 0x7F) << (7 * patch.varint_len);
+    patch.varint_len++;
+    if (byte & 0x80) {
+        return IMAGE_UPDATE_OK;
+    }
+    uint32_t value = patch.varint;
+    patch.varint = 0;
+    patch.varint_len = 0;
+    return end_varint(value);
+}
+
+/**
+ * @brief
+ *      Run the parser over the next part of the patch, one byte at a time except
+ *      for the bytes of a data op
+ */
+static image_update_status apply(const uint8_t *data, uint32_t len) {
+    image_update_status status = IMAGE_UPDATE_OK;
+
+    while (len > 0 && status == IMAGE_UPDATE_OK) {
+        uint32_t used = 1;
+        switch (patch.state) {
+        case PATCH_HEADER:
+            patch.header[patch.header_len++] = *data;
+            if (patch.header_len == IMAGE_PATCH_HEADER_LEN) {
+                status = start_image();
+            }
+            break;
+        case PATCH_OP:
+            status = start_op(*data);
+            break;
+        case PATCH_COPY_FROM:
+        case PATCH_LENGTH:
+            status = varint_byte(*data);
+            break;
+        case PATCH_FILL_BYTE:
+            patch.state = PATCH_OP;
+            status = emit(NULL, *data, patch.remaining);
+            break;
+        case PATCH_DATA:
+            used = len < patch.remaining ? len : patch.remaining;
+            patch.remaining -= used;
+            if (patch.remaining == 0) {
+                patch.state = PATCH_OP;
+            }
+            status = emit(data, 0, used);
+            break;
+        default:
+            // Bytes after the end of the patch
+            status = IMAGE_UPDATE_BAD_ARGS;
+            break;
+        }
+        data += used;
+        len -= used;
+        patch.next += used;
+    }
+    return status;
+}
+
+/**
+ * @brief
+ *      Start applying a new patch, abandoning any patch in progress
+ * @details
+ *      The update itself begins once the patch header has arrived and been checked
+ *      against the golden image
+ * @return image_update_status
+ */
+image_update_status image_patch_begin(void) {
+    memset(&patch, 0, sizeof(patch));
+    patch.state = PATCH_HEADER;
+    return IMAGE_UPDATE_OK;
+}
+
+/**
+ * @brief
+ *      Apply the next chunk of the patch
+ * @details
+ *      A chunk already applied, resent because its reply was lost, is accepted and
+ *      ignored. Any error abandons the patch and the update, which must then be
+ *      started again from image_patch_begin
+ * @param offset
+ *      Position of the chunk in the patch
+ * @param data
+ *      Chunk data
+ * @param len
+ *      Bytes in the chunk, any number
+ * @return image_update_status
+ *      IMAGE_UPDATE_OUT_OF_ORDER when the patch must be resent from image_patch_next
+ */
+image_update_status image_patch_write(uint32_t offset, const void *data, uint32_t len) {
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    if (patch.state == PATCH_IDLE) {
+        return IMAGE_UPDATE_NOT_STARTED;
+    }
+    if (len == 0) {
+        return IMAGE_UPDATE_BAD_ARGS;
+    }
+    if (offset > patch.next) {
+        return IMAGE_UPDATE_OUT_OF_ORDER;
+    }
+    if (offset + len <= patch.next) {
+        return IMAGE_UPDATE_OK;
+    }
+
+    image_update_status status = apply(bytes + (patch.next - offset), len - (patch.next - offset));
+    if (status != IMAGE_UPDATE_OK) {
+        bool began = patch.state != PATCH_HEADER;
+        memset(&patch, 0, sizeof(patch));
+        if (began) {
+            image_update_abort();
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief
+ *      Verify the rebuilt image and make it the application, see image_update_finish
+ * @return image_update_status
+ */
+image_update_status image_patch_finish(void) {
+    if (patch.state == PATCH_IDLE) {
+        return IMAGE_UPDATE_NOT_STARTED;
+    }
+    if (patch.state != PATCH_DONE) {
+        return IMAGE_UPDATE_INCOMPLETE;
+    }
+    image_update_status status = image_update_finish();
+    if (status == IMAGE_UPDATE_OK) {
+        memset(&patch, 0, sizeof(patch));
+    }
+    return status;
+}
+
+/**
+ * @brief
+ *      Offset in the patch the next chunk must start at
+ */
+uint32_t image_patch_next(void) { return patch.next; }
@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file image_update.c
+ * @date 2026-10-19
+ */
+
+#include "image_update.h"
+#include "bl_eeprom.h"
+#include "crc16.h"
+#include "eeprom.h"
+#include <string.h>
+
+#define IMAGE_UPDATE_READ_CHUNK 64
+
+typedef enum { FLASH_BLANK, FLASH_SAME, FLASH_DIRTY } flash_state;
+
+// Not locked: the updater service, on its own worker, is the only caller
+static struct {
+    update_info info;    // as last checkpointed to the EEPROM
+    uint32_t next;       // write pointer, in bytes from info.start_address
+    uint32_t erased_end; // flash from the write pointer up to this address has been erased for this update
+    uint16_t crc;        // running CRC of the first next bytes
+} update;
+
+static inline bool update_active(void) { return update.info.initialized == EXISTS_FLAG; }
+
+static image_update_status checkpoint(void) {
+    update.info.next_address = update.info.start_address + update.next;
+    if (eeprom_set_update_info(&update.info) != Fapi_Status_Success) {
+        return IMAGE_UPDATE_EEPROM_ERROR;
+    }
+    return IMAGE_UPDATE_OK;
+}
+
+static image_update_status clear_update(void) {
+    memset(&update, 0, sizeof(update));
+    return eeprom_set_update_info(&update.info) == Fapi_Status_Success ? IMAGE_UPDATE_OK
+                                                                        : IMAGE_UPDATE_EEPROM_ERROR;
+}
+
+static bool slot_valid(uint32_t address, uint32_t size) {
+    uint32_t start, length;
+    if (size == 0 || address < APP_MINIMUM_ADDR || address >= IMAGE_UPDATE_SLOT_END ||
+        size > IMAGE_UPDATE_SLOT_END - address) {
+        return false;
+    }
+    // Erasing ahead works in whole sectors, so the image must start on one
+    return image_flash_sector(address, &start, &length) && start == address;
+}
+
+/**
+ * @brief
+ *      Continue a CRC over flash that has already been programmed
+ */
+Fapi_StatusType image_flash_crc(uint32_t address, uint32_t len, uint16_t *crc) {
+    uint8_t buf[IMAGE_UPDATE_READ_CHUNK];
+    while (len > 0) {
+        uint32_t n = len < sizeof(buf) ? len : sizeof(buf);
+        Fapi_StatusType status = image_flash_read(address, buf, n);
+        if (status != Fapi_Status_Success) {
+            return status;
+        }
+        *crc = crc16_slice8(*crc, buf, n);
+        address += n;
+        len -= n;
+    }
+    return Fapi_Status_Success;
+}
+
+/**
+ * @brief
+ *      Compare the flash a chunk is about to be programmed into with the chunk
+ * @details
+ *      Flash past the write pointer is normally blank. After a reset it can already
+ *      hold chunks written after the last checkpoint, which are skipped when they
+ *      match, or one the reset cut off part way through
+ */
+static flash_state flash_compare(uint32_t address, const uint8_t *data, uint32_t len) {
+    uint8_t buf[IMAGE_UPDATE_READ_CHUNK];
+    bool blank = true, same = true;
+    uint32_t i;
+
+    while (len > 0) {
+        uint32_t n = len < sizeof(buf) ? len : sizeof(buf);
+        if (image_flash_read(address, buf, n) != Fapi_Status_Success) {
+            return FLASH_DIRTY;
+        }
+        for (i = 0; i < n; i++) {
+            blank &= buf[i] == 0xFF;
+            same &= buf[i] == data[i];
+        }
+        address += n;
+        data += n;
+        len -= n;
+    }
+    return same ? FLASH_SAME : blank ? FLASH_BLANK : FLASH_DIRTY;
+}
+
+/**
+ * @brief
+ *      Move the write pointer back to the start of a sector, which is erased again
+ *      before the data is resent
+ */
+static image_update_status rewind_to_sector(uint32_t address) {
+    uint32_t start, length;
+    if (!image_flash_sector(address, &start, &length) || start < update.info.start_address) {
+        return IMAGE_UPDATE_FLASH_ERROR;
+    }
+    update.next = start - update.info.start_address;
+    update.erased_end = start;
+    update.crc = CRC16_INIT;
+    if (image_flash_crc(update.info.start_address, update.next, &update.crc) != Fapi_Status_Success) {
+        return IMAGE_UPDATE_FLASH_ERROR;
+    }
+    return checkpoint();
+}
+
+/**
+ * @brief
+ *      Pick up an update left in progress by a reset
+ * @details
+ *      Call once at start up. The write pointer goes back to the last checkpoint and
+ *      the running CRC is rebuilt from the flash before it. The sector holding the
+ *      checkpoint was erased for this update, so it is not erased again
+ * @return image_update_status
+ *      IMAGE_UPDATE_OK whether or not there was an update to resume
+ */
+image_update_status image_update_resume(void) {
+    uint32_t start, length;
+
+    memset(&update, 0, sizeof(update));
+    if (eeprom_get_update_info(&update.info) != Fapi_Status_Success) {
+        memset(&update, 0, sizeof(update));
+        return IMAGE_UPDATE_EEPROM_ERROR;
+    }
+    if (!update_active()) {
+        memset(&update, 0, sizeof(update));
+        return IMAGE_UPDATE_OK;
+    }
+    if (!slot_valid(update.info.start_address, update.info.size) ||
+        update.info.next_address < update.info.start_address ||
+        update.info.next_address - update.info.start_address > update.info.size) {
+        clear_update();
+        return IMAGE_UPDATE_BAD_ARGS;
+    }
+
+    update.next = update.info.next_address - update.info.start_address;
+    update.erased_end = update.info.next_address;
+    if (image_flash_sector(update.info.next_address, &start, &length) && start != update.info.next_address) {
+        update.erased_end = start + length;
+    }
+    update.crc = CRC16_INIT;
+    if (image_flash_crc(update.info.start_address, update.next, &update.crc) != Fapi_Status_Success) {
+        return IMAGE_UPDATE_FLASH_ERROR;
+    }
+    return IMAGE_UPDATE_OK;
+}
+
+/**
+ * @brief
+ *      Start streaming a new application image, abandoning any update in progress
+ * @details
+ *      The application image_info is cleared first, so the bootloader never runs a
+ *      half written image
+ * @param address
+ *      Where the image goes, the start of a sector in the application slot
+ * @param size
+ *      Bytes in the image
+ * @param crc
+ *      CRC-16 of the whole image, stored in image_info once it is verified
+ * @return image_update_status
+ */
+image_update_status image_update_begin(uint32_t address, uint32_t size, uint16_t crc) {
+    image_info app_info = {0};
+
+    if (!slot_valid(address, size)) {
+        return IMAGE_UPDATE_BAD_ARGS;
+    }
+    if (eeprom_set_app_info(&app_info) != Fapi_Status_Success) {
+        return IMAGE_UPDATE_EEPROM_ERROR;
+    }
+
+    memset(&update, 0, sizeof(update));
+    update.info.start_address = address;
+    update.info.size = size;
+    update.info.initialized = EXISTS_FLAG;
+    update.info.crc = crc;
+    update.erased_end = address;
+    update.crc = CRC16_INIT;
+    image_update_status status = checkpoint();
+    if (status != IMAGE_UPDATE_OK) {
+        memset(&update, 0, sizeof(update));
+    }
+    return status;
+}
+
+/**
+ * @brief
+ *      Program the next chunk of the image
+ * @details
+ *      A chunk the update already has, resent because its reply was lost, is
+ *      accepted without being written again
+ * @param offset
+ *      Position of the chunk in the image, a multiple of IMAGE_UPDATE_ALIGN
+ * @param data
+ *      Chunk data
+ * @param len
+ *      Bytes in the chunk, a multiple of IMAGE_UPDATE_ALIGN unless it ends the image
+ * @return image_update_status
+ *      IMAGE_UPDATE_OUT_OF_ORDER when the data must be resent from progress.next
+ */
+image_update_status image_update_write(uint32_t offset, const void *data, uint32_t len) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t start, length, address;
+
+    if (!update_active()) {
+        return IMAGE_UPDATE_NOT_STARTED;
+    }
+    if (len == 0 || offset > update.info.size || len > update.info.size - offset ||
+        offset % IMAGE_UPDATE_ALIGN != 0 || (len % IMAGE_UPDATE_ALIGN != 0 && offset + len != update.info.size)) {
+        return IMAGE_UPDATE_BAD_ARGS;
+    }
+    if (offset > update.next) {
+        return IMAGE_UPDATE_OUT_OF_ORDER;
+    }
+    if (offset + len <= update.next) {
+        return IMAGE_UPDATE_OK;
+    }
+    // The write pointer is aligned, so this only drops whole flash words
+    bytes += update.next - offset;
+    len -= update.next - offset;
+    address = update.info.start_address + update.next;
+
+    while (address + len > update.erased_end) {
+        if (!image_flash_sector(update.erased_end, &start, &length) || start != update.erased_end ||
+            image_flash_erase(start, length) != Fapi_Status_Success) {
+            return IMAGE_UPDATE_FLASH_ERROR;
+        }
+        update.erased_end = start + length;
+    }
+
+    switch (flash_compare(address, bytes, len)) {
+    case FLASH_BLANK:
+        if (image_flash_program(address, bytes, len) != Fapi_Status_Success) {
+            return IMAGE_UPDATE_FLASH_ERROR;
+        }
+        break;
+    case FLASH_SAME:
+        break;
+    case FLASH_DIRTY: {
+        image_update_status status = rewind_to_sector(address);
+        return status == IMAGE_UPDATE_OK ? IMAGE_UPDATE_OUT_OF_ORDER : status;
+    }
+    }
+
+    update.crc = crc16_slice8(update.crc, bytes, len);
+    update.next += len;
+    if (update.info.start_address + update.next - update.info.next_address >= IMAGE_UPDATE_CHECKPOINT ||
+        update.next == update.info.size) {
+        return checkpoint();
+    }
+    return IMAGE_UPDATE_OK;
+}
+
+/**
+ * @brief
+ *      Verify the complete image and make it the application
+ * @details
+ *      Both the running CRC and a CRC of the image read back from flash must match
+ *      the one given when the update began. Only then is image_info written
+ * @return image_update_status
+ */
+image_update_status image_update_finish(void) {
+    uint16_t crc = CRC16_INIT;
+
+    if (!update_active()) {
+        return IMAGE_UPDATE_NOT_STARTED;
+    }
+    if (update.next != update.info.size) {
+        return IMAGE_UPDATE_INCOMPLETE;
+    }
+    if (update.crc != update.info.crc) {
+        return IMAGE_UPDATE_BAD_CRC;
+    }
+    if (image_flash_crc(update.info.start_address, update.info.size, &crc) != Fapi_Status_Success) {
+        return IMAGE_UPDATE_FLASH_ERROR;
+    }
+    if (crc != update.info.crc) {
+        return IMAGE_UPDATE_BAD_CRC;
+    }
+
+    image_info app_info = {0};
+    app_info.exists = EXISTS_FLAG;
+    app_info.size = update.info.size;
+    app_info.addr = update.info.start_address;
+    app_info.crc = crc;
+    if (eeprom_set_app_info(&app_info) != Fapi_Status_Success) {
+        return IMAGE_UPDATE_EEPROM_ERROR;
+    }
+    return clear_update();
+}
+
+/**
+ * @brief
+ *      Abandon the update in progress. The application slot is left without a valid image
+ */
+image_update_status image_update_abort(void) { return clear_update(); }
+
+void image_update_get_progress(image_update_progress *progress) {
+    progress->active = update_active();
+    progress->address = update.info.start_address;
+    progress->size = update.info.size;
+    progress->next = update.next;
+    progress->crc = update.info.crc;
+    progress->crc_sofar = update.crc;
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file mem_region.c
+ * @date 2026-10-19
+ */
+
+#include "mem_region.h"
+#include <FreeRTOS.h>
+#include <os_task.h>
+#include <string.h>
+
+/* Block sizes are multiples of 8 so every block keeps the heap's alignment */
+static const struct {
+    uint16_t block_size;
+    uint16_t blocks;
+} layout[MEM_REGION_CLASSES] = {
+    {64, 32},  // scheduled commands, GPS messages
+    {128, 16}, // ADCS telemetry frames
+    {1040, 12} // FTP download blocks of up to 1 KiB plus their header, enough for a full S-band queue
+};
+
+typedef struct free_block {
+    struct free_block *next;
+} free_block;
+
+typedef struct {
+    uint8_t *start;
+    uint8_t *end;
+    free_block *free_list;
+    mem_region_stats stats;
+} mem_region;
+
+static mem_region regions[MEM_REGION_CLASSES];
+static uint8_t *arena_start = NULL;
+static uint8_t *arena_end = NULL;
+static uint32_t spills = 0;
+
+/**
+ * @brief
+ *      Carve the size classes out of the heap
+ * @details
+ *      Call once, before anything else allocates, so the arena sits at the
+ *      bottom of the heap and never splits it
+ * @return
+ *      false if the heap could not supply the arena
+ */
+bool mem_region_init(void) {
+    size_t total = 0;
+    int i, j;
+
+    if (arena_start != NULL) {
+        return true;
+    }
+    for (i = 0; i < MEM_REGION_CLASSES; i++) {
+        total += (size_t)layout[i].block_size * layout[i].blocks;
+    }
+    uint8_t *next = pvPortMalloc(total);
+    if (next == NULL) {
+        return false;
+    }
+    arena_start = next;
+    arena_end = next + total;
+
+    for (i = 0; i < MEM_REGION_CLASSES; i++) {
+        mem_region *region = &regions[i];
+        memset(region, 0, sizeof(*region));
+        region->stats.block_size = layout[i].block_size;
+        region->stats.blocks = layout[i].blocks;
+        region->start = next;
+        region->end = next + (size_t)layout[i].block_size * layout[i].blocks;
+
+        // thread the free list through the blocks, lowest address first
+        for (j = layout[i].blocks - 1; j >= 0; j--) {
+            free_block *block = (free_block *)(next + (size_t)j * layout[i].block_size);
+            block->next = region->free_list;
+            region->free_list = block;
+        }
+        next = region->end;
+    }
+    return true;
+}
+
+/**
+ * @brief
+ *      Allocate from the smallest size class that fits and has a free block
+ * @details
+ *      Constant time. Requests no class can take, because they are too big
+ *      or every fitting class is exhausted, fall back to pvPortMalloc
+ * @return
+ *      Pointer to at least size bytes, or NULL
+ */
+void *mem_region_alloc(size_t size) {
+    int i;
+
+    if (size == 0) {
+        return NULL;
+    }
+    for (i = 0; i < MEM_REGION_CLASSES; i++) {
+        if (size <= regions[i].stats.block_size) {
+            break;
+        }
+    }
+    int first = i;
+
+    taskENTER_CRITICAL();
+    for (; i < MEM_REGION_CLASSES; i++) {
+        mem_region *region = &regions[i];
+        free_block *block = region->free_list;
+        if (block == NULL) {
+            continue;
+        }
+        region->free_list = block->next;
+        region->stats.allocations++;
+        region->stats.in_use++;
+        if (region->stats.in_use > region->stats.peak_in_use) {
+            region->stats.peak_in_use = region->stats.in_use;
+        }
+        if (i != first) {
+            regions[first].stats.exhausted++;
+        }
+        taskEXIT_CRITICAL();
+        return block;
+    }
+    if (first < MEM_REGION_CLASSES) {
+        regions[first].stats.exhausted++;
+    }
+    spills++;
+    taskEXIT_CRITICAL();
+
+    return pvPortMalloc(size);
+}
+
+/**
+ * @brief
+ *      Free memory from mem_region_alloc
+ * @param ptr
+ *      Block to free, may be NULL
+ */
+void mem_region_free(void *ptr) {
+    uint8_t *p = ptr;
+    int i;
+
+    if (p == NULL) {
+        return;
+    }
+    if (p < arena_start || p >= arena_end) {
+        vPortFree(ptr);
+        return;
+    }
+    for (i = 0; i < MEM_REGION_CLASSES; i++) {
+        if (p < regions[i].end) {
+            break;
+        }
+    }
+
+    free_block *block = ptr;
+    taskENTER_CRITICAL();
+    block->next = regions[i].free_list;
+    regions[i].free_list = block;
+    regions[i].stats.in_use--;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief
+ *      Copy out the counters of one size class
+ * @return
+ *      false once class_index is past the last class
+ */
+bool mem_region_get_stats(uint8_t class_index, mem_region_stats *stats) {
+    if (class_index >= MEM_REGION_CLASSES) {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    memcpy(stats, &regions[class_index].stats, sizeof(*stats));
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+/**
+ * @brief
+ *      Number of requests that fell back to pvPortMalloc
+ */
+uint32_t mem_region_spills(void) { return spills; }
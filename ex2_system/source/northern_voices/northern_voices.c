@@ -12,6 +12,7 @@
 #include "redposix.h"
 #include "logger/logger.h"
 #include "csp/csp.h"
+#include "csp_buffer_pool.h"
 
 #define NV_DELAY_WAIT vTaskDelay(pdMS_TO_TICKS(5000))
 #define NV_TIME_BETWEEN_SENDS (pdMS_TO_TICKS(10000))
@@ -78,7 +79,13 @@ void nv_daemon(void *pvParameters) {
             }
 
             // Get packet
-            csp_packet_t *packet = csp_buffer_get(sizeof(nv_data_packet_header_t) + read);
+            csp_packet_t *packet = csp_buffer_get_small(sizeof(nv_data_packet_header_t) + read);
+            if (packet == NULL) {
+                sys_log(WARN, "No CSP buffer for NV packet");
+                give_lock(ctx);
+                NV_DELAY_WAIT;
+                continue;
+            }
             packet->length = sizeof(nv_data_packet_header_t) + read;
 
             // Construct header
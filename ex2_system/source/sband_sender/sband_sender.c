@@ -13,6 +13,7 @@
 #include "error_correctionWrapper.h"
 #include "rfModeWrapper.h"
 #include "fec.h"
+#include "mem_region.h"
 
 typedef struct {
     void *data;
@@ -64,7 +65,7 @@ void sband_sender(void *pvParameters) {
                 break;
             }
             sdr_sband_tx(&ifdata, ctx.data, ctx.len);
-            vPortFree(ctx.data);
+            mem_region_free(ctx.data);
         };
         case ENDING: {
             sys_log(INFO, "Ending sband transfer");
@@ -25,6 +25,7 @@
 #include "logger/logger.h"
 #include "scheduler/scheduler_task.h"
 #include "scheduler/scheduler.h"
+#include "mem_region.h"
 
 /* The queue is used by the scheduler service to notify this task that something
  * in ScheduleFile has changed.
@@ -43,7 +44,7 @@ static ScheduledCmd_t* read_cmd(int32_t fd) {
      * progress we can.
      */
     size_t cmd_len = sizeof(ScheduledCmd_t);
-    ScheduledCmd_t *cmd = (ScheduledCmd_t*) pvPortMalloc(cmd_len);
+    ScheduledCmd_t *cmd = (ScheduledCmd_t*) mem_region_alloc(cmd_len);
     if (!cmd) {
         sys_log(NOTICE, "Out of memory?");
         return NULL;
@@ -56,7 +57,7 @@ static ScheduledCmd_t* read_cmd(int32_t fd) {
     if (cnt < 0) {
         sys_log(WARN, "red_read error: %d", (int)red_errno);
     }
-    vPortFree(cmd);
+    mem_region_free(cmd);
     return NULL;
 }
 
@@ -69,7 +70,8 @@ TickType_t schedule_cmd(int32_t fd, ScheduledCmd_t *cmd) {
      * read the next command and determine how long to wait before it's ready.
      */
     TickType_t timeout = pdMS_TO_TICKS(SCHED_TIMEOUT_MS);
-    time_t current_time = RTCMK_Unix_Now();
+    int32_t start_msec;
+    time_t current_time = RTCMK_Unix_Now_Ms(&start_msec);
     TickType_t start = xTaskGetTickCount();
 
     /* Caveat: determining time intervals with time_t and TickType_t is a pain
@@ -99,7 +101,8 @@ TickType_t schedule_cmd(int32_t fd, ScheduledCmd_t *cmd) {
      * prepare the message and connect to the service. Then we can sleep the
      * last few milliseconds and send the message.
      */
-    csp_packet_t *pkt = csp_buffer_get(cmd->len);
+    // Full size, the service replies in this packet
+    csp_packet_t *pkt = csp_buffer_get(csp_buffer_data_size());
     pkt->id.dst = cmd->dst;
     pkt->id.dport = cmd->dport;
     pkt->length = cmd->len;
@@ -115,9 +118,8 @@ TickType_t schedule_cmd(int32_t fd, ScheduledCmd_t *cmd) {
          */
         TickType_t delay = 0;
         wait_msec = wait*1000 + cmd->msecs;
-        int32_t msec = RTCMK_GetMs();
-        if (wait_msec > msec)
-            delay = pdMS_TO_TICKS(wait_msec - msec);
+        if (wait_msec > start_msec)
+            delay = pdMS_TO_TICKS(wait_msec - start_msec);
 
         /* Down to the brass tacks: now-start is the number of ticks since we
          * got the unix time (above).
@@ -158,12 +160,12 @@ TickType_t schedule_cmd(int32_t fd, ScheduledCmd_t *cmd) {
     ScheduledCmd_t *cmds[MAX_NUM_CMDS] = {0};
     int cmd_cnt = 0;
     if (cmd->period == 0) { // non-periodic command
-        vPortFree(cmd);
+        mem_region_free(cmd);
     }
     else {
         cmd->next += cmd->period; // next execution
         if (cmd->last && cmd->next>cmd->last) { // Command has expired
-            vPortFree(cmd);
+            mem_region_free(cmd);
         }
         else {
             cmds[0] = cmd;
@@ -220,7 +222,7 @@ TickType_t schedule_cmd(int32_t fd, ScheduledCmd_t *cmd) {
             if (red_write(fd, cmds[i], sizeof(ScheduledCmd_t)) < 0) {
                 sys_log(WARN, "red_write error: %d", (int)red_errno);
             }
-            vPortFree(cmds[i]);
+            mem_region_free(cmds[i]);
         }
     }
     return timeout;
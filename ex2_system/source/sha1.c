@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file sha1.c
+ * @date 2026-10-19
+ */
+
+#include "sha1.h"
+#include <string.h>
+
+#define ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+static inline uint32_t load_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void store_be32(uint32_t v, uint8_t *p) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+/**
+ * @brief
+ *      Compress one 64 byte block into the state
+ * @details
+ *      The message schedule is kept as a rolling window of 16 words rather than
+ *      all 80, which keeps the stack frame small
+ */
+static void sha1_block(uint32_t h[5], const uint8_t *block) {
+    uint32_t w[16];
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], t;
+    int i;
+
+#define SHA1_W(i) (i < 16 ? w[i] : (t = w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15], \
+                                     w[i & 15] = ROL(t, 1)))
+#define SHA1_ROUND(f, k)                                                                                      \
+    t = ROL(a, 5) + (f) + e + (k) + SHA1_W(i);                                                                \
+    e = d;                                                                                                    \
+    d = c;                                                                                                    \
+    c = ROL(b, 30);                                                                                           \
+    b = a;                                                                                                    \
+    a = t
+
+    for (i = 0; i < 16; i++) {
+        w[i] = load_be32(&block[4 * i]);
+    }
+    // One loop per round function, so no round has to pick its function
+    for (i = 0; i < 20; i++) {
+        SHA1_ROUND(d ^ (b & (c ^ d)), 0x5A827999U);
+    }
+    for (; i < 40; i++) {
+        SHA1_ROUND(b ^ c ^ d, 0x6ED9EBA1U);
+    }
+    for (; i < 60; i++) {
+        SHA1_ROUND((b & c) | (d & (b | c)), 0x8F1BBCDCU);
+    }
+    for (; i < 80; i++) {
+        SHA1_ROUND(b ^ c ^ d, 0xCA62C1D6U);
+    }
+#undef SHA1_ROUND
+#undef SHA1_W
+
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+}
+
+void sha1_init(sha1_state *state) {
+    state->h[0] = 0x67452301U;
+    state->h[1] = 0xEFCDAB89U;
+    state->h[2] = 0x98BADCFEU;
+    state->h[3] = 0x10325476U;
+    state->h[4] = 0xC3D2E1F0U;
+    state->length = 0;
+    state->block_len = 0;
+}
+
+/**
+ * @brief
+ *      Hash more of the message
+ * @details
+ *      Whole blocks are compressed straight from data, only a partial block at
+ *      either end is copied into the state
+ */
+void sha1_update(sha1_state *state, const void *data, uint32_t len) {
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    state->length += len;
+    if (state->block_len > 0) {
+        uint32_t n = SHA1_BLOCK_LEN - state->block_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(&state->block[state->block_len], bytes, n);
+        state->block_len += n;
+        bytes += n;
+        len -= n;
+        if (state->block_len < SHA1_BLOCK_LEN) {
+            return;
+        }
+        sha1_block(state->h, state->block);
+        state->block_len = 0;
+    }
+    while (len >= SHA1_BLOCK_LEN) {
+        sha1_block(state->h, bytes);
+        bytes += SHA1_BLOCK_LEN;
+        len -= SHA1_BLOCK_LEN;
+    }
+    memcpy(state->block, bytes, len);
+    state->block_len = len;
+}
+
+void sha1_final(sha1_state *state, uint8_t digest[SHA1_DIGEST_LEN]) {
+    uint64_t bits = state->length * 8;
+    int i;
+
+    state->block[state->block_len++] = 0x80;
+    if (state->block_len > SHA1_BLOCK_LEN - 8) {
+        memset(&state->block[state->block_len], 0, SHA1_BLOCK_LEN - state->block_len);
+        sha1_block(state->h, state->block);
+        state->block_len = 0;
+    }
+    memset(&state->block[state->block_len], 0, SHA1_BLOCK_LEN - 8 - state->block_len);
+    store_be32((uint32_t)(bits >> 32), &state->block[SHA1_BLOCK_LEN - 8]);
+    store_be32((uint32_t)bits, &state->block[SHA1_BLOCK_LEN - 4]);
+    sha1_block(state->h, state->block);
+
+    for (i = 0; i < 5; i++) {
+        store_be32(state->h[i], &digest[4 * i]);
+    }
+}
+
+void sha1(const void *data, uint32_t len, uint8_t digest[SHA1_DIGEST_LEN]) {
+    sha1_state state;
+    sha1_init(&state);
+    sha1_update(&state, data, len);
+    sha1_final(&state, digest);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file snapshot.c
+ * @date 2026-10-19
+ */
+
+#include "snapshot.h"
+#include <FreeRTOS.h>
+#include <os_task.h>
+#include <string.h>
+
+/**
+ * @brief
+ *      Copy in a new record. Only one task may publish to a snapshot
+ */
+void snapshot_publish(snapshot_t *snapshot, const void *record) {
+    uint32_t next = snapshot->seq + 1;
+    memcpy(snapshot->buffer[next & 1], record, snapshot->size);
+    taskENTER_CRITICAL();
+    snapshot->seq = next;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief
+ *      Borrow the latest record without copying it
+ * @details
+ *      Read the fields you need, then call snapshot_valid(). If it returns false
+ *      the record was being overwritten while you read it, so read again
+ * @param seq
+ *      Receives the publication number to pass to snapshot_valid()
+ * @return
+ *      The latest record. Whatever the buffers held before the first publication
+ */
+const void *snapshot_acquire(const snapshot_t *snapshot, uint32_t *seq) {
+    // The critical sections are compiler barriers keeping record reads between acquire and valid
+    taskENTER_CRITICAL();
+    *seq = snapshot->seq;
+    taskEXIT_CRITICAL();
+    return snapshot->buffer[*seq & 1];
+}
+
+/**
+ * @brief
+ *      Check a record from snapshot_acquire() was not overwritten while it was read
+ */
+bool snapshot_valid(const snapshot_t *snapshot, uint32_t seq) {
+    taskENTER_CRITICAL();
+    bool valid = snapshot->seq == seq;
+    taskEXIT_CRITICAL();
+    return valid;
+}
+
+/**
+ * @brief
+ *      Copy part of the latest record, reading again until it was not overwritten
+ * @return
+ *      false if the range is outside the record
+ */
+bool snapshot_read(const snapshot_t *snapshot, size_t offset, void *out, size_t len) {
+    uint32_t seq;
+
+    if (offset > snapshot->size || len > snapshot->size - offset) {
+        return false;
+    }
+    do {
+        const uint8_t *record = (const uint8_t *)snapshot_acquire(snapshot, &seq);
+        memcpy(out, record + offset, len);
+    } while (!snapshot_valid(snapshot, seq));
+    return true;
+}
@@ -26,7 +26,9 @@
 #include "logger/logger.h"
 #include "nmea_daemon.h"
 #include "time_management/rtc_daemon.h"
+#include "adcs_tlm_cache.h"
 #include "sw_wdt.h"
+#include "fs_copy.h"
 #include "northern_voices/northern_voices.h"
 
 #include "sband_sender/sband_sender.h"
@@ -41,17 +43,17 @@
 SAT_returnState start_system_tasks(void) {
 
     const static char *system_task_names[] = { "RTC_daemon",
-        "coordinate_management_daemon",  "housekeeping_daemon",
+        "adcs_tlm_cache", "coordinate_management_daemon",  "housekeeping_daemon",
         "NMEA_daemon", "nv_daemon", "sched_task",
         "sband_daemon", "sw_wdt",
-        "diagnostic_daemon", "beacon_daemon"
+        "diagnostic_daemon", "beacon_daemon", "fs_copy"
     };
 
     const system_tasks start_task[] = { start_RTC_daemon,
-        start_coordinate_management_daemon, start_housekeeping_daemon,
+        start_adcs_tlm_cache_daemon, start_coordinate_management_daemon, start_housekeeping_daemon,
         start_NMEA_daemon,  start_nv_daemon,  start_scheduler_task,
         start_sband_daemon, start_sw_watchdog,
-        start_diagnostic_daemon, start_beacon_daemon,
+        start_diagnostic_daemon, start_beacon_daemon, start_fs_copy_daemon,
         NULL
     };
 
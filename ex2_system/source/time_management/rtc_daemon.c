@@ -19,6 +19,7 @@
  */
 
 #include <FreeRTOS.h>
+#include <os_task.h>
 #include "skytraq_gps.h"
 #include "rtcmk.h"
 #include "system.h"
@@ -29,11 +30,69 @@
 
 #define DISCIPLINE_DELAY (24*60*60) // Do it once per day
 #define DRIFT_DELAY_INTERVAL (60*60) // check for drift every hour
+#define RTC_INT_STALE_MS 2000 // 1 Hz interrupt is considered stopped after this long
+#define RTC_RESYNC_INTERVAL_MS 10000 // minimum time between RTC reads while it is stopped
 
 static TickType_t last_second;
+static TickType_t last_resync;
+static bool rtc_started = false;
+
+/**
+ * @brief
+ *      Re-read the RTC if the 1 Hz interrupt has stopped, rate limited to one
+ *      bus transaction per RTC_RESYNC_INTERVAL_MS
+ */
+static void prv_resync_if_stale(void) {
+    time_t rtc_time;
+    TickType_t now = xTaskGetTickCount();
+
+    if (!rtc_started || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        return;
+    }
+    if (now - last_second < pdMS_TO_TICKS(RTC_INT_STALE_MS) ||
+        now - last_resync < pdMS_TO_TICKS(RTC_RESYNC_INTERVAL_MS)) {
+        return;
+    }
+    last_resync = now;
+    if (RTCMK_GetUnix(&rtc_time) == 0) {
+        taskENTER_CRITICAL();
+        unix_timestamp = rtc_time;
+        last_second = now;
+        taskEXIT_CRITICAL();
+    }
+}
+
+/**
+ * @brief
+ *      The time kept by the 1 Hz interrupt, counted on from the tick if it has stopped
+ */
+static time_t prv_cached_time(int32_t *msec) {
+    taskENTER_CRITICAL();
+    time_t seconds = unix_timestamp;
+    TickType_t since = xTaskGetTickCount() - last_second;
+    taskEXIT_CRITICAL();
+
+    // Only more than a second if the interrupt stopped; count on from the tick until the next resync
+    seconds += since / configTICK_RATE_HZ;
+    if (msec != NULL) {
+        *msec = ((since % configTICK_RATE_HZ) * 1000) / configTICK_RATE_HZ;
+    }
+    return seconds;
+}
+
+time_t RTCMK_Unix_Now_Ms(int32_t *msec) {
+    prv_resync_if_stale();
+    return prv_cached_time(msec);
+}
+
+time_t RTCMK_Unix_Now(void) { return RTCMK_Unix_Now_Ms(NULL); }
+
+time_t RTCMK_Unix_Cached(void) { return prv_cached_time(NULL); }
 
 int RTCMK_GetMs() {
-    return ((xTaskGetTickCount() * 1000) / configTICK_RATE_HZ) - ((last_second * 1000) / configTICK_RATE_HZ);
+    int32_t msec;
+    RTCMK_Unix_Now_Ms(&msec);
+    return msec;
 }
 
 /**
@@ -56,14 +115,18 @@ void RTC_discipline_daemon(void) {
             vTaskDelay(pdMS_TO_TICKS(DRIFT_DELAY_INTERVAL*1000));
             total_delay += DRIFT_DELAY_INTERVAL;
 
-            // check for drift between actual clock and cached version
+            // check for drift between actual clock and cached version. Skip
+            // the check if the cached second ticked over during the read
+            time_t before = RTCMK_Unix_Now();
             int err = RTCMK_GetUnix(&utc_time);
-            time_t unix_time = unix_timestamp;
-            if (!err && unix_time != utc_time) {
+            time_t unix_time = RTCMK_Unix_Now();
+            if (!err && before == unix_time && unix_time != utc_time) {
                 sys_log(NOTICE, "RTC drift: %ld (cached %ld) diff %ld",
                         utc_time, unix_time, (utc_time > unix_time) ?
                         utc_time - unix_time : unix_time - utc_time);
+                taskENTER_CRITICAL();
                 unix_timestamp = utc_time;
+                taskEXIT_CRITICAL();
             }
         }
         total_delay = 0;
@@ -92,7 +155,10 @@ SAT_returnState start_RTC_daemon() {
         return SATR_ERROR;
     }
 
-    RTCMK_GetUnix(&unix_timestamp);
+    if (RTCMK_GetUnix(&unix_timestamp) == 0) {
+        rtc_started = true;
+    }
+    last_second = xTaskGetTickCount();
 
     RTCMK_EnableInt(RTCMK_ADDR);
     gioEnableNotification(RTC_INT_PORT, RTC_INT_PIN);
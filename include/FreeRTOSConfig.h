@@ -104,7 +104,7 @@
 #define configTOTAL_HEAP_SIZE		  ( ( size_t ) 262144 )
 #define configMAX_TASK_NAME_LEN		  ( 16 )
 #define configIDLE_SHOULD_YIELD		  1
-#define configGENERATE_RUN_TIME_STATS 0
+#define configGENERATE_RUN_TIME_STATS 1
 #define configUSE_MALLOC_FAILED_HOOK  0
 
 /* USER CODE BEGIN (1) */
@@ -156,6 +156,7 @@
 #define INCLUDE_eTaskGetState               1
 #define INCLUDE_xTaskGetHandle              1
 #define INCLUDE_xTaskGetIdleTaskHandle      1
+#define INCLUDE_xTaskGetCurrentTaskHandle   1
 
 /* USER CODE BEGIN (4) */
 /* USER CODE END */
@@ -185,8 +186,21 @@ extern BaseType_t prvRaisePrivilege( void );
 void initializeProfiler();
 uint32 getProfilerTimerCount();
 
+/* Run time is counted in raw CPU cycles. The counter wraps every 14 s, so only
+ * differences over shorter periods mean anything (see task_stats.h) */
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() initializeProfiler()
 #define portGET_RUN_TIME_COUNTER_VALUE() getProfilerTimerCount()
+
+/* Ready to running latency for task_stats. Expanded inside os_tasks.c, which runs privileged */
+void task_stats_ready(uint32_t number, uint32_t cycles);
+void task_stats_switched_in(uint32_t number, uint32_t cycles);
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)                                                                    \
+    do {                                                                                                         \
+        if ((pxTCB) != pxCurrentTCB) {                                                                           \
+            task_stats_ready((pxTCB)->uxTCBNumber, _pmuGetCycleCount_());                                         \
+        }                                                                                                        \
+    } while (0)
+#define traceTASK_SWITCHED_IN() task_stats_switched_in(pxCurrentTCB->uxTCBNumber, _pmuGetCycleCount_())
 #define configINCLUDE_APPLICATION_DEFINED_PRIVILEGED_FUNCTIONS 1
 
 /* USER CODE END */
@@ -25,6 +25,10 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+/* Characters produced by encoding n bytes, including padding */
+#define BASE64_ENCODED_LEN(n) (4 * (((n) + 2) / 3))
+
+size_t base64_encode_into(const unsigned char *data, size_t input_length, char *out, size_t out_len);
 char *base64_encode(const unsigned char *data, size_t input_length, size_t *output_length);
 unsigned char *base64_decode(const char *data, size_t input_length, size_t *output_length);
 
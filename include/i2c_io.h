@@ -24,9 +24,25 @@
 #define I2C_TIMEOUT_MS 1000
 #define I2C_POLLING_TIMEOUT 1000
 #define MAX_I2C_RECV_LEN 20
+#define I2C_JOB_QUEUE_LEN 8
+
+#define I2C_XFER_WRITE 0x00
+#define I2C_XFER_READ 0x01
+#define I2C_XFER_NO_STOP 0x02 // Follow with a repeated start instead of a stop condition
+
+typedef struct {
+    uint8_t addr;
+    uint8_t flags;
+    uint16_t size;
+    void *buf;
+} i2c_xfer_t;
 
 void init_i2c_driver();
 
+int i2c_Transfer(i2cBASE_t *i2c, const i2c_xfer_t *xfers, uint16_t count);
+
+int i2c_WriteRead(i2cBASE_t *i2c, uint8_t addr, uint16_t wsize, void *wbuf, uint16_t rsize, void *rbuf);
+
 int i2c_Send(i2cBASE_t *i2c, uint8_t addr, uint16_t size, void *buf);
 
 int i2c_Receive(i2cBASE_t *i2c, uint8_t addr, uint16_t size, void *buf);
@@ -174,6 +174,46 @@ void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Fragmentation and usage statistics for heap_4.  Bucket n of the free block
+ * histogram counts free blocks of at least 2^(n+5) bytes and less than
+ * 2^(n+6) bytes, except that bucket 0 also takes every smaller block and the
+ * last bucket every larger one.
+ */
+#define portHEAP_HISTOGRAM_BUCKETS	12
+
+typedef struct xHEAP_STATS
+{
+	size_t xAvailableHeapSpaceInBytes;
+	size_t xSizeOfLargestFreeBlockInBytes;
+	size_t xSizeOfSmallestFreeBlockInBytes;
+	size_t xNumberOfFreeBlocks;
+	size_t xMinimumEverFreeBytesRemaining;
+	size_t xNumberOfSuccessfulAllocations;
+	size_t xNumberOfSuccessfulFrees;
+	size_t xNumberOfFailedAllocations;
+	size_t xLargestFailedRequest;
+	uint16_t usFreeBlockHistogram[ portHEAP_HISTOGRAM_BUCKETS ];
+} HeapStats_t;
+
+/*
+ * Allocations made by one task.  Allocations made before the scheduler
+ * starts are reported as "boot".  Once portHEAP_CALLER_SLOTS - 1 tasks have
+ * been seen, any further tasks share the last slot, reported as "other".
+ */
+#define portHEAP_CALLER_SLOTS		24
+
+typedef struct xHEAP_CALLER_STATS
+{
+	char pcTaskName[ configMAX_TASK_NAME_LEN ];
+	uint32_t ulAllocations;
+	uint32_t ulFailures;
+	uint32_t ulBytesRequested;
+} HeapCallerStats_t;
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats ) PRIVILEGED_FUNCTION;
+UBaseType_t uxPortGetHeapCallerStats( HeapCallerStats_t *pxCallerStats, UBaseType_t uxMaxCallers ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
@@ -71,8 +71,10 @@
 #include "csp/crypto/csp_hmac.h"
 #include "csp/crypto/csp_xtea.h"
 #include "crypto.h"
+#include "csp_buffer_pool.h"
 #include "csp_debug_wrapper.h"
 #include "bl_eeprom.h"
+#include "mem_region.h"
 
 #define SDR_TEST 0
 
@@ -214,7 +216,10 @@ void flatsat_test(void *pvParameters) { vTaskDelete(NULL); }
 
 int ex2_main(void) {
     _enable_IRQ_interrupt_(); // enable inturrupts
+    // First allocation, so the size class arena sits at the bottom of the heap
+    mem_region_init();
     InitIO();
+    eeprom_init();
 
 #if KEY_SET_MODE
     set_keys_from_keyfile();
@@ -315,7 +320,11 @@ static void init_csp() {
     csp_conf.fifo_length = 25;
     csp_conf.port_max_bind = 254;
     csp_conf.rdp_max_window = 20;
+#if CSP_BUFFER_SIZE_CLASSES
+    csp_conf.buffers = 9; // full size buffers, the small class is set in system.h
+#else
     csp_conf.buffers = 10;
+#endif
     csp_conf.buffer_data_size = 1024;
     csp_conf.conn_dfl_so = CSP_O_NONE;
 
@@ -466,7 +475,8 @@ void initializeProfiler() {
 // TODO: This might need to be put in application_defined_privileged_functions.h
 uint32 getProfilerTimerCount() {
     RAISE_PRIVILEGE;
-    uint32_t ret = _pmuGetCycleCount_() / GCLK_FREQ;
+    // Raw cycles so differences stay correct across the counter wrapping
+    uint32_t ret = _pmuGetCycleCount_();
     RESET_PRIVILEGE;
     return ret;
 }
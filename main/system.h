@@ -46,30 +46,32 @@
 #define LOGGER_TASK_PRIO (tskIDLE_PRIORITY + 2)
 #define MOCK_RTC_TASK_PRIO (configMAX_PRIORITIES - 1)
 #define TASK_MANAGER_PRIO (tskIDLE_PRIORITY + 3)
+#define ADCS_TLM_CACHE_TASK_PRIO (tskIDLE_PRIORITY + 1)
+#define HK_BUS_WORKER_PRIO (tskIDLE_PRIORITY + 1)
+#define FS_COPY_TASK_PRIO (tskIDLE_PRIORITY)
 
-#define CLI_SVC_SIZE 1000
 #define ADCS_SVC_SIZE 1536
-#define COMM_SVC_SIZE 1024
-#define DFGM_SVC_SIZE 1024
+#define CLI_SVC_SIZE 1000
 #define FTP_SVC_SIZE 500
-#define HK_SVC_SIZE 600
-#define LOGGER_SVC_SIZE 1200
-#define NS_SVC_SIZE 1024
-#define IRIS_SVC_SIZE 1000
-#define TIMEMANAGEMENT_SVC_SIZE 300
-#define SCHEDULER_SVC_SIZE 1024
-#define GENERAL_SVC_SIZE 300
+#define UPDATER_SVC_SIZE 400
 #define CSPSERVER_SVC_SIZE 256
+#define SERVICE_DISPATCHER_SIZE 256
+#define SERVICE_WORKER_SIZE 1200 // must fit the deepest service on the shared workers (logger)
+#define SERVICE_WORKER_COUNT 2
 
-#define COORD_DM_SIZE 128
+#define COORD_DM_SIZE 400
 #define DIAGNOSTIC_DM_SIZE 500
 #define HK_DM_SIZE 1200
+#define HK_BUS_WORKER_SIZE 600 // must fit the deepest getHK call (ADCS)
 #define LOGGER_DM_SIZE 500
 #define SBANDSEND_DM_SIZE 200
 #define RTC_DM_SIZE 256
 #define SWWDT_DM_SIZE 128
 #define INIT_STACK_SIZE 400
 #define NV_DAEMON_STACK_SIZE 400
+#define ADCS_TLM_DM_SIZE 400
+#define FS_COPY_DM_SIZE 400
+#define TASK_STATS_DM_SIZE 256
 
 #if IS_ATHENA == 1
 #define CSP_SCI sciREG2  // UART2
@@ -152,6 +154,10 @@
 #define ONE_MINUTE pdMS_TO_TICKS(60000)
 #define CSP_TIMEOUT 100
 
+// CSP packet buffers smaller than csp_conf.buffer_data_size with CSP_BUFFER_SIZE_CLASSES set, see csp_buffer_pool.h
+#define CSP_POOL_SMALL_SIZE 64 // short packets to the ground from csp_buffer_get_small
+#define CSP_POOL_SMALL_COUNT 10
+
 typedef enum {
     SATR_OK,
     SATR_ERROR,
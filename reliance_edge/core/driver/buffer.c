@@ -103,6 +103,33 @@
 */
 #define BBLK_INVALID UINT32_MAX
 
+#if REDCONF_BUFFER_HASH == 1
+/*  Ends a hash chain or the MRU list.  REDCONF_BUFFER_COUNT is at most 255, so
+    no buffer has this index.
+*/
+#define BIDX_NONE UINT8_MAX
+
+/*  Number of hash buckets: a power of two no smaller than the buffer count, so
+    that the chains average one buffer or less.
+*/
+#if REDCONF_BUFFER_COUNT <= 16U
+  #define BUFFER_HASH_BUCKETS 16U
+#elif REDCONF_BUFFER_COUNT <= 32U
+  #define BUFFER_HASH_BUCKETS 32U
+#elif REDCONF_BUFFER_COUNT <= 64U
+  #define BUFFER_HASH_BUCKETS 64U
+#elif REDCONF_BUFFER_COUNT <= 128U
+  #define BUFFER_HASH_BUCKETS 128U
+#else
+  #define BUFFER_HASH_BUCKETS 256U
+#endif
+
+/*  Consecutive blocks land in consecutive buckets; the volume number spreads
+    the same block on different volumes apart.
+*/
+#define BUFFER_HASH(vol, blk) ((uint8_t)(((blk) ^ ((uint32_t)(vol) << 5U)) & (BUFFER_HASH_BUCKETS - 1U)))
+#endif
+
 
 /** @brief Metadata stored for each block buffer.
 
@@ -115,6 +142,11 @@ typedef struct
     uint8_t     bVolNum;    /**< Volume the block resides on. */
     uint8_t     bRefCount;  /**< Number of references. */
     uint16_t    uFlags;     /**< Buffer flags: mask of BFLAG_* values. */
+  #if REDCONF_BUFFER_HASH == 1
+    uint8_t     bMoreRecent;    /**< Neighbor towards the MRU end of the list; BIDX_NONE if MRU. */
+    uint8_t     bLessRecent;    /**< Neighbor towards the LRU end of the list; BIDX_NONE if LRU. */
+    uint8_t     bHashNext;      /**< Next buffer in the same hash bucket; BIDX_NONE if last. */
+  #endif
 } BUFFERHEAD;
 
 
@@ -126,6 +158,19 @@ typedef struct
     */
     uint16_t    uNumUsed;
 
+  #if REDCONF_BUFFER_HASH == 1
+    /** Ends of the MRU list, which holds every buffer and is linked through
+        BUFFERHEAD::bLessRecent and BUFFERHEAD::bMoreRecent.  bMRU is the most-
+        recently-used buffer and bLRU the least-recently-used.
+    */
+    uint8_t     bMRU;
+    uint8_t     bLRU;
+
+    /** Hash table of the buffers holding a valid block, keyed by volume and
+        block number and chained through BUFFERHEAD::bHashNext.
+    */
+    uint8_t     abHash[BUFFER_HASH_BUCKETS];
+  #else
     /** MRU array.  Each element of the array stores a buffer index; each buffer
         index appears in the array once and only once.  The first element of the
         array is the most-recently-used (MRU) buffer, followed by the next most
@@ -133,6 +178,7 @@ typedef struct
         recently-used (LRU) buffer.
     */
     uint8_t     abMRU[REDCONF_BUFFER_COUNT];
+  #endif
 
     /** Buffer heads, storing metadata for each buffer.
     */
@@ -156,6 +202,11 @@ static REDSTATUS BufferFinalize(uint8_t *pbBuffer, uint8_t bVolNum, uint16_t uFl
 static void BufferMakeLRU(uint8_t bIdx);
 static void BufferMakeMRU(uint8_t bIdx);
 static bool BufferFind(uint32_t ulBlock, uint8_t *pbIdx);
+static uint8_t BufferVictim(void);
+static void BufferSetBlock(uint8_t bIdx, uint8_t bVolNum, uint32_t ulBlock);
+#if REDCONF_BUFFER_HASH == 1
+static void BufferUnlink(uint8_t bIdx);
+#endif
 
 #ifdef REDCONF_ENDIAN_SWAP
 static void BufferEndianSwap(const void *pBuffer, uint16_t uFlags);
@@ -178,12 +229,25 @@ void RedBufferInit(void)
 
     RedMemSet(&gBufCtx, 0U, sizeof(gBufCtx));
 
+  #if REDCONF_BUFFER_HASH == 1
+    RedMemSet(gBufCtx.abHash, BIDX_NONE, sizeof(gBufCtx.abHash));
+
+    gBufCtx.bMRU = (uint8_t)(REDCONF_BUFFER_COUNT - 1U);
+    gBufCtx.bLRU = 0U;
+  #endif
+
     for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
     {
         /*  When the buffers have been freshly initialized, acquire the buffers
             in the order in which they appear in the array.
         */
+      #if REDCONF_BUFFER_HASH == 1
+        gBufCtx.aHead[bIdx].bLessRecent = (bIdx == 0U) ? BIDX_NONE : (uint8_t)(bIdx - 1U);
+        gBufCtx.aHead[bIdx].bMoreRecent = (bIdx == (REDCONF_BUFFER_COUNT - 1U)) ? BIDX_NONE : (uint8_t)(bIdx + 1U);
+        gBufCtx.aHead[bIdx].bHashNext = BIDX_NONE;
+      #else
         gBufCtx.abMRU[bIdx] = (uint8_t)((REDCONF_BUFFER_COUNT - bIdx) - 1U);
+      #endif
         gBufCtx.aHead[bIdx].ulBlock = BBLK_INVALID;
     }
 }
@@ -217,7 +281,9 @@ REDSTATUS RedBufferGet(
     }
     else
     {
-        if(BufferFind(ulBlock, &bIdx))
+        bool fHit = BufferFind(ulBlock, &bIdx);
+
+        if(fHit)
         {
             /*  Error if the buffer exists and BFLAG_NEW was specified, since
                 the new flag is used when a block is newly allocated/created, so
@@ -246,18 +312,7 @@ REDSTATUS RedBufferGet(
         {
             BUFFERHEAD *pHead;
 
-            /*  Search for the least recently used buffer which is not
-                referenced.
-            */
-            for(bIdx = (uint8_t)(REDCONF_BUFFER_COUNT - 1U); bIdx > 0U; bIdx--)
-            {
-                if(gBufCtx.aHead[gBufCtx.abMRU[bIdx]].bRefCount == 0U)
-                {
-                    break;
-                }
-            }
-
-            bIdx = gBufCtx.abMRU[bIdx];
+            bIdx = BufferVictim();
             pHead = &gBufCtx.aHead[bIdx];
 
             if(pHead->bRefCount == 0U)
@@ -297,7 +352,7 @@ REDSTATUS RedBufferGet(
                         buffer were to be used subsequently with its partially
                         erroneous contents, bad things could happen.
                     */
-                    pHead->ulBlock = BBLK_INVALID;
+                    BufferSetBlock(bIdx, pHead->bVolNum, BBLK_INVALID);
 
                     ret = RedIoRead(gbRedVolNum, ulBlock, 1U, gBufCtx.b.aabBuffer[bIdx]);
 
@@ -331,8 +386,7 @@ REDSTATUS RedBufferGet(
 
             if(ret == 0)
             {
-                pHead->bVolNum = gbRedVolNum;
-                pHead->ulBlock = ulBlock;
+                BufferSetBlock(bIdx, gbRedVolNum, ulBlock);
                 pHead->uFlags = 0U;
             }
         }
@@ -362,6 +416,14 @@ REDSTATUS RedBufferGet(
             BufferMakeMRU(bIdx);
 
             *ppBuffer = gBufCtx.b.aabBuffer[bIdx];
+
+          #if REDCONF_CORE_STATS == 1
+            gRedCoreStats.ulBufferGets++;
+            if(fHit)
+            {
+                gRedCoreStats.ulBufferHits++;
+            }
+          #endif
         }
     }
 
@@ -500,7 +562,7 @@ void RedBufferBranch(
         REDASSERT((pHead->uFlags & BFLAG_DIRTY) == 0U);
 
         pHead->uFlags |= BFLAG_DIRTY;
-        pHead->ulBlock = ulBlockNew;
+        BufferSetBlock(bIdx, pHead->bVolNum, ulBlockNew);
     }
 }
 
@@ -525,7 +587,7 @@ void RedBufferDiscard(
         REDASSERT(gBufCtx.uNumUsed > 0U);
 
         gBufCtx.aHead[bIdx].bRefCount = 0U;
-        gBufCtx.aHead[bIdx].ulBlock = BBLK_INVALID;
+        BufferSetBlock(bIdx, gBufCtx.aHead[bIdx].bVolNum, BBLK_INVALID);
 
         gBufCtx.uNumUsed--;
 
@@ -576,7 +638,7 @@ REDSTATUS RedBufferDiscardRange(
             {
                 if(pHead->bRefCount == 0U)
                 {
-                    pHead->ulBlock = BBLK_INVALID;
+                    BufferSetBlock(bIdx, pHead->bVolNum, BBLK_INVALID);
 
                     BufferMakeLRU(bIdx);
                 }
@@ -735,6 +797,22 @@ static bool BufferToIdx(
     {
         uint8_t bIdx;
 
+      #if REDCONF_BUFFER_HASH == 1
+        /*  With many buffers the loop below is too slow for every put, so
+            compute the index from the address.
+        */
+        uintptr_t offset = BYTE_PTR_OFFSET(pBuffer, &gBufCtx.b.aabBuffer[0U][0U]);
+
+        if(    (offset < ((uintptr_t)REDCONF_BUFFER_COUNT * REDCONF_BLOCK_SIZE))
+            && ((offset % REDCONF_BLOCK_SIZE) == 0U))
+        {
+            bIdx = (uint8_t)(offset / REDCONF_BLOCK_SIZE);
+        }
+        else
+        {
+            bIdx = REDCONF_BUFFER_COUNT;
+        }
+      #else
         /*  pBuffer should be a pointer to one of the block buffers.
 
             A good compiler should optimize this loop into a bounds check and an
@@ -750,6 +828,7 @@ static bool BufferToIdx(
                 break;
             }
         }
+      #endif
 
         if(    (bIdx < REDCONF_BUFFER_COUNT)
             && (gBufCtx.aHead[bIdx].ulBlock != BBLK_INVALID)
@@ -795,6 +874,13 @@ static REDSTATUS BufferWrite(
         {
             ret = RedIoWrite(pHead->bVolNum, pHead->ulBlock, 1U, gBufCtx.b.aabBuffer[bIdx]);
 
+          #if REDCONF_CORE_STATS == 1
+            if(ret == 0)
+            {
+                gRedCoreStats.ulBufferWrites++;
+            }
+          #endif
+
           #ifdef REDCONF_ENDIAN_SWAP
             BufferEndianSwap(gBufCtx.b.aabBuffer[bIdx], pHead->uFlags);
           #endif
@@ -1074,6 +1160,162 @@ static void BufferEndianSwapIndir(
 #endif /* #ifdef REDCONF_ENDIAN_SWAP */
 
 
+#if REDCONF_BUFFER_HASH == 1
+
+/** @brief Remove a buffer from the MRU list.
+
+    The caller puts it back at one end.
+
+    @param bIdx The index of the buffer to remove.
+*/
+static void BufferUnlink(
+    uint8_t bIdx)
+{
+    const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+    if(pHead->bMoreRecent == BIDX_NONE)
+    {
+        gBufCtx.bMRU = pHead->bLessRecent;
+    }
+    else
+    {
+        gBufCtx.aHead[pHead->bMoreRecent].bLessRecent = pHead->bLessRecent;
+    }
+
+    if(pHead->bLessRecent == BIDX_NONE)
+    {
+        gBufCtx.bLRU = pHead->bMoreRecent;
+    }
+    else
+    {
+        gBufCtx.aHead[pHead->bLessRecent].bMoreRecent = pHead->bMoreRecent;
+    }
+}
+
+
+/** @brief Mark a buffer as least recently used.
+
+    @param bIdx The index of the buffer to make LRU.
+*/
+static void BufferMakeLRU(
+    uint8_t bIdx)
+{
+    if(bIdx >= REDCONF_BUFFER_COUNT)
+    {
+        REDERROR();
+    }
+    else if(bIdx != gBufCtx.bLRU)
+    {
+        BufferUnlink(bIdx);
+
+        gBufCtx.aHead[bIdx].bMoreRecent = gBufCtx.bLRU;
+        gBufCtx.aHead[bIdx].bLessRecent = BIDX_NONE;
+        gBufCtx.aHead[gBufCtx.bLRU].bLessRecent = bIdx;
+        gBufCtx.bLRU = bIdx;
+    }
+    else
+    {
+        /*  Buffer already LRU, nothing to do.
+        */
+    }
+}
+
+
+/** @brief Mark a buffer as most recently used.
+
+    @param bIdx The index of the buffer to make MRU.
+*/
+static void BufferMakeMRU(
+    uint8_t bIdx)
+{
+    if(bIdx >= REDCONF_BUFFER_COUNT)
+    {
+        REDERROR();
+    }
+    else if(bIdx != gBufCtx.bMRU)
+    {
+        BufferUnlink(bIdx);
+
+        gBufCtx.aHead[bIdx].bLessRecent = gBufCtx.bMRU;
+        gBufCtx.aHead[bIdx].bMoreRecent = BIDX_NONE;
+        gBufCtx.aHead[gBufCtx.bMRU].bMoreRecent = bIdx;
+        gBufCtx.bMRU = bIdx;
+    }
+    else
+    {
+        /*  Buffer already MRU, nothing to do.
+        */
+    }
+}
+
+
+/** @brief Find a block in the buffers.
+
+    @param ulBlock  The block number to find.
+    @param pbIdx    If the block is buffered (true is returned), populated with
+                    the index of the buffer.
+
+    @return Boolean indicating whether or not the block is buffered.
+
+    @retval true    @p ulBlock is buffered, and its index has been stored in
+                    @p pbIdx.
+    @retval false   @p ulBlock is not buffered.
+*/
+static bool BufferFind(
+    uint32_t ulBlock,
+    uint8_t *pbIdx)
+{
+    bool     ret = false;
+
+    if((ulBlock >= gpRedVolume->ulBlockCount) || (pbIdx == NULL))
+    {
+        REDERROR();
+    }
+    else
+    {
+        uint8_t bIdx = gBufCtx.abHash[BUFFER_HASH(gbRedVolNum, ulBlock)];
+
+        while(bIdx != BIDX_NONE)
+        {
+            const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+            if((pHead->bVolNum == gbRedVolNum) && (pHead->ulBlock == ulBlock))
+            {
+                *pbIdx = bIdx;
+                ret = true;
+                break;
+            }
+
+            bIdx = pHead->bHashNext;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Pick the buffer to repurpose for a block which is not buffered.
+
+    @return The index of the least recently used buffer which is not
+            referenced, or of the most recently used buffer if all are
+            referenced.
+*/
+static uint8_t BufferVictim(void)
+{
+    uint8_t bIdx = gBufCtx.bLRU;
+
+    /*  Referenced buffers were used recently, so few are passed over.
+    */
+    while((gBufCtx.aHead[bIdx].bRefCount != 0U) && (gBufCtx.aHead[bIdx].bMoreRecent != BIDX_NONE))
+    {
+        bIdx = gBufCtx.aHead[bIdx].bMoreRecent;
+    }
+
+    return bIdx;
+}
+
+#else
+
 /** @brief Mark a buffer as least recently used.
 
     @param bIdx The index of the buffer to make LRU.
@@ -1212,3 +1454,71 @@ static bool BufferFind(
     return ret;
 }
 
+
+/** @brief Pick the buffer to repurpose for a block which is not buffered.
+
+    @return The index of the least recently used buffer which is not
+            referenced, or of the most recently used buffer if all are
+            referenced.
+*/
+static uint8_t BufferVictim(void)
+{
+    uint8_t bMruIdx;
+
+    /*  Search for the least recently used buffer which is not referenced.
+    */
+    for(bMruIdx = (uint8_t)(REDCONF_BUFFER_COUNT - 1U); bMruIdx > 0U; bMruIdx--)
+    {
+        if(gBufCtx.aHead[gBufCtx.abMRU[bMruIdx]].bRefCount == 0U)
+        {
+            break;
+        }
+    }
+
+    return gBufCtx.abMRU[bMruIdx];
+}
+
+#endif /* REDCONF_BUFFER_HASH == 1 */
+
+
+/** @brief Change the block a buffer holds.
+
+    @param bIdx     The index of the buffer.
+    @param bVolNum  The volume of the new block.
+    @param ulBlock  The new block number; BBLK_INVALID to leave the buffer
+                    unused.
+*/
+static void BufferSetBlock(
+    uint8_t     bIdx,
+    uint8_t     bVolNum,
+    uint32_t    ulBlock)
+{
+    BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+  #if REDCONF_BUFFER_HASH == 1
+    if(pHead->ulBlock != BBLK_INVALID)
+    {
+        uint8_t *pbLink = &gBufCtx.abHash[BUFFER_HASH(pHead->bVolNum, pHead->ulBlock)];
+
+        while((*pbLink != bIdx) && (*pbLink != BIDX_NONE))
+        {
+            pbLink = &gBufCtx.aHead[*pbLink].bHashNext;
+        }
+
+        REDASSERT(*pbLink == bIdx);
+        *pbLink = pHead->bHashNext;
+    }
+
+    if(ulBlock != BBLK_INVALID)
+    {
+        uint8_t bBucket = BUFFER_HASH(bVolNum, ulBlock);
+
+        pHead->bHashNext = gBufCtx.abHash[bBucket];
+        gBufCtx.abHash[bBucket] = bIdx;
+    }
+  #endif
+
+    pHead->bVolNum = bVolNum;
+    pHead->ulBlock = ulBlock;
+}
+
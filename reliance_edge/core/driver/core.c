@@ -67,6 +67,10 @@ METAROOT       *gpRedMR = &gaCoreVol[0U].aMR[0U];
 
 CONST_IF_ONE_VOLUME uint8_t gbRedVolNum;
 
+#if REDCONF_CORE_STATS == 1
+REDCORESTATS gRedCoreStats;
+#endif
+
 
 /** @brief Initialize the Reliance Edge file system driver.
 
@@ -427,6 +427,13 @@ REDSTATUS RedVolTransact(void)
             ret = RedIoFlush(gbRedVolNum);
         }
 
+      #if REDCONF_CORE_STATS == 1
+        if(ret == 0)
+        {
+            gRedCoreStats.ulTransactions++;
+        }
+      #endif
+
         /*  Toggle to the other metaroot buffer.  The working state and committed
             state metaroot buffers exchange places.
         */
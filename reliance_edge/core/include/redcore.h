@@ -101,6 +101,23 @@ void RedBufferDiscard(const void *pBuffer);
 #endif
 REDSTATUS RedBufferDiscardRange(uint32_t ulBlockStart, uint32_t ulBlockCount);
 
+#if REDCONF_CORE_STATS == 1
+/** @brief Counters for tuning the buffer count and transaction settings.
+
+    Shared by all volumes.  Nothing resets them; callers take the difference
+    between two snapshots.
+*/
+typedef struct
+{
+    uint32_t    ulBufferGets;   /**< RedBufferGet() calls which succeeded. */
+    uint32_t    ulBufferHits;   /**< Gets satisfied by a buffer already holding the block. */
+    uint32_t    ulBufferWrites; /**< Dirty buffers written to disk. */
+    uint32_t    ulTransactions; /**< Transaction points which wrote a metaroot. */
+} REDCORESTATS;
+
+extern REDCORESTATS gRedCoreStats;
+#endif
+
 
 /** @brief Allocation state of a block.
 */
@@ -89,6 +89,10 @@
 
 #define REDCONF_CHECKER 0
 
+#define REDCONF_CORE_STATS 0
+
+#define REDCONF_BUFFER_HASH 0
+
 #define RED_CONFIG_UTILITY_VERSION 0x2030000U
 
 #define RED_CONFIG_MINCOMPAT_VER 0x2030000U
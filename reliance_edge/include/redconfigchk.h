@@ -174,6 +174,12 @@
 #ifndef REDCONF_CHECKER
   #error "Configuration error: REDCONF_CHECKER must be defined."
 #endif
+#ifndef REDCONF_CORE_STATS
+  #error "Configuration error: REDCONF_CORE_STATS must be defined."
+#endif
+#ifndef REDCONF_BUFFER_HASH
+  #error "Configuration error: REDCONF_BUFFER_HASH must be defined."
+#endif
 
 #if (REDCONF_READ_ONLY != 0) && (REDCONF_READ_ONLY != 1)
   #error "Configuration error: REDCONF_READ_ONLY must be either 0 or 1"
@@ -347,6 +353,14 @@
   #error "Configuration error: REDCONF_CHECKER must be either 0 or 1."
 #endif
 
+#if (REDCONF_CORE_STATS != 0) && (REDCONF_CORE_STATS != 1)
+  #error "Configuration error: REDCONF_CORE_STATS must be either 0 or 1."
+#endif
+
+#if (REDCONF_BUFFER_HASH != 0) && (REDCONF_BUFFER_HASH != 1)
+  #error "Configuration error: REDCONF_BUFFER_HASH must be either 0 or 1."
+#endif
+
 #if (REDCONF_DISCARDS == 1) && (RED_KIT == RED_KIT_GPL)
   #error "REDCONF_DISCARDS not supported in Reliance Edge under GPL. Contact sales@datalight.com to upgrade."
 #endif
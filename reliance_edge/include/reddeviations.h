@@ -220,5 +220,22 @@
 #define IS_ALIGNED_PTR(ptr) (((uintptr_t)(ptr) & (REDCONF_ALIGNMENT_SIZE - 1U)) == 0U)
 
 
+/** @brief Get the distance in bytes from one pointer up to another.
+
+    Used by the hashed buffer cache to turn a buffer pointer into a buffer index
+    without searching.  Subtracting the pointers themselves would be undefined
+    behavior when @p ptr is not within the same array as @p base, which is the
+    case the caller is checking for.
+
+    Usage of this macro deviates from MISRA C:2012 Rule 11.4 (advisory), with
+    the same rationale as IS_ALIGNED_PTR(): the integer values are not converted
+    back into pointers.  If @p ptr is below @p base the result wraps around to a
+    large value, which the caller rejects as out of range.
+
+    As Rule 11.4 is advisory, a deviation record is not required.
+*/
+#define BYTE_PTR_OFFSET(ptr, base) ((uintptr_t)(ptr) - (uintptr_t)(base))
+
+
 #endif
 
@@ -75,7 +75,10 @@ uint32_t RedOsClockGetTime(void)
         it targets have no RTC hardware.  If your hardware includes an RTC that
         you would like to use, this function must be customized.
     */
-    time_t unix_time = RTCMK_Unix_Now();
+    /*  Called with the Reliance Edge lock held, so use the cached time.
+        RTCMK_Unix_Now() could start an I2C read to resync a stopped RTC.
+    */
+    time_t unix_time = RTCMK_Unix_Cached();
     return unix_time;
 }
 
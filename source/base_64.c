@@ -7,11 +7,6 @@
 #include "base_64.h"
 #include "FreeRTOS.h"
 
-static const char encoding_table[] = {
-    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V',
-    'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r',
-    's', 't', 'u', 'v', 'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'};
-
 static const unsigned char decoding_table[256] = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -29,33 +24,72 @@ static const unsigned char decoding_table[256] = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00};
 
-char *base64_encode(const unsigned char *data, size_t input_length, size_t *output_length) {
+/* Base64 digit for a 6 bit value, usable in constant expressions */
+#define B64_DIGIT(x)                                                                                             \
+    ((x) < 26 ? 'A' + (x) : (x) < 52 ? 'a' + (x)-26 : (x) < 62 ? '0' + (x)-52 : (x) == 62 ? '+' : '/')
+#define B64_PAIR(n) {B64_DIGIT((n) >> 6), B64_DIGIT((n)&0x3F)}
+#define B64_R4(n) B64_PAIR(n), B64_PAIR((n) + 1), B64_PAIR((n) + 2), B64_PAIR((n) + 3)
+#define B64_R16(n) B64_R4(n), B64_R4((n) + 4), B64_R4((n) + 8), B64_R4((n) + 12)
+#define B64_R64(n) B64_R16(n), B64_R16((n) + 16), B64_R16((n) + 32), B64_R16((n) + 48)
+#define B64_R256(n) B64_R64(n), B64_R64((n) + 64), B64_R64((n) + 128), B64_R64((n) + 192)
+#define B64_R1024(n) B64_R256(n), B64_R256((n) + 256), B64_R256((n) + 512), B64_R256((n) + 768)
+
+/* Both output characters for every 12 bit value, so each 3 byte group takes two lookups. Lives in flash */
+static const char encoding_table_12[4096][2] = {B64_R1024(0), B64_R1024(1024), B64_R1024(2048), B64_R1024(3072)};
+
+/**
+ * @brief
+ *      Base64 encode into a caller supplied buffer
+ * @param out_len
+ *      Size of out. Must be at least BASE64_ENCODED_LEN(input_length)
+ * @return
+ *      Number of characters written, or 0 if out is too small. out is not terminated
+ */
+size_t base64_encode_into(const unsigned char *data, size_t input_length, char *out, size_t out_len) {
+    size_t output_length = BASE64_ENCODED_LEN(input_length);
+    size_t i = 0;
+    size_t j = 0;
 
-    const int mod_table[] = {0, 2, 1};
+    if (out_len < output_length) {
+        return 0;
+    }
 
-    *output_length = 4 * ((input_length + 2) / 3);
+    for (; i + 3 <= input_length; i += 3, j += 4) {
+        uint32_t triple = ((uint32_t)data[i] << 16) | ((uint32_t)data[i + 1] << 8) | data[i + 2];
+        const char *hi = encoding_table_12[triple >> 12];
+        const char *lo = encoding_table_12[triple & 0xFFF];
+        out[j] = hi[0];
+        out[j + 1] = hi[1];
+        out[j + 2] = lo[0];
+        out[j + 3] = lo[1];
+    }
 
-    char *encoded_data = (char *)pvPortMalloc(*output_length);
+    if (i < input_length) {
+        uint32_t triple = (uint32_t)data[i] << 16;
+        if (i + 1 < input_length) {
+            triple |= (uint32_t)data[i + 1] << 8;
+        }
+        const char *hi = encoding_table_12[triple >> 12];
+        const char *lo = encoding_table_12[triple & 0xFFF];
+        out[j] = hi[0];
+        out[j + 1] = hi[1];
+        out[j + 2] = i + 1 < input_length ? lo[0] : '=';
+        out[j + 3] = '=';
+    }
 
-    if (encoded_data == NULL)
-        return NULL;
+    return output_length;
+}
 
-    for (int i = 0, j = 0; i < input_length;) {
+char *base64_encode(const unsigned char *data, size_t input_length, size_t *output_length) {
 
-        uint32_t octet_a = i < input_length ? (unsigned char)data[i++] : 0;
-        uint32_t octet_b = i < input_length ? (unsigned char)data[i++] : 0;
-        uint32_t octet_c = i < input_length ? (unsigned char)data[i++] : 0;
+    *output_length = BASE64_ENCODED_LEN(input_length);
 
-        uint32_t triple = (octet_a << 0x10) + (octet_b << 0x08) + octet_c;
+    char *encoded_data = (char *)pvPortMalloc(*output_length);
 
-        encoded_data[j++] = encoding_table[(triple >> 3 * 6) & 0x3F];
-        encoded_data[j++] = encoding_table[(triple >> 2 * 6) & 0x3F];
-        encoded_data[j++] = encoding_table[(triple >> 1 * 6) & 0x3F];
-        encoded_data[j++] = encoding_table[(triple >> 0 * 6) & 0x3F];
-    }
+    if (encoded_data == NULL)
+        return NULL;
 
-    for (int i = 0; i < mod_table[input_length % 3]; i++)
-        encoded_data[*output_length - 1 - i] = '=';
+    base64_encode_into(data, input_length, encoded_data, *output_length);
 
     return encoded_data;
 };
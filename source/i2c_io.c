@@ -11,32 +11,163 @@
 #include <stdint.h>
 #include "os_task.h"
 
-/** @struct i2Csemphr
+/** @struct i2c_job
+*   @brief A list of transfers queued on a bus, completed as a unit
+*
+*   The ISR gives the complete semaphore when the job finishes. The owner's task
+*   notification is left alone, since callers such as the housekeeping bus workers
+*   use it themselves. A slot stays claimed until its owner has taken back the
+*   semaphore, so a late give can never wake the next job in the slot.
+*/
+typedef struct i2c_job {
+    const i2c_xfer_t *xfers;
+    uint16_t count;
+    SemaphoreHandle_t complete;
+    volatile bool claimed;
+    volatile int *result;
+    volatile bool *done;
+} i2c_job_t;
+
+/** @struct i2c_bus
 *   @brief Interrupt mode globals
 *
+*   jobs is a ring: jobs[tail] is on the bus, jobs[head] is the next free slot.
+*   Both indices are only touched with interrupts masked or from the ISR.
 */
-static struct i2csemphr
+static struct i2c_bus
 {
-    SemaphoreHandle_t i2c_mutex;
-    SemaphoreHandle_t i2c_block;
+    i2c_job_t jobs[I2C_JOB_QUEUE_LEN];
+    uint32_t head;
+    uint32_t tail;
+    uint16_t xfer_index;
     bool hadFailure;
     bool expecting_scd;
-} i2csemphr_t[2U];
+} i2c_bus_t[2U];
+
+static void prv_start_xfer(i2cBASE_t *i2c, struct i2c_bus *bus);
+static void prv_next_job(i2cBASE_t *i2c, struct i2c_bus *bus);
+static void prv_xfer_done(i2cBASE_t *i2c, struct i2c_bus *bus, BaseType_t *xHigherPriorityTaskWoken);
 
 /**
  * @Brief
  *    Initialize freertos structures for the driver
  **/
 void init_i2c_driver() {
-    // these can't fail
-    i2csemphr_t[0].i2c_mutex = xSemaphoreCreateMutex();
-    i2csemphr_t[1].i2c_mutex = xSemaphoreCreateMutex();
-    i2csemphr_t[0].i2c_block = xSemaphoreCreateBinary();
-    i2csemphr_t[1].i2c_block = xSemaphoreCreateBinary();
-    i2csemphr_t[0].hadFailure = false;
-    i2csemphr_t[1].hadFailure = false;
-    i2csemphr_t[0].expecting_scd = false;
-    i2csemphr_t[1].expecting_scd = false;
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < I2C_JOB_QUEUE_LEN; j++) {
+            i2c_job_t *job = &i2c_bus_t[i].jobs[j];
+            if (job->complete == NULL) { // the Iris bootloader initializes the driver again
+                job->complete = xSemaphoreCreateBinary(); // can't fail this early
+            }
+            job->claimed = false;
+        }
+        i2c_bus_t[i].head = 0;
+        i2c_bus_t[i].tail = 0;
+        i2c_bus_t[i].xfer_index = 0;
+        i2c_bus_t[i].hadFailure = false;
+        i2c_bus_t[i].expecting_scd = false;
+    }
+}
+
+/**
+ * @brief
+ *   Run a list of transfers on a bus and wait for all of them to complete
+ *
+ * @details
+ *   The job joins the bus queue and is started by the ISR as soon as the job
+ *   ahead of it finishes. Transfers within the job are chained from the ISR
+ *   without waking the caller in between. A transfer flagged I2C_XFER_NO_STOP
+ *   is followed by a repeated start instead of a stop condition. The job stops
+ *   at the first transfer that fails.
+ *
+ * @param[in] i2c
+ *   Pointer to I2C peripheral register block.
+ *
+ * @param[in] xfers
+ *   Transfers to run in order. Must stay valid until this returns
+ *
+ * @param[in] count
+ *   Number of transfers
+ *
+ * @return
+ *   Returns 0 if every transfer completed, <0 otherwise.
+ **/
+int i2c_Transfer(i2cBASE_t *i2c, const i2c_xfer_t *xfers, uint16_t count) {
+    uint32 index = i2c == i2cREG1 ? 0U : 1U;
+    struct i2c_bus *bus = &i2c_bus_t[index];
+    volatile int result = -1;
+    volatile bool done = false;
+    uint32_t seq;
+    uint32_t ahead;
+    i2c_job_t *job;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    // Queue the job, waiting for a free slot if the bus is very busy
+    TickType_t start = xTaskGetTickCount();
+    for (;;) {
+        taskENTER_CRITICAL();
+        ahead = bus->head - bus->tail;
+        if (ahead < I2C_JOB_QUEUE_LEN && !bus->jobs[bus->head % I2C_JOB_QUEUE_LEN].claimed) {
+            seq = bus->head;
+            job = &bus->jobs[seq % I2C_JOB_QUEUE_LEN];
+            job->xfers = xfers;
+            job->count = count;
+            job->claimed = true;
+            job->result = &result;
+            job->done = &done;
+            bus->head++;
+            if (ahead == 0) {
+                // Bus was idle
+                bus->xfer_index = 0;
+                bus->hadFailure = false;
+                prv_start_xfer(i2c, bus);
+            }
+            taskEXIT_CRITICAL();
+            break;
+        }
+        taskEXIT_CRITICAL();
+        if ((xTaskGetTickCount() - start) > I2C_TIMEOUT_MS) {
+            return -1;
+        }
+        vTaskDelay(1);
+    }
+
+    // Every job ahead of this one gets its own timeout
+    TickType_t timeout = I2C_TIMEOUT_MS * (ahead + count);
+    start = xTaskGetTickCount();
+    while (!done) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout || xSemaphoreTake(job->complete, timeout - elapsed) != pdTRUE) {
+            break;
+        }
+    }
+
+    taskENTER_CRITICAL();
+    if (!done) {
+        // Timed out. Detach the job so the ISR never touches this stack frame again
+        job->result = NULL;
+        job->done = NULL;
+        if (seq == bus->tail) {
+            // It is on the bus: abandon it the way a blocking transfer would
+            i2cSetStop(i2c);
+            i2cClearSCD(i2c);
+            bus->expecting_scd = false;
+            prv_next_job(i2c, bus);
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (done) {
+        // The give is still pending if the ISR finished the job before the first wait or
+        // after the last one gave up. Take it before the slot can be queued again
+        xSemaphoreTake(job->complete, 0);
+    }
+    job->claimed = false;
+
+    return result;
 }
 
 /**
@@ -60,40 +191,8 @@ void init_i2c_driver() {
  **/
 
 int i2c_Receive(i2cBASE_t *i2c, uint8_t addr, uint16_t size, void *buf) {
-    int ret = 0;
-    uint32 index = i2c == i2cREG1 ? 0U : 1U;
-
-    if (xSemaphoreTake(i2csemphr_t[index].i2c_mutex, I2C_TIMEOUT_MS) != pdTRUE) {
-        return -1;
-    }
-
-    taskENTER_CRITICAL();
-    i2csemphr_t[index].expecting_scd = true;
-    /* Configure address of Slave to talk to */
-    i2cSetSlaveAdd(i2c, addr);
-    i2cSetDirection(i2c, I2C_RECEIVER);
-    i2cSetCount(i2c, size);
-    i2cSetMode(i2c, I2C_MASTER);
-    i2cSetStop(i2c);
-    i2cSetStart(i2c);
-    i2cReceive(i2c, size, buf);
-    taskEXIT_CRITICAL();
-
-    if (xSemaphoreTake(i2csemphr_t[index].i2c_block, I2C_TIMEOUT_MS) != pdTRUE) {
-        i2cSetStop(i2c);
-        ret = -1;
-    } else {
-        if (i2csemphr_t[index].hadFailure == true) {
-            ret = -1;
-            i2csemphr_t[index].hadFailure = false; // reset failure flag
-        }
-    }
-
-    /* Clear the Stop condition */
-    i2cClearSCD(i2c);
-    i2csemphr_t[index].expecting_scd = false;
-    xSemaphoreGive(i2csemphr_t[index].i2c_mutex);
-    return ret;
+    i2c_xfer_t xfer = {addr, I2C_XFER_READ, size, buf};
+    return i2c_Transfer(i2c, &xfer, 1);
 }
 
 /**
@@ -116,51 +215,106 @@ int i2c_Receive(i2cBASE_t *i2c, uint8_t addr, uint16_t size, void *buf) {
  *   Returns 0 data written, <0 if unable to write data.
  **/
 int i2c_Send(i2cBASE_t *i2c, uint8_t addr, uint16_t size, void *buf) {
-    int ret = 0;
-    uint32 index = i2c == i2cREG1 ? 0U : 1U;
+    i2c_xfer_t xfer = {addr, I2C_XFER_WRITE, size, buf};
+    return i2c_Transfer(i2c, &xfer, 1);
+}
 
-    if (xSemaphoreTake(i2csemphr_t[index].i2c_mutex, I2C_TIMEOUT_MS) != pdTRUE) {
-        return -1;
-    }
+/**
+ * @brief
+ *   Write to an i2c device, then read back after a repeated start.
+ *   Typically a register address followed by the register contents.
+ *
+ * @return
+ *   Returns 0 on success, <0 if either half failed.
+ **/
+int i2c_WriteRead(i2cBASE_t *i2c, uint8_t addr, uint16_t wsize, void *wbuf, uint16_t rsize, void *rbuf) {
+    i2c_xfer_t xfers[2] = {{addr, I2C_XFER_WRITE | I2C_XFER_NO_STOP, wsize, wbuf},
+                           {addr, I2C_XFER_READ, rsize, rbuf}};
+    return i2c_Transfer(i2c, xfers, 2);
+}
+
+/**
+ * @brief
+ *   Program the peripheral for the current transfer of the job on the bus.
+ *   Called with interrupts masked or from the ISR.
+ **/
+static void prv_start_xfer(i2cBASE_t *i2c, struct i2c_bus *bus) {
+    const i2c_job_t *job = &bus->jobs[bus->tail % I2C_JOB_QUEUE_LEN];
+    const i2c_xfer_t *xfer = &job->xfers[bus->xfer_index];
+    bool read = (xfer->flags & I2C_XFER_READ) != 0;
 
-    taskENTER_CRITICAL();
-    i2csemphr_t[index].expecting_scd = true;
     /* Configure address of Slave to talk to */
-    i2cSetSlaveAdd(i2c, addr);
-    i2cSetDirection(i2c, I2C_TRANSMITTER);
-    i2cSetCount(i2c, size);
+    i2cSetSlaveAdd(i2c, xfer->addr);
+    i2cSetDirection(i2c, read ? I2C_RECEIVER : I2C_TRANSMITTER);
+    i2cSetCount(i2c, xfer->size);
     i2cSetMode(i2c, I2C_MASTER);
-    i2cSetStop(i2c);
-    i2cSetStart(i2c);
-    i2cSend(i2c, size, buf);
-    taskEXIT_CRITICAL();
-
-    if (xSemaphoreTake(i2csemphr_t[index].i2c_block, I2C_TIMEOUT_MS) != pdTRUE) {
+    if ((xfer->flags & I2C_XFER_NO_STOP) == 0) {
+        bus->expecting_scd = true;
         i2cSetStop(i2c);
-        ret = -1;
+    }
+    i2cSetStart(i2c);
+    if (read) {
+        i2cReceive(i2c, xfer->size, xfer->buf);
     } else {
-        if (i2csemphr_t[index].hadFailure == true) {
-            ret = -1;
-            i2csemphr_t[index].hadFailure = false; // reset failure flag
-        }
+        i2cSend(i2c, xfer->size, xfer->buf);
+    }
+}
+
+/**
+ * @brief
+ *   Retire the job on the bus and start the next queued one, if any.
+ *   Called with interrupts masked or from the ISR.
+ **/
+static void prv_next_job(i2cBASE_t *i2c, struct i2c_bus *bus) {
+    bus->tail++;
+    // Skip jobs whose owners gave up before they reached the bus
+    while (bus->tail != bus->head && bus->jobs[bus->tail % I2C_JOB_QUEUE_LEN].done == NULL) {
+        bus->tail++;
+    }
+    if (bus->tail != bus->head) {
+        bus->xfer_index = 0;
+        bus->hadFailure = false;
+        prv_start_xfer(i2c, bus);
+    }
+}
+
+/**
+ * @brief
+ *   Current transfer finished. Chain the next transfer of the job or
+ *   complete the job and wake its owner.
+ **/
+static void prv_xfer_done(i2cBASE_t *i2c, struct i2c_bus *bus, BaseType_t *xHigherPriorityTaskWoken) {
+    if (bus->head == bus->tail) {
+        return; // nothing on the bus
     }
+    i2c_job_t *job = &bus->jobs[bus->tail % I2C_JOB_QUEUE_LEN];
 
-    /* Clear the Stop condition */
-    i2cClearSCD(i2c);
-    i2csemphr_t[index].expecting_scd = false;
-    xSemaphoreGive(i2csemphr_t[index].i2c_mutex);
-    return ret;
+    if (!bus->hadFailure && (bus->xfer_index + 1U) < job->count) {
+        bus->xfer_index++;
+        prv_start_xfer(i2c, bus);
+        return;
+    }
+
+    if (job->done != NULL) {
+        *job->result = bus->hadFailure ? -1 : 0;
+        *job->done = true;
+        xSemaphoreGiveFromISR(job->complete, xHigherPriorityTaskWoken);
+    }
+    bus->hadFailure = false;
+    prv_next_job(i2c, bus);
 }
 
 void i2cNotification(i2cBASE_t *i2c, uint32 flags) {
     uint32 reg = i2c == i2cREG1 ? 0U : 1U;
-    static BaseType_t xHigherPriorityTaskWoken=pdFALSE;
+    struct i2c_bus *bus = &i2c_bus_t[reg];
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
     switch (flags) {
 
     case I2C_NACK_INT: // nack received after start byte. attempt to recover. A nack on the start byte does not trigger an interrupt
         i2c->STR = (uint32)I2C_NACK_INT;
-        i2csemphr_t[reg].hadFailure = true;
+        bus->hadFailure = true;
+        bus->expecting_scd = true; // the job ends on the stop condition below
         i2cSetStop(i2c);
         break;
 
@@ -170,16 +324,23 @@ void i2cNotification(i2cBASE_t *i2c, uint32 flags) {
         break;
 
     case I2C_SCD_INT:
-        if (i2csemphr_t[reg].expecting_scd == true) {
-            i2csemphr_t[reg].expecting_scd = false;
-            xSemaphoreGiveFromISR(i2csemphr_t[reg].i2c_block, &xHigherPriorityTaskWoken);
+        if (bus->expecting_scd == true) {
+            bus->expecting_scd = false;
+            i2cClearSCD(i2c);
+            prv_xfer_done(i2c, bus, &xHigherPriorityTaskWoken);
+        } else {
+            i2cClearSCD(i2c);
         }
-        i2cClearSCD(i2c);
         break;
 
     case I2C_ARDY_INT:
-        i2csemphr_t[reg].hadFailure = true;
-        i2cSetStop(i2c);
+        if (bus->head != bus->tail && !bus->expecting_scd) {
+            // Count reached zero on a transfer without a stop: repeated start into the next one
+            prv_xfer_done(i2c, bus, &xHigherPriorityTaskWoken);
+        } else {
+            bus->hadFailure = true;
+            i2cSetStop(i2c);
+        }
         break;
 
     case I2C_AAS_INT: // this shouldn't happen since Athena is not configured as a slave device
@@ -191,4 +352,3 @@ void i2cNotification(i2cBASE_t *i2c, uint32 flags) {
     }
     portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
 }
-
@@ -72,6 +72,7 @@
  * memory management pages of http://www.FreeRTOS.org for more information.
  */
 #include <stdlib.h>
+#include <string.h>
 
 /* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
 all the API functions to use the MPU wrappers.  That should only be done when
@@ -89,6 +90,10 @@ task.h is included from an application file. */
 /* Assumes 8bit bytes! */
 #define heapBITS_PER_BYTE		( ( size_t ) 8 )
 
+/* Free blocks smaller than 1 << heapHISTOGRAM_FIRST_SHIFT bytes go in the
+first histogram bucket. */
+#define heapHISTOGRAM_FIRST_SHIFT	( 6 )
+
 #pragma DATA_SECTION(ucHeap, ".kernelHEAP")
 
 
@@ -119,6 +124,12 @@ static void prvInsertBlockIntoFreeList( BlockLink_t *pxBlockToInsert );
  */
 static void prvHeapInit( void );
 
+/*
+ * Counts an allocation against the task making it.  Called with the scheduler
+ * suspended.
+ */
+static void prvRecordCaller( size_t xRequestedSize, BaseType_t xFailed );
+
 /*-----------------------------------------------------------*/
 
 
@@ -140,6 +151,24 @@ application.  When the bit is free the block is still part of the free heap
 space. */
 static size_t xBlockAllocatedBit = 0;
 
+/* Allocation counters reported by vPortGetHeapStats(). */
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+static size_t xNumberOfFailedAllocations = 0;
+static size_t xLargestFailedRequest = 0;
+
+/* Per task allocation counters reported by uxPortGetHeapCallerStats().  Slots
+are matched on both the handle and the name so a handle reused by a later
+task does not inherit the counts of a deleted one. */
+typedef struct A_CALLER_SLOT
+{
+	TaskHandle_t xTask;
+	HeapCallerStats_t xStats;
+} HeapCallerSlot_t;
+
+static HeapCallerSlot_t xCallerSlots[ portHEAP_CALLER_SLOTS ];
+static UBaseType_t uxCallerSlotsUsed = 0;
+
 /*-----------------------------------------------------------*/
 
 
@@ -147,6 +176,7 @@ void *pvPortMalloc( size_t xWantedSize )
 {
 BlockLink_t *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
 void *pvReturn = NULL;
+size_t xRequestedSize = xWantedSize;
 
 	vTaskSuspendAll();
 	{
@@ -270,6 +300,20 @@ void *pvReturn = NULL;
 			mtCOVERAGE_TEST_MARKER();
 		}
 
+		if( pvReturn != NULL )
+		{
+			xNumberOfSuccessfulAllocations++;
+		}
+		else
+		{
+			xNumberOfFailedAllocations++;
+			if( xRequestedSize > xLargestFailedRequest )
+			{
+				xLargestFailedRequest = xRequestedSize;
+			}
+		}
+		prvRecordCaller( xRequestedSize, ( BaseType_t ) ( pvReturn == NULL ) );
+
 		traceMALLOC( pvReturn, xWantedSize );
 	}
 	( void ) xTaskResumeAll();
@@ -323,6 +367,7 @@ BlockLink_t *pxLink;
 				{
 					/* Add this block to the list of free blocks. */
 					xFreeBytesRemaining += pxLink->xBlockSize;
+					xNumberOfSuccessfulFrees++;
 					traceFREE( pv, pxLink->xBlockSize );
 					prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
 				}
@@ -353,6 +398,139 @@ size_t xPortGetMinimumEverFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+BlockLink_t *pxBlock;
+size_t xSize;
+UBaseType_t uxBucket;
+
+	memset( pxHeapStats, 0, sizeof( HeapStats_t ) );
+
+	vTaskSuspendAll();
+	{
+		/* The heap is set up by the first allocation, until then there are no
+		free blocks to walk. */
+		if( pxEnd != NULL )
+		{
+			pxHeapStats->xSizeOfSmallestFreeBlockInBytes = ( size_t ) -1;
+
+			/* The list runs in address order from xStart to pxEnd. */
+			for( pxBlock = xStart.pxNextFreeBlock; pxBlock != pxEnd; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				xSize = pxBlock->xBlockSize;
+				pxHeapStats->xNumberOfFreeBlocks++;
+
+				if( xSize > pxHeapStats->xSizeOfLargestFreeBlockInBytes )
+				{
+					pxHeapStats->xSizeOfLargestFreeBlockInBytes = xSize;
+				}
+
+				if( xSize < pxHeapStats->xSizeOfSmallestFreeBlockInBytes )
+				{
+					pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xSize;
+				}
+
+				uxBucket = 0;
+				xSize >>= heapHISTOGRAM_FIRST_SHIFT;
+				while( ( xSize != 0 ) && ( uxBucket < ( portHEAP_HISTOGRAM_BUCKETS - 1 ) ) )
+				{
+					xSize >>= 1;
+					uxBucket++;
+				}
+
+				if( pxHeapStats->usFreeBlockHistogram[ uxBucket ] < UINT16_MAX )
+				{
+					pxHeapStats->usFreeBlockHistogram[ uxBucket ]++;
+				}
+			}
+
+			if( pxHeapStats->xNumberOfFreeBlocks == 0 )
+			{
+				pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+		pxHeapStats->xNumberOfFailedAllocations = xNumberOfFailedAllocations;
+		pxHeapStats->xLargestFailedRequest = xLargestFailedRequest;
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortGetHeapCallerStats( HeapCallerStats_t *pxCallerStats, UBaseType_t uxMaxCallers )
+{
+UBaseType_t ux;
+
+	vTaskSuspendAll();
+	{
+		for( ux = 0; ( ux < uxCallerSlotsUsed ) && ( ux < uxMaxCallers ); ux++ )
+		{
+			pxCallerStats[ ux ] = xCallerSlots[ ux ].xStats;
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	return ux;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecordCaller( size_t xRequestedSize, BaseType_t xFailed )
+{
+TaskHandle_t xTask = NULL;
+const char *pcName = "boot";
+HeapCallerSlot_t *pxSlot = NULL;
+UBaseType_t ux;
+
+	if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+	{
+		xTask = xTaskGetCurrentTaskHandle();
+		pcName = pcTaskGetName( xTask );
+	}
+
+	for( ux = 0; ux < uxCallerSlotsUsed; ux++ )
+	{
+		if( ( xCallerSlots[ ux ].xTask == xTask ) &&
+			( strncmp( xCallerSlots[ ux ].xStats.pcTaskName, pcName, configMAX_TASK_NAME_LEN ) == 0 ) )
+		{
+			pxSlot = &xCallerSlots[ ux ];
+			break;
+		}
+	}
+
+	if( pxSlot == NULL )
+	{
+		if( uxCallerSlotsUsed < ( portHEAP_CALLER_SLOTS - 1 ) )
+		{
+			pxSlot = &xCallerSlots[ uxCallerSlotsUsed++ ];
+			pxSlot->xTask = xTask;
+			strncpy( pxSlot->xStats.pcTaskName, pcName, configMAX_TASK_NAME_LEN - 1 );
+		}
+		else
+		{
+			/* Table full, everyone else shares the last slot. */
+			pxSlot = &xCallerSlots[ portHEAP_CALLER_SLOTS - 1 ];
+			if( uxCallerSlotsUsed < portHEAP_CALLER_SLOTS )
+			{
+				uxCallerSlotsUsed++;
+				pxSlot->xTask = NULL;
+				strncpy( pxSlot->xStats.pcTaskName, "other", configMAX_TASK_NAME_LEN - 1 );
+			}
+		}
+	}
+
+	pxSlot->xStats.ulAllocations++;
+	pxSlot->xStats.ulBytesRequested += ( uint32_t ) xRequestedSize;
+	if( xFailed != pdFALSE )
+	{
+		pxSlot->xStats.ulFailures++;
+	}
+}
+/*-----------------------------------------------------------*/
+
 void vPortInitialiseBlocks( void )
 {
 	/* This just exists to keep the linker quiet. */
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file base64_bench.c
+ * @date 2026-10-19
+ */
+
+/* base64 of a beacon sized packet into a caller buffer */
+
+#include "micro_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "base_64.h"
+#include "../source/base_64.c"
+
+#define BASE64_BENCH_PACKET_LEN 53
+#define BASE64_BENCH_ROUNDS 1000000
+
+bool base64_bench(void) {
+    unsigned char packet[BASE64_BENCH_PACKET_LEN];
+    char out[BASE64_ENCODED_LEN(BASE64_BENCH_PACKET_LEN) + 1];
+    size_t len = 0;
+    uint64_t start, elapsed_ns;
+    int i;
+
+    srand(0x64);
+    for (i = 0; i < BASE64_BENCH_PACKET_LEN; i++) {
+        packet[i] = (unsigned char)rand();
+    }
+
+    start = micro_bench_now_ns();
+    for (i = 0; i < BASE64_BENCH_ROUNDS; i++) {
+        packet[0] = (unsigned char)i; // a new packet each round, so the loop is not folded away
+        len = base64_encode_into(packet, sizeof(packet), out, sizeof(out));
+    }
+    elapsed_ns = micro_bench_now_ns() - start;
+
+    printf("base64 of %d bytes: %.1f ns per packet\n", BASE64_BENCH_PACKET_LEN,
+           (double)elapsed_ns / BASE64_BENCH_ROUNDS);
+    return len == BASE64_ENCODED_LEN(BASE64_BENCH_PACKET_LEN);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file crc16_bench.c
+ * @date 2026-10-19
+ */
+
+/* CRC-16 of a flash image sized buffer, bitwise and slicing-by-8 */
+
+#include "micro_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "crc16.h"
+#include "../source/crc16.c"
+
+#define CRC16_BENCH_LEN (2 * 1024 * 1024)
+
+bool crc16_bench(void) {
+    uint8_t *buf = malloc(CRC16_BENCH_LEN);
+    uint64_t start, bitwise_ns, slice8_ns;
+    uint16_t bitwise_crc, slice8_crc;
+    uint32_t i;
+
+    if (buf == NULL) {
+        return false;
+    }
+    srand(0x1021);
+    for (i = 0; i < CRC16_BENCH_LEN; i++) {
+        buf[i] = (uint8_t)rand();
+    }
+
+    start = micro_bench_now_ns();
+    bitwise_crc = crc16_bitwise(CRC16_INIT, buf, CRC16_BENCH_LEN);
+    bitwise_ns = micro_bench_now_ns() - start;
+
+    start = micro_bench_now_ns();
+    slice8_crc = crc16_slice8(CRC16_INIT, buf, CRC16_BENCH_LEN);
+    slice8_ns = micro_bench_now_ns() - start;
+
+    printf("crc16 over %d bytes: bitwise %.3f ms, slice8 %.3f ms\n", CRC16_BENCH_LEN, bitwise_ns / 1e6,
+           slice8_ns / 1e6);
+    free(buf);
+    return slice8_crc == bitwise_crc;
+}
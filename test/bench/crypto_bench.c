@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file crypto_bench.c
+ * @date 2026-10-19
+ */
+
+/* What each HMAC and XTEA protected packet costs: without contexts the HMAC pads are
+ * hashed and XTEA runs the generic path for every packet, with them both come from the
+ * context built once per key */
+
+#include "micro_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crypto.h"
+#include "sha1.h"
+#include "../source/crypto.c"
+#include "../source/sha1.c"
+
+#define CRYPTO_BENCH_PACKETS 20000
+#define CRYPTO_BENCH_MAX_LEN 256 // an FTP data packet
+#define CRYPTO_BENCH_HEADER 4    // the CSP id, covered by the HMAC
+
+// crypto.c keeps the key store in the EEPROM
+static key_store stored_keys;
+
+Fapi_StatusType eeprom_get_key_store(key_store *k) {
+    *k = stored_keys;
+    return Fapi_Status_Success;
+}
+
+Fapi_StatusType eeprom_set_key_store(key_store *k) {
+    stored_keys = *k;
+    return Fapi_Status_Success;
+}
+
+/* The generic path: the key loaded and the key word picked from the sum every
+ * round, on byte buffers */
+static void xtea_generic(const uint8_t key[CRYPTO_XTEA_KEY_LEN], uint8_t block[CRYPTO_XTEA_BLOCK_LEN]) {
+    uint32_t k[4], v0, v1, sum = 0;
+    int i;
+    for (i = 0; i < 4; i++) {
+        k[i] = ((uint32_t)key[4 * i] << 24) | ((uint32_t)key[4 * i + 1] << 16) | ((uint32_t)key[4 * i + 2] << 8) |
+               key[4 * i + 3];
+    }
+    v0 = ((uint32_t)block[0] << 24) | ((uint32_t)block[1] << 16) | ((uint32_t)block[2] << 8) | block[3];
+    v1 = ((uint32_t)block[4] << 24) | ((uint32_t)block[5] << 16) | ((uint32_t)block[6] << 8) | block[7];
+    for (i = 0; i < CRYPTO_XTEA_CYCLES; i++) {
+        v0 += (((v1 << 4) ^ (v1 >> 5)) + v1) ^ (sum + k[sum & 3]);
+        sum += XTEA_DELTA;
+        v1 += (((v0 << 4) ^ (v0 >> 5)) + v0) ^ (sum + k[(sum >> 11) & 3]);
+    }
+    for (i = 0; i < 4; i++) {
+        block[i] = (uint8_t)(v0 >> (24 - 8 * i));
+        block[4 + i] = (uint8_t)(v1 >> (24 - 8 * i));
+    }
+}
+
+/* csp_xtea_encrypt from libcsp 1.6 on top of the generic block */
+static void xtea_generic_csp(const uint8_t *key, uint8_t *plain, const uint32_t len, uint32_t iv[2]) {
+    uint32_t i, j, remain;
+    uint32_t blocks = (len + CRYPTO_XTEA_BLOCK_LEN - 1) / CRYPTO_XTEA_BLOCK_LEN;
+    uint8_t stream[CRYPTO_XTEA_BLOCK_LEN];
+    uint32_t words[2] = {iv[0], iv[1]};
+
+    for (i = 0; i < blocks; i++) {
+        for (j = 0; j < 4; j++) {
+            stream[j] = (uint8_t)(words[0] >> (24 - 8 * j));
+            stream[4 + j] = (uint8_t)(words[1] >> (24 - 8 * j));
+        }
+        xtea_generic(key, stream);
+        remain = len - i * CRYPTO_XTEA_BLOCK_LEN;
+        for (j = 0; j < (remain < CRYPTO_XTEA_BLOCK_LEN ? remain : CRYPTO_XTEA_BLOCK_LEN); j++) {
+            plain[len - remain + j] ^= stream[j];
+        }
+        words[0] = iv[0];
+        words[1] = iv[1]++;
+    }
+}
+
+bool crypto_bench(void) {
+    static const uint32_t sizes[] = {32, CRYPTO_BENCH_MAX_LEN}; // a telecommand, an FTP data packet
+    uint8_t packet[CRYPTO_BENCH_HEADER + CRYPTO_BENCH_MAX_LEN], generic_packet[sizeof(packet)];
+    uint8_t mac[CRYPTO_HMAC_LEN], generic_mac[CRYPTO_HMAC_LEN];
+    uint8_t hmac_key[CRYPTO_XTEA_KEY_LEN], xtea_key[CRYPTO_XTEA_KEY_LEN];
+    uint32_t nonce[2] = {1, 0}, i, s;
+    crypto_hmac_ctx hmac_ctx;
+    crypto_xtea_ctx xtea_ctx;
+    bool same = true;
+
+    srand(0x5EED);
+    for (i = 0; i < CRYPTO_XTEA_KEY_LEN; i++) {
+        hmac_key[i] = (uint8_t)rand();
+        xtea_key[i] = (uint8_t)rand();
+    }
+    crypto_hmac_init(&hmac_ctx, hmac_key, sizeof(hmac_key));
+    crypto_xtea_init(&xtea_ctx, xtea_key, sizeof(xtea_key));
+
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        uint32_t len = sizes[s];
+        uint64_t start, generic_ns, context_ns;
+
+        for (i = 0; i < sizeof(packet); i++) {
+            packet[i] = (uint8_t)rand();
+        }
+        memcpy(generic_packet, packet, sizeof(packet));
+
+        start = micro_bench_now_ns();
+        for (i = 0; i < CRYPTO_BENCH_PACKETS; i++) {
+            crypto_hmac_ctx hmac;
+            uint32_t iv[2] = {nonce[0], i};
+            xtea_generic_csp(xtea_key, &generic_packet[CRYPTO_BENCH_HEADER], len, iv);
+            crypto_hmac_init(&hmac, hmac_key, sizeof(hmac_key));
+            crypto_hmac(&hmac, generic_packet, CRYPTO_BENCH_HEADER + len, generic_mac);
+        }
+        generic_ns = micro_bench_now_ns() - start;
+
+        start = micro_bench_now_ns();
+        for (i = 0; i < CRYPTO_BENCH_PACKETS; i++) {
+            nonce[1] = i;
+            crypto_xtea_csp(&xtea_ctx, &packet[CRYPTO_BENCH_HEADER], len, nonce);
+            crypto_hmac(&hmac_ctx, packet, CRYPTO_BENCH_HEADER + len, mac);
+        }
+        context_ns = micro_bench_now_ns() - start;
+
+        printf("crypto on %3u byte packets: per packet %.0f packets/s, cached contexts %.0f packets/s\n",
+               (unsigned int)len, CRYPTO_BENCH_PACKETS * 1e9 / generic_ns, CRYPTO_BENCH_PACKETS * 1e9 / context_ns);
+        same &= memcmp(packet, generic_packet, sizeof(packet)) == 0 && memcmp(mac, generic_mac, sizeof(mac)) == 0;
+    }
+    return same;
+}
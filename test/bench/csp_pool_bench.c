@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file csp_pool_bench.c
+ * @date 2026-10-19
+ */
+
+/* Ten minutes of file transfer and housekeeping traffic sharing one radio, run
+ * against a single 1 KiB buffer class and against size classes */
+
+#include "micro_bench.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "csp_pool.h"
+#include "../source/csp_pool.c"
+
+#define CSP_BENCH_OVERHEAD 16 // the packet header in front of the data
+
+static uint64_t memory[4096];
+
+/*
+ * Load simulation in 1 ms steps. One radio sends packets first come first served.
+ *
+ * - ftp keeps up to SIM_FTP_WINDOW 1 KiB blocks out. Like RDP, a block is held from
+ *   allocation until its acknowledgement arrives SIM_ACK_RTT_MS after it was sent,
+ *   and is sent again if no acknowledgement came within SIM_RDP_TIMEOUT_MS
+ * - acknowledgements and housekeeping requests are received into full size buffers,
+ *   as the interfaces do. A housekeeping request is answered in the same buffer
+ * - hk sends small packets on a timer, asking for its size as csp_buffer_get_small
+ *   does. General and cli replies come from csp_buffer_get, which is always full size
+ */
+#define SIM_MS 600000
+#define SIM_RADIO_BYTES_PER_MS 2 // about 19200 baud
+#define SIM_WIRE_OVERHEAD 10
+#define SIM_TRAILER 12
+#define SIM_FTP_BLOCK 1000
+#define SIM_FTP_WINDOW 4
+#define SIM_ACK_RTT_MS 400
+#define SIM_RDP_TIMEOUT_MS 3000
+#define SIM_RETRY_MS 10
+#define SIM_RX_HOLD_MS 2
+#define SIM_HK_PERIOD_MS 1000
+#define SIM_HK_PROCESS_MS 30
+#define SIM_HK_REPLY 200
+#define SIM_STATUS_PERIOD_MS 500
+#define SIM_STATUS_LEN 40
+#define SIM_ACK_PERIOD_MS 250
+#define SIM_ACK_LEN 20
+#define SIM_CLI_PERIOD_MS 2000
+#define SIM_CLI_LEN 200
+#define SIM_QUEUE_LEN 64
+
+enum { BLOCK_FREE, BLOCK_QUEUED, BLOCK_SENT };
+
+typedef struct {
+    void *buf;
+    uint16_t len;
+    int8_t block; // index of the ftp block, -1 for anything else
+} sim_packet;
+
+typedef struct {
+    void *buf;
+    uint8_t state;
+    bool acked;
+    uint32_t ack_at;
+    uint32_t resend_at;
+} sim_block;
+
+typedef struct {
+    uint32_t ftp_bytes;
+    uint32_t ftp_resends;
+    uint32_t small_sent;
+    uint32_t small_lost;
+    uint32_t hk_answered;
+    uint32_t hk_lost;
+    uint32_t failures;
+} sim_result;
+
+static sim_packet queue[SIM_QUEUE_LEN];
+static uint8_t q_head, q_count;
+
+static void sim_enqueue(void *buf, uint16_t len, int8_t block) {
+    sim_packet *p = &queue[(q_head + q_count++) % SIM_QUEUE_LEN];
+    p->buf = buf;
+    p->len = len + SIM_WIRE_OVERHEAD;
+    p->block = block;
+}
+
+/* A timed packet source that drops its packet when there is no buffer */
+static void sim_send(uint32_t t, uint16_t len, bool small, const char *caller, sim_result *r) {
+    void *buf = csp_pool_get(small ? len + SIM_TRAILER : 1024, caller, t);
+    if (buf == NULL) {
+        r->small_lost++;
+        return;
+    }
+    sim_enqueue(buf, len, -1);
+}
+
+static bool sim_run(const csp_pool_class_config *config, uint8_t count, sim_result *r) {
+    sim_block blocks[SIM_FTP_WINDOW];
+    void *rx_buf[16];
+    uint32_t rx_free_at[16];
+    void *hk_buf = NULL;
+    uint32_t hk_reply_at = 0;
+    sim_packet tx = {0};
+    uint32_t tx_left = 0;
+    uint32_t ftp_next_try = 0;
+    uint32_t t;
+    csp_pool_class_stats stats[CSP_POOL_MAX_CLASSES];
+    csp_pool_caller_stats callers[CSP_POOL_MAX_CALLERS];
+    uint8_t i;
+
+    if (csp_pool_memory_size(config, count, CSP_BENCH_OVERHEAD) > sizeof(memory) ||
+        !csp_pool_init(config, count, CSP_BENCH_OVERHEAD, memory)) {
+        return false;
+    }
+    memset(r, 0, sizeof(*r));
+    memset(blocks, 0, sizeof(blocks));
+    memset(rx_buf, 0, sizeof(rx_buf));
+    q_head = q_count = 0;
+
+    for (t = 0; t < SIM_MS; t++) {
+        // radio
+        if (tx_left > 0) {
+            tx_left = tx_left > SIM_RADIO_BYTES_PER_MS ? tx_left - SIM_RADIO_BYTES_PER_MS : 0;
+            if (tx_left == 0) {
+                if (tx.block >= 0) {
+                    sim_block *b = &blocks[tx.block];
+                    b->state = BLOCK_SENT;
+                    b->ack_at = t + SIM_ACK_RTT_MS;
+                    b->resend_at = t + SIM_RDP_TIMEOUT_MS;
+                } else {
+                    csp_pool_free(tx.buf, t);
+                    r->small_sent++;
+                }
+            }
+        }
+        if (tx_left == 0 && q_count > 0) {
+            tx = queue[q_head];
+            q_head = (q_head + 1) % SIM_QUEUE_LEN;
+            q_count--;
+            tx_left = tx.len;
+        }
+
+        // acknowledgements come in, or the block is sent again
+        for (i = 0; i < SIM_FTP_WINDOW; i++) {
+            sim_block *b = &blocks[i];
+            if (b->state != BLOCK_SENT) {
+                continue;
+            }
+            if (t == b->ack_at) {
+                uint8_t j;
+                void *rx = csp_pool_get(1024, NULL, t);
+                if (rx == NULL) {
+                    continue;
+                }
+                for (j = 0; rx_buf[j] != NULL; j++) {
+                }
+                rx_buf[j] = rx;
+                rx_free_at[j] = t + SIM_RX_HOLD_MS;
+                csp_pool_free(b->buf, t);
+                b->state = BLOCK_FREE;
+                r->ftp_bytes += SIM_FTP_BLOCK;
+            } else if (t == b->resend_at) {
+                b->state = BLOCK_QUEUED;
+                sim_enqueue(b->buf, SIM_FTP_BLOCK, i);
+                r->ftp_resends++;
+            }
+        }
+        for (i = 0; i < 16; i++) {
+            if (rx_buf[i] != NULL && t == rx_free_at[i]) {
+                csp_pool_free(rx_buf[i], t);
+                rx_buf[i] = NULL;
+            }
+        }
+
+        // housekeeping request, answered in the buffer it came in
+        if (t % SIM_HK_PERIOD_MS == 7) {
+            if (hk_buf != NULL) {
+                r->hk_lost++;
+            } else if ((hk_buf = csp_pool_get(1024, NULL, t)) == NULL) {
+                r->hk_lost++;
+            } else {
+                hk_reply_at = t + SIM_HK_PROCESS_MS;
+            }
+        }
+        if (hk_buf != NULL && t == hk_reply_at) {
+            sim_enqueue(hk_buf, SIM_HK_REPLY, -1);
+            hk_buf = NULL;
+            r->hk_answered++;
+        }
+
+        if (t % SIM_STATUS_PERIOD_MS == 3) {
+            sim_send(t, SIM_STATUS_LEN, true, "hk", r);
+        }
+        if (t % SIM_ACK_PERIOD_MS == 5) {
+            sim_send(t, SIM_ACK_LEN, false, "general", r);
+        }
+        if (t % SIM_CLI_PERIOD_MS == 11) {
+            sim_send(t, SIM_CLI_LEN, false, "cli", r);
+        }
+
+        // file transfer fills its window, backing off when the pool is empty
+        if (t >= ftp_next_try) {
+            for (i = 0; i < SIM_FTP_WINDOW; i++) {
+                if (blocks[i].state != BLOCK_FREE) {
+                    continue;
+                }
+                blocks[i].buf = csp_pool_get(SIM_FTP_BLOCK + SIM_TRAILER, "ftp", t);
+                if (blocks[i].buf == NULL) {
+                    ftp_next_try = t + SIM_RETRY_MS;
+                    break;
+                }
+                blocks[i].state = BLOCK_QUEUED;
+                sim_enqueue(blocks[i].buf, SIM_FTP_BLOCK, i);
+            }
+        }
+    }
+
+    count = csp_pool_get_stats(stats, CSP_POOL_MAX_CLASSES, t);
+    for (i = 0; i < count; i++) {
+        r->failures += stats[i].failures;
+        printf("  %4u x %2u: high water %2u, allocs %6u, fallbacks %5u, failures %5u, "
+               "hold avg %4u ms max %5u ms\n",
+               stats[i].data_size, stats[i].count, stats[i].high_water, stats[i].allocs, stats[i].fallbacks,
+               stats[i].failures, stats[i].hold_avg_ms, stats[i].hold_max_ms);
+    }
+    count = csp_pool_get_callers(callers, CSP_POOL_MAX_CALLERS);
+    printf("  failures by caller:");
+    for (i = 0; i < count; i++) {
+        printf(" %s %u", callers[i].name, callers[i].failures);
+    }
+    printf("\n  ftp %.2f kB/s, %u resends; small sent %u, lost %u; hk answered %u, lost %u\n",
+           r->ftp_bytes / (double)SIM_MS, r->ftp_resends, r->small_sent, r->small_lost, r->hk_answered,
+           r->hk_lost);
+    return true;
+}
+
+bool csp_pool_bench(void) {
+    const csp_pool_class_config single[] = {{1024, 10}};
+    const csp_pool_class_config classed[] = {{64, 10}, {1024, 9}};
+    sim_result single_r, classed_r;
+    size_t single_mem = csp_pool_memory_size(single, 1, CSP_BENCH_OVERHEAD);
+    size_t classed_mem = csp_pool_memory_size(classed, 2, CSP_BENCH_OVERHEAD);
+
+    printf("csp pool, 10 x 1024 (%u bytes):\n", (unsigned int)single_mem);
+    if (!sim_run(single, 1, &single_r)) {
+        return false;
+    }
+    printf("csp pool, 10 x 64 + 9 x 1024 (%u bytes):\n", (unsigned int)classed_mem);
+    if (!sim_run(classed, 2, &classed_r)) {
+        return false;
+    }
+
+    // Requests answered and packets sent take full size buffers ftp would otherwise have had
+    return classed_mem <= single_mem && classed_r.failures < single_r.failures &&
+           classed_r.small_lost <= single_r.small_lost && classed_r.hk_lost <= single_r.hk_lost &&
+           classed_r.ftp_bytes * 4 >= single_r.ftp_bytes * 3;
+}
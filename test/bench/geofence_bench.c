@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file geofence_bench.c
+ * @date 2026-10-19
+ */
+
+/* A day of orbit at one position a second through the geofence, from Earth fixed
+ * vectors and from latitude and longitude, against the acos great circle check the
+ * coordinate management daemon used before */
+
+#include "micro_bench.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "coordinate_management/geofence.h"
+#include "../source/coordinate_management/geofence.c"
+
+#define GEOFENCE_BENCH_SECONDS (24 * 60 * 60)
+#define ORBIT_ALTITUDE_KM 550.0
+#define ORBIT_INCLINATION_DEG 97.5
+#define EARTH_MU 398600.4418        // km^3/s^2
+#define EARTH_ROTATION 7.2921159e-5 // rad/s
+
+/* The China regions, Edmonton, and a few more stations */
+static const float bench_zones[][4] = {
+    {30.7475f, 111.1816f, 1500.0f, -1.0f}, // lat, lon, radius km or -1, elevation mask
+    {38.5413f, 88.4180f, 1350.0f, -1.0f},
+    {46.3135f, 123.9258f, 1000.0f, -1.0f},
+    {53.5232f, -113.5263f, -1.0f, 10.0f},
+    {78.2300f, 15.4000f, -1.0f, 5.0f},
+    {-33.9000f, 18.4000f, -1.0f, 10.0f},
+    {64.8000f, -147.7000f, -1.0f, 10.0f},
+    {-77.8500f, 166.6700f, -1.0f, 5.0f},
+};
+#define BENCH_ZONES (sizeof(bench_zones) / sizeof(bench_zones[0]))
+
+static void set_zones(void) {
+    unsigned int i;
+    for (i = 0; i < BENCH_ZONES; i++) {
+        if (bench_zones[i][2] > 0) {
+            geofence_set_region(i, bench_zones[i][0], bench_zones[i][1], bench_zones[i][2]);
+        } else {
+            geofence_set_station(i, bench_zones[i][0], bench_zones[i][1], bench_zones[i][3]);
+        }
+    }
+}
+
+/* Great circle check with acos per zone and update */
+static int trig_update(const float *lat, const float *lon, const float enter[], const float leave[],
+                       bool inside[]) {
+    int changes = 0;
+    unsigned int i;
+
+    for (i = 0; i < BENCH_ZONES; i++) {
+        float lat1 = *lat * DEG_TO_RAD, lat2 = bench_zones[i][0] * DEG_TO_RAD;
+        float dlon = fabsf(*lon - bench_zones[i][1]) * DEG_TO_RAD;
+        float c = sinf(lat1) * sinf(lat2) + cosf(lat1) * cosf(lat2) * cosf(dlon);
+        float angle = acosf(c > 1.0f ? 1.0f : c);
+        if (!inside[i] && angle <= enter[i]) {
+            inside[i] = true;
+            changes++;
+        } else if (inside[i] && angle > leave[i]) {
+            inside[i] = false;
+            changes++;
+        }
+    }
+    return changes;
+}
+
+bool geofence_bench(void) {
+    geofence_vec *positions = malloc(GEOFENCE_BENCH_SECONDS * sizeof(geofence_vec));
+    float *lat = malloc(GEOFENCE_BENCH_SECONDS * sizeof(float));
+    float *lon = malloc(GEOFENCE_BENCH_SECONDS * sizeof(float));
+    float enter[BENCH_ZONES], leave[BENCH_ZONES];
+    bool inside[BENCH_ZONES] = {false};
+    double r = GEOFENCE_EARTH_RADIUS_KM + ORBIT_ALTITUDE_KM;
+    double n = sqrt(EARTH_MU / (r * r * r));
+    double incl = ORBIT_INCLINATION_DEG * DEG_TO_RAD;
+    int trig_events = 0, dot_events = 0, lat_lon_events = 0;
+    uint64_t start, trig_ns, dot_ns, lat_lon_ns;
+    unsigned int i;
+    int t;
+
+    if (positions == NULL || lat == NULL || lon == NULL) {
+        free(positions);
+        free(lat);
+        free(lon);
+        return false;
+    }
+    geofence_init();
+    geofence_set_altitude((float)ORBIT_ALTITUDE_KM);
+    set_zones();
+    for (i = 0; i < BENCH_ZONES; i++) {
+        enter[i] = bench_zones[i][2] > 0 ? bench_zones[i][2] / GEOFENCE_EARTH_RADIUS_KM
+                                         : station_angle(bench_zones[i][3]);
+        leave[i] = enter[i] + GEOFENCE_HYSTERESIS_KM / GEOFENCE_EARTH_RADIUS_KM;
+    }
+
+    // Circular orbit from the ascending node at 0 longitude, rotated into the Earth fixed frame
+    for (t = 0; t < GEOFENCE_BENCH_SECONDS; t++) {
+        double u = n * t, theta = -EARTH_ROTATION * t;
+        double x = r * cos(u), y = r * sin(u) * cos(incl), z = r * sin(u) * sin(incl);
+        positions[t].x = (float)(x * cos(theta) - y * sin(theta));
+        positions[t].y = (float)(x * sin(theta) + y * cos(theta));
+        positions[t].z = (float)z;
+        lat[t] = (float)(asin(z / r) / DEG_TO_RAD);
+        lon[t] = (float)(atan2(positions[t].y, positions[t].x) / DEG_TO_RAD);
+    }
+
+    start = micro_bench_now_ns();
+    for (t = 0; t < GEOFENCE_BENCH_SECONDS; t++) {
+        trig_events += trig_update(&lat[t], &lon[t], enter, leave, inside);
+    }
+    trig_ns = micro_bench_now_ns() - start;
+
+    start = micro_bench_now_ns();
+    for (t = 0; t < GEOFENCE_BENCH_SECONDS; t++) {
+        dot_events += geofence_update(&positions[t], t);
+    }
+    dot_ns = micro_bench_now_ns() - start;
+
+    for (i = 0; i < BENCH_ZONES; i++) {
+        geofence_clear(i);
+    }
+    set_zones();
+    start = micro_bench_now_ns();
+    for (t = 0; t < GEOFENCE_BENCH_SECONDS; t++) {
+        lat_lon_events += geofence_update_lat_lon(lat[t], lon[t], t);
+    }
+    lat_lon_ns = micro_bench_now_ns() - start;
+
+    printf("geofence over %d s, %d zones, %d events: trig %.2f ms, dot %.2f ms, lat/lon %.2f ms\n",
+           GEOFENCE_BENCH_SECONDS, (int)BENCH_ZONES, dot_events, trig_ns / 1e6, dot_ns / 1e6, lat_lon_ns / 1e6);
+
+    free(positions);
+    free(lat);
+    free(lon);
+    return dot_events > 0 && dot_events == trig_events && lat_lon_events == trig_events;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file mem_region_bench.c
+ * @date 2026-10-19
+ */
+
+/* An allocation trace shaped like the FTP, scheduler, ADCS and GPS hot paths, replayed
+ * through the size classes and through the heap */
+
+#include "micro_bench.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "mem_region.h"
+#include "../source/mem_region.c"
+
+#define MEM_BENCH_TRACE_LEN 200000
+#define MEM_BENCH_SLOTS 48
+
+typedef struct {
+    uint8_t slot;  // which live pointer the operation works on
+    uint16_t size; // 0 to free the slot
+} mem_bench_op;
+
+static mem_bench_op trace[MEM_BENCH_TRACE_LEN];
+static void *live[MEM_BENCH_SLOTS];
+
+/*
+ * Slots 0-11 are FTP blocks queued for S-band, up to 10 in flight, slots 12-27
+ * a schedule of 16 commands being rewritten, 28 ADCS telemetry and 29 GPS messages.
+ */
+static void build_trace(void) {
+    int n = 0;
+    int ftp_head = 0, ftp_tail = 0;
+    unsigned int seed = 1;
+
+    while (n < MEM_BENCH_TRACE_LEN - 64) {
+        seed = seed * 1103515245 + 12345;
+        switch ((seed >> 16) % 4) {
+        case 0: // FTP, the sender frees the oldest block once 10 are queued
+            if (ftp_head - ftp_tail == 10) {
+                trace[n++] = (mem_bench_op){ftp_tail++ % 12, 0};
+            }
+            trace[n++] = (mem_bench_op){ftp_head++ % 12, 12 + 1024};
+            break;
+        case 1: { // scheduler reads the whole schedule back then frees it
+            int i;
+            for (i = 0; i < 16; i++) {
+                trace[n++] = (mem_bench_op){12 + i, 36};
+            }
+            for (i = 0; i < 16; i++) {
+                trace[n++] = (mem_bench_op){12 + i, 0};
+            }
+            break;
+        }
+        case 2:
+            trace[n++] = (mem_bench_op){28, 112};
+            trace[n++] = (mem_bench_op){28, 0};
+            break;
+        default:
+            trace[n++] = (mem_bench_op){29, 7 + (seed >> 8) % 24};
+            trace[n++] = (mem_bench_op){29, 0};
+            break;
+        }
+    }
+    while (ftp_tail < ftp_head) {
+        trace[n++] = (mem_bench_op){ftp_tail++ % 12, 0};
+    }
+    while (n < MEM_BENCH_TRACE_LEN) {
+        trace[n++] = (mem_bench_op){29, 0}; // free of NULL
+    }
+}
+
+/**
+ * @return
+ *      ns per operation, or a negative value if an allocation failed
+ */
+static double replay(void *(*alloc)(size_t), void (*release)(void *)) {
+    int failures = 0;
+    int i;
+
+    memset(live, 0, sizeof(live));
+    uint64_t start = micro_bench_now_ns();
+    for (i = 0; i < MEM_BENCH_TRACE_LEN; i++) {
+        if (trace[i].size == 0) {
+            release(live[trace[i].slot]);
+            live[trace[i].slot] = NULL;
+        } else {
+            live[trace[i].slot] = alloc(trace[i].size);
+            if (live[trace[i].slot] == NULL) {
+                failures++;
+            } else {
+                memset(live[trace[i].slot], 0xA5, trace[i].size);
+            }
+        }
+    }
+    double ns = (double)(micro_bench_now_ns() - start) / MEM_BENCH_TRACE_LEN;
+    return failures == 0 ? ns : -1;
+}
+
+bool mem_region_bench(void) {
+    mem_region_init();
+    build_trace();
+    double region_ns = replay(mem_region_alloc, mem_region_free);
+    double heap_ns = replay(pvPortMalloc, vPortFree);
+
+    printf("mem_region trace of %d ops: %.1f ns/op in size classes, %.1f ns/op from the host malloc, %u spills\n",
+           MEM_BENCH_TRACE_LEN, region_ns, heap_ns, (unsigned int)mem_region_spills());
+    return region_ns >= 0 && heap_ns >= 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file micro_bench.c
+ * @date 2026-10-19
+ */
+
+/* Host throughput of single modules, run outside the unit tests so those stay quick.
+ *
+ *   make bench
+ *   ./bench/micro_bench [name...]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "micro_bench.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    const char *name;
+    bool (*run)(void);
+} micro_bench;
+
+static const micro_bench benches[] = {
+    {"crc16", crc16_bench},
+    {"base64", base64_bench},
+    {"mem_region", mem_region_bench},
+    {"crypto", crypto_bench},
+    {"geofence", geofence_bench},
+    {"xmodem", xmodem_bench},
+    {"csp_pool", csp_pool_bench},
+};
+
+#define MICRO_BENCH_COUNT (sizeof(benches) / sizeof(benches[0]))
+
+uint64_t micro_bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief
+ *      Run the benchmarks named on the command line, or all of them
+ * @return
+ *      Non-zero if a name is unknown or a benchmark failed
+ */
+int main(int argc, char **argv) {
+    int failed = 0;
+    int i, arg;
+
+    for (i = 0; i < (int)MICRO_BENCH_COUNT; i++) {
+        bool selected = argc < 2;
+        for (arg = 1; arg < argc; arg++) {
+            selected |= strcmp(argv[arg], benches[i].name) == 0;
+        }
+        if (selected && !benches[i].run()) {
+            printf("%s: FAILED\n", benches[i].name);
+            failed++;
+        }
+    }
+    for (arg = 1; arg < argc; arg++) {
+        for (i = 0; i < (int)MICRO_BENCH_COUNT && strcmp(argv[arg], benches[i].name) != 0; i++) {
+        }
+        if (i == (int)MICRO_BENCH_COUNT) {
+            printf("unknown benchmark %s\n", argv[arg]);
+            failed++;
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file micro_bench.h
+ * @date 2026-10-19
+ */
+
+#ifndef MICRO_BENCH_H
+#define MICRO_BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Monotonic host time */
+uint64_t micro_bench_now_ns(void);
+
+/* One per module. Each prints its results and returns false if the run went wrong */
+bool crc16_bench(void);
+bool base64_bench(void);
+bool mem_region_bench(void);
+bool crypto_bench(void);
+bool geofence_bench(void);
+bool xmodem_bench(void);
+bool csp_pool_bench(void);
+
+#endif /* MICRO_BENCH_H */
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file xmodem_bench.c
+ * @date 2026-10-19
+ */
+
+/* Link time of a file sent to Northern Spirit with base64 XMODEM and with streamed
+ * XMODEM-1K, over a modelled UART. The receiver acknowledges every block after a fixed
+ * turnaround, so the difference is the framing and the encoding */
+
+#include "micro_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xmodem.h"
+#include "../source/xmodem.c"
+
+#define XMODEM_BENCH_FILE_LEN (64 * 1024)
+#define XMODEM_BENCH_BAUD 115200
+#define XMODEM_BENCH_TURNAROUND_US 5000 // receiver time to check a block and answer
+
+static uint8_t file[XMODEM_BENCH_FILE_LEN];
+static uint32_t file_pos;
+static uint64_t link_us;
+static uint32_t blocks;
+static uint8_t answers[8];
+static int answer_head, answer_tail;
+static uint8_t *sending;
+static uint32_t sending_len;
+
+static void answer(uint8_t c) { answers[answer_tail++ % sizeof(answers)] = c; }
+
+/* The payload, taking every packet and acknowledging it */
+static void receive(const uint8_t *data, uint32_t len) {
+    link_us += (uint64_t)len * 10 * 1000000 / XMODEM_BENCH_BAUD;
+    if (len == 1) {
+        if (data[0] == EOT) {
+            answer(ACK);
+        }
+        return;
+    }
+    link_us += XMODEM_BENCH_TURNAROUND_US;
+    blocks++;
+    answer(ACK);
+}
+
+NS_return NS_sendOnly(uint8_t *command, uint32_t command_length) {
+    receive(command, command_length);
+    return NS_OK;
+}
+
+NS_return NS_sendBegin(uint8_t *command, uint32_t command_length) {
+    sending = command;
+    sending_len = command_length;
+    return NS_OK;
+}
+
+NS_return NS_sendEnd(TickType_t timeout) {
+    receive(sending, sending_len);
+    return NS_OK;
+}
+
+NS_return NS_expectResponse(uint8_t *response, uint8_t length, TickType_t timeout) {
+    uint8_t i;
+    for (i = 0; i < length; i++) {
+        if (answer_head == answer_tail) {
+            link_us += (uint64_t)timeout * 1000;
+            return NS_UART_FAIL;
+        }
+        response[i] = answers[answer_head++ % sizeof(answers)];
+    }
+    return NS_OK;
+}
+
+void NS_resetQueue(void) { answer_head = answer_tail; }
+
+TickType_t xTaskGetTickCount(void) { return (TickType_t)(link_us / 1000); }
+
+int32_t red_read(int32_t iFildes, void *pBuffer, uint32_t ulLength) {
+    if (ulLength > XMODEM_BENCH_FILE_LEN - file_pos) {
+        ulLength = XMODEM_BENCH_FILE_LEN - file_pos;
+    }
+    memcpy(pBuffer, &file[file_pos], ulLength);
+    file_pos += ulLength;
+    return ulLength;
+}
+
+int32_t red_open(const char *pszPath, uint32_t ulOpenMode) { return -1; }
+int32_t red_close(int32_t iFildes) { return 0; }
+int32_t red_write(int32_t iFildes, const void *pBuffer, uint32_t ulLength) { return ulLength; }
+
+static void start(void) {
+    file_pos = 0;
+    link_us = 0;
+    blocks = 0;
+    answer_head = answer_tail = 0;
+    answer('C'); // the receiver asks for CRC blocks
+}
+
+bool xmodem_bench(void) {
+    xmodem_stats stats;
+    uint64_t base64_us;
+    uint32_t base64_blocks;
+    int base64_sent, stream_sent;
+    uint32_t i;
+
+    srand(XMODEM_BENCH_FILE_LEN);
+    for (i = 0; i < XMODEM_BENCH_FILE_LEN; i++) {
+        file[i] = (uint8_t)rand();
+    }
+
+    start();
+    base64_sent = xmodemTransmit(0, XMODEM_BENCH_FILE_LEN);
+    base64_us = link_us;
+    base64_blocks = blocks;
+
+    start();
+    stream_sent = xmodemTransmitStream(0, XMODEM_BENCH_FILE_LEN, &stats);
+
+    printf("xmodem %d bytes at %d baud: base64 %u blocks %.2f s, stream 1K %u blocks %.2f s (%u B/s)\n",
+           XMODEM_BENCH_FILE_LEN, XMODEM_BENCH_BAUD, (unsigned int)base64_blocks, base64_us / 1e6,
+           (unsigned int)stats.blocks, link_us / 1e6, (unsigned int)stats.bytes_per_s);
+    return base64_sent == XMODEM_BENCH_FILE_LEN && stream_sent == XMODEM_BENCH_FILE_LEN;
+}
@@ -1,6 +1,20 @@
 #include "logger/test_logger.h"
 #include "test_leop.h"
 #include "test_adcs_handler.h"
+#include "test_adcs_tlm_cache.h"
+#include "test_xmodem.h"
+#include "test_crc16.h"
+#include "test_crypto.h"
+#include "test_eeprom_log.h"
+#include "test_image_update.h"
+#include "test_image_patch.h"
+#include "test_base_64.h"
+#include "diagnostic/test_task_stats.h"
+#include "coordinate_management/test_geofence.h"
+#include "test_mem_region.h"
+#include "test_csp_pool.h"
+#include "test_snapshot.h"
+#include "test_nmea_parser.h"
 #include "test_leop.h"
 
 int main() {
@@ -8,6 +22,20 @@ int main() {
     status += test_logger();
     status += test_leop();
     status += test_adcs_handler();
+    status += test_adcs_tlm_cache();
+    status += test_xmodem();
+    status += test_crc16();
+    status += test_crypto();
+    status += test_eeprom_log();
+    status += test_image_update();
+    status += test_image_patch();
+    status += test_base_64();
+    status += test_task_stats();
+    status += test_geofence();
+    status += test_mem_region();
+    status += test_csp_pool();
+    status += test_snapshot();
+    status += test_nmea_parser();
     status += test_leop();
     return status;
 }
@@ -0,0 +1,371 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file bench.c
+ * @date 2026-10-19
+ */
+
+/* Throughput and latency of FTP, housekeeping, logging and scheduling, measured the way
+ * the ground station sees them: over CSP, through the service dispatcher */
+
+#include "bench.h"
+#include <FreeRTOS.h>
+#include <os_task.h>
+#include <csp/csp.h>
+#include <csp/csp_endian.h>
+#include <redposix.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "file_transfer/ftp.h"
+#include "housekeeping/housekeeping_service.h"
+#include "logger/logger.h"
+#include "scheduler/scheduler.h"
+#include "services.h"
+#include "util/service_utilities.h"
+
+#define BENCH_FTP_FILE "VOL0:/bench.bin"
+#define BENCH_FTP_SIZE (256 * 1024)
+#define BENCH_FTP_BLOCK 512 // blocks plus the FTP header must fit a CSP buffer
+#define BENCH_HK_ROUNDS 20
+#define BENCH_LOG_MESSAGES 100
+#define BENCH_SCHED_CMDS 4
+#define BENCH_SCHED_LEAD_S 15 // the scheduler task sleeps 10 s after it starts
+#define BENCH_REPLY_TIMEOUT 5000
+
+typedef struct {
+    uint32_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+} bench_stat;
+
+static volatile uint32_t sink_count = 0;
+static int64_t sink_late_ms[BENCH_SCHED_CMDS];
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void stat_add(bench_stat *stat, uint64_t value) {
+    if (stat->count == 0 || value < stat->min) {
+        stat->min = value;
+    }
+    if (value > stat->max) {
+        stat->max = value;
+    }
+    stat->sum += value;
+    stat->count++;
+}
+
+static void stat_print(const char *name, const bench_stat *stat, const char *unit) {
+    if (stat->count == 0) {
+        fprintf(stdout, "%-24s no samples\n", name);
+        return;
+    }
+    fprintf(stdout, "%-24s n=%-4u min=%llu avg=%llu max=%llu %s\n", name, stat->count,
+            (unsigned long long)stat->min, (unsigned long long)(stat->sum / stat->count),
+            (unsigned long long)stat->max, unit);
+}
+
+static csp_conn_t *bench_connect(uint8_t port) {
+    return csp_connect(CSP_PRIO_NORM, CSP_ADDRESS, port, BENCH_REPLY_TIMEOUT, CSP_O_HMAC);
+}
+
+/**
+ * @brief
+ *      Write a file, then download it with one burst request and time the blocks arriving
+ */
+static bool bench_ftp(void) {
+    static uint8_t block[BENCH_FTP_BLOCK];
+    uint32_t i;
+
+    int32_t fd = red_open(BENCH_FTP_FILE, RED_O_CREAT | RED_O_TRUNC | RED_O_WRONLY);
+    if (fd < 0) {
+        fprintf(stdout, "ftp: cannot create %s, red_errno %d\n", BENCH_FTP_FILE, (int)red_errno);
+        return false;
+    }
+    uint64_t start = now_us();
+    for (i = 0; i < BENCH_FTP_SIZE / sizeof(block); i++) {
+        memset(block, (uint8_t)i, sizeof(block));
+        red_write(fd, block, sizeof(block));
+    }
+    red_close(fd);
+    red_transact("VOL0:");
+    uint64_t write_us = now_us() - start;
+    fprintf(stdout, "%-24s %u bytes in %llu us, %llu KiB/s\n", "fs write", BENCH_FTP_SIZE,
+            (unsigned long long)write_us,
+            (unsigned long long)(write_us ? BENCH_FTP_SIZE * 1000000ULL / 1024 / write_us : 0));
+
+    csp_conn_t *conn = bench_connect(TC_FTP_COMMAND_SERVICE);
+    csp_packet_t *packet = csp_buffer_get(64);
+    if (conn == NULL || packet == NULL) {
+        fprintf(stdout, "ftp: no connection or buffer\n");
+        if (packet != NULL) {
+            csp_buffer_free(packet);
+        }
+        if (conn != NULL) {
+            csp_close(conn);
+        }
+        return false;
+    }
+    packet->data[SUBSERVICE_BYTE] = FTP_REQUEST_BURST_DOWNLOAD;
+    cnv32_8(1, &packet->data[IN_DATA_BYTE]);                                         // request id
+    cnv32_8(BENCH_FTP_BLOCK, &packet->data[IN_DATA_BYTE + 4]);                       // block size
+    cnv32_8(0, &packet->data[IN_DATA_BYTE + 8]);                                     // skip
+    cnv32_8(BENCH_FTP_SIZE / BENCH_FTP_BLOCK + 1, &packet->data[IN_DATA_BYTE + 12]); // one past the end
+    cnv32_8(0, &packet->data[IN_DATA_BYTE + 16]);                                    // use_sband
+    strcpy((char *)&packet->data[IN_DATA_BYTE + 20], BENCH_FTP_FILE);
+    packet->length = IN_DATA_BYTE + 20 + strlen(BENCH_FTP_FILE) + 1;
+
+    start = now_us();
+    if (!csp_send(conn, packet, BENCH_REPLY_TIMEOUT)) {
+        csp_buffer_free(packet);
+        csp_close(conn);
+        return false;
+    }
+
+    uint32_t bytes = 0;
+    uint32_t blocks = 0;
+    uint64_t first_us = 0;
+    bool done = false;
+    while (!done && (packet = csp_read(conn, BENCH_REPLY_TIMEOUT)) != NULL) {
+        if (packet->data[SUBSERVICE_BYTE] == FTP_DATA_PACKET) {
+            int8_t status = (int8_t)packet->data[STATUS_BYTE];
+            uint32_t size;
+            memcpy(&size, &packet->data[6], sizeof(size)); // after subservice, status and request id
+            if (blocks++ == 0) {
+                first_us = now_us() - start;
+            }
+            bytes += size;
+            done = status == -1;
+        }
+        csp_buffer_free(packet);
+    }
+    uint64_t total_us = now_us() - start;
+    csp_close(conn);
+    red_unlink(BENCH_FTP_FILE);
+
+    fprintf(stdout, "%-24s %u bytes in %u blocks, first after %llu us, %llu KiB/s\n", "ftp burst download",
+            bytes, blocks, (unsigned long long)first_us,
+            (unsigned long long)(total_us ? bytes * 1000000ULL / 1024 / total_us : 0));
+    return done && bytes == BENCH_FTP_SIZE;
+}
+
+/**
+ * @brief
+ *      Time collecting and storing a housekeeping record, and fetching the latest one over CSP
+ */
+static bool bench_housekeeping(void) {
+    bench_stat collect = {0};
+    bench_stat fetch = {0};
+    uint16_t hk_size = get_size_of_housekeeping();
+    int i;
+
+    for (i = 0; i < BENCH_HK_ROUNDS; i++) {
+        uint64_t start = now_us();
+        if (populate_and_store_hk_data() != SUCCESS) {
+            fprintf(stdout, "housekeeping: populate_and_store_hk_data failed\n");
+            return false;
+        }
+        stat_add(&collect, now_us() - start);
+    }
+
+    for (i = 0; i < BENCH_HK_ROUNDS; i++) {
+        csp_conn_t *conn = bench_connect(TC_HOUSEKEEPING_SERVICE);
+        if (conn == NULL) {
+            break;
+        }
+        csp_packet_t *packet = csp_buffer_get(1);
+        if (packet == NULL) {
+            csp_close(conn);
+            break;
+        }
+        packet->data[SUBSERVICE_BYTE] = GET_LATEST_HK;
+        packet->length = 1;
+
+        uint64_t start = now_us();
+        if (!csp_send(conn, packet, BENCH_REPLY_TIMEOUT)) {
+            csp_buffer_free(packet);
+        } else if ((packet = csp_read(conn, BENCH_REPLY_TIMEOUT)) != NULL) {
+            if (packet->length == hk_size + 2) {
+                stat_add(&fetch, now_us() - start);
+            }
+            csp_buffer_free(packet);
+        }
+        csp_close(conn);
+    }
+
+    stat_print("hk collect and store", &collect, "us");
+    stat_print("hk fetch latest", &fetch, "us");
+    return fetch.count == BENCH_HK_ROUNDS;
+}
+
+static int32_t log_size(const char *path) {
+    REDSTAT stat;
+    int32_t fd = red_open(path, RED_O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    int32_t size = red_fstat(fd, &stat) == 0 ? (int32_t)stat.st_size : 0;
+    red_close(fd);
+    return size;
+}
+
+/**
+ * @brief
+ *      Log a burst of messages and time how long the logger takes to get them to the file
+ * @details
+ *      sys_log never waits for room in the logger queue, so messages that do not
+ *      reach the file were dropped
+ */
+static bool bench_logging(void) {
+    char msg[32];
+    int i;
+
+    snprintf(msg, sizeof(msg), "bench message %03d", 0);
+    // as written by do_output: uptime, level, task name, message
+    int32_t line_len = 10 + 1 + strlen("I,bench,") + strlen(msg) + 2;
+
+    vTaskDelay(pdMS_TO_TICKS(500)); // let earlier output drain
+    int32_t before = log_size(get_logger_file());
+
+    uint64_t start = now_us();
+    for (i = 0; i < BENCH_LOG_MESSAGES; i++) {
+        sys_log(INFO, "bench message %03d", i);
+    }
+    uint64_t call_us = now_us() - start;
+
+    int32_t size = before;
+    int32_t last = -1;
+    uint64_t drained_us = 0;
+    while (size != last) {
+        last = size;
+        drained_us = now_us() - start;
+        vTaskDelay(pdMS_TO_TICKS(200));
+        size = log_size(get_logger_file());
+    }
+
+    // the logger starts a new file every few kB, at most once for this many messages
+    int32_t written = size >= before ? size - before : log_size(get_logger_old_file()) - before + size;
+    int32_t lines = written / line_len;
+
+    fprintf(stdout, "%-24s %d messages, %llu us per call, %d written, %d dropped, drained in %llu us\n",
+            "sys_log burst", BENCH_LOG_MESSAGES, (unsigned long long)(call_us / BENCH_LOG_MESSAGES), (int)lines,
+            (int)(BENCH_LOG_MESSAGES - lines), (unsigned long long)drained_us);
+    return lines > 0;
+}
+
+/**
+ * @brief
+ *      Stands in for the service a scheduled command is addressed to
+ */
+static void bench_sink(void *pvParameters) {
+    csp_socket_t *sock = csp_socket(CSP_SO_NONE);
+    csp_bind(sock, BENCH_SINK_PORT);
+    csp_listen(sock, 2);
+
+    for (;;) {
+        csp_conn_t *conn = csp_accept(sock, CSP_MAX_TIMEOUT);
+        if (conn == NULL) {
+            continue;
+        }
+        csp_packet_t *packet = csp_read(conn, BENCH_REPLY_TIMEOUT);
+        if (packet != NULL) {
+            int64_t now = wall_ms();
+            uint32_t due;
+            memcpy(&due, packet->data, sizeof(due));
+            if (sink_count < BENCH_SCHED_CMDS) {
+                sink_late_ms[sink_count] = now - (int64_t)due * 1000;
+            }
+            sink_count++;
+            if (!csp_send(conn, packet, BENCH_REPLY_TIMEOUT)) { // the scheduler waits for a reply
+                csp_buffer_free(packet);
+            }
+        }
+        csp_close(conn);
+    }
+}
+
+/**
+ * @brief
+ *      Schedule one-shot commands a second apart and measure how late each is dispatched
+ */
+static bool bench_scheduler(void) {
+    bench_stat late = {0};
+    int i;
+
+    xTaskCreate(bench_sink, "bench_sink", 512, NULL, NORMAL_SERVICE_PRIO, NULL);
+
+    csp_conn_t *conn = bench_connect(TC_SCHEDULER_SERVICE);
+    csp_packet_t *packet = csp_buffer_get(128);
+    if (conn == NULL || packet == NULL) {
+        return false;
+    }
+    uint32_t first = (uint32_t)(wall_ms() / 1000) + BENCH_SCHED_LEAD_S;
+    uint8_t *ptr = &packet->data[IN_DATA_BYTE];
+    packet->data[SUBSERVICE_BYTE] = SET_SCHEDULE;
+    for (i = 0; i < BENCH_SCHED_CMDS; i++) {
+        uint32_t due = first + i;
+        uint32_t next = csp_hton32(due);
+        uint32_t zero = 0;
+        uint16_t len = sizeof(due);
+        memcpy(ptr, &next, 4); // next
+        memcpy(ptr + 4, &zero, 4); // period
+        memcpy(ptr + 8, &zero, 4); // last
+        ptr[12] = CSP_ADDRESS;
+        ptr[13] = BENCH_SINK_PORT;
+        memcpy(ptr + 14, &len, sizeof(len));
+        memcpy(ptr + 16, &due, sizeof(due)); // the command carries its own due time to the sink
+        ptr += 16 + sizeof(due);
+    }
+    packet->length = ptr - packet->data;
+
+    if (!csp_send(conn, packet, BENCH_REPLY_TIMEOUT)) {
+        csp_buffer_free(packet);
+    } else if ((packet = csp_read(conn, BENCH_REPLY_TIMEOUT)) != NULL) {
+        csp_buffer_free(packet);
+    }
+    csp_close(conn);
+
+    while (sink_count < BENCH_SCHED_CMDS && wall_ms() / 1000 < first + BENCH_SCHED_CMDS + 10) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    for (i = 0; i < BENCH_SCHED_CMDS && i < (int)sink_count; i++) {
+        stat_add(&late, sink_late_ms[i] < 0 ? 0 : (uint64_t)sink_late_ms[i]);
+    }
+    stat_print("scheduler lateness", &late, "ms");
+    return sink_count == BENCH_SCHED_CMDS;
+}
+
+bool bench_run_all(void) {
+    bool ok = true;
+
+    fprintf(stdout, "---- benchmarks ----\n");
+    ok &= bench_ftp();
+    ok &= bench_housekeeping();
+    ok &= bench_logging();
+    ok &= bench_scheduler();
+    fprintf(stdout, "---- %s ----\n", ok ? "done" : "FAILED");
+    fflush(stdout);
+    return ok;
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file bench.h
+ * @date 2026-10-19
+ */
+
+#ifndef SIM_BENCH_H
+#define SIM_BENCH_H
+
+#include <stdbool.h>
+
+#define BENCH_SINK_PORT 40 // receives the commands dispatched by the scheduler
+
+/* Run every benchmark from a task, returns false if any of them failed outright */
+bool bench_run_all(void);
+
+#endif /* SIM_BENCH_H */
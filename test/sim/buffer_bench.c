@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file buffer_bench.c
+ * @date 2026-10-19
+ */
+
+/* Times RedBufferGet and RedBufferPut on their own, with the volume on a RAM disk so a
+ * miss costs a copy rather than an SD card transfer. Buffer count and REDCONF_BUFFER_HASH
+ * are compile time settings, see the bufbench targets in the Makefile */
+
+#include <FreeRTOS.h>
+#include <os_task.h>
+#include <redconf.h>
+#include <redfs.h>
+#include <redposix.h>
+#include <redcore.h>
+#include <redvolume.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BUF_BENCH_STACK_SIZE 2000
+#define BUF_BENCH_GETS 1000000U
+#define BUF_BENCH_STRIDE 7919U // prime, so the blocks of a working set are visited out of order
+
+typedef struct {
+    const char *name;
+    uint32_t blocks; // working set
+} buf_workload;
+
+/* Smaller than the cache, so nearly every get is a lookup that hits, and larger, so most
+ * gets search the whole cache and then pick a victim */
+static const buf_workload workloads[] = {
+    {"resident", (REDCONF_BUFFER_COUNT * 3U) / 4U},
+    {"thrash", REDCONF_BUFFER_COUNT * 2U},
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief
+ *      Get and put data blocks from the middle of the volume, well clear of the metadata
+ *      the mount left in the cache
+ */
+static bool run_one(const buf_workload *workload) {
+    uint32_t first = gpRedVolume->ulBlockCount / 2U;
+    uint32_t gets = 0, hits;
+    uint64_t start, elapsed_ns;
+    REDCORESTATS before = gRedCoreStats;
+    void *buffer;
+
+    start = now_ns();
+    for (; gets < BUF_BENCH_GETS; gets++) {
+        uint32_t block = first + (gets * BUF_BENCH_STRIDE) % workload->blocks;
+        REDSTATUS ret = RedBufferGet(block, 0U, &buffer);
+        if (ret != 0) {
+            fprintf(stdout, "%-9s RedBufferGet(%u) error %d\n", workload->name, (unsigned int)block, (int)ret);
+            return false;
+        }
+        RedBufferPut(buffer);
+    }
+    elapsed_ns = now_ns() - start;
+
+    hits = gRedCoreStats.ulBufferHits - before.ulBufferHits;
+    fprintf(stdout, "%-9s %4u blocks %8.1f ns/get %5.1f%% hit\n", workload->name, (unsigned int)workload->blocks,
+            (double)elapsed_ns / gets, hits * 100.0 / gets);
+    return true;
+}
+
+static void buf_bench_task(void *pvParameters) {
+    const char *volume = gaRedVolConf[0].pszPathPrefix;
+    bool ok = true;
+    size_t w;
+
+    if (red_format(volume) != 0 || red_mount(volume) != 0) {
+        fprintf(stderr, "cannot set up %s, red_errno %d\n", volume, (int)red_errno);
+        exit(1);
+    }
+    fprintf(stdout, "buffers %u, hash %u\n", (unsigned int)REDCONF_BUFFER_COUNT,
+            (unsigned int)REDCONF_BUFFER_HASH);
+    for (w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) {
+        ok &= run_one(&workloads[w]);
+    }
+    exit(ok ? 0 : 1);
+}
+
+int main(int argc, char **argv) {
+    if (red_init() != 0) {
+        fprintf(stderr, "red_init failed, red_errno %d\n", (int)red_errno);
+        return 1;
+    }
+    xTaskCreate(buf_bench_task, "buf_bench", BUF_BENCH_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
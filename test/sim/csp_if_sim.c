@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file csp_if_sim.c
+ * @date 2026-10-19
+ */
+
+#include "csp_if_sim.h"
+#include <FreeRTOS.h>
+#include <csp/csp_interface.h>
+#include <os_queue.h>
+#include <os_task.h>
+#include <stdbool.h>
+
+#define SIM_LINK_QUEUE_LEN 32
+#define SIM_LINK_TASK_PRIO (configMAX_PRIORITIES - 2)
+#define SIM_LINK_TASK_SIZE 512
+
+typedef struct {
+    csp_packet_t *packet;
+    uint64_t due_us;
+} sim_frame;
+
+static csp_iface_t sim_iface;
+static csp_sim_conf_t sim_conf;
+static QueueHandle_t link_queue = NULL;
+static uint64_t line_free_us = 0; // when the transmitter finishes the packets already on the link
+static uint32_t sent = 0;
+
+static uint64_t prv_now_us(void) { return (uint64_t)xTaskGetTickCount() * (1000000 / configTICK_RATE_HZ); }
+
+/**
+ * @brief
+ *      Put a packet on the simulated link
+ * @details
+ *      The packet arrives after it has been clocked out behind the packets
+ *      already queued, plus the propagation delay
+ */
+static int csp_sim_tx(const csp_route_t *ifroute, csp_packet_t *packet) {
+    csp_iface_t *iface = ifroute->iface;
+    sim_frame frame = {packet, 0};
+    uint32_t bytes = packet->length + sizeof(packet->id) + sim_conf.overhead;
+    uint64_t now = prv_now_us();
+
+    taskENTER_CRITICAL();
+    sent++;
+    bool lost = sim_conf.loss_every != 0 && sent % sim_conf.loss_every == 0;
+    uint64_t start = line_free_us > now ? line_free_us : now;
+    if (sim_conf.bitrate != 0) {
+        start += (uint64_t)bytes * 8 * 1000000 / sim_conf.bitrate;
+    }
+    line_free_us = start;
+    frame.due_us = start + (uint64_t)sim_conf.latency_ms * 1000;
+    taskEXIT_CRITICAL();
+
+    iface->txbytes += bytes;
+    if (lost) {
+        iface->drop++;
+        csp_buffer_free(packet);
+        return CSP_ERR_NONE; // the sender cannot tell, as over the air
+    }
+    if (xQueueSend(link_queue, &frame, 0) != pdPASS) {
+        return CSP_ERR_NOBUFS;
+    }
+    return CSP_ERR_NONE;
+}
+
+/**
+ * @brief
+ *      Deliver packets back into the router once they have crossed the link
+ */
+static void csp_sim_rx_task(void *pvParameters) {
+    sim_frame frame;
+    for (;;) {
+        xQueueReceive(link_queue, &frame, portMAX_DELAY);
+        uint64_t now = prv_now_us();
+        if (frame.due_us > now) {
+            uint64_t wait_us = frame.due_us - now;
+            vTaskDelay((TickType_t)((wait_us + (1000000 / configTICK_RATE_HZ) - 1) /
+                                    (1000000 / configTICK_RATE_HZ)));
+        }
+        sim_iface.rx++;
+        sim_iface.rxbytes += frame.packet->length + sizeof(frame.packet->id) + sim_conf.overhead;
+        csp_qfifo_write(frame.packet, &sim_iface, NULL);
+    }
+}
+
+void csp_sim_set_conf(const csp_sim_conf_t *conf) {
+    taskENTER_CRITICAL();
+    sim_conf = *conf;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief
+ *      Create the simulated link and add it to the interface list
+ * @details
+ *      Route addresses through it with csp_rtable_set. Routing the node's own
+ *      address through it turns every request to a local service into a
+ *      round trip over the modelled link
+ * @return
+ *      CSP_ERR_NONE on success
+ */
+int csp_sim_open_and_add_interface(const csp_sim_conf_t *conf, const char *ifname, csp_iface_t **return_iface) {
+    if (link_queue != NULL) {
+        return CSP_ERR_ALREADY;
+    }
+    link_queue = xQueueCreate(SIM_LINK_QUEUE_LEN, sizeof(sim_frame));
+    if (link_queue == NULL) {
+        return CSP_ERR_NOMEM;
+    }
+    if (xTaskCreate(csp_sim_rx_task, "csp_sim", SIM_LINK_TASK_SIZE, NULL, SIM_LINK_TASK_PRIO, NULL) != pdPASS) {
+        return CSP_ERR_NOMEM;
+    }
+    sim_conf = *conf;
+    sim_iface.name = ifname;
+    sim_iface.nexthop = csp_sim_tx;
+    sim_iface.mtu = csp_buffer_data_size();
+
+    int error = csp_iflist_add(&sim_iface);
+    if (error != CSP_ERR_NONE) {
+        return error;
+    }
+    if (return_iface != NULL) {
+        *return_iface = &sim_iface;
+    }
+    return CSP_ERR_NONE;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file csp_if_sim.h
+ * @date 2026-10-19
+ */
+
+#ifndef SIM_CSP_IF_SIM_H
+#define SIM_CSP_IF_SIM_H
+
+#include <csp/csp.h>
+#include <csp/csp_interface.h>
+
+#define CSP_IF_SIM_NAME "SIM"
+
+/* Loopback link with the timing of a radio or serial link, every packet sent comes back in */
+typedef struct {
+    uint32_t latency_ms; // one way propagation and processing delay
+    uint32_t bitrate;    // bits per second on the link, 0 for no serialisation delay
+    uint16_t overhead;   // framing bytes added to each packet, e.g. KISS or the radio header
+    uint32_t loss_every; // drop one packet in this many, 0 never
+} csp_sim_conf_t;
+
+int csp_sim_open_and_add_interface(const csp_sim_conf_t *conf, const char *ifname, csp_iface_t **return_iface);
+
+/* Change the link model while running, applies to packets sent afterwards */
+void csp_sim_set_conf(const csp_sim_conf_t *conf);
+
+#endif /* SIM_CSP_IF_SIM_H */
@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file fs_bench.c
+ * @date 2026-10-19
+ */
+
+/* Replays the file access patterns of the flight software against Reliance Edge on a
+ * simulated SD card, once per transaction setting. Block size and buffer count are
+ * compile time settings, see the fsbench targets in the Makefile */
+
+#include <FreeRTOS.h>
+#include <os_task.h>
+#include <redconf.h>
+#include <redfs.h>
+#include <redposix.h>
+#include <redcore.h>
+#include <redvolume.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "housekeeping/housekeeping_service.h"
+#include "mock_bus.h"
+#include "scheduler/scheduler.h"
+#include "sd_io.h"
+
+#define FS_BENCH_VOLUME "VOL0:"
+#define FS_BENCH_STACK_SIZE 2000
+#define FS_SCHED_FILE "VOL0:/gs_cmds.TMP"
+
+#define FS_LOG_LINES 500
+#define FS_LOG_LINE_LEN 72 // "%010d,%s\r\n" around a typical sys_log message
+#define FS_DFGM_SECONDS 10
+#define FS_DFGM_SAMPLE 16 // dfgm_data_sample_t on the OBC, where time_t is 32 bits
+#define FS_HK_RECORDS 100
+#define FS_HK_CONFIG_LEN 10 // MAX_FILES, current_file and the debug time in HKconfig.TMP
+#define FS_SCHED_REWRITES 100
+#define FS_SCHED_CMDS 8
+
+/* SPI SD card defaults, override from the command line with figures measured on the OBC */
+#define FS_SD_CMD_US 100
+#define FS_SD_BYTE_NS 800
+#define FS_SD_PROGRAM_US 800
+
+typedef struct {
+    uint32_t ops;
+    uint64_t bytes; // what the application asked to write
+} fs_work;
+
+typedef bool (*fs_workload_fn)(fs_work *work);
+
+typedef struct {
+    const char *name;
+    fs_workload_fn run;
+} fs_workload;
+
+typedef struct {
+    const char *name;
+    uint32_t mask;
+} fs_transact_setting;
+
+static mock_sd_card card = {.fd = -1};
+static mock_device sd = {.name = "sd", .ctx = &card};
+
+static uint8_t scratch[FS_SCHED_CMDS * sizeof(ScheduledCmd_t)];
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static bool write_all(int32_t fd, const void *data, uint32_t len, fs_work *work) {
+    if (red_write(fd, data, len) != (int32_t)len) {
+        fprintf(stdout, "red_write error %d\n", (int)red_errno);
+        return false;
+    }
+    work->ops++;
+    work->bytes += len;
+    return true;
+}
+
+/**
+ * @brief
+ *      The logger: an append to syslog.log and a transaction point for every line
+ */
+static bool workload_logger(fs_work *work) {
+    char line[FS_LOG_LINE_LEN];
+    int32_t fd = red_open("VOL0:/syslog.log", RED_O_CREAT | RED_O_RDWR | RED_O_APPEND);
+    uint32_t i;
+
+    if (fd < 0) {
+        return false;
+    }
+    memset(line, 'x', sizeof(line));
+    for (i = 0; i < FS_LOG_LINES; i++) {
+        snprintf(line, sizeof(line), "%010u,", (unsigned int)i);
+        line[11] = 'x'; // snprintf's terminator
+        line[sizeof(line) - 2] = '\r';
+        line[sizeof(line) - 1] = '\n';
+        if (!write_all(fd, line, sizeof(line), work) || red_transact(FS_BENCH_VOLUME) != 0) {
+            red_close(fd);
+            return false;
+        }
+    }
+    return red_close(fd) == 0;
+}
+
+/**
+ * @brief
+ *      DFGM science: every second, 100 samples each to the raw and 100 Hz files and one
+ *      to the 1 Hz file, a write per sample. The files are closed when the run ends
+ */
+static bool workload_dfgm(fs_work *work) {
+    uint8_t sample[FS_DFGM_SAMPLE] = {0};
+    int32_t raw = red_open("VOL0:/0_rawDFGM.hex", RED_O_WRONLY | RED_O_CREAT | RED_O_APPEND);
+    int32_t hz100 = red_open("VOL0:/0_100HzDFGM.hex", RED_O_WRONLY | RED_O_CREAT | RED_O_APPEND);
+    int32_t hz1 = red_open("VOL0:/0_1HzDFGM.hex", RED_O_WRONLY | RED_O_CREAT | RED_O_APPEND);
+    bool ok = raw >= 0 && hz100 >= 0 && hz1 >= 0;
+    uint32_t s, i;
+
+    for (s = 0; ok && s < FS_DFGM_SECONDS; s++) {
+        for (i = 0; ok && i < 100; i++) {
+            ok = write_all(raw, sample, sizeof(sample), work);
+        }
+        for (i = 0; ok && i < 100; i++) {
+            ok = write_all(hz100, sample, sizeof(sample), work);
+        }
+        ok = ok && write_all(hz1, sample, sizeof(sample), work);
+    }
+    red_close(raw);
+    red_close(hz100);
+    red_close(hz1);
+    return ok;
+}
+
+/**
+ * @brief
+ *      Housekeeping: one fixed size record per period at its slot in tempHKdata.TMP,
+ *      then the slot's timestamp in HKconfig.TMP, each through open, write and close
+ */
+static bool workload_housekeeping(fs_work *work) {
+    static All_systems_housekeeping record;
+    uint8_t config[FS_HK_CONFIG_LEN] = {0};
+    uint32_t stamp = 0;
+    uint32_t i;
+    int32_t fd;
+
+    for (i = 0; i < FS_HK_RECORDS; i++) {
+        fd = red_open("VOL0:/tempHKdata.TMP", RED_O_CREAT | RED_O_RDWR);
+        if (fd < 0 || red_lseek(fd, (int64_t)i * sizeof(record), RED_SEEK_SET) < 0 ||
+            !write_all(fd, &record, sizeof(record), work) || red_close(fd) != 0) {
+            return false;
+        }
+
+        fd = red_open("VOL0:/HKconfig.TMP", RED_O_CREAT | RED_O_RDWR);
+        if (fd < 0 || !write_all(fd, config, sizeof(config), work) ||
+            red_lseek(fd, (int64_t)i * sizeof(stamp), RED_SEEK_CUR) < 0 ||
+            !write_all(fd, &stamp, sizeof(stamp), work) || red_close(fd) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief
+ *      The scheduler: after each dispatch gs_cmds.TMP is read whole, truncated and
+ *      written back a command at a time
+ */
+static bool workload_scheduler(fs_work *work) {
+    int32_t fd = red_open(FS_SCHED_FILE, RED_O_CREAT | RED_O_RDWR);
+    uint32_t r, i;
+
+    if (fd < 0) {
+        return false;
+    }
+    for (i = 0; i < FS_SCHED_CMDS; i++) {
+        if (!write_all(fd, &scratch[i * sizeof(ScheduledCmd_t)], sizeof(ScheduledCmd_t), work)) {
+            return false;
+        }
+    }
+    red_close(fd);
+
+    for (r = 0; r < FS_SCHED_REWRITES; r++) {
+        fd = red_open(FS_SCHED_FILE, RED_O_RDWR);
+        if (fd < 0 || red_read(fd, scratch, sizeof(scratch)) < 0 || red_ftruncate(fd, 0) < 0 ||
+            red_lseek(fd, 0, RED_SEEK_SET) < 0) {
+            return false;
+        }
+        for (i = 0; i < FS_SCHED_CMDS; i++) {
+            if (!write_all(fd, &scratch[i * sizeof(ScheduledCmd_t)], sizeof(ScheduledCmd_t), work)) {
+                return false;
+            }
+        }
+        if (red_close(fd) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const fs_workload workloads[] = {
+    {"logger", workload_logger},
+    {"dfgm", workload_dfgm},
+    {"housekeeping", workload_housekeeping},
+    {"scheduler", workload_scheduler},
+};
+
+static const fs_transact_setting settings[] = {
+    {"flight", REDCONF_TRANSACT_DEFAULT},
+    {"+write", REDCONF_TRANSACT_DEFAULT | RED_TRANSACT_WRITE},
+    {"manual", RED_TRANSACT_VOLFULL | RED_TRANSACT_UMOUNT}, // red_transact() and a full volume only
+};
+
+/**
+ * @brief
+ *      Format with the card at full speed, so every run starts from the same empty volume
+ */
+static bool fresh_volume(uint32_t mask) {
+    mock_device saved = sd;
+    uint32_t program_us = card.program_us;
+    bool ok;
+
+    sd.latency_us = 0;
+    sd.byte_time_ns = 0;
+    card.program_us = 0;
+    ok = red_format(FS_BENCH_VOLUME) == 0 && red_mount(FS_BENCH_VOLUME) == 0 &&
+         red_settransmask(FS_BENCH_VOLUME, mask) == 0;
+    sd = saved;
+    card.program_us = program_us;
+    return ok;
+}
+
+/**
+ * @brief
+ *      Run one workload under one transaction setting and print a line of results
+ * @details
+ *      Data the setting leaves uncommitted when the workload ends is not flushed, as
+ *      it would not be on the OBC, so it shows up as fewer device writes
+ */
+static bool run_one(const fs_workload *workload, const fs_transact_setting *setting) {
+    REDCORESTATS before, after;
+    fs_work work = {0};
+    uint64_t start, elapsed_us;
+    bool ok;
+
+    if (!fresh_volume(setting->mask)) {
+        fprintf(stdout, "%-12s %-7s cannot set up the volume, red_errno %d\n", workload->name, setting->name,
+                (int)red_errno);
+        return false;
+    }
+    mock_bus_reset_counters(&sd);
+    before = gRedCoreStats;
+    start = now_us();
+
+    ok = workload->run(&work);
+
+    elapsed_us = now_us() - start;
+    after = gRedCoreStats;
+    red_umount(FS_BENCH_VOLUME);
+    if (!ok) {
+        fprintf(stdout, "%-12s %-7s failed, red_errno %d\n", workload->name, setting->name, (int)red_errno);
+        return false;
+    }
+
+    uint32_t gets = after.ulBufferGets - before.ulBufferGets;
+    uint32_t hits = after.ulBufferHits - before.ulBufferHits;
+    fprintf(stdout, "%-12s %-7s %6u ops %9.1f ops/s %6.2f amp %6u trans %5.1f%% hit %6llu rd %6llu wr\n",
+            workload->name, setting->name, work.ops, work.ops * 1e6 / (elapsed_us ? elapsed_us : 1),
+            work.bytes ? (double)sd.bytes_written / work.bytes : 0.0,
+            after.ulTransactions - before.ulTransactions, gets ? hits * 100.0 / gets : 0.0,
+            (unsigned long long)(sd.bytes_read / SD_BLK_SIZE),
+            (unsigned long long)(sd.bytes_written / SD_BLK_SIZE));
+    return true;
+}
+
+static void fs_bench_task(void *pvParameters) {
+    bool ok = true;
+    size_t w, s;
+
+    fprintf(stdout, "block %u, buffers %u, sd %u us + %u ns/byte, program %u us\n",
+            (unsigned int)REDCONF_BLOCK_SIZE, (unsigned int)REDCONF_BUFFER_COUNT, (unsigned int)sd.latency_us,
+            (unsigned int)sd.byte_time_ns, (unsigned int)card.program_us);
+    for (w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) {
+        for (s = 0; s < sizeof(settings) / sizeof(settings[0]); s++) {
+            ok &= run_one(&workloads[w], &settings[s]);
+        }
+    }
+    exit(ok ? 0 : 1);
+}
+
+/**
+ * fs_bench [sd command us [sd byte ns [sd program us]]]
+ */
+int main(int argc, char **argv) {
+    char image[] = "/tmp/fs_bench.XXXXXX";
+
+    sd.latency_us = argc > 1 ? strtoul(argv[1], NULL, 0) : FS_SD_CMD_US;
+    sd.byte_time_ns = argc > 2 ? strtoul(argv[2], NULL, 0) : FS_SD_BYTE_NS;
+    card.program_us = argc > 3 ? strtoul(argv[3], NULL, 0) : FS_SD_PROGRAM_US;
+
+    // the image is sparse and goes away with the process
+    card.fd = mkstemp(image);
+    if (card.fd < 0) {
+        perror(image);
+        return 1;
+    }
+    unlink(image);
+    mock_sd_attach(0, &sd);
+
+    if (red_init() != 0) {
+        fprintf(stderr, "red_init failed, red_errno %d\n", (int)red_errno);
+        return 1;
+    }
+    xTaskCreate(fs_bench_task, "fs_bench", FS_BENCH_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
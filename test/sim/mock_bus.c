@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file mock_bus.c
+ * @date 2026-10-19
+ */
+
+#include "mock_bus.h"
+#include <os_task.h>
+
+#define NS_PER_TICK (1000000000ULL / configTICK_RATE_HZ)
+
+static void bus_sleep(mock_device *dev, uint64_t ns) {
+    taskENTER_CRITICAL();
+    dev->busy_ns += ns;
+    dev->owed_ns += ns;
+    TickType_t ticks = (TickType_t)(dev->owed_ns / NS_PER_TICK);
+    dev->owed_ns -= (uint64_t)ticks * NS_PER_TICK;
+    taskEXIT_CRITICAL();
+
+    if (ticks > 0) {
+        vTaskDelay(ticks);
+    }
+}
+
+/**
+ * @brief
+ *      Hold the bus for the time a transaction takes on the real hardware
+ * @details
+ *      The real drivers block on a semaphore given from the interrupt, so the
+ *      caller sleeps rather than spins. Time shorter than a tick is carried over
+ *      to the next transaction so many small transfers add up correctly
+ */
+void mock_bus_wait(mock_device *dev, size_t len) {
+    bus_sleep(dev, (uint64_t)dev->latency_us * 1000 + (uint64_t)dev->byte_time_ns * len);
+}
+
+/**
+ * @brief
+ *      Hold the bus while the device is busy on its own, e.g. an SD card programming a block
+ */
+void mock_bus_hold(mock_device *dev, uint32_t us) { bus_sleep(dev, (uint64_t)us * 1000); }
+
+/**
+ * @brief
+ *      Count one transaction and apply fault injection
+ * @return
+ *      false if the transaction must fail
+ */
+bool mock_bus_begin(mock_device *dev) {
+    bool ok = true;
+    taskENTER_CRITICAL();
+    dev->transactions++;
+    if (dev->fail_every != 0 && dev->transactions % dev->fail_every == 0) {
+        dev->failures++;
+        ok = false;
+    }
+    taskEXIT_CRITICAL();
+    return ok;
+}
+
+/**
+ * @brief
+ *      Zero the counters of a device between benchmark runs
+ */
+void mock_bus_reset_counters(mock_device *dev) {
+    taskENTER_CRITICAL();
+    dev->transactions = 0;
+    dev->failures = 0;
+    dev->bytes_written = 0;
+    dev->bytes_read = 0;
+    dev->busy_ns = 0;
+    dev->owed_ns = 0;
+    taskEXIT_CRITICAL();
+}
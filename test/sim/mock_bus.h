@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file mock_bus.h
+ * @date 2026-10-19
+ */
+
+#ifndef SIM_MOCK_BUS_H
+#define SIM_MOCK_BUS_H
+
+#include <FreeRTOS.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "HL_i2c.h"
+#include "HL_sci.h"
+
+typedef struct mock_device mock_device;
+
+/* Return 0, or a negative value to fail the transaction as the real driver would */
+typedef int (*mock_write_fn)(mock_device *dev, const uint8_t *data, size_t len);
+typedef int (*mock_read_fn)(mock_device *dev, uint8_t *data, size_t len);
+
+struct mock_device {
+    const char *name;
+    uint32_t latency_us;   // fixed cost of every transaction, e.g. address phase or chip turnaround
+    uint32_t byte_time_ns; // wire time of one byte, 10 bits over the baud rate for a UART
+    uint32_t fail_every;   // fail one transaction in this many, 0 never
+    mock_write_fn write;   // NULL accepts and drops
+    mock_read_fn read;     // NULL reads zeros
+    void *ctx;
+
+    // updated by the bus, read by benchmarks
+    uint32_t transactions;
+    uint32_t failures;
+    uint64_t bytes_written;
+    uint64_t bytes_read;
+    uint64_t busy_ns;
+
+    uint64_t owed_ns; // bus time not yet slept because it was less than a tick
+};
+
+/* Block the calling task for the time a transaction of len bytes holds the bus */
+void mock_bus_wait(mock_device *dev, size_t len);
+
+/* Block the calling task while the device is busy without transferring */
+void mock_bus_hold(mock_device *dev, uint32_t us);
+
+/* Count a transaction, returns false if fault injection says it fails */
+bool mock_bus_begin(mock_device *dev);
+
+void mock_bus_reset_counters(mock_device *dev);
+
+/* Attach a device to a bus. Passing NULL detaches it */
+bool mock_i2c_attach(i2cBASE_t *i2c, uint8_t addr, mock_device *dev);
+bool mock_spi_attach(uint8_t volume, mock_device *dev);
+bool mock_sci_attach(sciBASE_t *sci, mock_device *dev);
+
+/* SD card on the SPI bus, backed by a host file. The card is the device's ctx */
+typedef struct {
+    int fd;              // image file, read past its end as zeros
+    uint32_t program_us; // busy time after each block write while the card programs flash
+} mock_sd_card;
+
+bool mock_sd_attach(uint8_t volume, mock_device *dev);
+
+/* Bytes the device sends to the OBC, delivered at its byte time through sciNotification */
+size_t mock_sci_feed(sciBASE_t *sci, const uint8_t *data, size_t len);
+
+void mock_sci_start(void);
+
+#endif /* SIM_MOCK_BUS_H */
@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file mock_sci.c
+ * @date 2026-10-19
+ */
+
+/* Replaces the HALCoGen SCI driver (HL_sci.c) and the SCI part of HL_notification.c.
+ * Transmit is polled, as every user of sciSend runs it. Receive works in both modes:
+ * sciReceive arms a buffer that the pump task fills at the device's byte time before
+ * calling sciNotification, and sciIsRxReady/sciReceiveByte poll the same bytes */
+
+#include "mock_bus.h"
+#include "system.h"
+#include <os_task.h>
+#include <stdint.h>
+
+#define MOCK_SCI_PORTS 4
+#define MOCK_SCI_RX_LEN 1024
+#define MOCK_SCI_PUMP_PRIO (configMAX_PRIORITIES - 1)
+#define MOCK_SCI_PUMP_SIZE 256
+
+typedef struct {
+    sciBASE_t *sci;
+    mock_device *dev;
+    uint8_t rx[MOCK_SCI_RX_LEN];
+    uint16_t rx_head;
+    uint16_t rx_tail;
+    uint8 *armed;     // buffer given to sciReceive, NULL when not armed
+    uint32 armed_len;
+    uint32 armed_pos;
+    uint32 notifications;
+} sci_port;
+
+static sci_port ports[MOCK_SCI_PORTS];
+static TaskHandle_t pump_handle = NULL;
+
+void gps_sciNotification(sciBASE_t *sci, unsigned flags) __attribute__((weak));
+void ns_sciNotification(sciBASE_t *sci, unsigned flags) __attribute__((weak));
+void csp_sciNotification(sciBASE_t *sci, unsigned flags) __attribute__((weak));
+void adcs_sciNotification(sciBASE_t *sci, unsigned flags) __attribute__((weak));
+void dfgm_sciNotification(sciBASE_t *sci, unsigned flags) __attribute__((weak));
+
+static sci_port *prv_port(sciBASE_t *sci) {
+    int i;
+    if (sci == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < MOCK_SCI_PORTS; i++) {
+        if (ports[i].sci == sci) {
+            return &ports[i];
+        }
+    }
+    return NULL;
+}
+
+bool mock_sci_attach(sciBASE_t *sci, mock_device *dev) {
+    sci_port *port = prv_port(sci);
+    if (port == NULL) {
+        return false;
+    }
+    port->dev = dev;
+    return true;
+}
+
+/**
+ * @brief
+ *      Queue bytes from the device to the OBC
+ * @return
+ *      Bytes queued, fewer than len when the receive ring is full as on a real overrun
+ */
+size_t mock_sci_feed(sciBASE_t *sci, const uint8_t *data, size_t len) {
+    sci_port *port = prv_port(sci);
+    size_t i;
+
+    if (port == NULL) {
+        return 0;
+    }
+    taskENTER_CRITICAL();
+    for (i = 0; i < len; i++) {
+        uint16_t next = (port->rx_head + 1) % MOCK_SCI_RX_LEN;
+        if (next == port->rx_tail) {
+            break;
+        }
+        port->rx[port->rx_head] = data[i];
+        port->rx_head = next;
+    }
+    taskEXIT_CRITICAL();
+    if (pump_handle != NULL) {
+        xTaskNotifyGive(pump_handle);
+    }
+    return i;
+}
+
+static bool prv_take_byte(sci_port *port, uint8_t *byte) {
+    bool ok = false;
+    taskENTER_CRITICAL();
+    if (port->rx_tail != port->rx_head) {
+        *byte = port->rx[port->rx_tail];
+        port->rx_tail = (port->rx_tail + 1) % MOCK_SCI_RX_LEN;
+        ok = true;
+    }
+    taskEXIT_CRITICAL();
+    return ok;
+}
+
+void sciInit(void) {
+    ports[0].sci = sciREG1;
+    ports[1].sci = sciREG2;
+    ports[2].sci = sciREG3;
+    ports[3].sci = sciREG4;
+}
+
+void sciSetBaudrate(sciBASE_t *sci, uint32 baud) {
+    sci_port *port = prv_port(sci);
+    if (port != NULL && port->dev != NULL && baud != 0) {
+        port->dev->byte_time_ns = (uint32_t)(10000000000ULL / baud); // 8N1 is 10 bits a byte
+    }
+}
+
+uint32 sciIsTxReady(sciBASE_t *sci) { return SCI_TX_INT; }
+
+void sciSend(sciBASE_t *sci, uint32 length, uint8 *data) {
+    sci_port *port = prv_port(sci);
+    mock_device *dev = port != NULL ? port->dev : NULL;
+
+    if (dev == NULL) {
+        return;
+    }
+    if (!mock_bus_begin(dev)) {
+        return; // the bytes are lost on the wire
+    }
+    mock_bus_wait(dev, length);
+    dev->bytes_written += length;
+    if (dev->write != NULL) {
+        dev->write(dev, data, length);
+    }
+}
+
+void sciSendByte(sciBASE_t *sci, uint8 byte) { sciSend(sci, 1, &byte); }
+
+uint32 sciIsRxReady(sciBASE_t *sci) {
+    sci_port *port = prv_port(sci);
+    return (port != NULL && port->rx_tail != port->rx_head) ? SCI_RX_INT : 0;
+}
+
+uint32 sciReceiveByte(sciBASE_t *sci) {
+    sci_port *port = prv_port(sci);
+    uint8_t byte = 0;
+
+    if (port == NULL) {
+        return 0;
+    }
+    while (!prv_take_byte(port, &byte)) {
+        vTaskDelay(1);
+    }
+    if (port->dev != NULL) {
+        mock_bus_wait(port->dev, 1);
+        port->dev->bytes_read++;
+    }
+    return byte;
+}
+
+void sciReceive(sciBASE_t *sci, uint32 length, uint8 *data) {
+    sci_port *port = prv_port(sci);
+    if (port == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL();
+    port->armed = data;
+    port->armed_len = length;
+    port->armed_pos = 0;
+    taskEXIT_CRITICAL();
+    if (pump_handle != NULL) {
+        xTaskNotifyGive(pump_handle);
+    }
+}
+
+void sciEnableNotification(sciBASE_t *sci, uint32 flags) {}
+
+void sciDisableNotification(sciBASE_t *sci, uint32 flags) {}
+
+/**
+ * @brief
+ *      Same dispatch as the USER CODE section of HL_notification.c
+ */
+void sciNotification(sciBASE_t *sci, uint32 flags) {
+#if NS_IS_STUBBED == 1
+    if (sci == GPS_SCI && gps_sciNotification) {
+        gps_sciNotification(sci, flags);
+        return;
+    }
+#else
+    if (sci == PAYLOAD_SCI && ns_sciNotification) {
+        ns_sciNotification(sci, flags);
+        return;
+    }
+#endif
+    if (sci == CSP_SCI && csp_sciNotification) {
+        csp_sciNotification(sci, flags);
+    } else if (sci == ADCS_SCI && adcs_sciNotification) {
+        adcs_sciNotification(sci, flags);
+    } else if (sci == DFGM_SCI && dfgm_sciNotification) {
+        dfgm_sciNotification(sci, flags);
+    }
+}
+
+/**
+ * @brief
+ *      Stands in for the receive interrupt, one byte at a time at the device's pace
+ * @details
+ *      Runs above every application task so handlers see bytes with the same
+ *      priority an interrupt would give them
+ */
+static void sci_pump(void *pvParameters) {
+    for (;;) {
+        bool busy = false;
+        int i;
+
+        for (i = 0; i < MOCK_SCI_PORTS; i++) {
+            sci_port *port = &ports[i];
+            uint8_t byte;
+
+            if (port->armed == NULL || !prv_take_byte(port, &byte)) {
+                continue;
+            }
+            busy = true;
+            if (port->dev != NULL) {
+                mock_bus_wait(port->dev, 1);
+                port->dev->bytes_read++;
+            }
+            port->armed[port->armed_pos++] = byte;
+            if (port->armed_pos == port->armed_len) {
+                // the handler normally rearms from inside the notification
+                port->armed = NULL;
+                port->notifications++;
+                sciNotification(port->sci, SCI_RX_INT);
+            }
+        }
+        if (!busy) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+}
+
+/**
+ * @brief
+ *      Start delivering received bytes. Call after sciInit, before the scheduler starts
+ */
+void mock_sci_start(void) {
+    if (pump_handle == NULL) {
+        xTaskCreate(sci_pump, "sci_pump", MOCK_SCI_PUMP_SIZE, NULL, MOCK_SCI_PUMP_PRIO, &pump_handle);
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file mock_sd_io.c
+ * @date 2026-10-19
+ */
+
+/* Replaces ex2_hal/athena/equipment_handler/source/sd_io.c at block level, so Reliance
+ * Edge runs its flight block device (osbdev_custom.h) against an image file */
+
+#include "sd_io.h"
+#include "mock_bus.h"
+#include <string.h>
+#include <unistd.h>
+
+#define MOCK_SD_VOLUMES 2
+
+/* Command, R1 response, data token and CRC around every block on the wire */
+#define MOCK_SD_FRAME_BYTES 11
+
+static mock_device *devices[MOCK_SD_VOLUMES];
+
+bool mock_sd_attach(uint8_t volume, mock_device *dev) {
+    if (volume >= MOCK_SD_VOLUMES) {
+        return false;
+    }
+    devices[volume] = dev;
+    return true;
+}
+
+static mock_sd_card *card_of(uint8_t bVolNum) {
+    if (bVolNum >= MOCK_SD_VOLUMES || devices[bVolNum] == NULL) {
+        return NULL;
+    }
+    return (mock_sd_card *)devices[bVolNum]->ctx;
+}
+
+SDRESULTS SD_Init(uint8_t bVolNum) { return card_of(bVolNum) != NULL ? SD_OK : SD_NOINIT; }
+
+/**
+ * @brief
+ *      Read part of one block, clocking the whole block as the real driver does
+ */
+SDRESULTS SD_Read(uint8_t bVolNum, void *dat, DWORD sector, WORD ofs, WORD cnt) {
+    mock_sd_card *card = card_of(bVolNum);
+    mock_device *dev;
+    ssize_t got;
+
+    if (card == NULL) {
+        return SD_NOINIT;
+    }
+    dev = devices[bVolNum];
+    if (cnt == 0 || ofs + cnt > SD_BLK_SIZE) {
+        return SD_PARERR;
+    }
+    if (!mock_bus_begin(dev)) {
+        mock_bus_wait(dev, MOCK_SD_FRAME_BYTES);
+        return SD_ERROR;
+    }
+    mock_bus_wait(dev, SD_BLK_SIZE + MOCK_SD_FRAME_BYTES);
+
+    got = pread(card->fd, dat, cnt, (off_t)sector * SD_BLK_SIZE + ofs);
+    if (got < 0) {
+        return SD_ERROR;
+    }
+    if (got < cnt) {
+        memset((uint8_t *)dat + got, 0, cnt - got);
+    }
+    dev->bytes_read += SD_BLK_SIZE;
+    return SD_OK;
+}
+
+/**
+ * @brief
+ *      Write one block, then hold the bus for the card's programming time
+ */
+SDRESULTS SD_Write(uint8_t bVolNum, const void *dat, DWORD sector) {
+    mock_sd_card *card = card_of(bVolNum);
+    mock_device *dev;
+
+    if (card == NULL) {
+        return SD_NOINIT;
+    }
+    dev = devices[bVolNum];
+    if (!mock_bus_begin(dev)) {
+        mock_bus_wait(dev, MOCK_SD_FRAME_BYTES);
+        return SD_REJECT;
+    }
+    mock_bus_wait(dev, SD_BLK_SIZE + MOCK_SD_FRAME_BYTES);
+    if (pwrite(card->fd, dat, SD_BLK_SIZE, (off_t)sector * SD_BLK_SIZE) != SD_BLK_SIZE) {
+        return SD_ERROR;
+    }
+    mock_bus_hold(dev, card->program_us);
+    dev->bytes_written += SD_BLK_SIZE;
+    return SD_OK;
+}
+
+SDRESULTS SD_Status(uint8_t bVolNum) { return card_of(bVolNum) != NULL ? SD_OK : SD_NORESPONSE; }
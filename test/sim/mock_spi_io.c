@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file mock_spi_io.c
+ * @date 2026-10-19
+ */
+
+/* Replaces ex2_hal/athena/equipment_handler/source/spi_io.c. Chip select picks the device by volume */
+
+#include "spi_io.h"
+#include "mock_bus.h"
+#include <os_task.h>
+
+#define MOCK_SPI_VOLUMES 2
+
+static mock_device *devices[MOCK_SPI_VOLUMES];
+static mock_device *selected = NULL;
+
+bool mock_spi_attach(uint8_t volume, mock_device *dev) {
+    if (volume >= MOCK_SPI_VOLUMES) {
+        return false;
+    }
+    devices[volume] = dev;
+    return true;
+}
+
+void SPI_Init(void) {}
+
+/**
+ * @brief
+ *      Clock one byte out to the selected device and one back
+ * @return
+ *      The device's byte, 0xFF with nothing selected or on an injected fault,
+ *      which is what the real bus reads when MISO floats high
+ */
+BYTE SPI_RW(BYTE d) {
+    mock_device *dev = selected;
+    uint8_t reply = 0xFF;
+
+    if (dev == NULL) {
+        return 0xFF;
+    }
+    if (!mock_bus_begin(dev)) {
+        mock_bus_wait(dev, 1);
+        return 0xFF;
+    }
+    mock_bus_wait(dev, 1);
+    if (dev->write != NULL) {
+        dev->write(dev, &d, 1);
+    }
+    if (dev->read != NULL && dev->read(dev, &reply, 1) < 0) {
+        reply = 0xFF;
+    }
+    dev->bytes_written++;
+    dev->bytes_read++;
+    return reply;
+}
+
+BYTE rcvr_spi(void) { return SPI_RW(0xFF); }
+
+void SPI_Release(void) {
+    WORD idx;
+    for (idx = 512; idx && (SPI_RW(0xFF) != 0xFF); idx--)
+        ;
+}
+
+void SPI_CS_Low(uint8_t bVolNum) { selected = bVolNum < MOCK_SPI_VOLUMES ? devices[bVolNum] : NULL; }
+
+void SPI_CS_High(uint8_t bVolNum) { selected = NULL; }
+
+void SPI_Freq_High(void) {}
+
+void SPI_Freq_Low(void) {}
+
+void SPI_Timer_On(WORD ms, SPI_timer_handle_t *timer) { timer->timeout_tick = ms + xTaskGetTickCount(); }
+
+BOOL SPI_Timer_Status(SPI_timer_handle_t *timer) { return timer->timeout_tick > xTaskGetTickCount(); }
+
+void SPI_Timer_Off(SPI_timer_handle_t *timer) { timer->timeout_tick = 0; }
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file redconf.h
+ * @date 2026-10-19
+ */
+
+/* Found before reliance_edge/include/redconf.h. Takes the flight configuration and
+ * changes only what the host needs, plus the settings the file system benchmark sweeps */
+
+#ifndef SIM_REDCONF_H
+#define SIM_REDCONF_H
+
+#include "../../reliance_edge/include/redconf.h"
+
+/* The OBC is big endian, the host is not. Reliance Edge checks this at red_init */
+#undef REDCONF_ENDIAN_BIG
+#define REDCONF_ENDIAN_BIG 0
+
+#undef REDCONF_CORE_STATS
+#define REDCONF_CORE_STATS 1
+
+/* make fsbench BLOCK_SIZE=... BUFFER_COUNT=... BUFFER_HASH=... */
+#ifdef SIM_BLOCK_SIZE
+#undef REDCONF_BLOCK_SIZE
+#define REDCONF_BLOCK_SIZE SIM_BLOCK_SIZE
+#endif
+
+#ifdef SIM_BUFFER_COUNT
+#undef REDCONF_BUFFER_COUNT
+#define REDCONF_BUFFER_COUNT SIM_BUFFER_COUNT
+#endif
+
+#ifdef SIM_BUFFER_HASH
+#undef REDCONF_BUFFER_HASH
+#define REDCONF_BUFFER_HASH SIM_BUFFER_HASH
+#endif
+
+#endif /* SIM_REDCONF_H */
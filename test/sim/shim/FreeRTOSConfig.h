@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file FreeRTOSConfig.h
+ * @date 2026-10-19
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* Kernel configuration for the POSIX port. Tick rate, priorities, heap and name length match
+ * include/FreeRTOSConfig.h so the application sees the same kernel it does on the OBC */
+
+#include <stdint.h>
+
+#define configUSE_PREEMPTION 1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#define configUSE_IDLE_HOOK 0
+#define configUSE_TICK_HOOK 0
+#define configUSE_TRACE_FACILITY 1
+#define configUSE_16_BIT_TICKS 0
+#define configCPU_CLOCK_HZ ((unsigned long)300000000)
+#define configTICK_RATE_HZ ((TickType_t)1000)
+#define configMAX_PRIORITIES (5)
+#define configMINIMAL_STACK_SIZE ((unsigned short)256)
+#define configTOTAL_HEAP_SIZE ((size_t)262144)
+#define configMAX_TASK_NAME_LEN (16)
+#define configGENERATE_RUN_TIME_STATS 1
+#define configUSE_MALLOC_FAILED_HOOK 1
+#define configUSE_STATS_FORMATTING_FUNCTIONS 1
+#define configUSE_TICKLESS_IDLE 0
+#define configIDLE_SHOULD_YIELD 1
+#define configQUEUE_REGISTRY_SIZE 0
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#define configSUPPORT_STATIC_ALLOCATION 0
+
+/* Pthread stacks are not the task stacks the kernel checks, so overflow checking has nothing to find */
+#define configCHECK_FOR_STACK_OVERFLOW 0
+
+#define configUSE_CO_ROUTINES 0
+#define configMAX_CO_ROUTINE_PRIORITIES (2)
+#define configUSE_MUTEXES 1
+#define configUSE_RECURSIVE_MUTEXES 1
+#define configUSE_COUNTING_SEMAPHORES 1
+#define configUSE_TASK_NOTIFICATIONS 1
+#define configUSE_TIMERS 1
+#define configTIMER_TASK_PRIORITY (3)
+#define configTIMER_QUEUE_LENGTH 2
+#define configTIMER_TASK_STACK_DEPTH (256)
+
+#define INCLUDE_vTaskPrioritySet 1
+#define INCLUDE_uxTaskPriorityGet 1
+#define INCLUDE_vTaskDelete 1
+#define INCLUDE_vTaskCleanUpResources 0
+#define INCLUDE_vTaskSuspend 1
+#define INCLUDE_xTaskResumeFromISR 1
+#define INCLUDE_vTaskDelayUntil 1
+#define INCLUDE_vTaskDelay 1
+#define INCLUDE_xTaskGetSchedulerState 1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
+#define INCLUDE_xTaskAbortDelay 1
+#define INCLUDE_eTaskGetState 1
+#define INCLUDE_xTaskGetHandle 1
+#define INCLUDE_xTaskGetIdleTaskHandle 1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+#define INCLUDE_xTimerPendFunctionCall 1
+
+void vAssertCalled(unsigned long ulLine, const char *pcFile);
+#define configASSERT(x)                                                                                        \
+    if ((x) == 0)                                                                                              \
+    vAssertCalled(__LINE__, __FILE__)
+
+/* Run time in microseconds of host monotonic time, scaled to CPU cycles so task_stats
+ * reports the same units it does on the OBC */
+uint32_t sim_cycle_count(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() sim_cycle_count()
+
+void task_stats_ready(uint32_t number, uint32_t cycles);
+void task_stats_switched_in(uint32_t number, uint32_t cycles);
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)                                                                    \
+    do {                                                                                                         \
+        if ((pxTCB) != pxCurrentTCB) {                                                                           \
+            task_stats_ready((pxTCB)->uxTCBNumber, sim_cycle_count());                                           \
+        }                                                                                                        \
+    } while (0)
+#define traceTASK_SWITCHED_IN() task_stats_switched_in(pxCurrentTCB->uxTCBNumber, sim_cycle_count())
+
+#endif /* FREERTOS_CONFIG_H */
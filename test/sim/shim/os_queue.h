@@ -0,0 +1,26 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file os_queue.h
+ * @date 2026-10-19
+ */
+
+#ifndef SIM_OS_QUEUE_H
+#define SIM_OS_QUEUE_H
+
+/* HALCoGen names the kernel headers os_*.h, the upstream kernel does not */
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#endif /* SIM_OS_QUEUE_H */
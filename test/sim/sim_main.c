@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file sim_main.c
+ * @date 2026-10-19
+ */
+
+#include <FreeRTOS.h>
+#include <os_task.h>
+#include <csp/csp.h>
+#include <csp/crypto/csp_hmac.h>
+#include <csp/csp_rtable.h>
+#include <redconf.h>
+#include <redfs.h>
+#include <redposix.h>
+#include <redvolume.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "csp_if_sim.h"
+#include "housekeeping/housekeeping_task.h"
+#include "i2c_io.h"
+#include "logger/logger.h"
+#include "mem_region.h"
+#include "mock_bus.h"
+#include "scheduler/scheduler_task.h"
+#include "services.h"
+
+#define SIM_CONSOLE_BAUD 115200
+#define SIM_INIT_STACK_SIZE 1000
+
+static const char sim_hmac_key[] = "obc simulator";
+
+static int console_write(mock_device *dev, const uint8_t *data, size_t len) {
+    fwrite(data, 1, len, stdout);
+    return 0;
+}
+
+/* The debug UART, paced like the real one so logging costs what it does on the OBC */
+static mock_device console = {.name = "console", .write = console_write};
+
+/* Link timing, from the command line */
+static csp_sim_conf_t link_conf = {0};
+
+/**
+ * Format and mount a fresh RAM disk for every run, so results do not depend on the last one
+ */
+static bool init_filesystem(void) {
+    const char *volume = gaRedVolConf[0].pszPathPrefix;
+    if (red_init() == -1 || red_format(volume) == -1 || red_mount(volume) == -1) {
+        fprintf(stderr, "cannot set up %s, red_errno %d\n", volume, (int)red_errno);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Same CSP configuration as main.c, with the node's own address routed over the simulated link
+ */
+static bool init_csp(void) {
+    csp_conf_t csp_conf;
+    csp_conf.address = CSP_ADDRESS;
+    csp_conf.model = "Simulator";
+    csp_conf.hostname = CSP_HOSTNAME;
+    csp_conf.revision = "2";
+    csp_conf.conn_max = 20;
+    csp_conf.conn_queue_length = 10;
+    csp_conf.fifo_length = 25;
+    csp_conf.port_max_bind = 254;
+    csp_conf.rdp_max_window = 20;
+    csp_conf.buffers = 10;
+    csp_conf.buffer_data_size = 1024;
+    csp_conf.conn_dfl_so = CSP_O_NONE;
+
+    int error = csp_init(&csp_conf);
+    if (error != CSP_ERR_NONE) {
+        fprintf(stderr, "csp_init() failed, error: %d\n", error);
+        return false;
+    }
+    csp_route_start_task(1000, 2);
+
+    csp_iface_t *iface = NULL;
+    error = csp_sim_open_and_add_interface(&link_conf, CSP_IF_SIM_NAME, &iface);
+    if (error != CSP_ERR_NONE) {
+        fprintf(stderr, "Error %d opening the simulated link\n", error);
+        return false;
+    }
+    csp_rtable_set(CSP_ADDRESS, CSP_ID_HOST_SIZE, iface, CSP_NO_VIA_ADDRESS);
+    csp_hmac_set_key((char *)sim_hmac_key, sizeof(sim_hmac_key) - 1);
+    return start_csp_server() == SATR_OK;
+}
+
+/**
+ * Start the software as init_software does on the OBC, then benchmark it and exit
+ */
+static void sim_init(void *pvParameters) {
+    bool ok = start_service_server() == SATR_OK;
+    ok &= start_scheduler_task() == SATR_OK;
+    ok &= start_housekeeping_daemon() == SATR_OK;
+    if (!ok) {
+        fprintf(stderr, "software failed to start\n");
+        exit(1);
+    }
+    exit(bench_run_all() ? 0 : 1);
+}
+
+/**
+ * obc_sim [link bitrate [link latency ms]]
+ *
+ * A bitrate of 0, the default, models an unlimited link
+ */
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        link_conf.bitrate = strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        link_conf.latency_ms = strtoul(argv[2], NULL, 0);
+    }
+
+    if (!mem_region_init()) {
+        return 1;
+    }
+    sciInit();
+    mock_sci_attach(PRINTF_SCI, &console);
+    sciSetBaudrate(PRINTF_SCI, SIM_CONSOLE_BAUD);
+    mock_sci_start();
+    init_i2c_driver();
+
+    if (!init_filesystem() || !init_csp()) {
+        return 1;
+    }
+    start_logger_daemon();
+
+    // named for the log lines the logging benchmark counts
+    xTaskCreate(sim_init, "bench", SIM_INIT_STACK_SIZE, NULL, NORMAL_SERVICE_PRIO, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file sim_platform.c
+ * @date 2026-10-19
+ */
+
+/* Host versions of the target pieces the simulated modules call into */
+
+#include <FreeRTOS.h>
+#include <os_task.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "diagnostic/heap_stats.h"
+#include "rtcmk.h"
+#include "sband_sender/sband_sender.h"
+#include "system.h"
+
+static uint32_t malloc_failures = 0;
+
+/**
+ * @brief
+ *      Host monotonic time in 300 MHz cycles, the unit of the run time counter on the OBC
+ */
+uint32_t sim_cycle_count(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 300000000ULL + (uint64_t)ts.tv_nsec * 3 / 10);
+}
+
+time_t RTCMK_Unix_Now(void) { return time(NULL); }
+
+time_t RTCMK_Unix_Cached(void) { return time(NULL); }
+
+time_t RTCMK_Unix_Now_Ms(int32_t *msec) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    if (msec != NULL) {
+        *msec = (int32_t)(ts.tv_nsec / 1000000);
+    }
+    return ts.tv_sec;
+}
+
+int RTCMK_GetMs() {
+    int32_t ms;
+    RTCMK_Unix_Now_Ms(&ms);
+    return ms;
+}
+
+int RTCMK_SetUnix(time_t new_time) { return -1; } // the host clock is not ours to set
+
+/* No S-band transmitter, FTP falls back to sending over CSP */
+bool sband_send_data(void *data, size_t len) { return false; }
+
+/**
+ * @brief
+ *      heap_stats_get_hk for the upstream heap_4, which keeps no failure counters of its own
+ */
+void heap_stats_get_hk(heap_stats_hk *hk) {
+    HeapStats_t heap;
+    mem_region_stats region;
+    uint8_t i;
+
+    vPortGetHeapStats(&heap);
+    memset(hk, 0, sizeof(*hk));
+    hk->free_bytes = heap.xAvailableHeapSpaceInBytes;
+    hk->min_free_bytes = heap.xMinimumEverFreeBytesRemaining;
+    hk->largest_free_block = heap.xSizeOfLargestFreeBlockInBytes;
+    hk->free_blocks = heap.xNumberOfFreeBlocks > UINT16_MAX ? UINT16_MAX : heap.xNumberOfFreeBlocks;
+    hk->failed_allocations = malloc_failures > UINT16_MAX ? UINT16_MAX : malloc_failures;
+    hk->region_spills = mem_region_spills() > UINT16_MAX ? UINT16_MAX : mem_region_spills();
+    for (i = 0; mem_region_get_stats(i, &region); i++) {
+        hk->region_peak[i] = region.peak_in_use > UINT8_MAX ? UINT8_MAX : (uint8_t)region.peak_in_use;
+    }
+}
+
+/* Services start_service_server starts that are not part of the simulation. Their ports stay unregistered */
+SAT_returnState start_cli_service(void) { return SATR_OK; }
+SAT_returnState start_communication_service(void) { return SATR_OK; }
+SAT_returnState start_time_management_service(void) { return SATR_OK; }
+SAT_returnState start_general_service(void) { return SATR_OK; }
+SAT_returnState start_logger_service(void) { return SATR_OK; }
+SAT_returnState start_dfgm_service(void) { return SATR_OK; }
+SAT_returnState start_adcs_service(void) { return SATR_OK; }
+SAT_returnState start_ns_payload_service(void) { return SATR_OK; }
+SAT_returnState start_iris_service(void) { return SATR_OK; }
+SAT_returnState start_updater_service(void) { return SATR_OK; }
+
+void vApplicationMallocFailedHook(void) { malloc_failures++; }
+
+void vAssertCalled(unsigned long ulLine, const char *pcFile) {
+    fprintf(stderr, "assertion failed at %s:%lu\n", pcFile, ulLine);
+    abort();
+}
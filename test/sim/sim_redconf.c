@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file sim_redconf.c
+ * @date 2026-10-19
+ */
+
+/* Volume table for the simulator, used instead of reliance_edge/include/redconf.c.
+ * The RAM disk backing each volume is allocated whole, so the 1.9 GB SD card
+ * volumes are cut down. Every other setting comes from the flight redconf.h, through
+ * the host overrides in ./redconf.h */
+
+#include <redconf.h>
+#include <redtypes.h>
+#include <redmacs.h>
+#include <redvolume.h>
+
+#define SIM_VOLUME_SECTORS 65536U // 32 MiB
+
+const VOLCONF gaRedVolConf[REDCONF_VOLUME_COUNT] = {{512U, SIM_VOLUME_SECTORS, 0U, false, 10000U, 3U, "VOL0:"},
+                                                    {512U, SIM_VOLUME_SECTORS, 0U, false, 10000U, 3U, "VOL1:"}};
@@ -0,0 +1,6 @@
+#ifndef TEST_ADCS_TLM_CACHE_H
+#define TEST_ADCS_TLM_CACHE_H
+
+int test_adcs_tlm_cache();
+
+#endif
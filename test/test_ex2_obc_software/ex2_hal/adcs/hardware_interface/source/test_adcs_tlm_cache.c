@@ -0,0 +1,141 @@
+/*
+ * test_adcs_tlm_cache.c
+ *
+ * Reads through the ADCS telemetry cache, counting the requests that reach the
+ * ADCS: fresh frames come from the cache, stale or invalidated ones from the bus.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <string.h>
+
+// Other tests link their own tick and queue fakes, so the cache gets renamed ones
+#define MPU_xTaskGetTickCount tlm_cache_tick_count
+#define MPU_xQueueCreateMutex tlm_cache_create_mutex
+#define MPU_xQueueGenericReceive tlm_cache_take
+#define MPU_xQueueGenericSend tlm_cache_give
+#define MPU_xTaskCreate tlm_cache_task_create
+#define MPU_vTaskDelay tlm_cache_delay
+
+#include "adcs_tlm_cache.h"
+#include "test_adcs_tlm_cache.h"
+
+#include "../source/adcs_tlm_cache.c"
+
+static TickType_t ticks;
+static int mutex;
+static int fetches;
+static int16_t next_latitude;
+static bool invalidate_during_fetch;
+
+TickType_t tlm_cache_tick_count(void) { return ticks; }
+
+QueueHandle_t tlm_cache_create_mutex(const uint8_t ucQueueType) { return (QueueHandle_t)&mutex; }
+
+BaseType_t tlm_cache_take(QueueHandle_t xQueue, void *const pvBuffer, TickType_t xTicksToWait,
+                          const BaseType_t xJustPeeking) {
+    return pdTRUE;
+}
+
+BaseType_t tlm_cache_give(QueueHandle_t xQueue, const void *const pvItemToQueue, TickType_t xTicksToWait,
+                          const BaseType_t xCopyPosition) {
+    return pdTRUE;
+}
+
+// The poller is never run, reads here are the only requests
+BaseType_t tlm_cache_task_create(TaskFunction_t pxTaskCode, const char *const pcName, const uint16_t usStackDepth,
+                                 void *const pvParameters, UBaseType_t uxPriority, TaskHandle_t *const pxCreatedTask) {
+    return pdPASS;
+}
+
+void tlm_cache_delay(const TickType_t xTicksToDelay) {}
+
+/* The ADCS, answering with a new latitude on every request */
+ADCS_returnState HAL_ADCS_get_sat_pos_LLH(LLH *target) {
+    fetches++;
+    memset(target, 0, sizeof(*target));
+    target->latitude = next_latitude++;
+    if (invalidate_during_fetch) {
+        // A reset from another task while the frame is on the bus
+        invalidate_during_fetch = false;
+        adcs_tlm_cache_invalidate();
+    }
+    return ADCS_OK;
+}
+
+ADCS_returnState HAL_ADCS_get_current_state(adcs_state *data) { return ADCS_OK; }
+ADCS_returnState HAL_ADCS_get_measurements(adcs_measures *measurements) { return ADCS_OK; }
+ADCS_returnState HAL_ADCS_get_power_temp(adcs_pwr_temp *measurements) { return ADCS_OK; }
+ADCS_returnState HAL_ADCS_get_comms_stat(uint16_t *comm_status) { return ADCS_OK; }
+
+Describe(adcs_tlm_cache);
+BeforeEach(adcs_tlm_cache) {
+    start_adcs_tlm_cache_daemon();
+    adcs_tlm_cache_invalidate();
+    ticks = 1000;
+    fetches = 0;
+    next_latitude = 1;
+    invalidate_during_fetch = false;
+};
+AfterEach(adcs_tlm_cache) {};
+
+Ensure(adcs_tlm_cache, fresh_read_is_served_from_the_cache) {
+    LLH pos;
+
+    assert_that(adcs_tlm_cache_get(ADCS_TLM_SAT_POS_LLH, &pos, 100), is_equal_to(ADCS_OK));
+    assert_that(pos.latitude, is_equal_to(1));
+    ticks += 100;
+    assert_that(adcs_tlm_cache_get(ADCS_TLM_SAT_POS_LLH, &pos, 100), is_equal_to(ADCS_OK));
+    assert_that(pos.latitude, is_equal_to(1));
+    assert_that(fetches, is_equal_to(1));
+}
+
+Ensure(adcs_tlm_cache, stale_read_goes_to_the_bus) {
+    LLH pos;
+
+    adcs_tlm_cache_get(ADCS_TLM_SAT_POS_LLH, &pos, 100);
+    ticks += 101;
+    assert_that(adcs_tlm_cache_get(ADCS_TLM_SAT_POS_LLH, &pos, 100), is_equal_to(ADCS_OK));
+    assert_that(pos.latitude, is_equal_to(2));
+    assert_that(fetches, is_equal_to(2));
+}
+
+Ensure(adcs_tlm_cache, read_after_invalidation_goes_to_the_bus) {
+    LLH pos;
+
+    adcs_tlm_cache_get(ADCS_TLM_SAT_POS_LLH, &pos, 100);
+    adcs_tlm_cache_invalidate();
+    assert_that(adcs_tlm_cache_get(ADCS_TLM_SAT_POS_LLH, &pos, 100), is_equal_to(ADCS_OK));
+    assert_that(pos.latitude, is_equal_to(2));
+    assert_that(fetches, is_equal_to(2));
+}
+
+Ensure(adcs_tlm_cache, frame_fetched_across_an_invalidation_is_not_cached) {
+    LLH pos;
+
+    invalidate_during_fetch = true;
+    assert_that(adcs_tlm_cache_get(ADCS_TLM_SAT_POS_LLH, &pos, 100), is_equal_to(ADCS_OK));
+    assert_that(pos.latitude, is_equal_to(1));
+
+    // The caller had its answer, but the next read must not be given the same frame
+    assert_that(adcs_tlm_cache_get(ADCS_TLM_SAT_POS_LLH, &pos, 100), is_equal_to(ADCS_OK));
+    assert_that(pos.latitude, is_equal_to(2));
+    assert_that(fetches, is_equal_to(2));
+}
+
+TestSuite *adcs_tlm_cache_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, adcs_tlm_cache, fresh_read_is_served_from_the_cache);
+    add_test_with_context(suite, adcs_tlm_cache, stale_read_goes_to_the_bus);
+    add_test_with_context(suite, adcs_tlm_cache, read_after_invalidation_goes_to_the_bus);
+    add_test_with_context(suite, adcs_tlm_cache, frame_fetched_across_an_invalidation_is_not_cached);
+
+    return suite;
+}
+
+int test_adcs_tlm_cache() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, adcs_tlm_cache_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
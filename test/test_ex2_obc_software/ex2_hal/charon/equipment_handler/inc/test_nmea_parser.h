@@ -0,0 +1,6 @@
+#ifndef TEST_NMEA_PARSER
+#define TEST_NMEA_PARSER
+
+int test_nmea_parser(void);
+
+#endif
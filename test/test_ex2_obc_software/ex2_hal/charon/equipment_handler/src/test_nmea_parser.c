@@ -0,0 +1,301 @@
+/*
+ * test_nmea_parser.c
+ *
+ * Feeds the streaming NMEA parser through the UART receive ring the way the ISR
+ * and the NMEA daemon do: sentences split across reads, corrupted checksums,
+ * line noise and a ring that overflows.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Other tests link their own tick and queue fakes, so the parser gets renamed ones
+#define MPU_xTaskGetTickCount nmea_tick_count
+#define MPU_xTaskGetCurrentTaskHandle nmea_current_task
+#define MPU_xQueueCreateMutex nmea_create_mutex
+#define MPU_xQueueTakeMutexRecursive nmea_take_mutex
+#define MPU_xQueueGiveMutexRecursive nmea_give_mutex
+#define vTaskNotifyGiveFromISR nmea_notify_give_from_isr
+
+#include "NMEAParser.h"
+#include "test_nmea_parser.h"
+
+#include "../source/NMEAParser.c"
+
+static TickType_t ticks;
+static int notifications;
+static int mutex_depth;
+static int reader_task;
+
+TickType_t nmea_tick_count(void) { return ticks; }
+
+TaskHandle_t nmea_current_task(void) { return (TaskHandle_t)&reader_task; }
+
+QueueHandle_t nmea_create_mutex(const uint8_t ucQueueType) { return (QueueHandle_t)&mutex_depth; }
+
+BaseType_t nmea_take_mutex(QueueHandle_t xMutex, TickType_t xTicksToWait) {
+    mutex_depth++;
+    return pdTRUE;
+}
+
+BaseType_t nmea_give_mutex(QueueHandle_t xMutex) {
+    mutex_depth--;
+    return pdTRUE;
+}
+
+void nmea_notify_give_from_isr(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken) {
+    notifications++;
+    *pxHigherPriorityTaskWoken = pdTRUE;
+}
+
+/* Build "$body*XX\r\n" with the checksum of body, plus error XORed into the checksum */
+static int make_sentence(char *out, size_t len, const char *body, uint8_t error) {
+    uint8_t checksum = 0;
+    const char *p;
+    for (p = body; *p; p++) {
+        checksum ^= (uint8_t)*p;
+    }
+    return snprintf(out, len, "$%s*%02X\r\n", body, checksum ^ error);
+}
+
+/* Bytes arriving in the ISR */
+static void receive(const char *bytes, size_t len) {
+    BaseType_t woken = pdFALSE;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        NMEA_ring_put_from_isr((uint8_t)bytes[i], &woken);
+    }
+}
+
+/* One wake-up of the NMEA daemon, draining the ring in small chunks. Returns sentences published */
+static int drain(void) {
+    uint8_t chunk[7];
+    size_t len, i;
+    int published = 0;
+    while ((len = NMEA_ring_read(chunk, sizeof(chunk))) > 0) {
+        for (i = 0; i < len; i++) {
+            published += NMEAParser_encode((char)chunk[i]);
+        }
+    }
+    return published;
+}
+
+static NMEA_stats_s stats(void) {
+    NMEA_stats_s s;
+    NMEAParser_get_stats(&s);
+    return s;
+}
+
+static const char *gga_fix = "GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,";
+static const char *gga_no_fix = "GPGGA,123519,,,,,0,00,,,M,,M,,";
+
+Describe(nmea_parser);
+BeforeEach(nmea_parser) {
+    ticks = 1000;
+    notifications = 0;
+    mutex_depth = 0;
+    memset(&_stats, 0, sizeof(_stats));
+    memset(&_parser, 0, sizeof(_parser));
+    _ring_head = _ring_tail = 0;
+    _rate_window_sentences = 0;
+    init_NMEA();
+};
+AfterEach(nmea_parser) { assert_that(mutex_depth, is_equal_to(0)); };
+
+Ensure(nmea_parser, publishes_gga_with_a_fix) {
+    char line[128];
+    GPGGA_s gga = {0};
+    int len = make_sentence(line, sizeof(line), gga_fix, 0);
+
+    receive(line, len);
+    assert_that(notifications, is_equal_to(1));
+    assert_that(drain(), is_equal_to(1));
+    assert_that(NMEAParser_get_GPGGA(&gga), is_true);
+    assert_that(gga._time, is_equal_to(12351900));
+    assert_that(gga._latitude_upper, is_equal_to(48));
+    assert_that(gga._longitude_upper, is_equal_to(11));
+    assert_that(gga._fixquality, is_equal_to(1));
+    assert_that(gga._numsats, is_equal_to(8));
+    assert_that(gga._hdop, is_equal_to(90));
+    assert_that(gga._altitude, is_equal_to(54540));
+    assert_that(stats().sentences, is_equal_to(1));
+    assert_that(stats().gga, is_equal_to(1));
+}
+
+Ensure(nmea_parser, sentence_split_across_reads_is_decoded) {
+    char line[128];
+    GPGGA_s gga = {0};
+    int len = make_sentence(line, sizeof(line), gga_fix, 0);
+    int cut, published;
+
+    // Every split point, including inside a term and inside the checksum
+    for (cut = 1; cut < len; cut++) {
+        NMEAParser_clear_GPGGA();
+        receive(line, cut);
+        published = drain();
+        if (cut < len - 2) {
+            // Published as soon as the second checksum digit arrives
+            assert_that(published, is_equal_to(0));
+        }
+        receive(line + cut, len - cut);
+        published += drain();
+        assert_that(published, is_equal_to(1));
+        assert_that(NMEAParser_get_GPGGA(&gga), is_true);
+    }
+    assert_that(stats().gga, is_equal_to(len - 1));
+    assert_that(stats().malformed, is_equal_to(0));
+}
+
+Ensure(nmea_parser, bad_checksum_is_counted_and_not_published) {
+    char line[128];
+    GPGGA_s gga = {0};
+    int len = make_sentence(line, sizeof(line), gga_fix, 0x10);
+
+    receive(line, len);
+    assert_that(drain(), is_equal_to(0));
+    assert_that(NMEAParser_get_GPGGA(&gga), is_false);
+    assert_that(stats().checksum_failures, is_equal_to(1));
+    assert_that(stats().sentences, is_equal_to(0));
+
+    // A corrupted data byte fails the same way
+    len = make_sentence(line, sizeof(line), gga_fix, 0);
+    line[10] ^= 0x01;
+    receive(line, len);
+    assert_that(drain(), is_equal_to(0));
+    assert_that(stats().checksum_failures, is_equal_to(2));
+}
+
+Ensure(nmea_parser, sentence_without_fix_is_counted_and_not_published) {
+    char line[128];
+    GPGGA_s gga = {0};
+    int len = make_sentence(line, sizeof(line), gga_no_fix, 0);
+
+    receive(line, len);
+    assert_that(drain(), is_equal_to(0));
+    assert_that(NMEAParser_get_GPGGA(&gga), is_false);
+    assert_that(stats().sentences, is_equal_to(1));
+    assert_that(stats().no_fix, is_equal_to(1));
+}
+
+Ensure(nmea_parser, resyncs_after_line_noise) {
+    char line[128];
+    int len;
+
+    // Cut off by a new '$'
+    receive("$GPGGA,1235", 11);
+    len = make_sentence(line, sizeof(line), gga_fix, 0);
+    receive(line, len);
+    assert_that(drain(), is_equal_to(1));
+    assert_that(stats().malformed, is_equal_to(1));
+
+    // No checksum
+    receive("$GPGGA,123519\r\n", 15);
+    assert_that(drain(), is_equal_to(0));
+    assert_that(stats().malformed, is_equal_to(2));
+
+    // Longer than any sentence, then garbage before the next one
+    memset(line, 'A', sizeof(line));
+    line[0] = '$';
+    receive(line, sizeof(line));
+    receive("\r\nxx", 4);
+    len = make_sentence(line, sizeof(line), gga_fix, 0);
+    receive(line, len);
+    assert_that(drain(), is_equal_to(1));
+    assert_that(stats().malformed, is_equal_to(3));
+    assert_that(stats().gga, is_equal_to(2));
+}
+
+Ensure(nmea_parser, ring_overflow_drops_bytes_and_parser_recovers) {
+    char line[128];
+    char fill[NMEA_RING_SIZE];
+    int len;
+
+    // The ring holds NMEA_RING_SIZE - 1 bytes, the rest are dropped and counted
+    memset(fill, 'x', sizeof(fill));
+    receive(fill, sizeof(fill));
+    receive(fill, 10);
+    assert_that(stats().overruns, is_equal_to(11));
+
+    // A sentence arriving while the ring is full loses its bytes
+    len = make_sentence(line, sizeof(line), gga_fix, 0);
+    receive(line, len);
+    assert_that(stats().overruns, is_equal_to(11 + len));
+    assert_that(drain(), is_equal_to(0));
+
+    // Once drained, the next sentence gets through
+    receive(line, len);
+    assert_that(drain(), is_equal_to(1));
+    assert_that(stats().gga, is_equal_to(1));
+    assert_that(stats().overruns, is_equal_to(11 + len));
+}
+
+Ensure(nmea_parser, overflow_mid_sentence_fails_its_checksum) {
+    char line[128];
+    char fill[NMEA_RING_SIZE];
+    int len = make_sentence(line, sizeof(line), gga_fix, 0);
+    int head = 20;
+
+    // The start of the sentence fits, the ring fills, and the middle is lost before the tail arrives
+    memset(fill, 'x', sizeof(fill));
+    receive(fill, NMEA_RING_SIZE - 1 - head);
+    receive(line, head);
+    receive(line + head, 8);
+    assert_that(drain(), is_equal_to(0));
+    receive(line + head + 8, len - head - 8);
+    assert_that(drain(), is_equal_to(0));
+    assert_that(stats().overruns, is_equal_to(8));
+    assert_that(stats().checksum_failures, is_equal_to(1));
+}
+
+Ensure(nmea_parser, gsv_snr_is_averaged_over_the_report) {
+    char line[128];
+    GPGSV_s gsv = {0};
+    int len;
+
+    len = make_sentence(line, sizeof(line), "GPGSV,2,1,05,01,40,083,40,02,17,308,42,03,07,344,,04,22,228,44", 0);
+    receive(line, len);
+    len = make_sentence(line, sizeof(line), "GPGSV,2,2,05,05,10,120,30", 0);
+    receive(line, len);
+    assert_that(drain(), is_equal_to(2));
+    assert_that(NMEAParser_get_GPGSV(&gsv), is_true);
+    assert_that(gsv._snr_count, is_equal_to(4));
+    assert_that(gsv._snr_avg, is_equal_to((4000 + 4200 + 4400 + 3000) / 4));
+}
+
+Ensure(nmea_parser, rate_counts_sentences_per_window) {
+    char line[128];
+    int len = make_sentence(line, sizeof(line), gga_fix, 0);
+    int i;
+
+    for (i = 0; i < 5; i++) {
+        receive(line, len);
+    }
+    drain();
+    NMEAParser_update_rate(ticks + pdMS_TO_TICKS(NMEA_RATE_WINDOW_MS) - 1);
+    assert_that(stats().sentences_per_window, is_equal_to(0));
+    NMEAParser_update_rate(ticks + pdMS_TO_TICKS(NMEA_RATE_WINDOW_MS));
+    assert_that(stats().sentences_per_window, is_equal_to(5));
+}
+
+TestSuite *nmea_parser_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, nmea_parser, publishes_gga_with_a_fix);
+    add_test_with_context(suite, nmea_parser, sentence_split_across_reads_is_decoded);
+    add_test_with_context(suite, nmea_parser, bad_checksum_is_counted_and_not_published);
+    add_test_with_context(suite, nmea_parser, sentence_without_fix_is_counted_and_not_published);
+    add_test_with_context(suite, nmea_parser, resyncs_after_line_noise);
+    add_test_with_context(suite, nmea_parser, ring_overflow_drops_bytes_and_parser_recovers);
+    add_test_with_context(suite, nmea_parser, overflow_mid_sentence_fails_its_checksum);
+    add_test_with_context(suite, nmea_parser, gsv_snr_is_averaged_over_the_report);
+    add_test_with_context(suite, nmea_parser, rate_counts_sentences_per_window);
+    return suite;
+}
+
+int test_nmea_parser(void) {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, nmea_parser_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
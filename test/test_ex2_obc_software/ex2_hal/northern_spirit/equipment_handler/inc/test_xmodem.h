@@ -0,0 +1,6 @@
+#ifndef TEST_XMODEM
+#define TEST_XMODEM
+
+int test_xmodem(void);
+
+#endif
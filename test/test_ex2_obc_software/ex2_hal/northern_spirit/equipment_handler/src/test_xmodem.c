@@ -0,0 +1,343 @@
+/*
+ * test_xmodem.c
+ *
+ * Loops the XMODEM transmitters back into a simulated Northern Spirit receiver,
+ * with faults injected on the link and the file system, and compares the link
+ * time of the base64 and streaming 1K transfers. test/bench/xmodem_bench.c reports
+ * the link time of a 64 KiB file.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xmodem.h"
+#include "test_xmodem.h"
+
+// The logger test links its own file system and tick mocks, so the transmitter gets renamed fakes
+#define red_open xmodem_red_open
+#define red_close xmodem_red_close
+#define red_read xmodem_red_read
+#define red_write xmodem_red_write
+#define MPU_xTaskGetTickCount xmodem_tick_count
+
+#include "../source/xmodem.c"
+
+#define FILE_MAX (64 * 1024)
+#define LINK_BAUD 115200
+#define TURNAROUND_US 5000 // receiver time to check a block and answer
+#define MAX_EVENTS 512
+
+static uint8_t file[FILE_MAX];
+static uint32_t file_len, file_pos;
+static int read_calls, read_fail_at, read_chunk;
+
+static uint8_t received[FILE_MAX + XMODEM_1K_BLOCK_LEN];
+static uint32_t received_len;
+static int rx_expected, rx_deliveries, rx_eots, rx_cans, rx_packet_lens[256];
+static int rx_nak_at, rx_drop_at, rx_always_nak, rx_cancel_at;
+static bool rx_base64, rx_nak_first_eot;
+
+static uint8_t answers[64];
+static int answer_head, answer_tail;
+
+static uint64_t link_us;
+static char events[MAX_EVENTS];
+static int event_count;
+static unsigned char *sending;
+static uint32_t sending_len;
+
+static void event(char e) {
+    if (event_count < MAX_EVENTS) {
+        events[event_count++] = e;
+    }
+}
+
+static void answer(uint8_t c) { answers[answer_tail++ % sizeof(answers)] = c; }
+
+/* Simulated receiver, checks a packet the way the payload does and queues its answer */
+static void receive(const uint8_t *data, uint32_t len) {
+    int bufsz, crc_len;
+    uint16_t crc;
+
+    link_us += (uint64_t)len * 10 * 1000000 / LINK_BAUD;
+    if (len == 1) {
+        if (data[0] == EOT) {
+            // A careful receiver NAKs the first EOT in case it was noise
+            answer(rx_eots++ == 0 && rx_nak_first_eot ? NAK : ACK);
+        } else if (data[0] == CAN) {
+            rx_cans++;
+        }
+        return;
+    }
+    rx_deliveries++;
+    link_us += TURNAROUND_US;
+    if (rx_cancel_at == rx_deliveries) {
+        answer(CAN);
+        answer(CAN);
+        return;
+    }
+    if (rx_always_nak || rx_nak_at == rx_deliveries) {
+        answer(NAK);
+        return;
+    }
+    if (rx_drop_at == rx_deliveries) {
+        return;
+    }
+
+    bufsz = data[0] == STX ? XMODEM_1K_BLOCK_LEN : XMODEM_BLOCK_LEN;
+    crc_len = (int)len - XMODEM_HEADER_LEN - bufsz;
+    assert_that(crc_len == 1 || crc_len == 2, is_true);
+    assert_that(data[1], is_equal_to(rx_expected & 0xFF));
+    assert_that(data[2], is_equal_to(~rx_expected & 0xFF));
+    if (crc_len == 2) {
+        crc = crc16_bitwise(CRC16_INIT, &data[XMODEM_HEADER_LEN], bufsz);
+        assert_that(data[len - 2], is_equal_to(crc >> 8));
+        assert_that(data[len - 1], is_equal_to(crc & 0xFF));
+    }
+    if (rx_expected < 256) {
+        rx_packet_lens[rx_expected] = len;
+    }
+
+    if (rx_base64) {
+        // Decode up to the end of the last whole group, the rest is '=' fill
+        const uint8_t *fill = memchr(&data[XMODEM_HEADER_LEN], '=', bufsz);
+        size_t chars = fill == NULL ? bufsz : (fill - &data[XMODEM_HEADER_LEN] + 3) / 4 * 4;
+        size_t out_len;
+        unsigned char *out;
+        out = base64_decode((const char *)&data[XMODEM_HEADER_LEN], chars, &out_len);
+        memcpy(&received[received_len], out, out_len);
+        received_len += out_len;
+        free(out);
+    } else {
+        memcpy(&received[received_len], &data[XMODEM_HEADER_LEN], bufsz);
+        received_len += bufsz;
+    }
+    rx_expected++;
+    answer(ACK);
+}
+
+NS_return NS_sendOnly(uint8_t *command, uint32_t command_length) {
+    receive(command, command_length);
+    return NS_OK;
+}
+
+/* The packet is delivered at the end of the send, so changing it during the send would be caught */
+NS_return NS_sendBegin(uint8_t *command, uint32_t command_length) {
+    event('B');
+    sending = command;
+    sending_len = command_length;
+    return NS_OK;
+}
+
+NS_return NS_sendEnd(TickType_t timeout) {
+    event('E');
+    receive(sending, sending_len);
+    return NS_OK;
+}
+
+NS_return NS_expectResponse(uint8_t *response, uint8_t length, TickType_t timeout) {
+    uint8_t i;
+    for (i = 0; i < length; i++) {
+        if (answer_head == answer_tail) {
+            link_us += (uint64_t)timeout * 1000;
+            return NS_UART_FAIL;
+        }
+        response[i] = answers[answer_head++ % sizeof(answers)];
+    }
+    return NS_OK;
+}
+
+void NS_resetQueue(void) { answer_head = answer_tail; }
+
+TickType_t xTaskGetTickCount(void) { return (TickType_t)(link_us / 1000); }
+
+int32_t red_read(int32_t iFildes, void *pBuffer, uint32_t ulLength) {
+    event('R');
+    if (++read_calls == read_fail_at) {
+        return -1;
+    }
+    if (read_chunk > 0 && ulLength > (uint32_t)read_chunk) {
+        ulLength = read_chunk;
+    }
+    if (ulLength > file_len - file_pos) {
+        ulLength = file_len - file_pos;
+    }
+    memcpy(pBuffer, &file[file_pos], ulLength);
+    file_pos += ulLength;
+    return ulLength;
+}
+
+int32_t red_open(const char *pszPath, uint32_t ulOpenMode) { return -1; }
+int32_t red_close(int32_t iFildes) { return 0; }
+int32_t red_write(int32_t iFildes, const void *pBuffer, uint32_t ulLength) { return ulLength; }
+
+static void start(uint32_t len, uint8_t mode) {
+    uint32_t i;
+    srand(len);
+    for (i = 0; i < len; i++) {
+        file[i] = (uint8_t)rand();
+    }
+    file_len = len;
+    file_pos = 0;
+    received_len = 0;
+    rx_expected = 1;
+    rx_deliveries = rx_eots = rx_cans = 0;
+    link_us = 0;
+    answer_head = answer_tail = 0;
+    answer(mode);
+}
+
+static bool received_file(void) {
+    uint32_t i;
+    if (memcmp(received, file, file_len) != 0) {
+        return false;
+    }
+    for (i = file_len; i < received_len; i++) {
+        if (received[i] != CTRLZ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Describe(xmodem);
+BeforeEach(xmodem) {
+    read_calls = read_fail_at = read_chunk = 0;
+    rx_nak_at = rx_drop_at = rx_always_nak = rx_cancel_at = 0;
+    rx_base64 = rx_nak_first_eot = false;
+    memset(rx_packet_lens, 0, sizeof(rx_packet_lens));
+    event_count = 0;
+};
+AfterEach(xmodem) {};
+
+Ensure(xmodem, crc_matches_xmodem_check_value) {
+    assert_that(crc16_ccitt("123456789", 9), is_equal_to(0x31C3));
+}
+
+Ensure(xmodem, stream_sends_file_in_1k_blocks) {
+    xmodem_stats stats;
+
+    start(10000, 'C');
+    read_chunk = 700; // the file system may return less than asked for
+    rx_nak_first_eot = true;
+    assert_that(xmodemTransmitStream(0, file_len, &stats), is_equal_to(10000));
+    assert_that(received_file(), is_true);
+    assert_that(stats.bytes, is_equal_to(10000));
+    assert_that(stats.blocks, is_equal_to(10));
+    assert_that(stats.retries, is_equal_to(0));
+    assert_that(stats.elapsed_ms, is_greater_than(0));
+    assert_that(stats.bytes_per_s, is_greater_than(0));
+    assert_that(rx_packet_lens[1], is_equal_to(XMODEM_PACKET_LEN(XMODEM_1K_BLOCK_LEN)));
+    assert_that(rx_eots, is_equal_to(2));
+}
+
+Ensure(xmodem, stream_sends_short_tail_in_128_byte_block) {
+    start(2 * XMODEM_1K_BLOCK_LEN + 100, 'C');
+    assert_that(xmodemTransmitStream(0, file_len, NULL), is_equal_to(2 * XMODEM_1K_BLOCK_LEN + 100));
+    assert_that(rx_packet_lens[2], is_equal_to(XMODEM_PACKET_LEN(XMODEM_1K_BLOCK_LEN)));
+    assert_that(rx_packet_lens[3], is_equal_to(XMODEM_PACKET_LEN(XMODEM_BLOCK_LEN)));
+    assert_that(received_len, is_equal_to(2 * XMODEM_1K_BLOCK_LEN + XMODEM_BLOCK_LEN));
+    assert_that(received_file(), is_true);
+}
+
+Ensure(xmodem, stream_reads_next_block_during_send) {
+    start(3 * XMODEM_1K_BLOCK_LEN, 'C');
+    assert_that(xmodemTransmitStream(0, file_len, NULL), is_equal_to(3 * XMODEM_1K_BLOCK_LEN));
+    events[event_count] = '\0';
+    // The first block is read before sending, every later one while the one before it is sent.
+    // There is nothing left to read during the last send
+    assert_that(events, is_equal_to_string("RBREBREBE"));
+}
+
+Ensure(xmodem, stream_retries_nak_and_timeout) {
+    xmodem_stats stats;
+
+    start(6 * XMODEM_1K_BLOCK_LEN, 'C');
+    rx_nak_at = 3;
+    rx_drop_at = 5;
+    assert_that(xmodemTransmitStream(0, file_len, &stats), is_equal_to(6 * XMODEM_1K_BLOCK_LEN));
+    assert_that(received_file(), is_true);
+    assert_that(stats.blocks, is_equal_to(6));
+    assert_that(stats.retries, is_equal_to(2));
+    assert_that(stats.naks, is_equal_to(1));
+    assert_that(stats.timeouts, is_equal_to(1));
+    // A retry sends the packet again without reading the file again
+    assert_that(read_calls, is_equal_to(6));
+}
+
+Ensure(xmodem, stream_uses_checksum_when_asked) {
+    start(1500, NAK);
+    assert_that(xmodemTransmitStream(0, file_len, NULL), is_equal_to(1500));
+    assert_that(rx_packet_lens[1], is_equal_to(XMODEM_PACKET_LEN(XMODEM_1K_BLOCK_LEN) - 1));
+    assert_that(received_file(), is_true);
+}
+
+Ensure(xmodem, stream_cancels_on_errors) {
+    start(5000, 'C');
+    read_fail_at = 3;
+    assert_that(xmodemTransmitStream(0, file_len, NULL), is_equal_to(-4));
+    assert_that(rx_cans, is_equal_to(3));
+
+    start(5000, 'C');
+    rx_always_nak = 1;
+    assert_that(xmodemTransmitStream(0, file_len, NULL), is_equal_to(-4));
+
+    start(5000, 'C');
+    rx_always_nak = 0;
+    rx_cancel_at = 2;
+    assert_that(xmodemTransmitStream(0, file_len, NULL), is_equal_to(-1));
+
+    start(5000, 'C');
+    answer_head = answer_tail; // receiver never asks
+    assert_that(xmodemTransmitStream(0, file_len, NULL), is_equal_to(-2));
+}
+
+Ensure(xmodem, base64_transfer_sends_whole_file) {
+    // More than 127 bytes left used to end the transfer early
+    start(1000, 'C');
+    rx_base64 = true;
+    assert_that(xmodemTransmit(0, file_len), is_equal_to(1000));
+    assert_that(received_len, is_equal_to(1000));
+    assert_that(received_file(), is_true);
+}
+
+Ensure(xmodem, stream_takes_less_link_time_than_base64) {
+    xmodem_stats stats;
+    uint64_t base64_us;
+
+    start(16 * 1024, 'C');
+    rx_base64 = true;
+    assert_that(xmodemTransmit(0, file_len), is_equal_to(16 * 1024));
+    base64_us = link_us;
+
+    rx_base64 = false;
+    start(16 * 1024, 'C');
+    assert_that(xmodemTransmitStream(0, file_len, &stats), is_equal_to(16 * 1024));
+    assert_that(received_file(), is_true);
+    assert_that(stats.blocks, is_equal_to(16));
+    assert_that(link_us * 3 < base64_us * 2, is_true);
+}
+
+TestSuite *xmodem_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, xmodem, crc_matches_xmodem_check_value);
+    add_test_with_context(suite, xmodem, stream_sends_file_in_1k_blocks);
+    add_test_with_context(suite, xmodem, stream_sends_short_tail_in_128_byte_block);
+    add_test_with_context(suite, xmodem, stream_reads_next_block_during_send);
+    add_test_with_context(suite, xmodem, stream_retries_nak_and_timeout);
+    add_test_with_context(suite, xmodem, stream_uses_checksum_when_asked);
+    add_test_with_context(suite, xmodem, stream_cancels_on_errors);
+    add_test_with_context(suite, xmodem, base64_transfer_sends_whole_file);
+    add_test_with_context(suite, xmodem, stream_takes_less_link_time_than_base64);
+
+    return suite;
+}
+
+int test_xmodem(void) {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, xmodem_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
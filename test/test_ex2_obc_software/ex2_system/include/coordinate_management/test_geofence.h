@@ -0,0 +1,6 @@
+#ifndef TEST_GEOFENCE
+#define TEST_GEOFENCE
+
+int test_geofence();
+
+#endif
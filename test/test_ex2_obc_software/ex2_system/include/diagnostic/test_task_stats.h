@@ -0,0 +1,6 @@
+#ifndef TEST_TASK_STATS
+#define TEST_TASK_STATS
+
+int test_task_stats();
+
+#endif
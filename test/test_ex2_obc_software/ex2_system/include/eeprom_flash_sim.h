@@ -0,0 +1,34 @@
+/*
+ * eeprom_flash_sim.h
+ *
+ * RAM model of the bank 7 flash behind eeprom_flash_erase/program/read.
+ * Programming can only clear bits, like the real array, and can be cut off
+ * part way through to model a reset during a write.
+ */
+
+#ifndef EEPROM_FLASH_SIM_H
+#define EEPROM_FLASH_SIM_H
+
+#include <stdint.h>
+
+#define EEPROM_FLASH_SIM_SECTORS 32
+#define EEPROM_FLASH_SIM_SECTOR_SIZE 0x1000
+
+// Erase every sector and clear all counters and injected faults
+void eeprom_flash_sim_reset();
+
+// Let only this many more bytes be programmed before every program call fails
+void eeprom_flash_sim_cut_power_after(uint32_t bytes);
+
+void eeprom_flash_sim_restore_power();
+
+uint32_t eeprom_flash_sim_erase_count(uint8_t sector);
+
+uint32_t eeprom_flash_sim_program_count();
+
+// Number of program operations that targeted bytes which were not erased
+uint32_t eeprom_flash_sim_overwrite_count();
+
+uint8_t *eeprom_flash_sim_sector(uint8_t sector);
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * image_flash_sim.h
+ *
+ * RAM model of the application slot behind image_flash_sector/erase/program/read,
+ * plus the update_info and application image_info EEPROM records. A read only
+ * golden image, with its image_info, is the base for patches. Programming can
+ * only clear bits, like the real array, and can be cut off part way through to
+ * model a reset during a write. The sectors are the real 128 KiB ones.
+ */
+
+#ifndef IMAGE_FLASH_SIM_H
+#define IMAGE_FLASH_SIM_H
+
+#include <stdint.h>
+
+#define IMAGE_FLASH_SIM_BASE 0x00200000 // APP_DEFAULT_ADDR
+#define IMAGE_FLASH_SIM_SECTORS 8
+#define IMAGE_FLASH_SIM_SECTOR_SIZE 0x20000 // two checkpoints to a sector
+#define IMAGE_FLASH_SIM_GOLDEN_BASE 0x00020000 // GOLD_DEFAULT_ADDR
+
+// Erase the whole slot and golden image, clear all three records and all counters and injected faults
+void image_flash_sim_reset();
+
+// Let only this many more bytes be programmed before every program and erase call fails
+void image_flash_sim_cut_power_after(uint32_t bytes);
+
+void image_flash_sim_restore_power();
+
+uint32_t image_flash_sim_erase_count(uint8_t sector);
+
+uint32_t image_flash_sim_update_info_writes();
+
+// Number of program operations that targeted bytes which were not erased
+uint32_t image_flash_sim_overwrite_count();
+
+uint8_t *image_flash_sim_slot();
+
+// Load the golden image and record it in its image_info
+void image_flash_sim_set_golden(const uint8_t *image, uint32_t len);
+
+uint8_t *image_flash_sim_golden();
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef TEST_CRC16
+#define TEST_CRC16
+
+int test_crc16();
+
+#endif
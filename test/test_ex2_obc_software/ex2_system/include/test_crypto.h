@@ -0,0 +1,6 @@
+#ifndef TEST_CRYPTO
+#define TEST_CRYPTO
+
+int test_crypto();
+
+#endif
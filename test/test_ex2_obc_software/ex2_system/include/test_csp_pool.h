@@ -0,0 +1,6 @@
+#ifndef TEST_CSP_POOL
+#define TEST_CSP_POOL
+
+int test_csp_pool();
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef TEST_EEPROM_LOG
+#define TEST_EEPROM_LOG
+
+int test_eeprom_log();
+
+#endif
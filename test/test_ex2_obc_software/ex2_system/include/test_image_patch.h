@@ -0,0 +1,6 @@
+#ifndef TEST_IMAGE_PATCH
+#define TEST_IMAGE_PATCH
+
+int test_image_patch();
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef TEST_IMAGE_UPDATE
+#define TEST_IMAGE_UPDATE
+
+int test_image_update();
+
+#endif
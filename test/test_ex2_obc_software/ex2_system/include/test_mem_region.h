@@ -0,0 +1,6 @@
+#ifndef TEST_MEM_REGION
+#define TEST_MEM_REGION
+
+int test_mem_region();
+
+#endif
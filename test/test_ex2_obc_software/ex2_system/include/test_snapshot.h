@@ -0,0 +1,6 @@
+#ifndef TEST_SNAPSHOT
+#define TEST_SNAPSHOT
+
+int test_snapshot();
+
+#endif
@@ -0,0 +1,287 @@
+/*
+ * test_geofence.c
+ *
+ * Checks region and station caps, hysteresis and event delivery of the geofence,
+ * and compares it with a trig great circle check over two simulated orbits. Its
+ * cost over a day of orbit is measured by test/bench/geofence_bench.c.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "coordinate_management/geofence.h"
+#include "coordinate_management/test_geofence.h"
+
+#include "../source/coordinate_management/geofence.c"
+
+#define MAX_EVENTS 32
+
+#define ORBIT_SECONDS (2 * 5700) // two orbits
+#define ORBIT_ALTITUDE_KM 550.0
+#define ORBIT_INCLINATION_DEG 97.5
+#define EARTH_MU 398600.4418           // km^3/s^2
+#define EARTH_ROTATION 7.2921159e-5    // rad/s
+
+static geofence_event events[MAX_EVENTS];
+static int event_count;
+
+static void record(const geofence_event *event, void *arg) {
+    int *calls = (int *)arg;
+    if (event_count < MAX_EVENTS) {
+        events[event_count] = *event;
+    }
+    event_count++;
+    if (calls != NULL) {
+        (*calls)++;
+    }
+}
+
+Describe(geofence);
+BeforeEach(geofence) {
+    geofence_init();
+    event_count = 0;
+    geofence_subscribe(record, NULL);
+};
+AfterEach(geofence) {};
+
+Ensure(geofence, unit_vectors_point_along_the_axes) {
+    geofence_vec v;
+
+    geofence_unit_vector(0.0f, 0.0f, &v);
+    assert_that(fabsf(v.x - 1.0f) < 1e-6f, is_true);
+    geofence_unit_vector(0.0f, 90.0f, &v);
+    assert_that(fabsf(v.y - 1.0f) < 1e-6f, is_true);
+    geofence_unit_vector(-90.0f, 45.0f, &v);
+    assert_that(fabsf(v.z + 1.0f) < 1e-6f, is_true);
+    geofence_unit_vector(53.5f, -113.5f, &v);
+    assert_that(fabsf(v.x * v.x + v.y * v.y + v.z * v.z - 1.0f) < 1e-6f, is_true);
+}
+
+Ensure(geofence, region_enters_at_radius_and_exits_past_hysteresis) {
+    // 500 km is 4.497 degrees of longitude on the equator, the hysteresis adds 0.090
+    assert_that(geofence_set_region(0, 0.0f, 0.0f, 500.0f), is_equal_to(SATR_OK));
+
+    assert_that(geofence_update_lat_lon(0.0f, 4.6f, 1), is_equal_to(0));
+    assert_that(geofence_update_lat_lon(0.0f, 4.45f, 2), is_equal_to(1));
+    assert_that(geofence_inside(0), is_true);
+    assert_that(events[0].type, is_equal_to(GEOFENCE_ENTER));
+    assert_that(events[0].kind, is_equal_to(GEOFENCE_REGION));
+    assert_that(events[0].time, is_equal_to(2));
+
+    // Between the edges nothing changes in either direction
+    assert_that(geofence_update_lat_lon(0.0f, 4.55f, 3), is_equal_to(0));
+    assert_that(geofence_inside(0), is_true);
+    assert_that(geofence_update_lat_lon(0.0f, 4.62f, 4), is_equal_to(1));
+    assert_that(events[1].type, is_equal_to(GEOFENCE_EXIT));
+    assert_that(geofence_update_lat_lon(0.0f, 4.55f, 5), is_equal_to(0));
+    assert_that(geofence_inside(0), is_false);
+    assert_that(event_count, is_equal_to(2));
+}
+
+Ensure(geofence, propagated_positions_do_not_need_to_be_unit_vectors) {
+    geofence_vec position;
+
+    geofence_set_region(5, 0.0f, 0.0f, 500.0f);
+    geofence_unit_vector(0.0f, 4.4f, &position);
+    position.x *= 6921.0f;
+    position.y *= 6921.0f;
+    position.z *= 6921.0f;
+    assert_that(geofence_update(&position, 10), is_equal_to(1));
+    assert_that(events[0].zone, is_equal_to(5));
+
+    position.x = position.y = position.z = 0.0f;
+    assert_that(geofence_update(&position, 11), is_equal_to(0));
+    assert_that(geofence_inside(5), is_true);
+}
+
+Ensure(geofence, station_cap_follows_elevation_and_altitude) {
+    // Horizon at 550 km is acos(6371 / 6921) = 23.0 degrees, a 10 degree mask gives 14.97
+    geofence_set_station(1, 0.0f, 0.0f, 10.0f);
+    assert_that(geofence_update_lat_lon(0.0f, 15.2f, 1), is_equal_to(0));
+    assert_that(geofence_update_lat_lon(0.0f, 14.8f, 2), is_equal_to(1));
+    assert_that(events[0].kind, is_equal_to(GEOFENCE_STATION));
+    assert_that(geofence_update_lat_lon(0.0f, 15.2f, 3), is_equal_to(1));
+
+    // Higher up the station sees further, at 800 km and 10 degrees the cap is 18.96
+    geofence_set_altitude(800.0f);
+    assert_that(geofence_update_lat_lon(0.0f, 18.8f, 4), is_equal_to(1));
+    assert_that(geofence_update_lat_lon(0.0f, 19.0f, 5), is_equal_to(0));
+    assert_that(geofence_update_lat_lon(0.0f, 19.1f, 6), is_equal_to(1));
+
+    geofence_set_altitude(-1.0f);
+    assert_that(geofence_get_altitude() == 800.0f, is_true);
+}
+
+Ensure(geofence, every_subscriber_gets_every_event) {
+    int calls = 0;
+    int i;
+
+    for (i = 1; i < GEOFENCE_MAX_SUBSCRIBERS; i++) {
+        assert_that(geofence_subscribe(record, &calls), is_equal_to(SATR_OK));
+    }
+    assert_that(geofence_subscribe(record, &calls), is_equal_to(SATR_ERROR));
+    assert_that(geofence_subscribe(NULL, NULL), is_equal_to(SATR_ERROR));
+
+    geofence_set_region(0, 10.0f, 10.0f, 100.0f);
+    geofence_set_region(1, 10.0f, 10.0f, 200.0f);
+    assert_that(geofence_update_lat_lon(10.0f, 10.0f, 1), is_equal_to(2));
+    assert_that(calls, is_equal_to(2 * (GEOFENCE_MAX_SUBSCRIBERS - 1)));
+    assert_that(event_count, is_equal_to(2 * GEOFENCE_MAX_SUBSCRIBERS));
+}
+
+Ensure(geofence, clearing_or_replacing_a_zone_reports_exit) {
+    geofence_set_region(2, -30.0f, 150.0f, 300.0f);
+    geofence_set_region(3, -30.0f, 150.0f, 300.0f);
+    geofence_update_lat_lon(-30.0f, 150.0f, 7);
+    assert_that(event_count, is_equal_to(2));
+
+    assert_that(geofence_clear(2), is_equal_to(SATR_OK));
+    assert_that(event_count, is_equal_to(3));
+    assert_that(events[2].zone, is_equal_to(2));
+    assert_that(events[2].type, is_equal_to(GEOFENCE_EXIT));
+    assert_that(events[2].time, is_equal_to(7));
+    assert_that(geofence_inside(2), is_false);
+
+    // Replacing starts the new zone outside, the next update enters it again
+    geofence_set_station(3, -30.0f, 150.0f, 5.0f);
+    assert_that(event_count, is_equal_to(4));
+    assert_that(geofence_update_lat_lon(-30.0f, 150.0f, 8), is_equal_to(1));
+    assert_that(geofence_clear(2), is_equal_to(SATR_OK));
+    assert_that(event_count, is_equal_to(5));
+}
+
+Ensure(geofence, rejects_invalid_zones) {
+    assert_that(geofence_set_region(GEOFENCE_MAX_ZONES, 0.0f, 0.0f, 100.0f), is_equal_to(SATR_ERROR));
+    assert_that(geofence_set_region(0, 91.0f, 0.0f, 100.0f), is_equal_to(SATR_ERROR));
+    assert_that(geofence_set_region(0, 0.0f, 0.0f, 0.0f), is_equal_to(SATR_ERROR));
+    assert_that(geofence_set_region(0, 0.0f, 0.0f, NAN), is_equal_to(SATR_ERROR));
+    assert_that(geofence_set_station(0, 0.0f, 0.0f, 90.0f), is_equal_to(SATR_ERROR));
+    assert_that(geofence_set_station(0, 0.0f, 0.0f, -1.0f), is_equal_to(SATR_ERROR));
+    assert_that(geofence_clear(GEOFENCE_MAX_ZONES), is_equal_to(SATR_ERROR));
+    assert_that(geofence_inside(0), is_false);
+    assert_that(geofence_update_lat_lon(0.0f, 0.0f, 1), is_equal_to(0));
+}
+
+/* The China regions, Edmonton, and a few more stations, so polar passes cross some */
+static const float orbit_zones[][4] = {
+    {30.7475f, 111.1816f, 1500.0f, -1.0f}, // lat, lon, radius km or -1, elevation mask
+    {38.5413f, 88.4180f, 1350.0f, -1.0f},
+    {46.3135f, 123.9258f, 1000.0f, -1.0f},
+    {53.5232f, -113.5263f, -1.0f, 10.0f},
+    {78.2300f, 15.4000f, -1.0f, 5.0f},
+    {-33.9000f, 18.4000f, -1.0f, 10.0f},
+    {64.8000f, -147.7000f, -1.0f, 10.0f},
+    {-77.8500f, 166.6700f, -1.0f, 5.0f},
+};
+#define ORBIT_ZONES (sizeof(orbit_zones) / sizeof(orbit_zones[0]))
+
+/* Great circle check the daemon used before, with acos per zone and update */
+static int trig_update(const float *lat, const float *lon, const float enter[], const float leave[],
+                       bool inside[]) {
+    int changes = 0;
+    unsigned int i;
+
+    for (i = 0; i < ORBIT_ZONES; i++) {
+        float lat1 = *lat * DEG_TO_RAD, lat2 = orbit_zones[i][0] * DEG_TO_RAD;
+        float dlon = fabsf(*lon - orbit_zones[i][1]) * DEG_TO_RAD;
+        float c = sinf(lat1) * sinf(lat2) + cosf(lat1) * cosf(lat2) * cosf(dlon);
+        float angle = acosf(c > 1.0f ? 1.0f : c);
+        if (!inside[i] && angle <= enter[i]) {
+            inside[i] = true;
+            changes++;
+        } else if (inside[i] && angle > leave[i]) {
+            inside[i] = false;
+            changes++;
+        }
+    }
+    return changes;
+}
+
+Ensure(geofence, matches_great_circle_check_along_an_orbit) {
+    geofence_vec *positions = malloc(ORBIT_SECONDS * sizeof(geofence_vec));
+    float *lat = malloc(ORBIT_SECONDS * sizeof(float));
+    float *lon = malloc(ORBIT_SECONDS * sizeof(float));
+    float enter[ORBIT_ZONES], leave[ORBIT_ZONES];
+    bool inside[ORBIT_ZONES] = {false};
+    double r = GEOFENCE_EARTH_RADIUS_KM + ORBIT_ALTITUDE_KM;
+    double n = sqrt(EARTH_MU / (r * r * r));
+    double incl = ORBIT_INCLINATION_DEG * DEG_TO_RAD;
+    int trig_events = 0, dot_events = 0, lat_lon_events = 0;
+    unsigned int i;
+    int t;
+
+    geofence_set_altitude((float)ORBIT_ALTITUDE_KM);
+    for (i = 0; i < ORBIT_ZONES; i++) {
+        if (orbit_zones[i][2] > 0) {
+            geofence_set_region(i, orbit_zones[i][0], orbit_zones[i][1], orbit_zones[i][2]);
+            enter[i] = orbit_zones[i][2] / GEOFENCE_EARTH_RADIUS_KM;
+        } else {
+            geofence_set_station(i, orbit_zones[i][0], orbit_zones[i][1], orbit_zones[i][3]);
+            enter[i] = station_angle(orbit_zones[i][3]);
+        }
+        leave[i] = enter[i] + GEOFENCE_HYSTERESIS_KM / GEOFENCE_EARTH_RADIUS_KM;
+    }
+
+    // Circular orbit from the ascending node at 0 longitude, rotated into the Earth fixed frame
+    for (t = 0; t < ORBIT_SECONDS; t++) {
+        double u = n * t, theta = -EARTH_ROTATION * t;
+        double x = r * cos(u), y = r * sin(u) * cos(incl), z = r * sin(u) * sin(incl);
+        positions[t].x = (float)(x * cos(theta) - y * sin(theta));
+        positions[t].y = (float)(x * sin(theta) + y * cos(theta));
+        positions[t].z = (float)z;
+        lat[t] = (float)(asin(z / r) / DEG_TO_RAD);
+        lon[t] = (float)(atan2(positions[t].y, positions[t].x) / DEG_TO_RAD);
+    }
+
+    for (t = 0; t < ORBIT_SECONDS; t++) {
+        trig_events += trig_update(&lat[t], &lon[t], enter, leave, inside);
+    }
+    for (t = 0; t < ORBIT_SECONDS; t++) {
+        dot_events += geofence_update(&positions[t], t);
+    }
+
+    for (i = 0; i < ORBIT_ZONES; i++) {
+        geofence_clear(i);
+    }
+    for (i = 0; i < ORBIT_ZONES; i++) {
+        if (orbit_zones[i][2] > 0) {
+            geofence_set_region(i, orbit_zones[i][0], orbit_zones[i][1], orbit_zones[i][2]);
+        } else {
+            geofence_set_station(i, orbit_zones[i][0], orbit_zones[i][1], orbit_zones[i][3]);
+        }
+    }
+    for (t = 0; t < ORBIT_SECONDS; t++) {
+        lat_lon_events += geofence_update_lat_lon(lat[t], lon[t], t);
+    }
+
+    assert_that(dot_events, is_greater_than(0));
+    assert_that(dot_events, is_equal_to(trig_events));
+    assert_that(lat_lon_events, is_equal_to(trig_events));
+
+    free(positions);
+    free(lat);
+    free(lon);
+}
+
+TestSuite *geofence_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, geofence, unit_vectors_point_along_the_axes);
+    add_test_with_context(suite, geofence, region_enters_at_radius_and_exits_past_hysteresis);
+    add_test_with_context(suite, geofence, propagated_positions_do_not_need_to_be_unit_vectors);
+    add_test_with_context(suite, geofence, station_cap_follows_elevation_and_altitude);
+    add_test_with_context(suite, geofence, every_subscriber_gets_every_event);
+    add_test_with_context(suite, geofence, clearing_or_replacing_a_zone_reports_exit);
+    add_test_with_context(suite, geofence, rejects_invalid_zones);
+    add_test_with_context(suite, geofence, matches_great_circle_check_along_an_orbit);
+
+    return suite;
+}
+
+int test_geofence() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, geofence_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
@@ -0,0 +1,142 @@
+/*
+ * test_task_stats.c
+ *
+ * Drives the task statistics with synthetic scheduler samples and kernel hook
+ * calls, checking CPU share, rolling windows, latency and the housekeeping summary.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "diagnostic/task_stats.h"
+#include "diagnostic/test_task_stats.h"
+
+#include "../source/diagnostic/task_stats.c"
+
+#define PERIOD_CYCLES 1000000
+
+static task_stats_input tasks[3];
+static uint32_t now;
+
+/* Advance one period, giving each task the given share of it in hundredths of a percent */
+static void run_period(uint32_t idle, uint32_t a, uint32_t b) {
+    now += PERIOD_CYCLES;
+    tasks[0].run_time += (uint32_t)((uint64_t)PERIOD_CYCLES * idle / 10000);
+    tasks[1].run_time += (uint32_t)((uint64_t)PERIOD_CYCLES * a / 10000);
+    tasks[2].run_time += (uint32_t)((uint64_t)PERIOD_CYCLES * b / 10000);
+    task_stats_update(tasks, 3, now);
+}
+
+static void find_entry(uint8_t number, task_stats_entry *entry) {
+    task_stats_entry entries[TASK_STATS_MAX_TASKS];
+    size_t count = task_stats_get(0, entries, TASK_STATS_MAX_TASKS);
+    size_t i;
+    memset(entry, 0, sizeof(*entry));
+    for (i = 0; i < count; i++) {
+        if (entries[i].number == number) {
+            memcpy(entry, &entries[i], sizeof(*entry));
+        }
+    }
+}
+
+Describe(task_stats);
+BeforeEach(task_stats) {
+    task_stats_reset();
+    memset(tasks, 0, sizeof(tasks));
+    tasks[0] = (task_stats_input){.number = 1, .name = "IDLE", .priority = 0, .stack_free = 100};
+    tasks[1] = (task_stats_input){.number = 2, .name = "housekeeping", .priority = 1, .stack_free = 40};
+    tasks[2] = (task_stats_input){.number = 7, .name = "logger", .priority = 2, .stack_free = 300};
+    now = 0xFFF00000; // wraps during the tests
+    task_stats_update(tasks, 3, now);
+};
+AfterEach(task_stats) {};
+
+Ensure(task_stats, first_sample_registers_tasks) {
+    task_stats_entry entry;
+    assert_that(task_stats_count(), is_equal_to(3));
+    find_entry(2, &entry);
+    assert_that(entry.name, is_equal_to_string("housekeeping"));
+    assert_that(entry.stack_free, is_equal_to(40));
+    assert_that(entry.cpu_avg, is_equal_to(0));
+}
+
+Ensure(task_stats, cpu_share_survives_counter_wrap) {
+    task_stats_entry entry;
+    run_period(7000, 2500, 500);
+    find_entry(2, &entry);
+    assert_that(entry.cpu_avg, is_equal_to(2500));
+    find_entry(7, &entry);
+    assert_that(entry.cpu_avg, is_equal_to(500));
+}
+
+Ensure(task_stats, rolling_window_drops_old_samples) {
+    task_stats_entry entry;
+    int i;
+    run_period(0, 9000, 1000); // falls out of the window below
+    for (i = 0; i < TASK_STATS_WINDOW; i++) {
+        run_period(10000 - 1000 - i * 100, 1000 + i * 100, 0);
+    }
+    find_entry(2, &entry);
+    assert_that(entry.cpu_min, is_equal_to(1000));
+    assert_that(entry.cpu_max, is_equal_to(1000 + (TASK_STATS_WINDOW - 1) * 100));
+    assert_that(entry.cpu_avg, is_equal_to(1000 + (TASK_STATS_WINDOW - 1) * 50));
+}
+
+Ensure(task_stats, latency_is_ready_to_running) {
+    task_stats_entry entry;
+    task_stats_ready(7, 1000);
+    task_stats_ready(7, 5000); // already waiting, ignored
+    task_stats_switched_in(7, 1000 + 30 * TASK_STATS_CYCLES_PER_US);
+    task_stats_switched_in(7, 90000); // preempted task resuming, not a wake up
+    task_stats_ready(7, 0xFFFFFF00);
+    task_stats_switched_in(7, 0xFFFFFF00 + 10 * TASK_STATS_CYCLES_PER_US);
+    run_period(8000, 1000, 1000);
+    find_entry(7, &entry);
+    assert_that(entry.latency_max_us, is_equal_to(30));
+    assert_that(entry.latency_avg_us, is_equal_to(20));
+}
+
+Ensure(task_stats, deleted_tasks_are_dropped) {
+    task_stats_entry entries[TASK_STATS_MAX_TASKS];
+    now += PERIOD_CYCLES;
+    task_stats_update(tasks, 2, now);
+    assert_that(task_stats_count(), is_equal_to(2));
+    assert_that(task_stats_get(1, entries, TASK_STATS_MAX_TASKS), is_equal_to(1));
+    assert_that(entries[0].number, is_equal_to(2));
+}
+
+Ensure(task_stats, housekeeping_summary) {
+    task_stats_hk hk;
+    task_stats_ready(2, 0);
+    task_stats_switched_in(2, 50 * TASK_STATS_CYCLES_PER_US);
+    run_period(6000, 1000, 3000);
+    task_stats_get_hk(&hk);
+    assert_that(hk.task_count, is_equal_to(3));
+    assert_that(hk.idle_cpu_avg, is_equal_to(6000));
+    assert_that(hk.busiest_task, is_equal_to(7));
+    assert_that(hk.busiest_cpu_avg, is_equal_to(3000));
+    assert_that(hk.min_stack_task, is_equal_to(2));
+    assert_that(hk.min_stack_free, is_equal_to(40));
+    assert_that(hk.worst_latency_task, is_equal_to(2));
+    assert_that(hk.worst_latency_us, is_equal_to(50));
+}
+
+TestSuite *task_stats_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, task_stats, first_sample_registers_tasks);
+    add_test_with_context(suite, task_stats, cpu_share_survives_counter_wrap);
+    add_test_with_context(suite, task_stats, rolling_window_drops_old_samples);
+    add_test_with_context(suite, task_stats, latency_is_ready_to_running);
+    add_test_with_context(suite, task_stats, deleted_tasks_are_dropped);
+    add_test_with_context(suite, task_stats, housekeeping_summary);
+
+    return suite;
+}
+
+int test_task_stats() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, task_stats_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
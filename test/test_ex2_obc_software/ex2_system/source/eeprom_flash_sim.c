@@ -0,0 +1,88 @@
+/*
+ * eeprom_flash_sim.c
+ *
+ * Host implementation of the eeprom_log flash backend.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "eeprom_log.h"
+#include "eeprom_flash_sim.h"
+
+static uint8_t flash[EEPROM_FLASH_SIM_SECTORS][EEPROM_FLASH_SIM_SECTOR_SIZE];
+static uint32_t erase_count[EEPROM_FLASH_SIM_SECTORS];
+static uint32_t program_count;
+static uint32_t overwrite_count;
+static bool power_cut;
+static uint32_t power_budget;
+
+void eeprom_flash_sim_reset() {
+    memset(flash, 0xFF, sizeof(flash));
+    memset(erase_count, 0, sizeof(erase_count));
+    program_count = 0;
+    overwrite_count = 0;
+    power_cut = false;
+}
+
+void eeprom_flash_sim_cut_power_after(uint32_t bytes) {
+    power_cut = true;
+    power_budget = bytes;
+}
+
+void eeprom_flash_sim_restore_power() { power_cut = false; }
+
+uint32_t eeprom_flash_sim_erase_count(uint8_t sector) { return erase_count[sector]; }
+
+uint32_t eeprom_flash_sim_program_count() { return program_count; }
+
+uint32_t eeprom_flash_sim_overwrite_count() { return overwrite_count; }
+
+uint8_t *eeprom_flash_sim_sector(uint8_t sector) { return flash[sector]; }
+
+Fapi_StatusType eeprom_flash_erase(uint8_t sector) {
+    if (sector >= EEPROM_FLASH_SIM_SECTORS) {
+        return Fapi_Error_InvalidAddress;
+    }
+    if (power_cut) {
+        return Fapi_Error_Fail;
+    }
+    memset(flash[sector], 0xFF, EEPROM_FLASH_SIM_SECTOR_SIZE);
+    erase_count[sector]++;
+    return Fapi_Status_Success;
+}
+
+Fapi_StatusType eeprom_flash_program(uint8_t sector, uint32_t offset, const void *data, uint32_t size) {
+    const uint8_t *src = (const uint8_t *)data;
+    uint32_t i;
+    bool overwrite = false;
+
+    if (sector >= EEPROM_FLASH_SIM_SECTORS || offset + size > EEPROM_FLASH_SIM_SECTOR_SIZE) {
+        return Fapi_Error_InvalidAddress;
+    }
+    program_count++;
+    for (i = 0; i < size; i++) {
+        if (power_cut) {
+            if (power_budget == 0) {
+                return Fapi_Error_Fail;
+            }
+            power_budget--;
+        }
+        if (flash[sector][offset + i] != 0xFF) {
+            overwrite = true;
+        }
+        flash[sector][offset + i] &= src[i];
+    }
+    if (overwrite) {
+        overwrite_count++;
+    }
+    return Fapi_Status_Success;
+}
+
+Fapi_StatusType eeprom_flash_read(uint8_t sector, uint32_t offset, void *data, uint32_t size) {
+    if (sector >= EEPROM_FLASH_SIM_SECTORS || offset + size > EEPROM_FLASH_SIM_SECTOR_SIZE) {
+        return Fapi_Error_InvalidAddress;
+    }
+    memcpy(data, &flash[sector][offset], size);
+    return Fapi_Status_Success;
+}
@@ -0,0 +1,165 @@
+/*
+ * image_flash_sim.c
+ *
+ * Host implementation of the image_update flash backend and EEPROM records.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "bl_eeprom.h"
+#include "crc16.h"
+#include "eeprom.h"
+#include "image_update.h"
+#include "image_flash_sim.h"
+
+#define IMAGE_FLASH_SIM_SIZE (IMAGE_FLASH_SIM_SECTORS * IMAGE_FLASH_SIM_SECTOR_SIZE)
+
+static uint8_t flash[IMAGE_FLASH_SIM_SIZE];
+static uint8_t golden[IMAGE_FLASH_SIM_SIZE];
+static uint32_t erase_count[IMAGE_FLASH_SIM_SECTORS];
+static uint32_t overwrite_count;
+static uint32_t update_info_writes;
+static bool power_cut;
+static uint32_t power_budget;
+static update_info update_record;
+static image_info app_record;
+static image_info golden_record;
+
+void image_flash_sim_reset() {
+    memset(flash, 0xFF, sizeof(flash));
+    memset(golden, 0xFF, sizeof(golden));
+    memset(erase_count, 0, sizeof(erase_count));
+    memset(&update_record, 0, sizeof(update_record));
+    memset(&app_record, 0, sizeof(app_record));
+    memset(&golden_record, 0, sizeof(golden_record));
+    overwrite_count = 0;
+    update_info_writes = 0;
+    power_cut = false;
+}
+
+void image_flash_sim_cut_power_after(uint32_t bytes) {
+    power_cut = true;
+    power_budget = bytes;
+}
+
+void image_flash_sim_restore_power() { power_cut = false; }
+
+uint32_t image_flash_sim_erase_count(uint8_t sector) { return erase_count[sector]; }
+
+uint32_t image_flash_sim_overwrite_count() { return overwrite_count; }
+
+uint32_t image_flash_sim_update_info_writes() { return update_info_writes; }
+
+uint8_t *image_flash_sim_slot() { return flash; }
+
+void image_flash_sim_set_golden(const uint8_t *image, uint32_t len) {
+    memcpy(golden, image, len);
+    golden_record.exists = EXISTS_FLAG;
+    golden_record.size = len;
+    golden_record.addr = IMAGE_FLASH_SIM_GOLDEN_BASE;
+    golden_record.crc = crc16_checksum(image, len);
+}
+
+uint8_t *image_flash_sim_golden() { return golden; }
+
+static bool in_slot(uint32_t address, uint32_t size) {
+    return address >= IMAGE_FLASH_SIM_BASE && address - IMAGE_FLASH_SIM_BASE <= IMAGE_FLASH_SIM_SIZE &&
+           size <= IMAGE_FLASH_SIM_SIZE - (address - IMAGE_FLASH_SIM_BASE);
+}
+
+bool image_flash_sector(uint32_t address, uint32_t *start, uint32_t *length) {
+    if (!in_slot(address, 1)) {
+        return false;
+    }
+    *start = address - (address - IMAGE_FLASH_SIM_BASE) % IMAGE_FLASH_SIM_SECTOR_SIZE;
+    *length = IMAGE_FLASH_SIM_SECTOR_SIZE;
+    return true;
+}
+
+Fapi_StatusType image_flash_erase(uint32_t start, uint32_t length) {
+    uint32_t offset = start - IMAGE_FLASH_SIM_BASE;
+    if (!in_slot(start, length) || offset % IMAGE_FLASH_SIM_SECTOR_SIZE != 0 ||
+        length % IMAGE_FLASH_SIM_SECTOR_SIZE != 0) {
+        return Fapi_Error_InvalidAddress;
+    }
+    if (power_cut && power_budget == 0) {
+        return Fapi_Error_Fail;
+    }
+    memset(&flash[offset], 0xFF, length);
+    for (; length > 0; length -= IMAGE_FLASH_SIM_SECTOR_SIZE, offset += IMAGE_FLASH_SIM_SECTOR_SIZE) {
+        erase_count[offset / IMAGE_FLASH_SIM_SECTOR_SIZE]++;
+    }
+    return Fapi_Status_Success;
+}
+
+Fapi_StatusType image_flash_program(uint32_t address, const void *data, uint32_t size) {
+    const uint8_t *src = (const uint8_t *)data;
+    uint32_t offset = address - IMAGE_FLASH_SIM_BASE;
+    uint32_t i;
+    bool overwrite = false;
+
+    if (!in_slot(address, size)) {
+        return Fapi_Error_InvalidAddress;
+    }
+    for (i = 0; i < size; i++) {
+        if (power_cut) {
+            if (power_budget == 0) {
+                return Fapi_Error_Fail;
+            }
+            power_budget--;
+        }
+        if (flash[offset + i] != 0xFF) {
+            overwrite = true;
+        }
+        flash[offset + i] &= src[i];
+    }
+    if (overwrite) {
+        overwrite_count++;
+    }
+    return Fapi_Status_Success;
+}
+
+static bool in_golden(uint32_t address, uint32_t size) {
+    return address >= IMAGE_FLASH_SIM_GOLDEN_BASE &&
+           address - IMAGE_FLASH_SIM_GOLDEN_BASE <= IMAGE_FLASH_SIM_SIZE &&
+           size <= IMAGE_FLASH_SIM_SIZE - (address - IMAGE_FLASH_SIM_GOLDEN_BASE);
+}
+
+Fapi_StatusType image_flash_read(uint32_t address, void *data, uint32_t size) {
+    if (in_golden(address, size)) {
+        memcpy(data, &golden[address - IMAGE_FLASH_SIM_GOLDEN_BASE], size);
+        return Fapi_Status_Success;
+    }
+    if (!in_slot(address, size)) {
+        return Fapi_Error_InvalidAddress;
+    }
+    memcpy(data, &flash[address - IMAGE_FLASH_SIM_BASE], size);
+    return Fapi_Status_Success;
+}
+
+Fapi_StatusType eeprom_set_update_info(update_info *u) {
+    update_record = *u;
+    update_info_writes++;
+    return Fapi_Status_Success;
+}
+
+Fapi_StatusType eeprom_get_update_info(update_info *u) {
+    *u = update_record;
+    return Fapi_Status_Success;
+}
+
+Fapi_StatusType eeprom_set_app_info(image_info *i) {
+    app_record = *i;
+    return Fapi_Status_Success;
+}
+
+Fapi_StatusType eeprom_get_app_info(image_info *i) {
+    *i = app_record;
+    return Fapi_Status_Success;
+}
+
+Fapi_StatusType eeprom_get_golden_info(image_info *i) {
+    *i = golden_record;
+    return Fapi_Status_Success;
+}
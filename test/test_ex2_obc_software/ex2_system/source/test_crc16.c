@@ -0,0 +1,77 @@
+/*
+ * test_crc16.c
+ *
+ * Cross-checks the CRC-16/XMODEM implementations against each other.
+ * Throughput is measured by test/bench/crc16_bench.c.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "crc16.h"
+#include "test_crc16.h"
+
+#include "../source/crc16.c"
+
+#define CRC16_TEST_BUF_LEN 4352 // covers every offset and length below
+
+static uint8_t *buf;
+
+Describe(crc16);
+BeforeEach(crc16) {
+    uint32_t i;
+    buf = malloc(CRC16_TEST_BUF_LEN);
+    srand(0x1021);
+    for (i = 0; i < CRC16_TEST_BUF_LEN; i++) {
+        buf[i] = (uint8_t)rand();
+    }
+};
+AfterEach(crc16) { free(buf); };
+
+Ensure(crc16, check_value_matches_xmodem) {
+    const char *check = "123456789";
+    assert_that(crc16_bitwise(CRC16_INIT, check, 9), is_equal_to(0x31C3));
+    assert_that(crc16_slice8(CRC16_INIT, check, 9), is_equal_to(0x31C3));
+    assert_that(crc16_checksum(check, 9), is_equal_to(0x31C3));
+}
+
+Ensure(crc16, empty_buffer_returns_init) {
+    assert_that(crc16_bitwise(CRC16_INIT, buf, 0), is_equal_to(CRC16_INIT));
+    assert_that(crc16_slice8(CRC16_INIT, buf, 0), is_equal_to(CRC16_INIT));
+}
+
+Ensure(crc16, slice8_matches_bitwise_for_all_offsets_and_lengths) {
+    uint32_t offset, length;
+    for (offset = 0; offset < 8; offset++) {
+        for (length = 0; length < 256; length++) {
+            assert_that(crc16_slice8(CRC16_INIT, buf + offset, length),
+                        is_equal_to(crc16_bitwise(CRC16_INIT, buf + offset, length)));
+        }
+    }
+}
+
+Ensure(crc16, chained_updates_match_single_pass) {
+    uint16_t whole = crc16_bitwise(CRC16_INIT, buf, 4099);
+    uint16_t crc = crc16_update(CRC16_SLICE8, CRC16_INIT, buf, 13);
+    crc = crc16_update(CRC16_BITWISE, crc, buf + 13, 1000);
+    crc = crc16_update(CRC16_SLICE8, crc, buf + 1013, 4099 - 1013);
+    assert_that(crc, is_equal_to(whole));
+}
+
+TestSuite *crc16_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, crc16, check_value_matches_xmodem);
+    add_test_with_context(suite, crc16, empty_buffer_returns_init);
+    add_test_with_context(suite, crc16, slice8_matches_bitwise_for_all_offsets_and_lengths);
+    add_test_with_context(suite, crc16, chained_updates_match_single_pass);
+
+    return suite;
+}
+
+int test_crc16() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, crc16_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
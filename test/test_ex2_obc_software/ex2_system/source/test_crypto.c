@@ -0,0 +1,238 @@
+/*
+ * test_crypto.c
+ *
+ * Known answer tests for SHA-1, HMAC-SHA1 and XTEA. Packets/s with and without
+ * contexts built once per key are measured by test/bench/crypto_bench.c.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crypto.h"
+#include "sha1.h"
+#include "test_crypto.h"
+
+#include "../source/crypto.c"
+#include "../source/sha1.c"
+
+#define CRYPTO_TEST_PACKET_LEN 256 // an FTP data packet
+
+// crypto.c keeps the key store in the EEPROM
+static key_store stored_keys;
+
+Fapi_StatusType eeprom_get_key_store(key_store *k) {
+    *k = stored_keys;
+    return Fapi_Status_Success;
+}
+
+Fapi_StatusType eeprom_set_key_store(key_store *k) {
+    stored_keys = *k;
+    return Fapi_Status_Success;
+}
+
+static void from_hex(const char *hex, uint8_t *out) {
+    while (*hex) {
+        unsigned int byte;
+        sscanf(hex, "%2x", &byte);
+        *out++ = (uint8_t)byte;
+        hex += 2;
+    }
+}
+
+static void assert_digest(const uint8_t *digest, const char *hex) {
+    uint8_t expected[SHA1_DIGEST_LEN];
+    from_hex(hex, expected);
+    assert_that(digest, is_equal_to_contents_of(expected, SHA1_DIGEST_LEN));
+}
+
+static void assert_hmac(const uint8_t *key, uint32_t key_len, const char *data, const char *hex) {
+    crypto_hmac_ctx ctx;
+    uint8_t mac[CRYPTO_HMAC_LEN];
+    crypto_hmac_init(&ctx, key, key_len);
+    crypto_hmac(&ctx, data, strlen(data), mac);
+    assert_digest(mac, hex);
+}
+
+/* The generic path: the key loaded and the key word picked from the sum every
+ * round, on byte buffers */
+static void xtea_reference(const uint8_t key[CRYPTO_XTEA_KEY_LEN], uint8_t block[CRYPTO_XTEA_BLOCK_LEN]) {
+    uint32_t k[4], v0, v1, sum = 0;
+    int i;
+    for (i = 0; i < 4; i++) {
+        k[i] = ((uint32_t)key[4 * i] << 24) | ((uint32_t)key[4 * i + 1] << 16) | ((uint32_t)key[4 * i + 2] << 8) |
+               key[4 * i + 3];
+    }
+    v0 = ((uint32_t)block[0] << 24) | ((uint32_t)block[1] << 16) | ((uint32_t)block[2] << 8) | block[3];
+    v1 = ((uint32_t)block[4] << 24) | ((uint32_t)block[5] << 16) | ((uint32_t)block[6] << 8) | block[7];
+    for (i = 0; i < CRYPTO_XTEA_CYCLES; i++) {
+        v0 += (((v1 << 4) ^ (v1 >> 5)) + v1) ^ (sum + k[sum & 3]);
+        sum += XTEA_DELTA;
+        v1 += (((v0 << 4) ^ (v0 >> 5)) + v0) ^ (sum + k[(sum >> 11) & 3]);
+    }
+    for (i = 0; i < 4; i++) {
+        block[i] = (uint8_t)(v0 >> (24 - 8 * i));
+        block[4 + i] = (uint8_t)(v1 >> (24 - 8 * i));
+    }
+}
+
+/* csp_xtea_encrypt from libcsp 1.6 (src/crypto/csp_xtea.c), which the ground station
+ * decrypts with, on top of the generic block. The counter is incremented after it is
+ * copied, so the second block reuses the first block's stream */
+static void csp_xtea_encrypt_reference(const uint8_t *key, uint8_t *plain, const uint32_t len, uint32_t iv[2]) {
+    uint32_t i, j, remain;
+    uint32_t blocks = (len + CRYPTO_XTEA_BLOCK_LEN - 1) / CRYPTO_XTEA_BLOCK_LEN;
+    uint8_t stream[CRYPTO_XTEA_BLOCK_LEN];
+    uint32_t words[2] = {iv[0], iv[1]};
+
+    for (i = 0; i < blocks; i++) {
+        for (j = 0; j < 4; j++) {
+            stream[j] = (uint8_t)(words[0] >> (24 - 8 * j));
+            stream[4 + j] = (uint8_t)(words[1] >> (24 - 8 * j));
+        }
+        xtea_reference(key, stream);
+        remain = len - i * CRYPTO_XTEA_BLOCK_LEN;
+        for (j = 0; j < (remain < CRYPTO_XTEA_BLOCK_LEN ? remain : CRYPTO_XTEA_BLOCK_LEN); j++) {
+            plain[len - remain + j] ^= stream[j];
+        }
+        words[0] = iv[0];
+        words[1] = iv[1]++;
+    }
+}
+
+Describe(crypto);
+BeforeEach(crypto) {
+    memset(&stored_keys, 0, sizeof(stored_keys));
+    srand(0x5C36);
+};
+AfterEach(crypto){};
+
+Ensure(crypto, sha1_known_answers) {
+    uint8_t digest[SHA1_DIGEST_LEN];
+    const char *two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    sha1("", 0, digest);
+    assert_digest(digest, "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    sha1("abc", 3, digest);
+    assert_digest(digest, "a9993e364706816aba3e25717850c26c9cd0d89d");
+    sha1(two_blocks, strlen(two_blocks), digest);
+    assert_digest(digest, "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+}
+
+Ensure(crypto, sha1_in_pieces_matches_one_pass) {
+    uint8_t data[300], whole[SHA1_DIGEST_LEN], parts[SHA1_DIGEST_LEN];
+    uint32_t split, i;
+    sha1_state state;
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)rand();
+    }
+    sha1(data, sizeof(data), whole);
+    for (split = 0; split <= sizeof(data); split += 7) {
+        sha1_init(&state);
+        sha1_update(&state, data, split);
+        sha1_update(&state, &data[split], sizeof(data) - split);
+        sha1_final(&state, parts);
+        assert_that(parts, is_equal_to_contents_of(whole, SHA1_DIGEST_LEN));
+    }
+}
+
+// RFC 2202 test cases 1, 2, 6 and 7
+Ensure(crypto, hmac_known_answers) {
+    uint8_t key[80];
+    memset(key, 0x0B, 20);
+    assert_hmac(key, 20, "Hi There", "b617318655057264e28bc0b6fb378c8ef146be00");
+    assert_hmac((const uint8_t *)"Jefe", 4, "what do ya want for nothing?",
+                "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79");
+    memset(key, 0xAA, 80);
+    assert_hmac(key, 80, "Test Using Larger Than Block-Size Key - Hash Key First",
+                "aa4ae5e15272d00e95705637ce8a3b55ed402112");
+    assert_hmac(key, 80, "Test Using Larger Than Block-Size Key and Larger Than One Block-Size Data",
+                "e8e99d0f45237d786d6bbaa7965c7808bbff1a91");
+}
+
+Ensure(crypto, hmac_over_header_and_data) {
+    crypto_hmac_ctx ctx;
+    uint8_t packet[4 + 100], whole[CRYPTO_HMAC_LEN], parts[CRYPTO_HMAC_LEN];
+    sha1_state state;
+    uint32_t i;
+    for (i = 0; i < sizeof(packet); i++) {
+        packet[i] = (uint8_t)rand();
+    }
+    crypto_hmac_init(&ctx, (const uint8_t *)"key", 3);
+    crypto_hmac(&ctx, packet, sizeof(packet), whole);
+    crypto_hmac_begin(&ctx, &state);
+    sha1_update(&state, packet, 4);
+    sha1_update(&state, &packet[4], sizeof(packet) - 4);
+    crypto_hmac_end(&ctx, &state, parts);
+    assert_that(parts, is_equal_to_contents_of(whole, CRYPTO_HMAC_LEN));
+}
+
+Ensure(crypto, xtea_known_answers) {
+    crypto_xtea_ctx ctx;
+    uint8_t key[CRYPTO_XTEA_KEY_LEN];
+    uint32_t v[2] = {0x41424344, 0x45464748};
+    uint32_t zero[2] = {0, 0};
+
+    from_hex("000102030405060708090a0b0c0d0e0f", key);
+    crypto_xtea_init(&ctx, key, sizeof(key));
+    crypto_xtea_encrypt_block(&ctx, v);
+    assert_that(v[0], is_equal_to(0x497DF3D0));
+    assert_that(v[1], is_equal_to(0x72612CB5));
+    crypto_xtea_decrypt_block(&ctx, v);
+    assert_that(v[0], is_equal_to(0x41424344));
+    assert_that(v[1], is_equal_to(0x45464748));
+
+    memset(key, 0, sizeof(key));
+    crypto_xtea_init(&ctx, key, sizeof(key));
+    crypto_xtea_encrypt_block(&ctx, zero);
+    assert_that(zero[0], is_equal_to(0xDEE9D4D8));
+    assert_that(zero[1], is_equal_to(0xF7131ED9));
+}
+
+Ensure(crypto, xtea_csp_matches_libcsp) {
+    crypto_xtea_ctx ctx;
+    uint8_t key[CRYPTO_XTEA_KEY_LEN], data[CRYPTO_TEST_PACKET_LEN + 5], copy[sizeof(data)], plain[sizeof(data)];
+    uint8_t zero[3 * CRYPTO_XTEA_BLOCK_LEN] = {0};
+    uint32_t nonce[2] = {0x12345678, 0xFFFFFFFE}, iv[2], i; // the counter wraps
+    for (i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t)rand();
+    }
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)rand();
+    }
+    memcpy(copy, data, sizeof(data));
+    memcpy(plain, data, sizeof(data));
+
+    crypto_xtea_init(&ctx, key, sizeof(key));
+    crypto_xtea_csp(&ctx, data, sizeof(data), nonce);
+    memcpy(iv, nonce, sizeof(iv));
+    csp_xtea_encrypt_reference(key, copy, sizeof(copy), iv);
+    assert_that(data, is_equal_to_contents_of(copy, sizeof(data)));
+    crypto_xtea_csp(&ctx, data, sizeof(data), nonce);
+    assert_that(data, is_equal_to_contents_of(plain, sizeof(data)));
+
+    // The stream libcsp makes: blocks 0 and 1 alike, block 2 from the next counter
+    crypto_xtea_csp(&ctx, zero, sizeof(zero), nonce);
+    assert_that(&zero[CRYPTO_XTEA_BLOCK_LEN], is_equal_to_contents_of(zero, CRYPTO_XTEA_BLOCK_LEN));
+    assert_that(memcmp(&zero[2 * CRYPTO_XTEA_BLOCK_LEN], zero, CRYPTO_XTEA_BLOCK_LEN), is_not_equal_to(0));
+}
+
+TestSuite *crypto_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, crypto, sha1_known_answers);
+    add_test_with_context(suite, crypto, sha1_in_pieces_matches_one_pass);
+    add_test_with_context(suite, crypto, hmac_known_answers);
+    add_test_with_context(suite, crypto, hmac_over_header_and_data);
+    add_test_with_context(suite, crypto, xtea_known_answers);
+    add_test_with_context(suite, crypto, xtea_csp_matches_libcsp);
+
+    return suite;
+}
+
+int test_crypto() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, crypto_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
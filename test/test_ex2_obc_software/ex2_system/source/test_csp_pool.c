@@ -0,0 +1,219 @@
+/*
+ * test_csp_pool.c
+ *
+ * Size class selection, statistics and reference counting of the CSP buffer
+ * pool. test/bench/csp_pool_bench.c runs file transfer and housekeeping traffic
+ * through it against a single 1 KiB class and against size classes.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "csp_pool.h"
+#include "test_csp_pool.h"
+
+#include "../source/csp_pool.c"
+
+#define TEST_OVERHEAD 16
+
+static uint64_t memory[4096];
+
+static const csp_pool_class_config three_classes[] = {{64, 4}, {256, 2}, {1024, 2}};
+
+Describe(csp_pool);
+BeforeEach(csp_pool) {
+    assert_that(csp_pool_memory_size(three_classes, 3, TEST_OVERHEAD) <= sizeof(memory), is_true);
+    assert_that(csp_pool_init(three_classes, 3, TEST_OVERHEAD, memory), is_true);
+};
+AfterEach(csp_pool){};
+
+Ensure(csp_pool, rejects_bad_classes) {
+    const csp_pool_class_config unsorted[] = {{256, 2}, {64, 2}};
+    const csp_pool_class_config empty[] = {{64, 0}};
+    assert_that(csp_pool_init(unsorted, 2, TEST_OVERHEAD, memory), is_false);
+    assert_that(csp_pool_init(empty, 1, TEST_OVERHEAD, memory), is_false);
+    assert_that(csp_pool_init(three_classes, 0, TEST_OVERHEAD, memory), is_false);
+}
+
+Ensure(csp_pool, request_goes_to_smallest_class_that_fits) {
+    void *a = csp_pool_get(1, "t", 0);
+    void *b = csp_pool_get(64, "t", 0);
+    void *c = csp_pool_get(65, "t", 0);
+    void *d = csp_pool_get(1024, "t", 0);
+
+    assert_that(csp_pool_capacity(a), is_equal_to(64));
+    assert_that(csp_pool_capacity(b), is_equal_to(64));
+    assert_that(csp_pool_capacity(c), is_equal_to(256));
+    assert_that(csp_pool_capacity(d), is_equal_to(1024));
+    assert_that(csp_pool_max_size(), is_equal_to(1024));
+    assert_that(((uintptr_t)a - (uintptr_t)memory) % CSP_POOL_ALIGN, is_equal_to(0));
+    assert_that(((uintptr_t)c - (uintptr_t)memory) % CSP_POOL_ALIGN, is_equal_to(0));
+}
+
+Ensure(csp_pool, buffers_do_not_overlap) {
+    uint8_t *bufs[8];
+    int i;
+    for (i = 0; i < 8; i++) {
+        bufs[i] = csp_pool_get(i < 4 ? 64 : (i < 6 ? 256 : 1024), "t", 0);
+        assert_that(bufs[i], is_not_null);
+        // the packet header is inside the buffer, in front of the data
+        memset(bufs[i], i, TEST_OVERHEAD + csp_pool_capacity(bufs[i]));
+    }
+    for (i = 0; i < 8; i++) {
+        assert_that(bufs[i][0], is_equal_to(i));
+        assert_that(bufs[i][TEST_OVERHEAD + csp_pool_capacity(bufs[i]) - 1], is_equal_to(i));
+        assert_that(csp_pool_free(bufs[i], 0), is_true);
+    }
+    assert_that(csp_pool_remaining(), is_equal_to(8));
+}
+
+Ensure(csp_pool, empty_class_falls_back_to_larger) {
+    csp_pool_class_stats stats[3];
+    int i;
+    for (i = 0; i < 4; i++) {
+        csp_pool_get(10, "t", 0);
+    }
+    void *fallback = csp_pool_get(10, "t", 0);
+    assert_that(csp_pool_capacity(fallback), is_equal_to(256));
+
+    csp_pool_get_stats(stats, 3, 0);
+    assert_that(stats[0].fallbacks, is_equal_to(1));
+    assert_that(stats[0].allocs, is_equal_to(4));
+    assert_that(stats[1].allocs, is_equal_to(1));
+    assert_that(stats[0].failures, is_equal_to(0));
+}
+
+Ensure(csp_pool, failures_are_counted_by_class_and_caller) {
+    csp_pool_class_stats stats[3];
+    csp_pool_caller_stats callers[CSP_POOL_MAX_CALLERS];
+    int i;
+
+    csp_pool_get(1024, "ftp", 0);
+    csp_pool_get(1024, "ftp", 0);
+    assert_that(csp_pool_get(1000, "ftp", 0), is_null);
+    assert_that(csp_pool_get(1000, "ftp", 0), is_null);
+    assert_that(csp_pool_get(1000, NULL, 0), is_null);
+    // small requests still have their own class
+    assert_that(csp_pool_get(20, "hk", 0), is_not_null);
+
+    csp_pool_get_stats(stats, 3, 0);
+    assert_that(stats[2].failures, is_equal_to(3));
+    assert_that(stats[0].failures, is_equal_to(0));
+
+    assert_that(csp_pool_get_callers(callers, CSP_POOL_MAX_CALLERS), is_equal_to(2));
+    assert_that(callers[0].name, is_equal_to_string("ftp"));
+    assert_that(callers[0].failures, is_equal_to(2));
+    assert_that(callers[1].name, is_equal_to_string("ISR"));
+    assert_that(callers[1].failures, is_equal_to(1));
+
+    for (i = 0; i < 12; i++) {
+        char name[8];
+        snprintf(name, sizeof(name), "task%d", i);
+        csp_pool_get(1024, name, 0);
+    }
+    assert_that(csp_pool_get_callers(callers, CSP_POOL_MAX_CALLERS), is_equal_to(CSP_POOL_MAX_CALLERS));
+    assert_that(callers[CSP_POOL_MAX_CALLERS - 1].name, is_equal_to_string("other"));
+    assert_that(callers[CSP_POOL_MAX_CALLERS - 1].failures, is_equal_to(12 - (CSP_POOL_MAX_CALLERS - 3)));
+}
+
+Ensure(csp_pool, oversize_request_fails_without_touching_classes) {
+    csp_pool_class_stats stats[3];
+    csp_pool_caller_stats callers[CSP_POOL_MAX_CALLERS];
+
+    assert_that(csp_pool_get(1025, "big", 0), is_null);
+    assert_that(csp_pool_remaining(), is_equal_to(8));
+    csp_pool_get_stats(stats, 3, 0);
+    assert_that(stats[2].failures, is_equal_to(0));
+    assert_that(csp_pool_get_callers(callers, CSP_POOL_MAX_CALLERS), is_equal_to(1));
+}
+
+Ensure(csp_pool, high_water_and_remaining) {
+    csp_pool_class_stats stats[3];
+    void *a = csp_pool_get(64, "t", 0);
+    void *b = csp_pool_get(64, "t", 0);
+    void *c = csp_pool_get(64, "t", 0);
+
+    assert_that(csp_pool_remaining(), is_equal_to(5));
+    csp_pool_free(a, 0);
+    csp_pool_free(b, 0);
+    csp_pool_get_stats(stats, 3, 0);
+    assert_that(stats[0].free, is_equal_to(3));
+    assert_that(stats[0].high_water, is_equal_to(3));
+
+    csp_pool_reset_stats();
+    csp_pool_get_stats(stats, 3, 0);
+    assert_that(stats[0].high_water, is_equal_to(1));
+    assert_that(stats[0].allocs, is_equal_to(0));
+    csp_pool_free(c, 0);
+}
+
+Ensure(csp_pool, hold_times_and_oldest_buffer) {
+    csp_pool_class_stats stats[3];
+    void *a = csp_pool_get(64, "t", 1000);
+    void *b = csp_pool_get(64, "t", 1100);
+    void *c = csp_pool_get(64, "t", 1200);
+
+    csp_pool_free(a, 1010); // 10
+    csp_pool_free(b, 1400); // 300
+    csp_pool_get_stats(stats, 3, 2000);
+    assert_that(stats[0].hold_avg_ms, is_equal_to(155));
+    assert_that(stats[0].hold_max_ms, is_equal_to(300));
+    assert_that(stats[0].oldest_ms, is_equal_to(800));
+    assert_that(stats[1].oldest_ms, is_equal_to(0));
+
+    csp_pool_free(c, 2000);
+    csp_pool_get_stats(stats, 3, 2500);
+    assert_that(stats[0].oldest_ms, is_equal_to(0));
+    assert_that(stats[0].hold_max_ms, is_equal_to(800));
+}
+
+Ensure(csp_pool, hold_time_survives_tick_wrap) {
+    csp_pool_class_stats stats[3];
+    void *a = csp_pool_get(64, "t", UINT32_MAX - 9);
+    csp_pool_free(a, 10);
+    csp_pool_get_stats(stats, 3, 10);
+    assert_that(stats[0].hold_max_ms, is_equal_to(20));
+}
+
+Ensure(csp_pool, references_and_bad_frees) {
+    uint8_t outside[32];
+    uint8_t *a = csp_pool_get(64, "t", 0);
+
+    assert_that(csp_pool_ref(a), is_true);
+    assert_that(csp_pool_free(a, 0), is_true);
+    assert_that(csp_pool_remaining(), is_equal_to(7));
+    assert_that(csp_pool_free(a, 0), is_true);
+    assert_that(csp_pool_remaining(), is_equal_to(8));
+
+    assert_that(csp_pool_free(a, 0), is_false);
+    assert_that(csp_pool_ref(a), is_false);
+    assert_that(csp_pool_free(a + 4, 0), is_false);
+    assert_that(csp_pool_free(outside + 16, 0), is_false);
+    assert_that(csp_pool_capacity(outside + 16), is_equal_to(0));
+    assert_that(csp_pool_remaining(), is_equal_to(8));
+}
+
+TestSuite *csp_pool_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, csp_pool, rejects_bad_classes);
+    add_test_with_context(suite, csp_pool, request_goes_to_smallest_class_that_fits);
+    add_test_with_context(suite, csp_pool, buffers_do_not_overlap);
+    add_test_with_context(suite, csp_pool, empty_class_falls_back_to_larger);
+    add_test_with_context(suite, csp_pool, failures_are_counted_by_class_and_caller);
+    add_test_with_context(suite, csp_pool, oversize_request_fails_without_touching_classes);
+    add_test_with_context(suite, csp_pool, high_water_and_remaining);
+    add_test_with_context(suite, csp_pool, hold_times_and_oldest_buffer);
+    add_test_with_context(suite, csp_pool, hold_time_survives_tick_wrap);
+    add_test_with_context(suite, csp_pool, references_and_bad_frees);
+
+    return suite;
+}
+
+int test_csp_pool() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, csp_pool_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
@@ -0,0 +1,201 @@
+/*
+ * test_eeprom_log.c
+ *
+ * Exercises the EEPROM record log against the RAM flash model in
+ * eeprom_flash_sim.c, including resets in the middle of writes.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "eeprom_log.h"
+#include "eeprom_flash_sim.h"
+#include "test_eeprom_log.h"
+
+#include "../source/eeprom_log.c"
+
+#define TEST_RECORDS 6
+#define TEST_RECORD_LEN 136 // sizeof(key_store), the largest record in use
+
+static uint8_t expected[TEST_RECORDS][TEST_RECORD_LEN];
+
+static void fill(uint8_t *buf, uint32_t seed) {
+    uint32_t i;
+    for (i = 0; i < TEST_RECORD_LEN; i++) {
+        buf[i] = (uint8_t)(seed * 31 + i * 7);
+    }
+}
+
+static void assert_record(uint8_t id, const uint8_t *data) {
+    uint8_t buf[TEST_RECORD_LEN];
+    assert_that(eeprom_log_read(id, buf, sizeof(buf)), is_equal_to(Fapi_Status_Success));
+    assert_that(buf, is_equal_to_contents_of(data, sizeof(buf)));
+}
+
+Describe(eeprom_log);
+BeforeEach(eeprom_log) {
+    eeprom_flash_sim_reset();
+    memset(&elog, 0, sizeof(elog));
+    srand(0xEE);
+};
+AfterEach(eeprom_log){};
+
+Ensure(eeprom_log, mount_formats_blank_flash) {
+    assert_that(eeprom_log_mount(), is_equal_to(Fapi_Status_Success));
+    assert_that(eeprom_flash_sim_erase_count(EEPROM_LOG_FIRST_SECTOR), is_equal_to(0));
+    uint32_t magic = *(uint32_t *)eeprom_flash_sim_sector(EEPROM_LOG_FIRST_SECTOR);
+    assert_that(magic, is_equal_to(EEPROM_LOG_SECTOR_MAGIC));
+}
+
+Ensure(eeprom_log, read_of_unwritten_record_fails) {
+    uint8_t buf[8];
+    assert_that(eeprom_log_read(2, buf, sizeof(buf)), is_equal_to(Fapi_Error_Fail));
+}
+
+Ensure(eeprom_log, rejects_bad_id_and_size) {
+    uint8_t buf[EEPROM_LOG_MAX_DATA_LEN + 1] = {0};
+    assert_that(eeprom_log_write(EEPROM_LOG_MAX_RECORDS, buf, 4), is_equal_to(Fapi_Error_InvalidAddress));
+    assert_that(eeprom_log_write(0, buf, sizeof(buf)), is_equal_to(Fapi_Error_AsyncIncorrectDataBufferLength));
+}
+
+Ensure(eeprom_log, latest_version_survives_remount) {
+    uint8_t id;
+    uint32_t version;
+    for (version = 0; version < 5; version++) {
+        for (id = 0; id < TEST_RECORDS; id++) {
+            fill(expected[id], version * TEST_RECORDS + id);
+            assert_that(eeprom_log_write(id, expected[id], TEST_RECORD_LEN), is_equal_to(Fapi_Status_Success));
+        }
+    }
+    assert_that(eeprom_log_mount(), is_equal_to(Fapi_Status_Success));
+    for (id = 0; id < TEST_RECORDS; id++) {
+        assert_record(id, expected[id]);
+    }
+}
+
+Ensure(eeprom_log, short_record_is_zero_padded_on_read) {
+    uint8_t data[4] = {1, 2, 3, 4};
+    uint8_t buf[8];
+    uint8_t want[8] = {1, 2, 3, 4, 0, 0, 0, 0};
+    eeprom_log_write(1, data, sizeof(data));
+    assert_that(eeprom_log_read(1, buf, sizeof(buf)), is_equal_to(Fapi_Status_Success));
+    assert_that(buf, is_equal_to_contents_of(want, sizeof(want)));
+}
+
+Ensure(eeprom_log, unchanged_write_does_not_program) {
+    eeprom_log_stats_t stats;
+    fill(expected[0], 1);
+    eeprom_log_write(0, expected[0], TEST_RECORD_LEN);
+    uint32_t programs = eeprom_flash_sim_program_count();
+    assert_that(eeprom_log_write(0, expected[0], TEST_RECORD_LEN), is_equal_to(Fapi_Status_Success));
+    assert_that(eeprom_flash_sim_program_count(), is_equal_to(programs));
+    eeprom_log_get_stats(&stats);
+    assert_that(stats.skipped_writes, is_equal_to(1));
+}
+
+Ensure(eeprom_log, writes_are_single_programs_and_erases_are_rare) {
+    uint32_t i, erases = 0;
+    uint8_t s;
+    for (i = 0; i < 2000; i++) {
+        uint8_t id = i % TEST_RECORDS;
+        fill(expected[id], i);
+        assert_that(eeprom_log_write(id, expected[id], TEST_RECORD_LEN), is_equal_to(Fapi_Status_Success));
+    }
+    for (s = 0; s < EEPROM_FLASH_SIM_SECTORS; s++) {
+        erases += eeprom_flash_sim_erase_count(s);
+    }
+    // A 152 byte record fills a 4 KiB sector after ~26 writes, so one erase per ~20 writes
+    assert_that(erases, is_less_than(2000 / 20));
+    assert_that(eeprom_flash_sim_overwrite_count(), is_equal_to(0));
+    // Wear is spread over every log sector and never touches the legacy ones
+    for (s = 0; s < EEPROM_FLASH_SIM_SECTORS; s++) {
+        if (s >= EEPROM_LOG_FIRST_SECTOR && s < EEPROM_LOG_FIRST_SECTOR + EEPROM_LOG_NUM_SECTORS) {
+            assert_that(eeprom_flash_sim_erase_count(s), is_greater_than(0));
+        } else {
+            assert_that(eeprom_flash_sim_erase_count(s), is_equal_to(0));
+        }
+    }
+    assert_that(eeprom_log_mount(), is_equal_to(Fapi_Status_Success));
+    for (i = 0; i < TEST_RECORDS; i++) {
+        assert_record(i, expected[i]);
+    }
+}
+
+Ensure(eeprom_log, torn_write_keeps_previous_version) {
+    uint8_t next[TEST_RECORD_LEN];
+    fill(expected[3], 100);
+    eeprom_log_write(3, expected[3], TEST_RECORD_LEN);
+
+    fill(next, 200);
+    eeprom_flash_sim_cut_power_after(EEPROM_LOG_RECORD_HDR_LEN + 10);
+    assert_that(eeprom_log_write(3, next, TEST_RECORD_LEN), is_not_equal_to(Fapi_Status_Success));
+    eeprom_flash_sim_restore_power();
+
+    assert_that(eeprom_log_mount(), is_equal_to(Fapi_Status_Success));
+    assert_record(3, expected[3]);
+
+    assert_that(eeprom_log_write(3, next, TEST_RECORD_LEN), is_equal_to(Fapi_Status_Success));
+    assert_that(eeprom_log_mount(), is_equal_to(Fapi_Status_Success));
+    assert_record(3, next);
+}
+
+Ensure(eeprom_log, random_resets_never_lose_committed_records) {
+    uint8_t pending[TEST_RECORD_LEN];
+    uint8_t buf[TEST_RECORD_LEN];
+    uint32_t i;
+    uint8_t id;
+
+    for (id = 0; id < TEST_RECORDS; id++) {
+        fill(expected[id], id);
+        eeprom_log_write(id, expected[id], TEST_RECORD_LEN);
+    }
+    for (i = 0; i < 3000; i++) {
+        id = rand() % TEST_RECORDS;
+        fill(pending, TEST_RECORDS + i);
+        if (rand() % 8 == 0) {
+            eeprom_flash_sim_cut_power_after(rand() % (EEPROM_LOG_SECTOR_SIZE / 2));
+        }
+        Fapi_StatusType status = eeprom_log_write(id, pending, TEST_RECORD_LEN);
+        eeprom_flash_sim_restore_power();
+        if (status == Fapi_Status_Success) {
+            memcpy(expected[id], pending, TEST_RECORD_LEN);
+            continue;
+        }
+
+        assert_that(eeprom_log_mount(), is_equal_to(Fapi_Status_Success));
+        uint8_t other;
+        for (other = 0; other < TEST_RECORDS; other++) {
+            assert_that(eeprom_log_read(other, buf, sizeof(buf)), is_equal_to(Fapi_Status_Success));
+            if (other == id && memcmp(buf, pending, sizeof(buf)) == 0) {
+                // The record made it to flash before the reset
+                memcpy(expected[id], pending, TEST_RECORD_LEN);
+            }
+            assert_that(buf, is_equal_to_contents_of(expected[other], sizeof(buf)));
+        }
+    }
+    assert_that(eeprom_flash_sim_overwrite_count(), is_equal_to(0));
+}
+
+TestSuite *eeprom_log_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, eeprom_log, mount_formats_blank_flash);
+    add_test_with_context(suite, eeprom_log, read_of_unwritten_record_fails);
+    add_test_with_context(suite, eeprom_log, rejects_bad_id_and_size);
+    add_test_with_context(suite, eeprom_log, latest_version_survives_remount);
+    add_test_with_context(suite, eeprom_log, short_record_is_zero_padded_on_read);
+    add_test_with_context(suite, eeprom_log, unchanged_write_does_not_program);
+    add_test_with_context(suite, eeprom_log, writes_are_single_programs_and_erases_are_rare);
+    add_test_with_context(suite, eeprom_log, torn_write_keeps_previous_version);
+    add_test_with_context(suite, eeprom_log, random_resets_never_lose_committed_records);
+
+    return suite;
+}
+
+int test_eeprom_log() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, eeprom_log_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
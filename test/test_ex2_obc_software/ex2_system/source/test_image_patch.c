@@ -0,0 +1,318 @@
+/*
+ * test_image_patch.c
+ *
+ * Builds patches with the ground generator in tools/image_patch and applies them
+ * to the golden image in image_flash_sim.c, checking the application slot ends up
+ * holding exactly the new image.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crc16.h"
+#include "image_patch.h"
+#include "image_flash_sim.h"
+#include "test_image_patch.h"
+
+#include "../source/image_patch.c"
+#include "tools/image_patch/image_patch_gen.c"
+
+#define TEST_BASE_LEN (5 * IMAGE_FLASH_SIM_SECTOR_SIZE / 2)
+#define TEST_MAX_LEN (IMAGE_FLASH_SIM_SECTORS * IMAGE_FLASH_SIM_SECTOR_SIZE)
+
+static uint8_t base[TEST_MAX_LEN];
+static uint8_t image[TEST_MAX_LEN];
+static uint32_t image_len;
+
+// Something like a linked binary: code, then the 0xFF the linker pads the last sector with
+static void make_base(void) {
+    uint32_t i;
+    for (i = 0; i < TEST_BASE_LEN; i++) {
+        base[i] = i < TEST_BASE_LEN - 2000 ? (uint8_t)rand() : 0xFF;
+    }
+    image_flash_sim_set_golden(base, TEST_BASE_LEN);
+    memcpy(image, base, TEST_BASE_LEN);
+    image_len = TEST_BASE_LEN;
+}
+
+static void insert(uint32_t at, uint32_t len) {
+    uint32_t i;
+    memmove(&image[at + len], &image[at], image_len - at);
+    for (i = 0; i < len; i++) {
+        image[at + i] = (uint8_t)rand();
+    }
+    image_len += len;
+}
+
+static void delete(uint32_t at, uint32_t len) {
+    memmove(&image[at], &image[at + len], image_len - at - len);
+    image_len -= len;
+}
+
+// A rebuilt application: a few constants and branch targets change, a function grows, another goes
+static void edit_image(void) {
+    uint32_t i;
+    for (i = 0; i < 20; i++) {
+        uint32_t at = (uint32_t)rand() % (image_len - 4);
+        image[at] ^= 0x5A;
+        image[at + 3] ^= 0xA5;
+    }
+    insert(10000, 300);
+    delete(30000, 200);
+    memset(&image[image_len], 0, 1500);
+    image_len += 1500;
+    insert(image_len, 700);
+}
+
+static uint8_t *make_patch(uint32_t *patch_len) {
+    uint8_t *patch = image_patch_generate(base, TEST_BASE_LEN, image, image_len, patch_len);
+    assert_that(patch, is_not_null);
+    return patch;
+}
+
+static image_update_status send(const uint8_t *data, uint32_t len, uint32_t chunk) {
+    uint32_t offset = 0;
+    while (offset < len) {
+        uint32_t n = len - offset < chunk ? len - offset : chunk;
+        image_update_status status = image_patch_write(offset, &data[offset], n);
+        if (status != IMAGE_UPDATE_OK) {
+            return status;
+        }
+        offset = image_patch_next();
+    }
+    return IMAGE_UPDATE_OK;
+}
+
+static void assert_committed(void) {
+    image_info info;
+    eeprom_get_app_info(&info);
+    assert_that(info.exists, is_equal_to(EXISTS_FLAG));
+    assert_that(info.addr, is_equal_to(APP_DEFAULT_ADDR));
+    assert_that(info.size, is_equal_to(image_len));
+    assert_that(info.crc, is_equal_to(crc16_checksum(image, image_len)));
+    assert_that(image_flash_sim_slot(), is_equal_to_contents_of(image, image_len));
+}
+
+static void apply_patch(const uint8_t *data, uint32_t len, uint32_t chunk) {
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(send(data, len, chunk), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_patch_finish(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_committed();
+}
+
+// The header of a patch for the golden image, for hand made op lists
+static uint32_t header(uint8_t *out, uint32_t size) {
+    uint16_t base_crc = crc16_checksum(base, TEST_BASE_LEN);
+    uint16_t crc = crc16_checksum(image, size);
+    uint8_t h[IMAGE_PATCH_HEADER_LEN] = {0x45, 0x58, 0x44, 0x50, TEST_BASE_LEN >> 24, TEST_BASE_LEN >> 16,
+                                         TEST_BASE_LEN >> 8, TEST_BASE_LEN & 0xFF, base_crc >> 8, base_crc,
+                                         size >> 24, size >> 16, size >> 8, size, crc >> 8, crc};
+    memcpy(out, h, sizeof(h));
+    return sizeof(h);
+}
+
+Describe(image_patch);
+BeforeEach(image_patch) {
+    image_flash_sim_reset();
+    image_update_abort();
+    memset(&patch, 0, sizeof(patch));
+    srand(0x46);
+    make_base();
+};
+AfterEach(image_patch){};
+
+Ensure(image_patch, unchanged_image_is_a_few_bytes) {
+    uint32_t patch_len;
+    uint8_t *data = make_patch(&patch_len);
+    assert_that(patch_len, is_less_than(IMAGE_PATCH_HEADER_LEN + 16));
+    apply_patch(data, patch_len, 1000);
+    free(data);
+}
+
+Ensure(image_patch, rebuilds_an_edited_image) {
+    uint32_t patch_len;
+    edit_image();
+    uint8_t *data = make_patch(&patch_len);
+    // The new bytes are 1000 random ones, the fill and the edits
+    assert_that(patch_len, is_less_than(1400));
+    // An odd chunk size splits ops, varints and the header between chunks
+    apply_patch(data, patch_len, 7);
+    assert_that(image_flash_sim_overwrite_count(), is_equal_to(0));
+    free(data);
+}
+
+Ensure(image_patch, random_edits_round_trip) {
+    int round;
+    for (round = 0; round < 20; round++) {
+        uint32_t patch_len, edits = 1 + (uint32_t)rand() % 6, i;
+        make_base();
+        for (i = 0; i < edits; i++) {
+            uint32_t at = (uint32_t)rand() % image_len, len = 1 + (uint32_t)rand() % 2000;
+            switch (rand() % 3) {
+            case 0:
+                insert(at, len);
+                break;
+            case 1:
+                delete(at, len < image_len - at ? len : image_len - at);
+                break;
+            default:
+                memset(&image[at], rand(), len < image_len - at ? len : image_len - at);
+                break;
+            }
+        }
+        uint8_t *data = make_patch(&patch_len);
+        apply_patch(data, patch_len, 1 + (uint32_t)rand() % 300);
+        free(data);
+        image_flash_sim_reset();
+    }
+}
+
+Ensure(image_patch, resent_chunks_are_ignored) {
+    uint32_t patch_len, offset;
+    edit_image();
+    uint8_t *data = make_patch(&patch_len);
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    for (offset = 0; offset < patch_len; offset += 50) {
+        uint32_t n = patch_len - offset < 50 ? patch_len - offset : 50;
+        assert_that(image_patch_write(offset, &data[offset], n), is_equal_to(IMAGE_UPDATE_OK));
+        // Lost reply: the same chunk again, then one that overlaps it
+        assert_that(image_patch_write(offset, &data[offset], n), is_equal_to(IMAGE_UPDATE_OK));
+        if (offset + n < patch_len) {
+            assert_that(image_patch_write(offset + n + 1, &data[offset + n + 1], 1),
+                        is_equal_to(IMAGE_UPDATE_OUT_OF_ORDER));
+        }
+        if (offset >= 25) {
+            assert_that(image_patch_write(offset - 25, &data[offset - 25], n + 25), is_equal_to(IMAGE_UPDATE_OK));
+        }
+    }
+    assert_that(image_patch_next(), is_equal_to(patch_len));
+    assert_that(image_patch_finish(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_committed();
+    free(data);
+}
+
+Ensure(image_patch, needs_the_golden_image_it_was_made_from) {
+    image_info app = {EXISTS_FLAG, TEST_BASE_LEN, APP_DEFAULT_ADDR, 0x1234}, info;
+    uint32_t patch_len;
+    edit_image();
+    uint8_t *data = make_patch(&patch_len);
+    eeprom_set_app_info(&app);
+
+    // A different golden image
+    base[100] ^= 1;
+    image_flash_sim_set_golden(base, TEST_BASE_LEN);
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(send(data, patch_len, 64), is_equal_to(IMAGE_UPDATE_BAD_SOURCE));
+
+    // The right image_info, but the flash under it has changed
+    base[100] ^= 1;
+    image_flash_sim_set_golden(base, TEST_BASE_LEN);
+    image_flash_sim_golden()[5000] ^= 0x80;
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(send(data, patch_len, 64), is_equal_to(IMAGE_UPDATE_BAD_SOURCE));
+    assert_that(image_patch_write(patch_len, data, 1), is_equal_to(IMAGE_UPDATE_NOT_STARTED));
+
+    // Refused before the update began, so the application is still there
+    eeprom_get_app_info(&info);
+    assert_that(info.exists, is_equal_to(EXISTS_FLAG));
+    free(data);
+}
+
+Ensure(image_patch, rejects_malformed_patches) {
+    uint8_t data[64];
+    uint32_t len;
+
+    // Bad magic
+    len = header(data, 100);
+    data[0] = 0;
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_patch_write(0, data, len), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+
+    // Copy from past the end of the base
+    len = header(data, 100);
+    data[len++] = IMAGE_PATCH_COPY;
+    data[len++] = 0x80; // zigzag 0x80000 * 2: the base offset moves on four sectors, past its 2.5
+    data[len++] = 0x80;
+    data[len++] = 0x40;
+    data[len++] = 100;
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_patch_write(0, data, len), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+
+    // More data than the image holds
+    len = header(data, 100);
+    data[len++] = IMAGE_PATCH_FILL;
+    data[len++] = 101;
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_patch_write(0, data, len), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+
+    // Ends short of the image
+    len = header(data, 100);
+    data[len++] = IMAGE_PATCH_COPY;
+    data[len++] = 0;
+    data[len++] = 99;
+    data[len++] = IMAGE_PATCH_END;
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_patch_write(0, data, len), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+
+    // Unknown op, and a varint longer than a uint32_t
+    len = header(data, 100);
+    data[len++] = 9;
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_patch_write(0, data, len), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+    len = header(data, 100);
+    data[len++] = IMAGE_PATCH_DATA;
+    memset(&data[len], 0xFF, 5);
+    len += 5;
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_patch_write(0, data, len), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+
+    // Bytes after the end
+    len = header(data, 100);
+    data[len++] = IMAGE_PATCH_COPY;
+    data[len++] = 0;
+    data[len++] = 100;
+    data[len++] = IMAGE_PATCH_END;
+    data[len++] = IMAGE_PATCH_END;
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_patch_write(0, data, len), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+
+    // Any of these abandons the update
+    assert_that(image_patch_finish(), is_equal_to(IMAGE_UPDATE_NOT_STARTED));
+    assert_that(image_update_finish(), is_equal_to(IMAGE_UPDATE_NOT_STARTED));
+}
+
+Ensure(image_patch, finish_needs_the_whole_patch) {
+    uint32_t patch_len;
+    edit_image();
+    uint8_t *data = make_patch(&patch_len);
+    assert_that(image_patch_finish(), is_equal_to(IMAGE_UPDATE_NOT_STARTED));
+    assert_that(image_patch_begin(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(send(data, patch_len - 1, 100), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_patch_finish(), is_equal_to(IMAGE_UPDATE_INCOMPLETE));
+    assert_that(image_patch_write(patch_len - 1, &data[patch_len - 1], 1), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_patch_finish(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_committed();
+    free(data);
+}
+
+TestSuite *image_patch_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, image_patch, unchanged_image_is_a_few_bytes);
+    add_test_with_context(suite, image_patch, rebuilds_an_edited_image);
+    add_test_with_context(suite, image_patch, random_edits_round_trip);
+    add_test_with_context(suite, image_patch, resent_chunks_are_ignored);
+    add_test_with_context(suite, image_patch, needs_the_golden_image_it_was_made_from);
+    add_test_with_context(suite, image_patch, rejects_malformed_patches);
+    add_test_with_context(suite, image_patch, finish_needs_the_whole_patch);
+
+    return suite;
+}
+
+int test_image_patch() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, image_patch_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
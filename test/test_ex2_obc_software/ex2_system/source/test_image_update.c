@@ -0,0 +1,250 @@
+/*
+ * test_image_update.c
+ *
+ * Streams images into the RAM application slot in image_flash_sim.c, including
+ * resets part way through an update.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crc16.h"
+#include "image_update.h"
+#include "image_flash_sim.h"
+#include "test_image_update.h"
+
+#include "../source/image_update.c"
+
+#define TEST_IMAGE_LEN (3 * IMAGE_FLASH_SIM_SECTOR_SIZE + 1000 + 7) // ends part way through a flash word
+#define TEST_CHUNK 256
+
+static uint8_t image[TEST_IMAGE_LEN];
+
+// Reset the OBC: everything in RAM is lost, flash and the EEPROM records survive
+static void reboot(void) {
+    memset(&update, 0, sizeof(update));
+    assert_that(image_update_resume(), is_equal_to(IMAGE_UPDATE_OK));
+}
+
+static uint32_t next_offset(void) {
+    image_update_progress progress;
+    image_update_get_progress(&progress);
+    return progress.next;
+}
+
+// What the ground station does: send chunks from where the update says it is until the end
+static image_update_status stream(uint32_t chunk) {
+    uint32_t offset = next_offset();
+    while (offset < TEST_IMAGE_LEN) {
+        uint32_t len = TEST_IMAGE_LEN - offset < chunk ? TEST_IMAGE_LEN - offset : chunk;
+        image_update_status status = image_update_write(offset, &image[offset], len);
+        if (status != IMAGE_UPDATE_OK && status != IMAGE_UPDATE_OUT_OF_ORDER) {
+            return status;
+        }
+        offset = next_offset();
+    }
+    return IMAGE_UPDATE_OK;
+}
+
+static void assert_committed(void) {
+    image_info info;
+    eeprom_get_app_info(&info);
+    assert_that(info.exists, is_equal_to(EXISTS_FLAG));
+    assert_that(info.addr, is_equal_to(IMAGE_FLASH_SIM_BASE));
+    assert_that(info.size, is_equal_to(TEST_IMAGE_LEN));
+    assert_that(info.crc, is_equal_to(crc16_checksum(image, TEST_IMAGE_LEN)));
+    assert_that(image_flash_sim_slot(), is_equal_to_contents_of(image, TEST_IMAGE_LEN));
+}
+
+Describe(image_update);
+BeforeEach(image_update) {
+    uint32_t i;
+    image_flash_sim_reset();
+    memset(&update, 0, sizeof(update));
+    srand(0x1A);
+    for (i = 0; i < TEST_IMAGE_LEN; i++) {
+        image[i] = (uint8_t)rand();
+    }
+};
+AfterEach(image_update){};
+
+Ensure(image_update, rejects_images_outside_the_slot) {
+    assert_that(image_update_begin(GOLD_DEFAULT_ADDR, TEST_IMAGE_LEN, 0), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE + IMAGE_UPDATE_ALIGN, TEST_IMAGE_LEN, 0),
+                is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE, 0, 0), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE, IMAGE_UPDATE_SLOT_END, 0),
+                is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+    assert_that(image_update_write(0, image, TEST_CHUNK), is_equal_to(IMAGE_UPDATE_NOT_STARTED));
+}
+
+Ensure(image_update, begin_invalidates_the_application) {
+    image_info info = {EXISTS_FLAG, TEST_IMAGE_LEN, IMAGE_FLASH_SIM_BASE, 0x1234};
+    eeprom_set_app_info(&info);
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE, TEST_IMAGE_LEN, 0), is_equal_to(IMAGE_UPDATE_OK));
+    eeprom_get_app_info(&info);
+    assert_that(info.exists, is_not_equal_to(EXISTS_FLAG));
+}
+
+Ensure(image_update, streams_and_commits_the_image) {
+    uint16_t crc = crc16_checksum(image, TEST_IMAGE_LEN);
+    uint32_t offset;
+    uint8_t sector;
+
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE, TEST_IMAGE_LEN, crc), is_equal_to(IMAGE_UPDATE_OK));
+    for (offset = 0; offset < TEST_IMAGE_LEN; offset += TEST_CHUNK) {
+        uint32_t len = TEST_IMAGE_LEN - offset < TEST_CHUNK ? TEST_IMAGE_LEN - offset : TEST_CHUNK;
+        assert_that(image_update_write(offset, &image[offset], len), is_equal_to(IMAGE_UPDATE_OK));
+        // Sectors are erased only once the write pointer reaches them
+        for (sector = 0; sector < IMAGE_FLASH_SIM_SECTORS; sector++) {
+            uint32_t expected = sector * IMAGE_FLASH_SIM_SECTOR_SIZE < offset + len ? 1 : 0;
+            assert_that(image_flash_sim_erase_count(sector), is_equal_to(expected));
+        }
+    }
+    assert_that(image_update_finish(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_committed();
+    assert_that(image_flash_sim_overwrite_count(), is_equal_to(0));
+    // One for begin, one per checkpoint including the end of the image, one for finish
+    assert_that(image_flash_sim_update_info_writes(),
+                is_equal_to(2 + (TEST_IMAGE_LEN + IMAGE_UPDATE_CHECKPOINT - 1) / IMAGE_UPDATE_CHECKPOINT));
+
+    image_update_progress progress;
+    image_update_get_progress(&progress);
+    assert_that(progress.active, is_equal_to(false));
+}
+
+Ensure(image_update, chunks_must_be_in_order_and_aligned) {
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE, TEST_IMAGE_LEN, 0), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_update_write(TEST_CHUNK, image, TEST_CHUNK), is_equal_to(IMAGE_UPDATE_OUT_OF_ORDER));
+    assert_that(image_update_write(IMAGE_UPDATE_ALIGN / 2, image, TEST_CHUNK), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+    assert_that(image_update_write(0, image, TEST_CHUNK - 1), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+    assert_that(image_update_write(TEST_IMAGE_LEN - 7, image, 8), is_equal_to(IMAGE_UPDATE_BAD_ARGS));
+    assert_that(next_offset(), is_equal_to(0));
+}
+
+Ensure(image_update, resent_chunks_are_not_programmed_again) {
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE, TEST_IMAGE_LEN, 0), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_update_write(0, image, TEST_CHUNK), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_update_write(0, image, TEST_CHUNK), is_equal_to(IMAGE_UPDATE_OK));
+    // Overlaps the write pointer, only the new half is written
+    assert_that(image_update_write(TEST_CHUNK / 2, &image[TEST_CHUNK / 2], TEST_CHUNK),
+                is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(next_offset(), is_equal_to(TEST_CHUNK * 3 / 2));
+    assert_that(image_flash_sim_overwrite_count(), is_equal_to(0));
+}
+
+Ensure(image_update, finish_checks_length_and_crc) {
+    uint16_t crc = crc16_checksum(image, TEST_IMAGE_LEN);
+    assert_that(image_update_finish(), is_equal_to(IMAGE_UPDATE_NOT_STARTED));
+
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE, TEST_IMAGE_LEN, crc ^ 1), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_update_write(0, image, TEST_CHUNK), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_update_finish(), is_equal_to(IMAGE_UPDATE_INCOMPLETE));
+    assert_that(stream(TEST_CHUNK), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_update_finish(), is_equal_to(IMAGE_UPDATE_BAD_CRC));
+
+    image_info info;
+    eeprom_get_app_info(&info);
+    assert_that(info.exists, is_not_equal_to(EXISTS_FLAG));
+}
+
+Ensure(image_update, finish_reads_back_the_flash) {
+    uint16_t crc = crc16_checksum(image, TEST_IMAGE_LEN);
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE, TEST_IMAGE_LEN, crc), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(stream(TEST_CHUNK), is_equal_to(IMAGE_UPDATE_OK));
+    image_flash_sim_slot()[1234] ^= 0x10; // a bit flipped after it was programmed
+    assert_that(image_update_finish(), is_equal_to(IMAGE_UPDATE_BAD_CRC));
+}
+
+Ensure(image_update, resumes_from_the_last_checkpoint) {
+    uint16_t crc = crc16_checksum(image, TEST_IMAGE_LEN);
+    uint32_t offset;
+
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE, TEST_IMAGE_LEN, crc), is_equal_to(IMAGE_UPDATE_OK));
+    for (offset = 0; offset < IMAGE_UPDATE_CHECKPOINT + 3 * TEST_CHUNK; offset += TEST_CHUNK) {
+        assert_that(image_update_write(offset, &image[offset], TEST_CHUNK), is_equal_to(IMAGE_UPDATE_OK));
+    }
+    reboot();
+    assert_that(next_offset(), is_equal_to(IMAGE_UPDATE_CHECKPOINT));
+
+    image_update_progress progress;
+    image_update_get_progress(&progress);
+    assert_that(progress.crc_sofar, is_equal_to(crc16_checksum(image, IMAGE_UPDATE_CHECKPOINT)));
+
+    assert_that(stream(TEST_CHUNK), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_update_finish(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_committed();
+    assert_that(image_flash_sim_overwrite_count(), is_equal_to(0));
+}
+
+Ensure(image_update, torn_chunk_rewinds_to_its_sector) {
+    uint16_t crc = crc16_checksum(image, TEST_IMAGE_LEN);
+    uint32_t offset = 0;
+
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE, TEST_IMAGE_LEN, crc), is_equal_to(IMAGE_UPDATE_OK));
+    // The last checkpoint is half way through the second sector
+    while (offset < IMAGE_FLASH_SIM_SECTOR_SIZE + IMAGE_UPDATE_CHECKPOINT + IMAGE_UPDATE_CHECKPOINT / 4) {
+        assert_that(image_update_write(offset, &image[offset], TEST_CHUNK), is_equal_to(IMAGE_UPDATE_OK));
+        offset += TEST_CHUNK;
+    }
+    image_flash_sim_cut_power_after(TEST_CHUNK / 2);
+    assert_that(offset % IMAGE_FLASH_SIM_SECTOR_SIZE, is_not_equal_to(0));
+    assert_that(image_update_write(offset, &image[offset], TEST_CHUNK), is_equal_to(IMAGE_UPDATE_FLASH_ERROR));
+    image_flash_sim_restore_power();
+    reboot();
+
+    // The chunks after the checkpoint are already there. The torn one sends the update back to its sector
+    assert_that(next_offset(), is_equal_to(IMAGE_FLASH_SIM_SECTOR_SIZE + IMAGE_UPDATE_CHECKPOINT));
+    for (offset = next_offset(); image_update_write(offset, &image[offset], TEST_CHUNK) == IMAGE_UPDATE_OK;
+         offset += TEST_CHUNK) {
+    }
+    assert_that(next_offset(), is_equal_to(IMAGE_FLASH_SIM_SECTOR_SIZE));
+    assert_that(stream(TEST_CHUNK), is_equal_to(IMAGE_UPDATE_OK));
+    assert_that(image_update_finish(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_committed();
+    assert_that(image_flash_sim_overwrite_count(), is_equal_to(0));
+}
+
+Ensure(image_update, random_resets_always_end_with_the_image) {
+    uint16_t crc = crc16_checksum(image, TEST_IMAGE_LEN);
+    uint32_t resets = 0;
+
+    assert_that(image_update_begin(IMAGE_FLASH_SIM_BASE, TEST_IMAGE_LEN, crc), is_equal_to(IMAGE_UPDATE_OK));
+    while (next_offset() < TEST_IMAGE_LEN) {
+        image_flash_sim_cut_power_after(rand() % (IMAGE_FLASH_SIM_SECTOR_SIZE * 2));
+        if (stream(TEST_CHUNK) != IMAGE_UPDATE_OK) {
+            resets++;
+        }
+        image_flash_sim_restore_power();
+        reboot();
+    }
+    assert_that(resets, is_greater_than(0));
+    assert_that(image_update_finish(), is_equal_to(IMAGE_UPDATE_OK));
+    assert_committed();
+    assert_that(image_flash_sim_overwrite_count(), is_equal_to(0));
+}
+
+TestSuite *image_update_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, image_update, rejects_images_outside_the_slot);
+    add_test_with_context(suite, image_update, begin_invalidates_the_application);
+    add_test_with_context(suite, image_update, streams_and_commits_the_image);
+    add_test_with_context(suite, image_update, chunks_must_be_in_order_and_aligned);
+    add_test_with_context(suite, image_update, resent_chunks_are_not_programmed_again);
+    add_test_with_context(suite, image_update, finish_checks_length_and_crc);
+    add_test_with_context(suite, image_update, finish_reads_back_the_flash);
+    add_test_with_context(suite, image_update, resumes_from_the_last_checkpoint);
+    add_test_with_context(suite, image_update, torn_chunk_rewinds_to_its_sector);
+    add_test_with_context(suite, image_update, random_resets_always_end_with_the_image);
+
+    return suite;
+}
+
+int test_image_update() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, image_update_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
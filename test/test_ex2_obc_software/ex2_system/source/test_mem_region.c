@@ -0,0 +1,203 @@
+/*
+ * test_mem_region.c
+ *
+ * Checks size class selection, fallback to the heap and the counters, then
+ * replays an allocation trace shaped like the FTP, scheduler, ADCS and GPS hot
+ * paths through the size classes. Its cost is measured by test/bench/mem_region_bench.c.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem_region.h"
+#include "test_mem_region.h"
+
+#include "../source/mem_region.c"
+
+#define TRACE_LEN 5000
+#define TRACE_SLOTS 48
+
+typedef struct {
+    uint8_t slot;  // which live pointer the operation works on
+    uint16_t size; // 0 to free the slot
+} trace_op;
+
+static trace_op trace[TRACE_LEN];
+static void *live[TRACE_SLOTS];
+
+static void reset_regions(void) {
+    vPortFree(arena_start);
+    arena_start = NULL;
+    arena_end = NULL;
+    spills = 0;
+    memset(regions, 0, sizeof(regions));
+    mem_region_init();
+}
+
+static mem_region_stats stats_of(uint8_t class_index) {
+    mem_region_stats stats;
+    mem_region_get_stats(class_index, &stats);
+    return stats;
+}
+
+/*
+ * Slots 0-11 are FTP blocks queued for S-band, up to 10 in flight, slots 12-27
+ * a schedule of 16 commands being rewritten, 28 ADCS telemetry and 29 GPS messages.
+ */
+static void build_trace(void) {
+    int n = 0;
+    int ftp_head = 0, ftp_tail = 0;
+    unsigned int seed = 1;
+
+    while (n < TRACE_LEN - 64) {
+        seed = seed * 1103515245 + 12345;
+        switch ((seed >> 16) % 4) {
+        case 0: // FTP, the sender frees the oldest block once 10 are queued
+            if (ftp_head - ftp_tail == 10) {
+                trace[n++] = (trace_op){ftp_tail++ % 12, 0};
+            }
+            trace[n++] = (trace_op){ftp_head++ % 12, 12 + 1024};
+            break;
+        case 1: { // scheduler reads the whole schedule back then frees it
+            int i;
+            for (i = 0; i < 16; i++) {
+                trace[n++] = (trace_op){12 + i, 36};
+            }
+            for (i = 0; i < 16; i++) {
+                trace[n++] = (trace_op){12 + i, 0};
+            }
+            break;
+        }
+        case 2:
+            trace[n++] = (trace_op){28, 112};
+            trace[n++] = (trace_op){28, 0};
+            break;
+        default:
+            trace[n++] = (trace_op){29, 7 + (seed >> 8) % 24};
+            trace[n++] = (trace_op){29, 0};
+            break;
+        }
+    }
+    while (ftp_tail < ftp_head) {
+        trace[n++] = (trace_op){ftp_tail++ % 12, 0};
+    }
+    while (n < TRACE_LEN) {
+        trace[n++] = (trace_op){29, 0}; // free of NULL
+    }
+}
+
+static int replay(void) {
+    int failures = 0;
+    int i;
+
+    memset(live, 0, sizeof(live));
+    for (i = 0; i < TRACE_LEN; i++) {
+        if (trace[i].size == 0) {
+            mem_region_free(live[trace[i].slot]);
+            live[trace[i].slot] = NULL;
+        } else {
+            live[trace[i].slot] = mem_region_alloc(trace[i].size);
+            if (live[trace[i].slot] == NULL) {
+                failures++;
+            } else {
+                memset(live[trace[i].slot], 0xA5, trace[i].size);
+            }
+        }
+    }
+    return failures;
+}
+
+Describe(mem_region);
+BeforeEach(mem_region) { reset_regions(); };
+AfterEach(mem_region) {};
+
+Ensure(mem_region, uses_smallest_class_that_fits) {
+    void *a = mem_region_alloc(1);
+    void *b = mem_region_alloc(64);
+    void *c = mem_region_alloc(65);
+    void *d = mem_region_alloc(1040);
+    assert_that(stats_of(0).in_use, is_equal_to(2));
+    assert_that(stats_of(1).in_use, is_equal_to(1));
+    assert_that(stats_of(2).in_use, is_equal_to(1));
+    assert_that((uint8_t *)a >= arena_start && (uint8_t *)d < arena_end, is_true);
+    mem_region_free(a);
+    mem_region_free(b);
+    mem_region_free(c);
+    mem_region_free(d);
+    assert_that(stats_of(0).in_use, is_equal_to(0));
+    assert_that(stats_of(0).peak_in_use, is_equal_to(2));
+    assert_that(stats_of(2).allocations, is_equal_to(1));
+    assert_that(mem_region_spills(), is_equal_to(0));
+}
+
+Ensure(mem_region, blocks_do_not_overlap) {
+    void *blocks[32];
+    int i;
+    for (i = 0; i < 32; i++) {
+        blocks[i] = mem_region_alloc(64);
+        memset(blocks[i], i, 64);
+    }
+    for (i = 0; i < 32; i++) {
+        assert_that(((uint8_t *)blocks[i])[0], is_equal_to(i));
+        assert_that(((uint8_t *)blocks[i])[63], is_equal_to(i));
+    }
+    for (i = 0; i < 32; i++) {
+        mem_region_free(blocks[i]);
+    }
+}
+
+Ensure(mem_region, exhausted_class_moves_up_then_to_heap) {
+    void *blocks[16 + 12 + 1];
+    int i;
+    for (i = 0; i < 16 + 12 + 1; i++) {
+        blocks[i] = mem_region_alloc(100);
+        assert_that(blocks[i], is_not_null);
+    }
+    assert_that(stats_of(1).in_use, is_equal_to(16));
+    assert_that(stats_of(2).in_use, is_equal_to(12));
+    assert_that(stats_of(1).exhausted, is_equal_to(13));
+    assert_that(mem_region_spills(), is_equal_to(1));
+    assert_that((uint8_t *)blocks[28] < arena_start || (uint8_t *)blocks[28] >= arena_end, is_true);
+    for (i = 0; i < 16 + 12 + 1; i++) {
+        mem_region_free(blocks[i]);
+    }
+    assert_that(stats_of(1).in_use, is_equal_to(0));
+    assert_that(stats_of(2).in_use, is_equal_to(0));
+}
+
+Ensure(mem_region, oversize_goes_to_heap) {
+    void *big = mem_region_alloc(4096);
+    assert_that(big, is_not_null);
+    assert_that(mem_region_spills(), is_equal_to(1));
+    mem_region_free(big);
+    mem_region_free(NULL);
+    assert_that(mem_region_alloc(0), is_null);
+}
+
+Ensure(mem_region, trace_never_leaves_the_regions) {
+    build_trace();
+    assert_that(replay(), is_equal_to(0));
+    assert_that(mem_region_spills(), is_equal_to(0));
+    assert_that(stats_of(0).in_use, is_equal_to(0));
+    assert_that(stats_of(2).peak_in_use, is_equal_to(10));
+}
+
+TestSuite *mem_region_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, mem_region, uses_smallest_class_that_fits);
+    add_test_with_context(suite, mem_region, blocks_do_not_overlap);
+    add_test_with_context(suite, mem_region, exhausted_class_moves_up_then_to_heap);
+    add_test_with_context(suite, mem_region, oversize_goes_to_heap);
+    add_test_with_context(suite, mem_region, trace_never_leaves_the_regions);
+
+    return suite;
+}
+
+int test_mem_region() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, mem_region_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
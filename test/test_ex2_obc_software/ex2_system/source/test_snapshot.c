@@ -0,0 +1,126 @@
+/*
+ * test_snapshot.c
+ *
+ * Publication and reads of a double buffered snapshot, including a reader that
+ * is overtaken by the writer in the middle of a read and has to read again.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "snapshot.h"
+#include "test_snapshot.h"
+
+#include "../source/snapshot.c"
+
+typedef struct {
+    uint32_t time;
+    uint8_t section[12];
+} test_record;
+
+extern void (*fake_critical_hook)(void);
+
+static test_record buffers[2];
+static snapshot_t snapshot;
+static test_record writer_record;
+static int critical_entries;
+static int publish_on_entry;
+
+static test_record make_record(uint8_t fill) {
+    test_record record;
+    record.time = fill;
+    memset(record.section, fill, sizeof(record.section));
+    return record;
+}
+
+/* The housekeeping daemon publishing twice at the chosen critical section entry,
+ * so the buffer the reader had is overwritten */
+static void writer_interrupts(void) {
+    critical_entries++;
+    if (critical_entries == publish_on_entry) {
+        fake_critical_hook = NULL; // snapshot_publish enters a critical section too
+        writer_record = make_record(2);
+        snapshot_publish(&snapshot, &writer_record);
+        writer_record = make_record(3);
+        snapshot_publish(&snapshot, &writer_record);
+        fake_critical_hook = writer_interrupts;
+    }
+}
+
+Describe(snapshot);
+BeforeEach(snapshot) {
+    snapshot_t empty = SNAPSHOT_INIT(&buffers[0], &buffers[1], sizeof(test_record));
+    memset(buffers, 0, sizeof(buffers));
+    snapshot = empty;
+    critical_entries = 0;
+    publish_on_entry = 0;
+    fake_critical_hook = NULL;
+};
+AfterEach(snapshot) { fake_critical_hook = NULL; };
+
+Ensure(snapshot, reads_latest_publication) {
+    test_record first = make_record(1), second = make_record(7), out;
+
+    snapshot_publish(&snapshot, &first);
+    assert_that(snapshot_read(&snapshot, 0, &out, sizeof(out)), is_true);
+    assert_that(&out, is_equal_to_contents_of(&first, sizeof(first)));
+
+    snapshot_publish(&snapshot, &second);
+    assert_that(snapshot_read(&snapshot, 0, &out, sizeof(out)), is_true);
+    assert_that(&out, is_equal_to_contents_of(&second, sizeof(second)));
+}
+
+Ensure(snapshot, reads_one_section) {
+    test_record record = make_record(5);
+    uint8_t section[sizeof(record.section)];
+
+    snapshot_publish(&snapshot, &record);
+    assert_that(snapshot_read(&snapshot, offsetof(test_record, section), section, sizeof(section)), is_true);
+    assert_that(section, is_equal_to_contents_of(record.section, sizeof(section)));
+    assert_that(snapshot_read(&snapshot, sizeof(test_record), section, 1), is_false);
+    assert_that(snapshot_read(&snapshot, offsetof(test_record, section), section, sizeof(section) + 1), is_false);
+}
+
+Ensure(snapshot, acquire_is_invalid_once_overwritten) {
+    test_record record = make_record(1);
+    uint32_t seq;
+
+    snapshot_publish(&snapshot, &record);
+    snapshot_acquire(&snapshot, &seq);
+    assert_that(snapshot_valid(&snapshot, seq), is_true);
+    snapshot_publish(&snapshot, &record);
+    assert_that(snapshot_valid(&snapshot, seq), is_false);
+}
+
+Ensure(snapshot, read_retries_when_the_writer_overtakes_it) {
+    test_record first = make_record(1), out;
+    test_record latest = make_record(3);
+
+    snapshot_publish(&snapshot, &first);
+    // Entry 1 is the acquire, entry 2 the check after the copy: the writer gets in between
+    publish_on_entry = 2;
+    fake_critical_hook = writer_interrupts;
+    assert_that(snapshot_read(&snapshot, 0, &out, sizeof(out)), is_true);
+
+    // Acquire and check again after the failed check
+    assert_that(critical_entries, is_equal_to(4));
+    assert_that(&out, is_equal_to_contents_of(&latest, sizeof(latest)));
+}
+
+TestSuite *snapshot_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, snapshot, reads_latest_publication);
+    add_test_with_context(suite, snapshot, reads_one_section);
+    add_test_with_context(suite, snapshot, acquire_is_invalid_once_overwritten);
+    add_test_with_context(suite, snapshot, read_retries_when_the_writer_overtakes_it);
+
+    return suite;
+}
+
+int test_snapshot() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, snapshot_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
@@ -8,3 +8,15 @@ void *pvPortMalloc(size_t len) {
 void vPortFree(void *pv) {
     free(pv);
 }
+
+/* Called on entering every critical section, so a test can play another task that
+ * runs between two critical sections of the code under test */
+void (*fake_critical_hook)(void) = NULL;
+
+void vPortEnterCritical(void) {
+    if (fake_critical_hook != NULL) {
+        fake_critical_hook();
+    }
+}
+
+void vPortExitCritical(void) {}
@@ -0,0 +1,6 @@
+#ifndef TEST_BASE_64
+#define TEST_BASE_64
+
+int test_base_64();
+
+#endif
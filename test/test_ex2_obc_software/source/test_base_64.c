@@ -0,0 +1,87 @@
+/*
+ * test_base_64.c
+ *
+ * Checks the table driven base64 encoder against RFC 4648 vectors and the
+ * decoder. Throughput is measured by test/bench/base64_bench.c.
+ */
+
+#include <cgreen/cgreen.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base_64.h"
+#include "test_base_64.h"
+
+#include "../source/base_64.c"
+
+#define B64_TEST_BUF_LEN 300
+
+static unsigned char buf[B64_TEST_BUF_LEN];
+static char out[BASE64_ENCODED_LEN(B64_TEST_BUF_LEN) + 1];
+
+Describe(base_64);
+BeforeEach(base_64) {
+    uint32_t i;
+    srand(0x64);
+    for (i = 0; i < B64_TEST_BUF_LEN; i++) {
+        buf[i] = (unsigned char)rand();
+    }
+    memset(out, 0, sizeof(out));
+};
+AfterEach(base_64) {};
+
+Ensure(base_64, encodes_rfc4648_vectors) {
+    const char *in[] = {"", "f", "fo", "foo", "foob", "fooba", "foobar"};
+    const char *expected[] = {"", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy"};
+    int i;
+    for (i = 0; i < 7; i++) {
+        size_t len = base64_encode_into((const unsigned char *)in[i], strlen(in[i]), out, sizeof(out));
+        out[len] = '\0';
+        assert_that(out, is_equal_to_string(expected[i]));
+    }
+}
+
+Ensure(base_64, rejects_short_output_buffer) {
+    assert_that(base64_encode_into(buf, 3, out, 3), is_equal_to(0));
+    assert_that(base64_encode_into(buf, 4, out, 7), is_equal_to(0));
+    assert_that(base64_encode_into(buf, 4, out, 8), is_equal_to(8));
+}
+
+Ensure(base_64, round_trips_all_lengths) {
+    size_t length;
+    for (length = 1; length < B64_TEST_BUF_LEN; length++) {
+        size_t decoded_len;
+        size_t encoded_len = base64_encode_into(buf, length, out, sizeof(out));
+        unsigned char *decoded = base64_decode(out, encoded_len, &decoded_len);
+        assert_that(decoded_len, is_equal_to(length));
+        assert_that(memcmp(decoded, buf, length), is_equal_to(0));
+        free(decoded);
+    }
+}
+
+Ensure(base_64, allocating_encode_matches_encode_into) {
+    size_t len;
+    char *encoded = base64_encode(buf, 53, &len);
+    assert_that(len, is_equal_to(BASE64_ENCODED_LEN(53)));
+    assert_that(base64_encode_into(buf, 53, out, sizeof(out)), is_equal_to(len));
+    assert_that(memcmp(encoded, out, len), is_equal_to(0));
+    free(encoded);
+}
+
+TestSuite *base_64_test_code() {
+    TestSuite *suite = create_test_suite();
+    add_test_with_context(suite, base_64, encodes_rfc4648_vectors);
+    add_test_with_context(suite, base_64, rejects_short_output_buffer);
+    add_test_with_context(suite, base_64, round_trips_all_lengths);
+    add_test_with_context(suite, base_64, allocating_encode_matches_encode_into);
+
+    return suite;
+}
+
+int test_base_64() {
+    TestSuite *suite = create_test_suite();
+    add_suite(suite, base_64_test_code());
+    return run_test_suite(suite, create_text_reporter());
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file image_patch_gen.c
+ * @date 2026-10-19
+ */
+
+#include "image_patch_gen.h"
+#include "crc16.h"
+#include "image_patch.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GEN_NONE 0xFFFFFFFFU
+
+typedef struct {
+    uint8_t *data;
+    uint32_t len;
+    uint32_t cap;
+    bool failed;
+} gen_out;
+
+typedef struct {
+    const uint8_t *base;
+    uint32_t base_len;
+    uint32_t *head; // latest base offset for each hash
+    uint32_t *prev; // earlier base offset with the same hash
+} gen_index;
+
+static void put(gen_out *out, const void *data, uint32_t len) {
+    if (out->failed) {
+        return;
+    }
+    if (out->len + len > out->cap) {
+        uint32_t cap = out->cap * 2 + len;
+        uint8_t *grown = realloc(out->data, cap);
+        if (grown == NULL) {
+            out->failed = true;
+            return;
+        }
+        out->data = grown;
+        out->cap = cap;
+    }
+    memcpy(&out->data[out->len], data, len);
+    out->len += len;
+}
+
+static void put_byte(gen_out *out, uint8_t byte) { put(out, &byte, 1); }
+
+static void put_be32(gen_out *out, uint32_t value) {
+    uint8_t bytes[4] = {value >> 24, value >> 16, value >> 8, value};
+    put(out, bytes, sizeof(bytes));
+}
+
+static void put_be16(gen_out *out, uint16_t value) {
+    uint8_t bytes[2] = {value >> 8, value};
+    put(out, bytes, sizeof(bytes));
+}
+
+static void put_varint(gen_out *out, uint32_t value) {
+    while (value >= 0x80) {
+        put_byte(out, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    put_byte(out, (uint8_t)value);
+}
+
+static uint32_t hash_window(const uint8_t *p) {
+    uint32_t h = 2166136261U;
+    int i;
+    for (i = 0; i < GEN_WINDOW; i++) {
+        h = (h ^ p[i]) * 16777619U;
+    }
+    return h >> (32 - GEN_HASH_BITS);
+}
+
+static bool index_base(gen_index *index, const uint8_t *base, uint32_t base_len) {
+    uint32_t i;
+    index->base = base;
+    index->base_len = base_len;
+    index->head = malloc(sizeof(uint32_t) << GEN_HASH_BITS);
+    index->prev = malloc(sizeof(uint32_t) * (base_len + 1));
+    if (index->head == NULL || index->prev == NULL) {
+        return false;
+    }
+    memset(index->head, 0xFF, sizeof(uint32_t) << GEN_HASH_BITS);
+    for (i = 0; i + GEN_WINDOW <= base_len; i++) {
+        uint32_t h = hash_window(&base[i]);
+        index->prev[i] = index->head[h];
+        index->head[h] = i;
+    }
+    return true;
+}
+
+static uint32_t match_len(const gen_index *index, uint32_t from, const uint8_t *image, uint32_t image_left) {
+    uint32_t n = 0, max = index->base_len - from;
+    if (max > image_left) {
+        max = image_left;
+    }
+    while (n < max && index->base[from + n] == image[n]) {
+        n++;
+    }
+    return n;
+}
+
+// Image bytes that no copy covers, split into data and fill ops
+static void put_literals(gen_out *out, const uint8_t *data, uint32_t len) {
+    uint32_t start = 0, i = 0;
+    while (i < len) {
+        uint32_t run = 1;
+        while (i + run < len && data[i + run] == data[i]) {
+            run++;
+        }
+        if (run < GEN_MIN_FILL) {
+            i += run;
+            continue;
+        }
+        if (i > start) {
+            put_byte(out, IMAGE_PATCH_DATA);
+            put_varint(out, i - start);
+            put(out, &data[start], i - start);
+        }
+        put_byte(out, IMAGE_PATCH_FILL);
+        put_varint(out, run);
+        put_byte(out, data[i]);
+        i += run;
+        start = i;
+    }
+    if (len > start) {
+        put_byte(out, IMAGE_PATCH_DATA);
+        put_varint(out, len - start);
+        put(out, &data[start], len - start);
+    }
+}
+
+uint8_t *image_patch_generate(const uint8_t *base, uint32_t base_len, const uint8_t *image, uint32_t image_len,
+                              uint32_t *patch_len) {
+    gen_out out = {0};
+    gen_index index = {0};
+    uint32_t pos = 0, literal = 0, copy_from = 0;
+    uint32_t shift = 0; // base offset minus image offset of the last copy
+
+    if (!index_base(&index, base, base_len)) {
+        free(index.head);
+        free(index.prev);
+        return NULL;
+    }
+
+    put_be32(&out, IMAGE_PATCH_MAGIC);
+    put_be32(&out, base_len);
+    put_be16(&out, crc16_checksum(base, base_len));
+    put_be32(&out, image_len);
+    put_be16(&out, crc16_checksum(image, image_len));
+
+    while (pos < image_len) {
+        uint32_t best_from = GEN_NONE, best_len = 0;
+        uint32_t from = pos + shift;
+
+        if (from < base_len) {
+            best_len = match_len(&index, from, &image[pos], image_len - pos);
+            best_from = from;
+            if (best_len < GEN_MIN_RESUME) {
+                best_len = 0;
+            }
+        }
+        if (best_len < GEN_MIN_MATCH && pos + GEN_WINDOW <= image_len) {
+            uint32_t cand = index.head[hash_window(&image[pos])];
+            int tries;
+            for (tries = 0; tries < GEN_CHAIN && cand != GEN_NONE; tries++, cand = index.prev[cand]) {
+                uint32_t n = match_len(&index, cand, &image[pos], image_len - pos);
+                if (n >= GEN_MIN_MATCH && n > best_len) {
+                    best_from = cand;
+                    best_len = n;
+                }
+            }
+        }
+
+        if (best_len == 0) {
+            pos++;
+            continue;
+        }
+        put_literals(&out, &image[literal], pos - literal);
+        put_byte(&out, IMAGE_PATCH_COPY);
+        uint32_t delta = best_from - copy_from;
+        put_varint(&out, (delta << 1) ^ (0U - (delta >> 31))); // zigzag
+        put_varint(&out, best_len);
+        copy_from = best_from + best_len;
+        shift = best_from - pos;
+        pos += best_len;
+        literal = pos;
+    }
+    put_literals(&out, &image[literal], image_len - literal);
+    put_byte(&out, IMAGE_PATCH_END);
+
+    free(index.head);
+    free(index.prev);
+    if (out.failed) {
+        free(out.data);
+        return NULL;
+    }
+    *patch_len = out.len;
+    return out.data;
+}
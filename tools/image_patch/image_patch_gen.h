@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file image_patch_gen.h
+ * @date 2026-10-19
+ */
+
+#ifndef TOOLS_IMAGE_PATCH_IMAGE_PATCH_GEN_H_
+#define TOOLS_IMAGE_PATCH_IMAGE_PATCH_GEN_H_
+
+#include <stdint.h>
+
+/*
+ * Ground side of ex2_system/include/image_patch.h: builds the patch that turns the
+ * golden image into a new application image.
+ *
+ * Every offset of the base is indexed by a hash of the GEN_WINDOW bytes there.
+ * The image is then walked front to back. At each position the base is tried at
+ * the same alignment as the last copy, which is where unchanged code after an
+ * edit continues, and then at the offsets the index gives. The longest match
+ * becomes a copy if it is long enough to be worth one; otherwise the byte goes
+ * into a data op, or a fill op when it starts a long run of one value.
+ */
+#define GEN_WINDOW 16     // bytes hashed to look a position up in the base
+#define GEN_MIN_MATCH 24  // shortest copy from anywhere in the base
+#define GEN_MIN_RESUME 8  // shortest copy continuing at the last alignment, its offset is one byte
+#define GEN_CHAIN 64      // base offsets tried per position
+#define GEN_MIN_FILL 16   // shortest run of one byte sent as a fill
+#define GEN_HASH_BITS 18
+
+/**
+ * @brief
+ *      Build a patch
+ * @param patch_len
+ *      Set to the bytes in the patch
+ * @return
+ *      The patch, to be freed by the caller, or NULL when memory runs out
+ */
+uint8_t *image_patch_generate(const uint8_t *base, uint32_t base_len, const uint8_t *image, uint32_t image_len,
+                              uint32_t *patch_len);
+
+#endif /* TOOLS_IMAGE_PATCH_IMAGE_PATCH_GEN_H_ */
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026  University of Alberta
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+/**
+ * @file make_patch.c
+ * @date 2026-10-19
+ */
+
+/* make_patch golden.bin new_app.bin new_app.patch
+ *
+ * Both images are the raw binaries written to flash. The patch is uplinked with the
+ * updater service's UPDATE_PATCH_* subservices */
+
+#include "image_patch_gen.h"
+#include "crc16.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint8_t *read_file(const char *path, uint32_t *len) {
+    FILE *f = fopen(path, "rb");
+    uint8_t *data = NULL;
+    long size;
+
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0) {
+        data = malloc(size);
+        if (data != NULL && fread(data, 1, size, f) != (size_t)size) {
+            free(data);
+            data = NULL;
+        }
+        *len = (uint32_t)size;
+    }
+    if (data == NULL) {
+        fprintf(stderr, "%s: cannot read\n", path);
+    }
+    fclose(f);
+    return data;
+}
+
+int main(int argc, char **argv) {
+    uint32_t base_len, image_len, patch_len;
+    uint8_t *base, *image, *patch;
+    FILE *f;
+
+    if (argc != 4) {
+        fprintf(stderr, "usage: %s golden.bin new_app.bin new_app.patch\n", argv[0]);
+        return 2;
+    }
+    base = read_file(argv[1], &base_len);
+    image = read_file(argv[2], &image_len);
+    if (base == NULL || image == NULL) {
+        return 1;
+    }
+    patch = image_patch_generate(base, base_len, image, image_len, &patch_len);
+    if (patch == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    f = fopen(argv[3], "wb");
+    if (f == NULL || fwrite(patch, 1, patch_len, f) != patch_len || fclose(f) != 0) {
+        perror(argv[3]);
+        return 1;
+    }
+    printf("base  %8u bytes crc 0x%04X\n", (unsigned int)base_len, crc16_checksum(base, base_len));
+    printf("image %8u bytes crc 0x%04X\n", (unsigned int)image_len, crc16_checksum(image, image_len));
+    printf("patch %8u bytes, %.1f%% of the image\n", (unsigned int)patch_len, patch_len * 100.0 / image_len);
+
+    free(base);
+    free(image);
+    free(patch);
+    return 0;
+}